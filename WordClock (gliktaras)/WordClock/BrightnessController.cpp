@@ -2,6 +2,9 @@
 
 #define MIN_DIM 100
 
+// Smallest brightness change worth an update, in 8.8 fixed point.
+#define MIN_BRIGHTNESS_STEP 32
+
 BrightnessController::BrightnessController() {}
 
 void BrightnessController::setup()
@@ -14,20 +17,26 @@ void BrightnessController::loop()
 {
   lightSensor_.loop();
 
-  if (lightSensor_.sensitivity == 0)
+  if (brightness_ >= 0 || lightSensor_.sensitivity == 0)
   {
-    RgbColor gamma_corrected = gammaAdjust(original_);
+    WideColor gamma_corrected =
+        gammaAdjust(original_, brightness_ >= 0 ? brightness_ : 255);
     changed_ = corrected_ != gamma_corrected;
     corrected_ = gamma_corrected;
     return;
   }
 
   float dim = (255 - MIN_DIM) * lightSensor_.reading() + MIN_DIM;
-  RgbColor newColor = gammaAdjust(original_.Dim(static_cast<int>(dim)));
-
-  if (abs(corrected_.CalculateBrightness() - newColor.CalculateBrightness()) < 5.)
+  WideColor newColor = gammaAdjust(original_, static_cast<int>(dim));
+
+  // Don't adjust for small changes. The threshold is relative, so that dim
+  // colors still follow the sensor in fractional steps.
+  int oldBrightness = corrected_.CalculateBrightness();
+  int newBrightness = newColor.CalculateBrightness();
+  if (abs(oldBrightness - newBrightness) <
+      max(MIN_BRIGHTNESS_STEP, max(oldBrightness, newBrightness) / 16))
   {
-    return; // don't adjust for small changes.
+    return;
   }
 
   corrected_ = newColor;
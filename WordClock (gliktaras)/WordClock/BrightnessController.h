@@ -3,33 +3,52 @@
 #include <NeoPixelAnimator.h>
 #include <NeoPixelBus.h>
 
+#include "Dither.h"
 #include "LDRReader.h"
 
-/* An 8-bit gamma-correction table from the Adafruit NeoPixel lib.
+/* A gamma-correction table adapted from the Adafruit NeoPixel lib. Values are
+   8.8 fixed point (see WideColor), so that dim colors keep the fraction that
+   temporal dithering needs instead of collapsing to 0-3.
    Copy & paste this snippet into a Python REPL to regenerate:
 import math
 gamma=2.6
 for x in range(256):
-    print("{:3},".format(int(math.pow((x)/255.0,gamma)*255.0+0.5))),
-    if x&15 == 15: print
+    print("{:5},".format(int(math.pow((x)/255.0,gamma)*255.0*256+0.5))),
+    if x&7 == 7: print
 */
-static const uint8_t PROGMEM gammaTable_[256] = {
-    0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
-    0,  0,  0,  0,  0,  0,  0,  0,  1,  1,  1,  1,  1,  1,  1,  1,
-    1,  1,  1,  1,  2,  2,  2,  2,  2,  2,  2,  2,  3,  3,  3,  3,
-    3,  3,  4,  4,  4,  4,  5,  5,  5,  5,  5,  6,  6,  6,  6,  7,
-    7,  7,  8,  8,  8,  9,  9,  9, 10, 10, 10, 11, 11, 11, 12, 12,
-   13, 13, 13, 14, 14, 15, 15, 16, 16, 17, 17, 18, 18, 19, 19, 20,
-   20, 21, 21, 22, 22, 23, 24, 24, 25, 25, 26, 27, 27, 28, 29, 29,
-   30, 31, 31, 32, 33, 34, 34, 35, 36, 37, 38, 38, 39, 40, 41, 42,
-   42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57,
-   58, 59, 60, 61, 62, 63, 64, 65, 66, 68, 69, 70, 71, 72, 73, 75,
-   76, 77, 78, 80, 81, 82, 84, 85, 86, 88, 89, 90, 92, 93, 94, 96,
-   97, 99,100,102,103,105,106,108,109,111,112,114,115,117,119,120,
-  122,124,125,127,129,130,132,134,136,137,139,141,143,145,146,148,
-  150,152,154,156,158,160,162,164,166,168,170,172,174,176,178,180,
-  182,184,186,188,191,193,195,197,199,202,204,206,209,211,213,215,
-  218,220,223,225,227,230,232,235,237,240,242,245,247,250,252,255};
+static const uint16_t PROGMEM gammaTable_[256] = {
+      0,    0,    0,    1,    1,    2,    4,    6,
+      8,   11,   14,   18,   23,   28,   34,   41,
+     49,   57,   66,   76,   87,   99,  112,  125,
+    140,  156,  172,  190,  209,  229,  250,  272,
+    296,  321,  346,  374,  402,  432,  463,  495,
+    529,  564,  600,  638,  677,  718,  760,  804,
+    849,  896,  944,  994, 1046, 1099, 1153, 1210,
+   1268, 1328, 1389, 1452, 1517, 1584, 1652, 1722,
+   1794, 1868, 1944, 2021, 2100, 2182, 2265, 2350,
+   2437, 2526, 2617, 2710, 2805, 2902, 3001, 3102,
+   3205, 3310, 3417, 3527, 3638, 3752, 3868, 3986,
+   4106, 4229, 4353, 4480, 4609, 4741, 4874, 5010,
+   5149, 5289, 5432, 5577, 5725, 5875, 6027, 6182,
+   6340, 6499, 6661, 6826, 6993, 7163, 7335, 7510,
+   7687, 7866, 8049, 8234, 8421, 8611, 8804, 8999,
+   9197, 9398, 9601, 9807,10015,10227,10441,10658,
+  10877,11100,11325,11553,11783,12017,12253,12492,
+  12734,12979,13227,13478,13731,13988,14247,14509,
+  14775,15043,15314,15588,15866,16146,16429,16715,
+  17005,17297,17593,17891,18193,18498,18805,19116,
+  19431,19748,20068,20392,20719,21049,21382,21719,
+  22059,22402,22748,23098,23450,23806,24166,24529,
+  24895,25264,25637,26013,26393,26776,27162,27552,
+  27945,28341,28741,29145,29552,29962,30376,30794,
+  31215,31639,32067,32499,32934,33372,33815,34260,
+  34710,35163,35620,36080,36544,37011,37483,37958,
+  38436,38918,39405,39894,40388,40885,41386,41891,
+  42399,42911,43427,43947,44471,44998,45530,46065,
+  46604,47147,47693,48244,48798,49357,49919,50486,
+  51056,51630,52208,52790,53376,53966,54560,55158,
+  55760,56366,56976,57591,58209,58831,59458,60088,
+  60723,61361,62004,62651,63302,63957,64616,65280};
 
 //
 // Controls the brighness of a LED strip based on the light value of a
@@ -47,6 +66,13 @@ public:
   void loop();
 
   void setSensorSensitivity(int value) { lightSensor_.sensitivity = value; };
+  // Sets a fixed brightness from 0 to 255 instead of following the light
+  // sensor, or follows the sensor again if `value` is negative.
+  void setBrightness(int value) { brightness_ = value; }
+  // Returns the fixed brightness, or -1 if the sensor is followed.
+  int getBrightness() const { return brightness_; }
+  // Returns the smoothed light sensor reading, from 0.0 to 1.0.
+  float getLightLevel() { return lightSensor_.reading(); }
   bool hasChanged()
   {
     bool res = changed_;
@@ -54,19 +80,23 @@ public:
     return res;
   };
   void setOriginalColor(RgbColor color) { original_ = color; }
-  RgbColor getCorrectedColor() { return corrected_; };
+  WideColor getCorrectedColor() { return corrected_; };
+  // Sets the dimmed color until the sensor reading differs enough from it.
+  void setCorrectedColor(const WideColor &color) { corrected_ = color; }
 
   /*!
     @brief   A gamma-correction function for RgbColor. Makes color
              transitions appear more perceptially correct.
     @param   color RgbColor
-    @return  Gamma-adjusted RgbColor.
+    @param   dim Brightness to scale the color to, 255 being unchanged.
+    @return  Gamma-adjusted color, with the fraction kept for dithering.
   */
-  static RgbColor gammaAdjust(RgbColor color)
+  static WideColor gammaAdjust(RgbColor color, uint8_t dim = 255)
   {
-    return RgbColor(pgm_read_byte(&gammaTable_[color.R]),
-                    pgm_read_byte(&gammaTable_[color.G]),
-                    pgm_read_byte(&gammaTable_[color.B]));
+    uint32_t gain = pgm_read_word(&gammaTable_[dim]);
+    return WideColor(pgm_read_word(&gammaTable_[color.R]) * gain / 0xFF00,
+                     pgm_read_word(&gammaTable_[color.G]) * gain / 0xFF00,
+                     pgm_read_word(&gammaTable_[color.B]) * gain / 0xFF00);
   }
 
 private:
@@ -74,11 +104,14 @@ private:
   RgbColor original_ = RgbColor(255);
 
   // Original color dimmed according to the current sensor reading.
-  RgbColor corrected_;
+  WideColor corrected_;
 
   // Dirty flag.
   bool changed_;
 
+  // Fixed brightness, or -1 to follow the sensor.
+  int brightness_ = -1;
+
   // The light sensor.
   LDRReader lightSensor_;
 };
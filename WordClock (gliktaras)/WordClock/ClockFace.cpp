@@ -1,74 +1,219 @@
 #include "logging.h"
 
-#include <NeoPixelBus.h> // Only need NeoTopology
-
 #include "ClockFace.h"
 
-// The number of LEDs connected before the start of the matrix.
-#define NEOPIXEL_SIGNALS 4
-
-// Matrix dimensions.
-#define NEOPIXEL_ROWS 11
-#define NEOPIXEL_COLUMNS 10
+template <typename Geometry>
+BasicClockFace<Geometry>::BasicClockFace(Orientation orientation)
+    : _hour(-1), _minute(-1), _second(-1)
+{
+  static constexpr int width = Geometry::width;
+  static constexpr int height = Geometry::height;
+  // The panels' tables are only needed to build the face's.
+  const Geometry geometry;
+  for (int index = 0; index < orientationCount; index++)
+  {
+    const Orientation variant = static_cast<Orientation>(index);
+    if (!supportsOrientation(variant))
+      continue;
+    const int turns = index & 3;
+    const bool mirrored = (index & 4) != 0;
+    uint16_t *table = _tables[tableIndex(variant)];
+
+    // Undoes the turns, then the mirroring, to find where on the canvas a
+    // grid position is. Quarter turns only exist on square canvases.
+    const auto locate = [&](int x, int y, int *canvasX, int *canvasY) {
+      int turnedX = x, turnedY = y;
+      switch (turns)
+      {
+      case 1:
+        turnedX = y;
+        turnedY = width - 1 - x;
+        break;
+      case 2:
+        turnedX = width - 1 - x;
+        turnedY = height - 1 - y;
+        break;
+      case 3:
+        turnedX = width - 1 - y;
+        turnedY = x;
+        break;
+      }
+      *canvasX = mirrored ? width - 1 - turnedX : turnedX;
+      *canvasY = turnedY;
+    };
+    for (int y = 0; y < height; y++)
+    {
+      for (int x = 0; x < width; x++)
+      {
+        int canvasX, canvasY;
+        locate(x, y, &canvasX, &canvasY);
+        table[y * width + x] = geometry.map(canvasX, canvasY);
+      }
+    }
+    // Corners are wired clockwise from the bottom right one of the canvas.
+    static const Corners corners[] = {TopLeft, BottomLeft, BottomRight, TopRight};
+    for (Corners corner : corners)
+    {
+      const bool right = corner == TopRight || corner == BottomRight;
+      const bool bottom = corner == BottomLeft || corner == BottomRight;
+      int canvasX, canvasY;
+      locate(right ? width - 1 : 0, bottom ? height - 1 : 0, &canvasX,
+             &canvasY);
+      const Corners canvasCorner =
+          canvasX == 0 ? (canvasY == 0 ? TopLeft : BottomLeft)
+                       : (canvasY == 0 ? TopRight : BottomRight);
+      table[width * height + corner] = (canvasCorner + 2) % 4;
+    }
+  }
+  _orientation = supportsOrientation(orientation) ? orientation
+                                                  : Orientation::Rotate0;
+  _map = _tables[tableIndex(_orientation)];
+}
 
-// Number of LEDs on the whole strip.
-#define NEOPIXEL_COUNT (NEOPIXEL_ROWS * NEOPIXEL_COLUMNS + NEOPIXEL_SIGNALS)
+template <typename Geometry>
+bool BasicClockFace<Geometry>::setOrientation(Orientation orientation)
+{
+  if (!supportsOrientation(orientation))
+    return false;
+  _orientation = orientation;
+  _map = _tables[tableIndex(orientation)];
+  _hour = _minute = -1;
+  return true;
+}
 
-// static
-int ClockFace::pixelCount()
+// Lit a segment in updateState.
+template <typename Geometry>
+void BasicClockFace<Geometry>::updateSegment(int x, int y, int length)
 {
-  return NEOPIXEL_COUNT;
+  for (int i = x; i <= x + length - 1; i++)
+    _state[map(i, y)] = true;
 }
 
-ClockFace::ClockFace(LightSensorPosition position) : _hour(-1), _minute(-1), _second(-1),
-                                                     _position(position), _state(NEOPIXEL_COUNT){};
+template class BasicClockFace<FaceGeometry>;
 
-void ClockFace::setLightSensorPosition(LightSensorPosition position)
+#if WORDCLOCK_HAS_LETTER_GRID
+
+// Returns the symbol index of `c` in LetterIndex, or -1 if letter grids do not
+// hold it.
+static int symbolIndex(char c)
 {
-  _position = position;
+  if (c >= 'a' && c <= 'z')
+    return c - 'a';
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c == '!')
+    return 26;
+  if (c == '-')
+    return 27;
+  return -1;
 }
 
-uint16_t ClockFace::map(int16_t x, int16_t y)
+// Returns the first position from `from` on set in `mask`, or -1.
+static int firstPosition(const uint64_t mask[2], int from)
 {
-  switch (_position)
-  {
-  case LightSensorPosition::Top:
+  if (from < 64)
   {
-    static NeoTopology<ColumnMajorAlternating90Layout> sensor_on_top(
-        NEOPIXEL_ROWS, NEOPIXEL_COLUMNS);
-    return sensor_on_top.Map(x, y) + NEOPIXEL_SIGNALS;
-  }
-  case LightSensorPosition::Bottom:
-  {
-    static NeoTopology<ColumnMajorAlternating270Layout> sensor_on_bottom(
-        NEOPIXEL_ROWS, NEOPIXEL_COLUMNS);
-    return sensor_on_bottom.Map(x, y) + NEOPIXEL_SIGNALS;
-  }
-  default:
-    DCHECK(false, static_cast<int>(_position));
+    const uint64_t low = mask[0] & (~0ull << from);
+    if (low != 0)
+      return __builtin_ctzll(low);
+    from = 64;
   }
+  if (from >= 128)
+    return -1;
+  const uint64_t high = mask[1] & (~0ull << (from - 64));
+  return high != 0 ? 64 + __builtin_ctzll(high) : -1;
 }
 
-uint16_t ClockFace::mapMinute(Corners corner)
+int LetterClockFace::place(const char *text, uint8_t *positions) const
 {
-  switch (_position)
+  if (_letters == nullptr)
+    return -1;
+  // First position the next letter may take.
+  int next = 0;
+  int count = 0;
+  bool space = false;
+  for (const char *c = text; *c != 0; c++)
   {
-  case LightSensorPosition::Bottom:
-    return (static_cast<uint16_t>(corner) + 2) % 4;
-  case LightSensorPosition::Top:
-    return static_cast<uint16_t>(corner);
-  default:
-    DCHECK(false, static_cast<int>(corner));
+    if (*c == ' ')
+    {
+      space = count > 0;
+      continue;
+    }
+    const int symbol = symbolIndex(*c);
+    if (symbol < 0)
+      return -1;
+    // Words are apart, unless the previous one ended its row.
+    const int from = space && next % letterGridWidth != 0 ? next + 1 : next;
+    space = false;
+    // Taking the first position that fits leaves the most room to the rest,
+    // so the text fits if this finds positions for all its letters.
+    const int position = firstPosition(_letters->masks[symbol], from);
+    if (position < 0)
+      return -1;
+    if (positions != nullptr)
+      positions[count] = position;
+    count++;
+    next = position + 1;
   }
+  return count;
 }
 
-// Lit a segment in updateState.
-void ClockFace::updateSegment(int x, int y, int length)
+bool LetterClockFace::canSpell(const char *text) const
 {
-  for (int i = x; i <= x + length - 1; i++)
-    _state[map(i, y)] = true;
+  return place(text, nullptr) >= 0;
 }
 
+bool LetterClockFace::stateForText(const char *text)
+{
+  uint8_t positions[letterGridWidth * letterGridHeight];
+  const int count = place(text, positions);
+  if (count < 0)
+    return false;
+
+  _hour = _minute = -1;
+  _state.reset();
+  for (int i = 0; i < count; i++)
+    updateSegment(positions[i] % letterGridWidth,
+                  positions[i] / letterGridWidth, 1);
+  return true;
+}
+
+// Returns the mask of the positions of `symbol` in `letters`, from `first`
+// to first + 63, starting at bit `bit`. Stops at the end of `letters`.
+constexpr uint64_t letterBits(const char *letters, char symbol, int first,
+                              int bit)
+{
+  return bit == 64 || letters[first + bit] == 0
+             ? 0
+             : (letters[first + bit] == symbol ? 1ull << bit : 0) |
+                   letterBits(letters, symbol, first, bit + 1);
+}
+
+// Mask of the positions of `symbol` in `letters`, as in LetterIndex.
+#define LETTER_MASK(letters, symbol) \
+  { letterBits(letters, symbol, 0, 0), letterBits(letters, symbol, 64, 0) }
+
+// Locates every symbol in `letters`, in LetterIndex order.
+#define LETTER_INDEX(letters)                                                \
+  {                                                                          \
+    {                                                                        \
+      LETTER_MASK(letters, 'A'), LETTER_MASK(letters, 'B'),                  \
+      LETTER_MASK(letters, 'C'), LETTER_MASK(letters, 'D'),                  \
+      LETTER_MASK(letters, 'E'), LETTER_MASK(letters, 'F'),                  \
+      LETTER_MASK(letters, 'G'), LETTER_MASK(letters, 'H'),                  \
+      LETTER_MASK(letters, 'I'), LETTER_MASK(letters, 'J'),                  \
+      LETTER_MASK(letters, 'K'), LETTER_MASK(letters, 'L'),                  \
+      LETTER_MASK(letters, 'M'), LETTER_MASK(letters, 'N'),                  \
+      LETTER_MASK(letters, 'O'), LETTER_MASK(letters, 'P'),                  \
+      LETTER_MASK(letters, 'Q'), LETTER_MASK(letters, 'R'),                  \
+      LETTER_MASK(letters, 'S'), LETTER_MASK(letters, 'T'),                  \
+      LETTER_MASK(letters, 'U'), LETTER_MASK(letters, 'V'),                  \
+      LETTER_MASK(letters, 'W'), LETTER_MASK(letters, 'X'),                  \
+      LETTER_MASK(letters, 'Y'), LETTER_MASK(letters, 'Z'),                  \
+      LETTER_MASK(letters, '!'), LETTER_MASK(letters, '-'),                  \
+    }                                                                        \
+  }
+
 //
 // Constants to match the ClockFace.
 //
@@ -89,6 +234,26 @@ void ClockFace::updateSegment(int x, int y, int length)
 // QUARTSPILE!
 //
 
+// The letters above in reading order, the unused ones included, as text can
+// use them.
+constexpr char FR_LETTERS[] = "ILBESTJDEUX"
+                              "QUATRETROIS"
+                              "NEUFUNESEPT"
+                              "HUITSIXCINQ"
+                              "MIDIXMINUIT"
+                              "ONZEWHEURES"
+                              "MOINSYLEDIX"
+                              "ETTROISDEMI"
+                              "VINGT-CINQK"
+                              "QUARTSPILE!";
+static_assert(sizeof(FR_LETTERS) ==
+                  LetterClockFace::letterGridWidth *
+                          LetterClockFace::letterGridHeight + 1,
+              "The French letters must fill the grid");
+
+// Built by the compiler.
+constexpr LetterIndex FR_LETTER_INDEX = LETTER_INDEX(FR_LETTERS);
+
 // All the segments of words on the board. The first too numbers are the
 // coordinate of the first letter of the word, the last is the length. A word
 // must always be on one row.
@@ -127,6 +292,9 @@ void ClockFace::updateSegment(int x, int y, int length)
 #define FR_M_QUARTS 0, 9, 6
 #define FR_M_PILE 6, 9, 4
 
+FrenchClockFace::FrenchClockFace(Orientation orientation)
+    : LetterClockFace(orientation, &FR_LETTER_INDEX) {}
+
 bool FrenchClockFace::stateForTime(int hour, int minute, int second, bool show_ampm)
 {
   if (hour == _hour && minute == _minute)
@@ -140,8 +308,7 @@ bool FrenchClockFace::stateForTime(int hour, int minute, int second, bool show_a
 
   // TODO move to a more convenient place
   // Reset the board to all black
-  for (int i = 0; i < NEOPIXEL_COUNT; i++)
-    _state[i] = false;
+  _state.reset();
 
   int leftover = minute % 5;
   minute = minute - leftover;
@@ -349,14 +516,13 @@ bool EnglishClockFace::stateForTime(int hour, int minute, int second, bool show_
   _hour = hour;
   _minute = minute;
   _show_ampm = show_ampm;
-  Serial.printf("EnglishClockFace::stateForTime() time:%02d:%02d:%02d\n",
-                hour, minute, second);
+  LOGI("EnglishClockFace::stateForTime() time:%02d:%02d:%02d",
+       hour, minute, second);
 
   DLOGLN("update state");
 
   // Reset the board to all black
-  for (int i = 0; i < NEOPIXEL_COUNT; i++)
-    _state[i] = false;
+  _state.reset();
 
   int leftover = minute % 5;
   minute = minute - leftover;
@@ -507,3 +673,5 @@ bool EnglishClockFace::stateForTime(int hour, int minute, int second, bool show_
   }
   return true;
 }
+
+#endif  // WORDCLOCK_HAS_LETTER_GRID
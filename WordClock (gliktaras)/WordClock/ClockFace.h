@@ -1,39 +1,88 @@
 #pragma once
 
-#include <vector>
+#include <stdint.h>
+#include <bitset>
 
-class ClockFace
+#include "geometry.h"
+
+// A clock face over a canvas of the given `Geometry`, see geometry.h.
+template <typename Geometry>
+class BasicClockFace
 {
 public:
-  static int pixelCount();
-
-  // The orientation of the clock is infered from where the light sensor is.
-  enum class LightSensorPosition
+  // One bit per LED, in strip order.
+  typedef std::bitset<Geometry::pixel_count> State;
+
+  static constexpr int pixelCount() { return Geometry::pixel_count; }
+  // Returns the number of letters in a row of the grid.
+  static constexpr int gridWidth() { return Geometry::width; }
+  // Returns the number of rows of the grid.
+  static constexpr int gridHeight() { return Geometry::height; }
+
+  // How the canvas is mounted, seen from the front: mirrored left to right
+  // for the Mirror* ones, then turned clockwise. Rotate0 has the light sensor
+  // at the bottom, Rotate180 on top. Mirror180 mirrors top to bottom.
+  enum class Orientation : uint8_t
   {
-    Bottom,
-    Top
+    Rotate0,
+    Rotate90,
+    Rotate180,
+    Rotate270,
+    Mirror0,
+    Mirror90,
+    Mirror180,
+    Mirror270,
   };
+  static constexpr int orientationCount = 8;
 
-  ClockFace(LightSensorPosition position);
+  // Returns whether the canvas can be mounted with `orientation`. Quarter
+  // turns need a square canvas, as the grid keeps its dimensions.
+  static constexpr bool supportsOrientation(Orientation orientation)
+  {
+    return static_cast<int>(orientation) < orientationCount &&
+           (Geometry::width == Geometry::height ||
+            (static_cast<int>(orientation) & 1) == 0);
+  }
 
-  // Rotates the display.
-  void setLightSensorPosition(LightSensorPosition position);
+  BasicClockFace(Orientation orientation);
+
+  // Rotates or mirrors the display. Returns false, keeping the current
+  // orientation, if the canvas does not support `orientation`. The next
+  // stateForTime() call updates the state.
+  bool setOrientation(Orientation orientation);
+  Orientation getOrientation() const { return _orientation; }
 
   // Updates the state by setting to true all the LEDs that need to be turned on
   // for the given time. Returns false if there is no change since last update,
   // in which case the state is not updated.
   virtual bool stateForTime(int hour, int minute, int second, bool show_ampm) = 0;
 
+  // Updates the state by lighting letters that spell `text` in reading order.
+  // Returns false, leaving the state unchanged, if the face cannot spell it.
+  // The next stateForTime() call always updates the state.
+  virtual bool stateForText(const char *text) { return false; }
+
+  // Returns whether stateForText() can spell `text`. Only reads constant
+  // data, so it may be called from any task.
+  virtual bool canSpell(const char *text) const { return false; }
+
   // Returns the state of all LEDs as pixels. Updated when updateStateForTime()
   // is called.
-  const std::vector<bool> &getState() { return _state; };
+  const State &getState() const { return _state; };
 
-protected:
-  // Lights up a segment in the state.
-  void updateSegment(int x, int y, int length);
+  // Returns the state of all LEDs for modification, e.g. to restore a state
+  // saved by a previous run. The next stateForTime() call always updates it.
+  State &editState()
+  {
+    _hour = _minute = -1;
+    return _state;
+  };
 
   // Returns the index of the LED in the strip given a position on the grid.
-  uint16_t map(int16_t x, int16_t y);
+  uint16_t map(int16_t x, int16_t y) const
+  {
+    return _map[y * Geometry::width + x];
+  }
 
   // The first four LED are the corner ones, counting minutes. They are assumed
   // to be wired in clockwise order, starting from the light sensor position.
@@ -46,31 +95,114 @@ protected:
     BottomRight,
     TopRight
   };
-  uint16_t mapMinute(Corners corner);
+  uint16_t mapMinute(Corners corner) const
+  {
+    return _map[Geometry::width * Geometry::height + corner];
+  }
+
+protected:
+  // Lights up a segment in the state.
+  void updateSegment(int x, int y, int length);
 
   // To avoid refreshing too often, this stores the time of the previous UI
   // update. If nothing changed, there will be no interuption of animations.
   int _hour, _minute, _second;
   bool _show_ampm;
 
-  LightSensorPosition _position;
-
   // Stores the bits of the clock that need to be turned on.
-  std::vector<bool> _state;
+  State _state;
+
+private:
+  // Number of mapping tables, one per supported orientation.
+  static constexpr int tableCount =
+      Geometry::width == Geometry::height ? orientationCount
+                                          : orientationCount / 2;
+
+  // Returns the index of the mapping table of a supported `orientation`.
+  static constexpr int tableIndex(Orientation orientation)
+  {
+    return Geometry::width == Geometry::height
+               ? static_cast<int>(orientation)
+               : static_cast<int>(orientation) >> 1;
+  }
+
+  Orientation _orientation;
+
+  // Strip index of every LED, row by row over the grid followed by the
+  // corners, for every supported orientation. Built once, so that changing
+  // the orientation only moves _map.
+  uint16_t _tables[tableCount][Geometry::pixel_count];
+  // The table of _orientation.
+  const uint16_t *_map;
+};
+
+// The clock face of the geometry the clock is built for.
+typedef BasicClockFace<FaceGeometry> ClockFace;
+
+#if WORDCLOCK_HAS_LETTER_GRID
+// Number of symbols a letter grid may hold: A to Z, '!' and '-'.
+#define LETTER_SYMBOL_COUNT 28
+
+// Where every symbol is on a letter grid. Bit i of a symbol's mask is set if
+// the letter at position i, in reading order, is that symbol.
+struct LetterIndex
+{
+  uint64_t masks[LETTER_SYMBOL_COUNT][2];
+};
+
+// A face of words spelled on an 11 x 10 letter grid, centered on the canvas.
+class LetterClockFace : public ClockFace
+{
+public:
+  static constexpr int letterGridWidth = 11;
+  static constexpr int letterGridHeight = 10;
+
+  static_assert(letterGridWidth <= FaceGeometry::width &&
+                    letterGridHeight <= FaceGeometry::height,
+                "The letter grid must fit the canvas");
+  static_assert(letterGridWidth * letterGridHeight <= 128,
+                "The letter grid must fit LetterIndex's masks");
+
+  // `letters` locates the letters of the grid, or is null if the face
+  // cannot spell text.
+  LetterClockFace(Orientation orientation, const LetterIndex *letters = nullptr)
+      : ClockFace(orientation), _letters(letters){};
+
+  virtual bool stateForText(const char *text);
+  virtual bool canSpell(const char *text) const;
+
+protected:
+  // Lights up a segment of the letter grid in the state.
+  void updateSegment(int x, int y, int length)
+  {
+    ClockFace::updateSegment(x + (FaceGeometry::width - letterGridWidth) / 2,
+                             y + (FaceGeometry::height - letterGridHeight) / 2,
+                             length);
+  }
+
+private:
+  // Places the letters of `text` at the first positions that follow each
+  // other in reading order, with a gap for spaces. Fills `positions`, of
+  // letterGridWidth * letterGridHeight entries, if not null. Returns the
+  // number of letters placed, or -1 if `text` cannot be spelled.
+  int place(const char *text, uint8_t *positions) const;
+
+  const LetterIndex *_letters;
 };
 
-class FrenchClockFace : public ClockFace
+class FrenchClockFace : public LetterClockFace
 {
 public:
-  FrenchClockFace(LightSensorPosition position) : ClockFace(position){};
+  FrenchClockFace(Orientation orientation);
 
   virtual bool stateForTime(int hour, int minute, int second, bool show_ampm);
 };
 
-class EnglishClockFace : public ClockFace
+class EnglishClockFace : public LetterClockFace
 {
 public:
-  EnglishClockFace(LightSensorPosition position) : ClockFace(position){};
+  EnglishClockFace(Orientation orientation) : LetterClockFace(orientation){};
 
   virtual bool stateForTime(int hour, int minute, int second, bool show_ampm);
 };
+#endif  // WORDCLOCK_HAS_LETTER_GRID
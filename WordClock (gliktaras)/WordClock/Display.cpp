@@ -1,30 +1,74 @@
 #include "logging.h"
+#include "metrics.h"
 
 #include "Display.h"
 
-Display::Display(ClockFace &clockFace, uint8_t pin)
+#include <esp_timer.h>
+
+template <typename Geometry>
+BasicDisplay<Geometry>::BasicDisplay(Face &clockFace, uint8_t pin)
     : _clockFace(clockFace),
-      _pixels(ClockFace::pixelCount(), pin),
-      _animations(ClockFace::pixelCount(), NEO_CENTISECONDS) {}
+      _pixels(Geometry::pixel_count, pin),
+      _frame(),
+      _power(Geometry::pixel_count),
+      _powerMetric(&_power),
+      _animations(1, NEO_CENTISECONDS) {}
 
-void Display::setup()
+template <typename Geometry>
+void BasicDisplay<Geometry>::setup()
 {
   _pixels.Begin();
   _brightnessController.setup();
 }
 
-void Display::loop()
+template <typename Geometry>
+void BasicDisplay<Geometry>::loop()
 {
+  TIME_SCOPE(metrics::display_loop_duration);
   _brightnessController.loop();
   _animations.UpdateAnimations();
   if (_brightnessController.hasChanged())
   {
     _update(30); // Update in 300 ms
   }
+  // The LEDs keep showing a still frame until told otherwise.
+  _idle = !_animations.IsAnimating() && !_frameChanged && _steady &&
+          esp_timer_get_time() - _renderedUs < STILL_FRAME_REFRESH_US;
+  if (!_idle)
+  {
+    _render();
+  }
+}
+
+template <typename Geometry>
+void BasicDisplay<Geometry>::_render()
+{
+  const int64_t now = esp_timer_get_time();
+  _power.endFrame(now - _renderedUs);
+  _renderedUs = now;
+
+  const uint32_t scale = _power.scale();
+  bool steady = true;
+  for (int index = 0; index < _frame.size(); index++)
+  {
+    WideColor color = _frame[index];
+    if (scale != POWER_SCALE_ONE)
+    {
+      color = WideColor(color.R * scale >> 16, color.G * scale >> 16,
+                        color.B * scale >> 16);
+    }
+    steady = steady && Dither::isSteady(color);
+    _pixels.SetPixelColor(index, _dither.apply(color, index));
+  }
+  _frameChanged = false;
+  _steady = steady;
+  _dither.nextFrame();
+  TIME_SCOPE(metrics::show_duration);
   _pixels.Show();
 }
 
-void Display::setColor(const RgbColor &color)
+template <typename Geometry>
+void BasicDisplay<Geometry>::setColor(const RgbColor &color)
 {
   DLOGLN("Updating color");
   _color = color;
@@ -32,35 +76,110 @@ void Display::setColor(const RgbColor &color)
   _update();
 }
 
-void Display::_update(int animationSpeed)
+template <typename Geometry>
+void BasicDisplay<Geometry>::restore(const RgbColor &color, const WideColor &shownColor)
+{
+  _color = color;
+  _brightnessController.setOriginalColor(color);
+  _brightnessController.setCorrectedColor(shownColor);
+
+  const typename Face::State &state = _clockFace.getState();
+  for (int index = 0; index < state.size(); index++)
+  {
+    _setPixel(index, state[index] ? shownColor : WideColor());
+  }
+  _render();
+}
+
+template <typename Geometry>
+void BasicDisplay<Geometry>::_update(int animationSpeed, transition::Effect effect)
 {
   DLOGLN("Updating display");
 
   _animations.StopAll();
-  static const RgbColor black = RgbColor(0x00, 0x00, 0x00);
+  static const WideColor black = WideColor(0x00, 0x00, 0x00);
 
-  // For all the LED animate a change from the current visible state to the new
-  // one.
-  const std::vector<bool> &state = _clockFace.getState();
+  // Animate a change of all the LEDs from the current visible state to the
+  // new one.
+  const typename Face::State &state = _clockFace.getState();
   for (int index = 0; index < state.size(); index++)
   {
-    RgbColor originalColor = _pixels.GetPixelColor(index);
-    RgbColor targetColor = state[index] ? _brightnessController.getCorrectedColor() : black;
-
-    AnimUpdateCallback animUpdate = [=](const AnimationParam &param) {
-      float progress = NeoEase::QuadraticIn(param.progress);
-      RgbColor updatedColor = RgbColor::LinearBlend(
-          originalColor, targetColor, progress);
-      _pixels.SetPixelColor(index, updatedColor);
-    };
-    _animations.StartAnimation(index, animationSpeed, animUpdate);
+    _from[index] = _frame[index];
+    _to[index] = state[index] ? _brightnessController.getCorrectedColor() : black;
+  }
+  _effect = effect;
+  _computeDelays(effect);
+
+  AnimUpdateCallback animUpdate = [this](const AnimationParam &param) {
+    _animate(param.progress);
+  };
+  _animations.StartAnimation(0, animationSpeed, animUpdate);
+}
+
+template <typename Geometry>
+void BasicDisplay<Geometry>::_computeDelays(transition::Effect effect)
+{
+  const int width = Geometry::width;
+  const int height = Geometry::height;
+  const uint32_t seed = ++_transitionCount;
+
+  transition::Position position;
+  position.order = 0;
+  position.count = 0;
+  for (int index = 0; index < Geometry::pixel_count; index++)
+  {
+    position.count += _from[index] != _to[index];
   }
+
+  // Visits the LEDs in reading order, corners included.
+  auto place = [&](uint16_t index, int x, int y) {
+    position.x = x;
+    position.y = y;
+    _delays[index] = transition::delayFor(effect, position, width, height, seed);
+    position.order += _from[index] != _to[index];
+  };
+  place(_clockFace.mapMinute(Face::TopLeft), 0, 0);
+  place(_clockFace.mapMinute(Face::TopRight), width - 1, 0);
+  for (int y = 0; y < height; y++)
+  {
+    for (int x = 0; x < width; x++)
+    {
+      place(_clockFace.map(x, y), x, y);
+    }
+  }
+  place(_clockFace.mapMinute(Face::BottomLeft), 0, height - 1);
+  place(_clockFace.mapMinute(Face::BottomRight), width - 1, height - 1);
 }
 
-void Display::updateForTime(int hour, int minute, int second, int animationSpeed)
+template <typename Geometry>
+void BasicDisplay<Geometry>::_animate(float progress)
 {
+  TIME_SCOPE(metrics::transition_frame_duration);
+  const uint32_t at = progress * TRANSITION_ONE;
+  for (int index = 0; index < Geometry::pixel_count; index++)
+  {
+    if (_from[index] == _to[index])
+    {
+      continue;
+    }
+    const uint32_t level = transition::level(_effect, _delays[index], at);
+    _setPixel(index, WideColor::Blend(_from[index], _to[index], level));
+  }
+}
 
-  if (!_clockFace.stateForTime(hour, minute, second, _show_ampm))
+template <typename Geometry>
+void BasicDisplay<Geometry>::updateForTime(int hour, int minute, int second, int animationSpeed)
+{
+  if (_showingText)
+  {
+    return; // The text stays until cleared.
+  }
+  bool changed;
+  {
+    TIME_SCOPE(metrics::state_for_time_duration);
+    changed = _clockFace.stateForTime(hour, minute, second, _show_ampm);
+  }
+  if (!changed)
   {
     return; // Nothing to update.
   }
@@ -72,5 +191,22 @@ void Display::updateForTime(int hour, int minute, int second, int animationSpeed
   DLOG(":");
   DLOGLN(minute);
 
-  _update(animationSpeed);
+  _update(animationSpeed, _transition);
+}
+
+template <typename Geometry>
+bool BasicDisplay<Geometry>::showText(const char *text, int animationSpeed)
+{
+  {
+    TIME_SCOPE(metrics::state_for_text_duration);
+    if (!_clockFace.stateForText(text))
+    {
+      return false;
+    }
+  }
+  _showingText = true;
+  _update(animationSpeed, _transition);
+  return true;
 }
+
+template class BasicDisplay<FaceGeometry>;
@@ -1,10 +1,15 @@
 #pragma once
 
+#include <array>
+
 #include <NeoPixelAnimator.h>
 #include <NeoPixelBrightnessBus.h>
 
 #include "BrightnessController.h"
 #include "ClockFace.h"
+#include "Dither.h"
+#include "power_budget.h"
+#include "transition.h"
 
 // The pin to control the matrix
 #define NEOPIXEL_PIN 32
@@ -12,49 +17,179 @@
 //
 #define TIME_CHANGE_ANIMATION_SPEED 400
 
-class Display
+// Longest time a still frame goes without being sent again, in microseconds.
+// Keeps the energy estimate current, and repairs LEDs that latched a glitch.
+#define STILL_FRAME_REFRESH_US 1000000
+
+// Shows a clock face over a canvas of the given `Geometry`, see geometry.h.
+template <typename Geometry>
+class BasicDisplay
 {
 public:
-  Display(ClockFace &clockFace, uint8_t pin = NEOPIXEL_PIN);
+  typedef BasicClockFace<Geometry> Face;
+  // Color of every LED, in strip order.
+  typedef std::array<WideColor, Geometry::pixel_count> Frame;
+
+  BasicDisplay(Face &clockFace, uint8_t pin = NEOPIXEL_PIN);
 
   void setup();
+  // Animates the frame and sends it to the LEDs, unless it is idle.
   void loop();
+  // Returns whether the last loop() call had nothing to do: no animation ran
+  // and the LEDs already showed the frame, which dithering does not change.
+  bool isIdle() const { return _idle; }
   void setColor(const RgbColor &color);
 
+  // Returns the clock face the display shows.
+  const Face &getClockFace() const { return _clockFace; }
+  // Returns the color of every LED, before dithering.
+  const Frame &getFrame() const { return _frame; }
+
+  // Returns the configured color.
+  const RgbColor &getColor() const { return _color; }
+  // Returns the color lit LEDs are shown with, dimming included.
+  WideColor getShownColor() { return _brightnessController.getCorrectedColor(); }
+
+  // Immediately shows the current clock face state with `color`, dimmed to
+  // `shownColor`, without animation. Used to draw the first frame at boot.
+  void restore(const RgbColor &color, const WideColor &shownColor);
+
   // Sets the sensor sensitivity of the brightness controller.
   int setSensorSensitivity(int value) { _brightnessController.setSensorSensitivity(value); }
 
+  // Sets a fixed brightness from 0 to 255, or follows the light sensor again if
+  // `value` is negative.
+  void setBrightness(int value) { _brightnessController.setBrightness(value); }
+  // Returns the fixed brightness, or -1 if the light sensor is followed.
+  int getBrightness() const { return _brightnessController.getBrightness(); }
+  // Returns the smoothed light sensor reading, from 0.0 to 1.0.
+  float getLightLevel() { return _brightnessController.getLightLevel(); }
+
+  // Sets the current the LEDs may draw, in milliamps, or 0 for no limit.
+  // Frames that would draw more are dimmed as a whole.
+  void setPowerLimit(uint32_t limitMa)
+  {
+    _power.setLimitMa(limitMa);
+    _frameChanged = true;
+  }
+  // Returns the estimated current the LEDs draw, in milliamps.
+  uint32_t getCurrentMa() const { return _power.drawMa(); }
+
+  // Rotates or mirrors the display. Returns false if the canvas does not
+  // support `orientation`. The face is redrawn by the next updateForTime().
+  bool setOrientation(typename Face::Orientation orientation) { return _clockFace.setOrientation(orientation); }
+
+  // Sets the effect of the transitions between two times or texts. Color and
+  // brightness changes always fade.
+  void setTransition(transition::Effect effect) { _transition = effect; }
+  transition::Effect getTransition() const { return _transition; }
+
   // Sets whether to show AM/PM information on the display.
   void setShowAmPm(bool show_ampm) { _show_ampm = show_ampm; }
 
-  // Starts an animation to update the clock to a new time if necessary.
+  // Starts an animation to update the clock to a new time if necessary. Does
+  // nothing while text is shown.
   void updateForTime(int hour, int minute, int second, int animationSpeed = TIME_CHANGE_ANIMATION_SPEED);
 
+  // Starts an animation to spell `text` instead of the time. Returns false,
+  // changing nothing, if the clock face cannot spell it.
+  bool showText(const char *text, int animationSpeed = TIME_CHANGE_ANIMATION_SPEED);
+  // Shows the time again, from the next updateForTime() call.
+  void clearText() { _showingText = false; }
+  // Returns whether text is shown instead of the time.
+  bool isShowingText() const { return _showingText; }
+
 private:
-  // Updates pixel color on the display.
-  void _update(int animationSpeed = TIME_CHANGE_ANIMATION_SPEED);
+  // Starts a transition of every LED from its current color to the one of
+  // the clock face state, with `effect`.
+  void _update(int animationSpeed = TIME_CHANGE_ANIMATION_SPEED,
+               transition::Effect effect = transition::Effect::Fade);
+
+  // Fills _delays for `effect`, from the position of every LED.
+  void _computeDelays(transition::Effect effect);
+
+  // Draws the running transition at `progress` (0.0 to 1.0).
+  void _animate(float progress);
+
+  // Sends the frame to the LEDs, dithered down to 8 bits per channel.
+  void _render();
+
+  // Sets the color of LED `index` in the frame.
+  void _setPixel(int index, const WideColor &color)
+  {
+    if (color == _frame[index])
+    {
+      return;
+    }
+    _power.change(_frame[index], color);
+    _frame[index] = color;
+    _frameChanged = true;
+  }
 
   // To know which pixels to turn on and off, one needs to know which letter
   // matches which LED, and the orientation of the display. This is the job
   // of the clockFace.
-  ClockFace &_clockFace;
+  Face &_clockFace;
 
   // Whether the display should show AM/PM information.
   bool _show_ampm = 1;
 
+  // Whether the display shows text set by showText() rather than the time.
+  bool _showingText = false;
+
+  // Effect of the transitions between two times or texts.
+  transition::Effect _transition = transition::Effect::Fade;
+  // Effect of the running transition.
+  transition::Effect _effect = transition::Effect::Fade;
+  // Number of transitions started, which seeds the random effects.
+  uint32_t _transitionCount = 0;
+  // Colors of every LED at the start and at the end of the running
+  // transition.
+  Frame _from;
+  Frame _to;
+  // When every LED starts to change during the running transition, see
+  // transition::delayFor().
+  uint8_t _delays[Geometry::pixel_count];
+
   // Color of the LEDs. Can be manipulated via Web configuration interface.
   RgbColor _color;
 
   // Addressable bus to control the LEDs.
   NeoPixelBus<NeoGrbFeature, Neo800KbpsMethod> _pixels;
 
+  // Color of every LED with fractional precision. Animations write here, and
+  // _render() turns it into what _pixels shows on each frame.
+  Frame _frame;
+
+  // Temporal dithering of _frame, so that dim colors fade smoothly.
+  Dither _dither;
+
+  // Whether _frame changed since it was last sent.
+  bool _frameChanged = true;
+  // Whether the last frame sent looks the same on every dithering frame.
+  bool _steady = false;
+  // Whether the last loop() call skipped sending the frame.
+  bool _idle = false;
+
+  // Estimates the current _frame draws, and dims it to the limit. Follows
+  // _frame through _setPixel().
+  PowerBudget _power;
+  // Publishes _power's state on /metrics.
+  PowerMetric _powerMetric;
+  // When the previous frame was sent, in microseconds.
+  int64_t _renderedUs = 0;
+
   // Reacts to change in ambient light to adapt the power of the LEDs
   BrightnessController _brightnessController;
 
   //
-  // Animation time management object.
+  // Animation time management object, running a single animation: the
+  // transition of the whole frame.
   // Uses centiseconds as precision, so an animation can range from 1/100 of a
   // second to a little bit more than 10 minutes.
   //
   NeoPixelAnimator _animations;
 };
+
+// The display of the geometry the clock is built for.
+typedef BasicDisplay<FaceGeometry> Display;
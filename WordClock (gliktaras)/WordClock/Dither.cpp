@@ -0,0 +1,18 @@
+#include "Dither.h"
+
+// Thresholds of one dithering cycle, from DITHER_MIN_THRESHOLD to
+// DITHER_MAX_THRESHOLD in bit-reversed order so that the frames where a
+// fraction rounds up are spread evenly over the cycle rather than bunched
+// together.
+static const uint8_t PROGMEM ditherThresholds_[DITHER_FRAMES] = {
+    8, 136, 72, 200, 40, 168, 104, 232, 24, 152, 88, 216, 56, 184, 120, 248};
+
+void Dither::nextFrame()
+{
+  _frame = (_frame + 1) & (DITHER_FRAMES - 1);
+  for (int phase = 0; phase < DITHER_FRAMES; phase++)
+  {
+    _thresholds[phase] = pgm_read_byte(
+        &ditherThresholds_[(_frame + phase) & (DITHER_FRAMES - 1)]);
+  }
+}
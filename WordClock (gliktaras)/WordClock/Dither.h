@@ -0,0 +1,116 @@
+#pragma once
+
+#include <NeoPixelBus.h>
+
+// Number of frames in one temporal dithering cycle. Must be a power of two.
+#define DITHER_FRAMES 16
+
+// Offset between the dithering phases of neighbouring pixels, so that pixels
+// sharing a color do not all blink on the same frame. Must be odd.
+#define DITHER_PIXEL_STRIDE 7
+
+// Lowest and highest thresholds of the dithering cycle. Fractions up to the
+// lowest never round up, fractions above the highest always do.
+#define DITHER_MIN_THRESHOLD 8
+#define DITHER_MAX_THRESHOLD 248
+
+//
+// A color with 8.8 fixed point channels. The high byte is the level an 8 bit
+// LED can show directly, the low byte is the fraction that is spread over
+// several frames by Dither. Full brightness is 0xFF00.
+//
+struct WideColor
+{
+  WideColor(uint16_t r = 0, uint16_t g = 0, uint16_t b = 0) : R(r), G(g), B(b){};
+
+  bool operator==(const WideColor &other) const
+  {
+    return R == other.R && G == other.G && B == other.B;
+  }
+  bool operator!=(const WideColor &other) const { return !(*this == other); }
+
+  // Returns the average of the three channels, in the same 8.8 scale.
+  uint16_t CalculateBrightness() const { return (R + G + B) / 3; }
+
+  // Returns the color at `progress` (0.0 to 1.0) between left and right.
+  static WideColor LinearBlend(const WideColor &left, const WideColor &right,
+                               float progress)
+  {
+    return WideColor(left.R + (right.R - left.R) * progress,
+                     left.G + (right.G - left.G) * progress,
+                     left.B + (right.B - left.B) * progress);
+  }
+
+  // Returns the color at `level` (0 to 0x10000) between left and right,
+  // without floating point.
+  static WideColor Blend(const WideColor &left, const WideColor &right,
+                         uint32_t level)
+  {
+    return WideColor(BlendChannel(left.R, right.R, level),
+                     BlendChannel(left.G, right.G, level),
+                     BlendChannel(left.B, right.B, level));
+  }
+
+  uint16_t R;
+  uint16_t G;
+  uint16_t B;
+
+private:
+  static uint16_t BlendChannel(uint16_t left, uint16_t right, uint32_t level)
+  {
+    return left + ((static_cast<int64_t>(right - left) * level) >> 16);
+  }
+};
+
+//
+// Ordered temporal dithering. A channel at 8.8 level h.l is shown as h + 1 on
+// roughly l / 256 of the frames and as h on the others, so that the eye
+// averages it to the intended level.
+//
+// The per-pixel thresholds of the current frame are precomputed by
+// nextFrame(), which leaves only a table lookup and three compares per pixel
+// in apply().
+//
+class Dither
+{
+public:
+  Dither() { nextFrame(); }
+
+  // Returns the 8 bit color to send for `color` on LED `index` this frame.
+  RgbColor apply(const WideColor &color, uint16_t index) const
+  {
+    uint8_t threshold =
+        _thresholds[(index * DITHER_PIXEL_STRIDE) & (DITHER_FRAMES - 1)];
+    return RgbColor(quantize(color.R, threshold),
+                    quantize(color.G, threshold),
+                    quantize(color.B, threshold));
+  }
+
+  // Moves to the next frame of the dithering cycle.
+  void nextFrame();
+
+  // Returns whether `color` is shown the same on every frame of the cycle.
+  static bool isSteady(const WideColor &color)
+  {
+    return isSteady(color.R) && isSteady(color.G) && isSteady(color.B);
+  }
+
+private:
+  static bool isSteady(uint16_t value)
+  {
+    return (value & 0xFF) <= DITHER_MIN_THRESHOLD ||
+           (value & 0xFF) > DITHER_MAX_THRESHOLD;
+  }
+
+  static uint8_t quantize(uint16_t value, uint8_t threshold)
+  {
+    uint8_t level = value >> 8;
+    return (value & 0xFF) > threshold && level < 255 ? level + 1 : level;
+  }
+
+  // Position in the dithering cycle.
+  uint8_t _frame = 0;
+
+  // Threshold of every pixel phase for the current frame.
+  uint8_t _thresholds[DITHER_FRAMES];
+};
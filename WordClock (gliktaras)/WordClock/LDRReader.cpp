@@ -14,7 +14,8 @@ void LDRReader::setup()
 {
   pinMode(_pin, INPUT);
   _currentLDR = analogRead(_pin); // Initial value.
-  Serial.printf("LDRReader::setup() reading from pin:%d, value:%f\n", _pin, _currentLDR);
+  LOGI("LDRReader::setup() reading from pin:%d, value:%d", _pin,
+       static_cast<int>(_currentLDR));
 }
 
 void LDRReader::loop()
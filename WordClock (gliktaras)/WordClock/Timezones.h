@@ -1,931 +0,0 @@
-
-#include <Arduino.h>
-
-// This file was generated by the script in tools/timezones_gen.js,
-// based on data found in https://github.com/nayarsystems/posix_tz_db
-
-const char location0[] PROGMEM = "Africa/Abidjan";
-const char location1[] PROGMEM = "Africa/Accra";
-const char location2[] PROGMEM = "Africa/Addis Ababa";
-const char location3[] PROGMEM = "Africa/Algiers";
-const char location4[] PROGMEM = "Africa/Asmara";
-const char location5[] PROGMEM = "Africa/Bamako";
-const char location6[] PROGMEM = "Africa/Bangui";
-const char location7[] PROGMEM = "Africa/Banjul";
-const char location8[] PROGMEM = "Africa/Bissau";
-const char location9[] PROGMEM = "Africa/Blantyre";
-const char location10[] PROGMEM = "Africa/Brazzaville";
-const char location11[] PROGMEM = "Africa/Bujumbura";
-const char location12[] PROGMEM = "Africa/Cairo";
-const char location13[] PROGMEM = "Africa/Casablanca";
-const char location14[] PROGMEM = "Africa/Ceuta";
-const char location15[] PROGMEM = "Africa/Conakry";
-const char location16[] PROGMEM = "Africa/Dakar";
-const char location17[] PROGMEM = "Africa/Dar es Salaam";
-const char location18[] PROGMEM = "Africa/Djibouti";
-const char location19[] PROGMEM = "Africa/Douala";
-const char location20[] PROGMEM = "Africa/El Aaiun";
-const char location21[] PROGMEM = "Africa/Freetown";
-const char location22[] PROGMEM = "Africa/Gaborone";
-const char location23[] PROGMEM = "Africa/Harare";
-const char location24[] PROGMEM = "Africa/Johannesburg";
-const char location25[] PROGMEM = "Africa/Juba";
-const char location26[] PROGMEM = "Africa/Kampala";
-const char location27[] PROGMEM = "Africa/Khartoum";
-const char location28[] PROGMEM = "Africa/Kigali";
-const char location29[] PROGMEM = "Africa/Kinshasa";
-const char location30[] PROGMEM = "Africa/Lagos";
-const char location31[] PROGMEM = "Africa/Libreville";
-const char location32[] PROGMEM = "Africa/Lome";
-const char location33[] PROGMEM = "Africa/Luanda";
-const char location34[] PROGMEM = "Africa/Lubumbashi";
-const char location35[] PROGMEM = "Africa/Lusaka";
-const char location36[] PROGMEM = "Africa/Malabo";
-const char location37[] PROGMEM = "Africa/Maputo";
-const char location38[] PROGMEM = "Africa/Maseru";
-const char location39[] PROGMEM = "Africa/Mbabane";
-const char location40[] PROGMEM = "Africa/Mogadishu";
-const char location41[] PROGMEM = "Africa/Monrovia";
-const char location42[] PROGMEM = "Africa/Nairobi";
-const char location43[] PROGMEM = "Africa/Ndjamena";
-const char location44[] PROGMEM = "Africa/Niamey";
-const char location45[] PROGMEM = "Africa/Nouakchott";
-const char location46[] PROGMEM = "Africa/Ouagadougou";
-const char location47[] PROGMEM = "Africa/Porto-Novo";
-const char location48[] PROGMEM = "Africa/Sao Tome";
-const char location49[] PROGMEM = "Africa/Tripoli";
-const char location50[] PROGMEM = "Africa/Tunis";
-const char location51[] PROGMEM = "Africa/Windhoek";
-const char location52[] PROGMEM = "America/Adak";
-const char location53[] PROGMEM = "America/Anchorage";
-const char location54[] PROGMEM = "America/Anguilla";
-const char location55[] PROGMEM = "America/Antigua";
-const char location56[] PROGMEM = "America/Araguaina";
-const char location57[] PROGMEM = "America/Argentina/Buenos Aires";
-const char location58[] PROGMEM = "America/Argentina/Catamarca";
-const char location59[] PROGMEM = "America/Argentina/Cordoba";
-const char location60[] PROGMEM = "America/Argentina/Jujuy";
-const char location61[] PROGMEM = "America/Argentina/La Rioja";
-const char location62[] PROGMEM = "America/Argentina/Mendoza";
-const char location63[] PROGMEM = "America/Argentina/Rio Gallegos";
-const char location64[] PROGMEM = "America/Argentina/Salta";
-const char location65[] PROGMEM = "America/Argentina/San Juan";
-const char location66[] PROGMEM = "America/Argentina/San Luis";
-const char location67[] PROGMEM = "America/Argentina/Tucuman";
-const char location68[] PROGMEM = "America/Argentina/Ushuaia";
-const char location69[] PROGMEM = "America/Aruba";
-const char location70[] PROGMEM = "America/Asuncion";
-const char location71[] PROGMEM = "America/Atikokan";
-const char location72[] PROGMEM = "America/Bahia";
-const char location73[] PROGMEM = "America/Bahia Banderas";
-const char location74[] PROGMEM = "America/Barbados";
-const char location75[] PROGMEM = "America/Belem";
-const char location76[] PROGMEM = "America/Belize";
-const char location77[] PROGMEM = "America/Blanc-Sablon";
-const char location78[] PROGMEM = "America/Boa Vista";
-const char location79[] PROGMEM = "America/Bogota";
-const char location80[] PROGMEM = "America/Boise";
-const char location81[] PROGMEM = "America/Cambridge Bay";
-const char location82[] PROGMEM = "America/Campo Grande";
-const char location83[] PROGMEM = "America/Cancun";
-const char location84[] PROGMEM = "America/Caracas";
-const char location85[] PROGMEM = "America/Cayenne";
-const char location86[] PROGMEM = "America/Cayman";
-const char location87[] PROGMEM = "America/Chicago";
-const char location88[] PROGMEM = "America/Chihuahua";
-const char location89[] PROGMEM = "America/Costa Rica";
-const char location90[] PROGMEM = "America/Creston";
-const char location91[] PROGMEM = "America/Cuiaba";
-const char location92[] PROGMEM = "America/Curacao";
-const char location93[] PROGMEM = "America/Danmarkshavn";
-const char location94[] PROGMEM = "America/Dawson";
-const char location95[] PROGMEM = "America/Dawson Creek";
-const char location96[] PROGMEM = "America/Denver";
-const char location97[] PROGMEM = "America/Detroit";
-const char location98[] PROGMEM = "America/Dominica";
-const char location99[] PROGMEM = "America/Edmonton";
-const char location100[] PROGMEM = "America/Eirunepe";
-const char location101[] PROGMEM = "America/El Salvador";
-const char location102[] PROGMEM = "America/Fort Nelson";
-const char location103[] PROGMEM = "America/Fortaleza";
-const char location104[] PROGMEM = "America/Glace Bay";
-const char location105[] PROGMEM = "America/Godthab";
-const char location106[] PROGMEM = "America/Goose Bay";
-const char location107[] PROGMEM = "America/Grand Turk";
-const char location108[] PROGMEM = "America/Grenada";
-const char location109[] PROGMEM = "America/Guadeloupe";
-const char location110[] PROGMEM = "America/Guatemala";
-const char location111[] PROGMEM = "America/Guayaquil";
-const char location112[] PROGMEM = "America/Guyana";
-const char location113[] PROGMEM = "America/Halifax";
-const char location114[] PROGMEM = "America/Havana";
-const char location115[] PROGMEM = "America/Hermosillo";
-const char location116[] PROGMEM = "America/Indiana/Indianapolis";
-const char location117[] PROGMEM = "America/Indiana/Knox";
-const char location118[] PROGMEM = "America/Indiana/Marengo";
-const char location119[] PROGMEM = "America/Indiana/Petersburg";
-const char location120[] PROGMEM = "America/Indiana/Tell City";
-const char location121[] PROGMEM = "America/Indiana/Vevay";
-const char location122[] PROGMEM = "America/Indiana/Vincennes";
-const char location123[] PROGMEM = "America/Indiana/Winamac";
-const char location124[] PROGMEM = "America/Inuvik";
-const char location125[] PROGMEM = "America/Iqaluit";
-const char location126[] PROGMEM = "America/Jamaica";
-const char location127[] PROGMEM = "America/Juneau";
-const char location128[] PROGMEM = "America/Kentucky/Louisville";
-const char location129[] PROGMEM = "America/Kentucky/Monticello";
-const char location130[] PROGMEM = "America/Kralendijk";
-const char location131[] PROGMEM = "America/La Paz";
-const char location132[] PROGMEM = "America/Lima";
-const char location133[] PROGMEM = "America/Los Angeles";
-const char location134[] PROGMEM = "America/Lower Princes";
-const char location135[] PROGMEM = "America/Maceio";
-const char location136[] PROGMEM = "America/Managua";
-const char location137[] PROGMEM = "America/Manaus";
-const char location138[] PROGMEM = "America/Marigot";
-const char location139[] PROGMEM = "America/Martinique";
-const char location140[] PROGMEM = "America/Matamoros";
-const char location141[] PROGMEM = "America/Mazatlan";
-const char location142[] PROGMEM = "America/Menominee";
-const char location143[] PROGMEM = "America/Merida";
-const char location144[] PROGMEM = "America/Metlakatla";
-const char location145[] PROGMEM = "America/Mexico City";
-const char location146[] PROGMEM = "America/Miquelon";
-const char location147[] PROGMEM = "America/Moncton";
-const char location148[] PROGMEM = "America/Monterrey";
-const char location149[] PROGMEM = "America/Montevideo";
-const char location150[] PROGMEM = "America/Montreal";
-const char location151[] PROGMEM = "America/Montserrat";
-const char location152[] PROGMEM = "America/Nassau";
-const char location153[] PROGMEM = "America/New York";
-const char location154[] PROGMEM = "America/Nipigon";
-const char location155[] PROGMEM = "America/Nome";
-const char location156[] PROGMEM = "America/Noronha";
-const char location157[] PROGMEM = "America/North Dakota/Beulah";
-const char location158[] PROGMEM = "America/North Dakota/Center";
-const char location159[] PROGMEM = "America/North Dakota/New Salem";
-const char location160[] PROGMEM = "America/Ojinaga";
-const char location161[] PROGMEM = "America/Panama";
-const char location162[] PROGMEM = "America/Pangnirtung";
-const char location163[] PROGMEM = "America/Paramaribo";
-const char location164[] PROGMEM = "America/Phoenix";
-const char location165[] PROGMEM = "America/Port-au-Prince";
-const char location166[] PROGMEM = "America/Port of Spain";
-const char location167[] PROGMEM = "America/Porto Velho";
-const char location168[] PROGMEM = "America/Puerto Rico";
-const char location169[] PROGMEM = "America/Punta Arenas";
-const char location170[] PROGMEM = "America/Rainy River";
-const char location171[] PROGMEM = "America/Rankin Inlet";
-const char location172[] PROGMEM = "America/Recife";
-const char location173[] PROGMEM = "America/Regina";
-const char location174[] PROGMEM = "America/Resolute";
-const char location175[] PROGMEM = "America/Rio Branco";
-const char location176[] PROGMEM = "America/Santarem";
-const char location177[] PROGMEM = "America/Santiago";
-const char location178[] PROGMEM = "America/Santo Domingo";
-const char location179[] PROGMEM = "America/Sao Paulo";
-const char location180[] PROGMEM = "America/Scoresbysund";
-const char location181[] PROGMEM = "America/Sitka";
-const char location182[] PROGMEM = "America/St Barthelemy";
-const char location183[] PROGMEM = "America/St Johns";
-const char location184[] PROGMEM = "America/St Kitts";
-const char location185[] PROGMEM = "America/St Lucia";
-const char location186[] PROGMEM = "America/St Thomas";
-const char location187[] PROGMEM = "America/St Vincent";
-const char location188[] PROGMEM = "America/Swift Current";
-const char location189[] PROGMEM = "America/Tegucigalpa";
-const char location190[] PROGMEM = "America/Thule";
-const char location191[] PROGMEM = "America/Thunder Bay";
-const char location192[] PROGMEM = "America/Tijuana";
-const char location193[] PROGMEM = "America/Toronto";
-const char location194[] PROGMEM = "America/Tortola";
-const char location195[] PROGMEM = "America/Vancouver";
-const char location196[] PROGMEM = "America/Whitehorse";
-const char location197[] PROGMEM = "America/Winnipeg";
-const char location198[] PROGMEM = "America/Yakutat";
-const char location199[] PROGMEM = "America/Yellowknife";
-const char location200[] PROGMEM = "Antarctica/Casey";
-const char location201[] PROGMEM = "Antarctica/Davis";
-const char location202[] PROGMEM = "Antarctica/DumontDUrville";
-const char location203[] PROGMEM = "Antarctica/Macquarie";
-const char location204[] PROGMEM = "Antarctica/Mawson";
-const char location205[] PROGMEM = "Antarctica/McMurdo";
-const char location206[] PROGMEM = "Antarctica/Palmer";
-const char location207[] PROGMEM = "Antarctica/Rothera";
-const char location208[] PROGMEM = "Antarctica/Syowa";
-const char location209[] PROGMEM = "Antarctica/Troll";
-const char location210[] PROGMEM = "Antarctica/Vostok";
-const char location211[] PROGMEM = "Arctic/Longyearbyen";
-const char location212[] PROGMEM = "Asia/Aden";
-const char location213[] PROGMEM = "Asia/Almaty";
-const char location214[] PROGMEM = "Asia/Amman";
-const char location215[] PROGMEM = "Asia/Anadyr";
-const char location216[] PROGMEM = "Asia/Aqtau";
-const char location217[] PROGMEM = "Asia/Aqtobe";
-const char location218[] PROGMEM = "Asia/Ashgabat";
-const char location219[] PROGMEM = "Asia/Atyrau";
-const char location220[] PROGMEM = "Asia/Baghdad";
-const char location221[] PROGMEM = "Asia/Bahrain";
-const char location222[] PROGMEM = "Asia/Baku";
-const char location223[] PROGMEM = "Asia/Bangkok";
-const char location224[] PROGMEM = "Asia/Barnaul";
-const char location225[] PROGMEM = "Asia/Beirut";
-const char location226[] PROGMEM = "Asia/Bishkek";
-const char location227[] PROGMEM = "Asia/Brunei";
-const char location228[] PROGMEM = "Asia/Chita";
-const char location229[] PROGMEM = "Asia/Choibalsan";
-const char location230[] PROGMEM = "Asia/Colombo";
-const char location231[] PROGMEM = "Asia/Damascus";
-const char location232[] PROGMEM = "Asia/Dhaka";
-const char location233[] PROGMEM = "Asia/Dili";
-const char location234[] PROGMEM = "Asia/Dubai";
-const char location235[] PROGMEM = "Asia/Dushanbe";
-const char location236[] PROGMEM = "Asia/Famagusta";
-const char location237[] PROGMEM = "Asia/Gaza";
-const char location238[] PROGMEM = "Asia/Hebron";
-const char location239[] PROGMEM = "Asia/Ho Chi Minh";
-const char location240[] PROGMEM = "Asia/Hong Kong";
-const char location241[] PROGMEM = "Asia/Hovd";
-const char location242[] PROGMEM = "Asia/Irkutsk";
-const char location243[] PROGMEM = "Asia/Jakarta";
-const char location244[] PROGMEM = "Asia/Jayapura";
-const char location245[] PROGMEM = "Asia/Jerusalem";
-const char location246[] PROGMEM = "Asia/Kabul";
-const char location247[] PROGMEM = "Asia/Kamchatka";
-const char location248[] PROGMEM = "Asia/Karachi";
-const char location249[] PROGMEM = "Asia/Kathmandu";
-const char location250[] PROGMEM = "Asia/Khandyga";
-const char location251[] PROGMEM = "Asia/Kolkata";
-const char location252[] PROGMEM = "Asia/Krasnoyarsk";
-const char location253[] PROGMEM = "Asia/Kuala Lumpur";
-const char location254[] PROGMEM = "Asia/Kuching";
-const char location255[] PROGMEM = "Asia/Kuwait";
-const char location256[] PROGMEM = "Asia/Macau";
-const char location257[] PROGMEM = "Asia/Magadan";
-const char location258[] PROGMEM = "Asia/Makassar";
-const char location259[] PROGMEM = "Asia/Manila";
-const char location260[] PROGMEM = "Asia/Muscat";
-const char location261[] PROGMEM = "Asia/Nicosia";
-const char location262[] PROGMEM = "Asia/Novokuznetsk";
-const char location263[] PROGMEM = "Asia/Novosibirsk";
-const char location264[] PROGMEM = "Asia/Omsk";
-const char location265[] PROGMEM = "Asia/Oral";
-const char location266[] PROGMEM = "Asia/Phnom Penh";
-const char location267[] PROGMEM = "Asia/Pontianak";
-const char location268[] PROGMEM = "Asia/Pyongyang";
-const char location269[] PROGMEM = "Asia/Qatar";
-const char location270[] PROGMEM = "Asia/Qyzylorda";
-const char location271[] PROGMEM = "Asia/Riyadh";
-const char location272[] PROGMEM = "Asia/Sakhalin";
-const char location273[] PROGMEM = "Asia/Samarkand";
-const char location274[] PROGMEM = "Asia/Seoul";
-const char location275[] PROGMEM = "Asia/Shanghai";
-const char location276[] PROGMEM = "Asia/Singapore";
-const char location277[] PROGMEM = "Asia/Srednekolymsk";
-const char location278[] PROGMEM = "Asia/Taipei";
-const char location279[] PROGMEM = "Asia/Tashkent";
-const char location280[] PROGMEM = "Asia/Tbilisi";
-const char location281[] PROGMEM = "Asia/Tehran";
-const char location282[] PROGMEM = "Asia/Thimphu";
-const char location283[] PROGMEM = "Asia/Tokyo";
-const char location284[] PROGMEM = "Asia/Tomsk";
-const char location285[] PROGMEM = "Asia/Ulaanbaatar";
-const char location286[] PROGMEM = "Asia/Urumqi";
-const char location287[] PROGMEM = "Asia/Ust-Nera";
-const char location288[] PROGMEM = "Asia/Vientiane";
-const char location289[] PROGMEM = "Asia/Vladivostok";
-const char location290[] PROGMEM = "Asia/Yakutsk";
-const char location291[] PROGMEM = "Asia/Yangon";
-const char location292[] PROGMEM = "Asia/Yekaterinburg";
-const char location293[] PROGMEM = "Asia/Yerevan";
-const char location294[] PROGMEM = "Atlantic/Azores";
-const char location295[] PROGMEM = "Atlantic/Bermuda";
-const char location296[] PROGMEM = "Atlantic/Canary";
-const char location297[] PROGMEM = "Atlantic/Cape Verde";
-const char location298[] PROGMEM = "Atlantic/Faroe";
-const char location299[] PROGMEM = "Atlantic/Madeira";
-const char location300[] PROGMEM = "Atlantic/Reykjavik";
-const char location301[] PROGMEM = "Atlantic/South Georgia";
-const char location302[] PROGMEM = "Atlantic/St Helena";
-const char location303[] PROGMEM = "Atlantic/Stanley";
-const char location304[] PROGMEM = "Australia/Adelaide";
-const char location305[] PROGMEM = "Australia/Brisbane";
-const char location306[] PROGMEM = "Australia/Broken Hill";
-const char location307[] PROGMEM = "Australia/Currie";
-const char location308[] PROGMEM = "Australia/Darwin";
-const char location309[] PROGMEM = "Australia/Eucla";
-const char location310[] PROGMEM = "Australia/Hobart";
-const char location311[] PROGMEM = "Australia/Lindeman";
-const char location312[] PROGMEM = "Australia/Lord Howe";
-const char location313[] PROGMEM = "Australia/Melbourne";
-const char location314[] PROGMEM = "Australia/Perth";
-const char location315[] PROGMEM = "Australia/Sydney";
-const char location316[] PROGMEM = "Etc/GMT";
-const char location317[] PROGMEM = "Etc/GMT+0";
-const char location318[] PROGMEM = "Etc/GMT+1";
-const char location319[] PROGMEM = "Etc/GMT+10";
-const char location320[] PROGMEM = "Etc/GMT+11";
-const char location321[] PROGMEM = "Etc/GMT+12";
-const char location322[] PROGMEM = "Etc/GMT+2";
-const char location323[] PROGMEM = "Etc/GMT+3";
-const char location324[] PROGMEM = "Etc/GMT+4";
-const char location325[] PROGMEM = "Etc/GMT+5";
-const char location326[] PROGMEM = "Etc/GMT+6";
-const char location327[] PROGMEM = "Etc/GMT+7";
-const char location328[] PROGMEM = "Etc/GMT+8";
-const char location329[] PROGMEM = "Etc/GMT+9";
-const char location330[] PROGMEM = "Etc/GMT-0";
-const char location331[] PROGMEM = "Etc/GMT-1";
-const char location332[] PROGMEM = "Etc/GMT-10";
-const char location333[] PROGMEM = "Etc/GMT-11";
-const char location334[] PROGMEM = "Etc/GMT-12";
-const char location335[] PROGMEM = "Etc/GMT-13";
-const char location336[] PROGMEM = "Etc/GMT-14";
-const char location337[] PROGMEM = "Etc/GMT-2";
-const char location338[] PROGMEM = "Etc/GMT-3";
-const char location339[] PROGMEM = "Etc/GMT-4";
-const char location340[] PROGMEM = "Etc/GMT-5";
-const char location341[] PROGMEM = "Etc/GMT-6";
-const char location342[] PROGMEM = "Etc/GMT-7";
-const char location343[] PROGMEM = "Etc/GMT-8";
-const char location344[] PROGMEM = "Etc/GMT-9";
-const char location345[] PROGMEM = "Etc/GMT0";
-const char location346[] PROGMEM = "Etc/Greenwich";
-const char location347[] PROGMEM = "Etc/UCT";
-const char location348[] PROGMEM = "Etc/UTC";
-const char location349[] PROGMEM = "Etc/Universal";
-const char location350[] PROGMEM = "Etc/Zulu";
-const char location351[] PROGMEM = "Europe/Amsterdam";
-const char location352[] PROGMEM = "Europe/Andorra";
-const char location353[] PROGMEM = "Europe/Astrakhan";
-const char location354[] PROGMEM = "Europe/Athens";
-const char location355[] PROGMEM = "Europe/Belgrade";
-const char location356[] PROGMEM = "Europe/Berlin";
-const char location357[] PROGMEM = "Europe/Bratislava";
-const char location358[] PROGMEM = "Europe/Brussels";
-const char location359[] PROGMEM = "Europe/Bucharest";
-const char location360[] PROGMEM = "Europe/Budapest";
-const char location361[] PROGMEM = "Europe/Busingen";
-const char location362[] PROGMEM = "Europe/Chisinau";
-const char location363[] PROGMEM = "Europe/Copenhagen";
-const char location364[] PROGMEM = "Europe/Dublin";
-const char location365[] PROGMEM = "Europe/Gibraltar";
-const char location366[] PROGMEM = "Europe/Guernsey";
-const char location367[] PROGMEM = "Europe/Helsinki";
-const char location368[] PROGMEM = "Europe/Isle of Man";
-const char location369[] PROGMEM = "Europe/Istanbul";
-const char location370[] PROGMEM = "Europe/Jersey";
-const char location371[] PROGMEM = "Europe/Kaliningrad";
-const char location372[] PROGMEM = "Europe/Kiev";
-const char location373[] PROGMEM = "Europe/Kirov";
-const char location374[] PROGMEM = "Europe/Lisbon";
-const char location375[] PROGMEM = "Europe/Ljubljana";
-const char location376[] PROGMEM = "Europe/London";
-const char location377[] PROGMEM = "Europe/Luxembourg";
-const char location378[] PROGMEM = "Europe/Madrid";
-const char location379[] PROGMEM = "Europe/Malta";
-const char location380[] PROGMEM = "Europe/Mariehamn";
-const char location381[] PROGMEM = "Europe/Minsk";
-const char location382[] PROGMEM = "Europe/Monaco";
-const char location383[] PROGMEM = "Europe/Moscow";
-const char location384[] PROGMEM = "Europe/Oslo";
-const char location385[] PROGMEM = "Europe/Paris";
-const char location386[] PROGMEM = "Europe/Podgorica";
-const char location387[] PROGMEM = "Europe/Prague";
-const char location388[] PROGMEM = "Europe/Riga";
-const char location389[] PROGMEM = "Europe/Rome";
-const char location390[] PROGMEM = "Europe/Samara";
-const char location391[] PROGMEM = "Europe/San Marino";
-const char location392[] PROGMEM = "Europe/Sarajevo";
-const char location393[] PROGMEM = "Europe/Saratov";
-const char location394[] PROGMEM = "Europe/Simferopol";
-const char location395[] PROGMEM = "Europe/Skopje";
-const char location396[] PROGMEM = "Europe/Sofia";
-const char location397[] PROGMEM = "Europe/Stockholm";
-const char location398[] PROGMEM = "Europe/Tallinn";
-const char location399[] PROGMEM = "Europe/Tirane";
-const char location400[] PROGMEM = "Europe/Ulyanovsk";
-const char location401[] PROGMEM = "Europe/Uzhgorod";
-const char location402[] PROGMEM = "Europe/Vaduz";
-const char location403[] PROGMEM = "Europe/Vatican";
-const char location404[] PROGMEM = "Europe/Vienna";
-const char location405[] PROGMEM = "Europe/Vilnius";
-const char location406[] PROGMEM = "Europe/Volgograd";
-const char location407[] PROGMEM = "Europe/Warsaw";
-const char location408[] PROGMEM = "Europe/Zagreb";
-const char location409[] PROGMEM = "Europe/Zaporozhye";
-const char location410[] PROGMEM = "Europe/Zurich";
-const char location411[] PROGMEM = "Indian/Antananarivo";
-const char location412[] PROGMEM = "Indian/Chagos";
-const char location413[] PROGMEM = "Indian/Christmas";
-const char location414[] PROGMEM = "Indian/Cocos";
-const char location415[] PROGMEM = "Indian/Comoro";
-const char location416[] PROGMEM = "Indian/Kerguelen";
-const char location417[] PROGMEM = "Indian/Mahe";
-const char location418[] PROGMEM = "Indian/Maldives";
-const char location419[] PROGMEM = "Indian/Mauritius";
-const char location420[] PROGMEM = "Indian/Mayotte";
-const char location421[] PROGMEM = "Indian/Reunion";
-const char location422[] PROGMEM = "Pacific/Apia";
-const char location423[] PROGMEM = "Pacific/Auckland";
-const char location424[] PROGMEM = "Pacific/Bougainville";
-const char location425[] PROGMEM = "Pacific/Chatham";
-const char location426[] PROGMEM = "Pacific/Chuuk";
-const char location427[] PROGMEM = "Pacific/Easter";
-const char location428[] PROGMEM = "Pacific/Efate";
-const char location429[] PROGMEM = "Pacific/Enderbury";
-const char location430[] PROGMEM = "Pacific/Fakaofo";
-const char location431[] PROGMEM = "Pacific/Fiji";
-const char location432[] PROGMEM = "Pacific/Funafuti";
-const char location433[] PROGMEM = "Pacific/Galapagos";
-const char location434[] PROGMEM = "Pacific/Gambier";
-const char location435[] PROGMEM = "Pacific/Guadalcanal";
-const char location436[] PROGMEM = "Pacific/Guam";
-const char location437[] PROGMEM = "Pacific/Honolulu";
-const char location438[] PROGMEM = "Pacific/Kiritimati";
-const char location439[] PROGMEM = "Pacific/Kosrae";
-const char location440[] PROGMEM = "Pacific/Kwajalein";
-const char location441[] PROGMEM = "Pacific/Majuro";
-const char location442[] PROGMEM = "Pacific/Marquesas";
-const char location443[] PROGMEM = "Pacific/Midway";
-const char location444[] PROGMEM = "Pacific/Nauru";
-const char location445[] PROGMEM = "Pacific/Niue";
-const char location446[] PROGMEM = "Pacific/Norfolk";
-const char location447[] PROGMEM = "Pacific/Noumea";
-const char location448[] PROGMEM = "Pacific/Pago Pago";
-const char location449[] PROGMEM = "Pacific/Palau";
-const char location450[] PROGMEM = "Pacific/Pitcairn";
-const char location451[] PROGMEM = "Pacific/Pohnpei";
-const char location452[] PROGMEM = "Pacific/Port Moresby";
-const char location453[] PROGMEM = "Pacific/Rarotonga";
-const char location454[] PROGMEM = "Pacific/Saipan";
-const char location455[] PROGMEM = "Pacific/Tahiti";
-const char location456[] PROGMEM = "Pacific/Tarawa";
-const char location457[] PROGMEM = "Pacific/Tongatapu";
-const char location458[] PROGMEM = "Pacific/Wake";
-const char location459[] PROGMEM = "Pacific/Wallis";
-
-const char posix0[] PROGMEM = "GMT0";
-const char posix1[] PROGMEM = "GMT0";
-const char posix2[] PROGMEM = "EAT-3";
-const char posix3[] PROGMEM = "CET-1";
-const char posix4[] PROGMEM = "EAT-3";
-const char posix5[] PROGMEM = "GMT0";
-const char posix6[] PROGMEM = "WAT-1";
-const char posix7[] PROGMEM = "GMT0";
-const char posix8[] PROGMEM = "GMT0";
-const char posix9[] PROGMEM = "CAT-2";
-const char posix10[] PROGMEM = "WAT-1";
-const char posix11[] PROGMEM = "CAT-2";
-const char posix12[] PROGMEM = "EET-2";
-const char posix13[] PROGMEM = "<+01>-1";
-const char posix14[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix15[] PROGMEM = "GMT0";
-const char posix16[] PROGMEM = "GMT0";
-const char posix17[] PROGMEM = "EAT-3";
-const char posix18[] PROGMEM = "EAT-3";
-const char posix19[] PROGMEM = "WAT-1";
-const char posix20[] PROGMEM = "<+01>-1";
-const char posix21[] PROGMEM = "GMT0";
-const char posix22[] PROGMEM = "CAT-2";
-const char posix23[] PROGMEM = "CAT-2";
-const char posix24[] PROGMEM = "SAST-2";
-const char posix25[] PROGMEM = "EAT-3";
-const char posix26[] PROGMEM = "EAT-3";
-const char posix27[] PROGMEM = "CAT-2";
-const char posix28[] PROGMEM = "CAT-2";
-const char posix29[] PROGMEM = "WAT-1";
-const char posix30[] PROGMEM = "WAT-1";
-const char posix31[] PROGMEM = "WAT-1";
-const char posix32[] PROGMEM = "GMT0";
-const char posix33[] PROGMEM = "WAT-1";
-const char posix34[] PROGMEM = "CAT-2";
-const char posix35[] PROGMEM = "CAT-2";
-const char posix36[] PROGMEM = "WAT-1";
-const char posix37[] PROGMEM = "CAT-2";
-const char posix38[] PROGMEM = "SAST-2";
-const char posix39[] PROGMEM = "SAST-2";
-const char posix40[] PROGMEM = "EAT-3";
-const char posix41[] PROGMEM = "GMT0";
-const char posix42[] PROGMEM = "EAT-3";
-const char posix43[] PROGMEM = "WAT-1";
-const char posix44[] PROGMEM = "WAT-1";
-const char posix45[] PROGMEM = "GMT0";
-const char posix46[] PROGMEM = "GMT0";
-const char posix47[] PROGMEM = "WAT-1";
-const char posix48[] PROGMEM = "GMT0";
-const char posix49[] PROGMEM = "EET-2";
-const char posix50[] PROGMEM = "CET-1";
-const char posix51[] PROGMEM = "CAT-2";
-const char posix52[] PROGMEM = "HST10HDT,M3.2.0,M11.1.0";
-const char posix53[] PROGMEM = "AKST9AKDT,M3.2.0,M11.1.0";
-const char posix54[] PROGMEM = "AST4";
-const char posix55[] PROGMEM = "AST4";
-const char posix56[] PROGMEM = "<-03>3";
-const char posix57[] PROGMEM = "<-03>3";
-const char posix58[] PROGMEM = "<-03>3";
-const char posix59[] PROGMEM = "<-03>3";
-const char posix60[] PROGMEM = "<-03>3";
-const char posix61[] PROGMEM = "<-03>3";
-const char posix62[] PROGMEM = "<-03>3";
-const char posix63[] PROGMEM = "<-03>3";
-const char posix64[] PROGMEM = "<-03>3";
-const char posix65[] PROGMEM = "<-03>3";
-const char posix66[] PROGMEM = "<-03>3";
-const char posix67[] PROGMEM = "<-03>3";
-const char posix68[] PROGMEM = "<-03>3";
-const char posix69[] PROGMEM = "AST4";
-const char posix70[] PROGMEM = "<-04>4<-03>,M10.1.0/0,M3.4.0/0";
-const char posix71[] PROGMEM = "EST5";
-const char posix72[] PROGMEM = "<-03>3";
-const char posix73[] PROGMEM = "CST6CDT,M4.1.0,M10.5.0";
-const char posix74[] PROGMEM = "AST4";
-const char posix75[] PROGMEM = "<-03>3";
-const char posix76[] PROGMEM = "CST6";
-const char posix77[] PROGMEM = "AST4";
-const char posix78[] PROGMEM = "<-04>4";
-const char posix79[] PROGMEM = "<-05>5";
-const char posix80[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
-const char posix81[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
-const char posix82[] PROGMEM = "<-04>4";
-const char posix83[] PROGMEM = "EST5";
-const char posix84[] PROGMEM = "<-04>4";
-const char posix85[] PROGMEM = "<-03>3";
-const char posix86[] PROGMEM = "EST5";
-const char posix87[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix88[] PROGMEM = "MST7MDT,M4.1.0,M10.5.0";
-const char posix89[] PROGMEM = "CST6";
-const char posix90[] PROGMEM = "MST7";
-const char posix91[] PROGMEM = "<-04>4";
-const char posix92[] PROGMEM = "AST4";
-const char posix93[] PROGMEM = "GMT0";
-const char posix94[] PROGMEM = "MST7";
-const char posix95[] PROGMEM = "MST7";
-const char posix96[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
-const char posix97[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix98[] PROGMEM = "AST4";
-const char posix99[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
-const char posix100[] PROGMEM = "<-05>5";
-const char posix101[] PROGMEM = "CST6";
-const char posix102[] PROGMEM = "MST7";
-const char posix103[] PROGMEM = "<-03>3";
-const char posix104[] PROGMEM = "AST4ADT,M3.2.0,M11.1.0";
-const char posix105[] PROGMEM = "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1";
-const char posix106[] PROGMEM = "AST4ADT,M3.2.0,M11.1.0";
-const char posix107[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix108[] PROGMEM = "AST4";
-const char posix109[] PROGMEM = "AST4";
-const char posix110[] PROGMEM = "CST6";
-const char posix111[] PROGMEM = "<-05>5";
-const char posix112[] PROGMEM = "<-04>4";
-const char posix113[] PROGMEM = "AST4ADT,M3.2.0,M11.1.0";
-const char posix114[] PROGMEM = "CST5CDT,M3.2.0/0,M11.1.0/1";
-const char posix115[] PROGMEM = "MST7";
-const char posix116[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix117[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix118[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix119[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix120[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix121[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix122[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix123[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix124[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
-const char posix125[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix126[] PROGMEM = "EST5";
-const char posix127[] PROGMEM = "AKST9AKDT,M3.2.0,M11.1.0";
-const char posix128[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix129[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix130[] PROGMEM = "AST4";
-const char posix131[] PROGMEM = "<-04>4";
-const char posix132[] PROGMEM = "<-05>5";
-const char posix133[] PROGMEM = "PST8PDT,M3.2.0,M11.1.0";
-const char posix134[] PROGMEM = "AST4";
-const char posix135[] PROGMEM = "<-03>3";
-const char posix136[] PROGMEM = "CST6";
-const char posix137[] PROGMEM = "<-04>4";
-const char posix138[] PROGMEM = "AST4";
-const char posix139[] PROGMEM = "AST4";
-const char posix140[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix141[] PROGMEM = "MST7MDT,M4.1.0,M10.5.0";
-const char posix142[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix143[] PROGMEM = "CST6CDT,M4.1.0,M10.5.0";
-const char posix144[] PROGMEM = "AKST9AKDT,M3.2.0,M11.1.0";
-const char posix145[] PROGMEM = "CST6CDT,M4.1.0,M10.5.0";
-const char posix146[] PROGMEM = "<-03>3<-02>,M3.2.0,M11.1.0";
-const char posix147[] PROGMEM = "AST4ADT,M3.2.0,M11.1.0";
-const char posix148[] PROGMEM = "CST6CDT,M4.1.0,M10.5.0";
-const char posix149[] PROGMEM = "<-03>3";
-const char posix150[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix151[] PROGMEM = "AST4";
-const char posix152[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix153[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix154[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix155[] PROGMEM = "AKST9AKDT,M3.2.0,M11.1.0";
-const char posix156[] PROGMEM = "<-02>2";
-const char posix157[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix158[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix159[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix160[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
-const char posix161[] PROGMEM = "EST5";
-const char posix162[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix163[] PROGMEM = "<-03>3";
-const char posix164[] PROGMEM = "MST7";
-const char posix165[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix166[] PROGMEM = "AST4";
-const char posix167[] PROGMEM = "<-04>4";
-const char posix168[] PROGMEM = "AST4";
-const char posix169[] PROGMEM = "<-03>3";
-const char posix170[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix171[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix172[] PROGMEM = "<-03>3";
-const char posix173[] PROGMEM = "CST6";
-const char posix174[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix175[] PROGMEM = "<-05>5";
-const char posix176[] PROGMEM = "<-03>3";
-const char posix177[] PROGMEM = "<-04>4<-03>,M9.1.6/24,M4.1.6/24";
-const char posix178[] PROGMEM = "AST4";
-const char posix179[] PROGMEM = "<-03>3";
-const char posix180[] PROGMEM = "<-01>1<+00>,M3.5.0/0,M10.5.0/1";
-const char posix181[] PROGMEM = "AKST9AKDT,M3.2.0,M11.1.0";
-const char posix182[] PROGMEM = "AST4";
-const char posix183[] PROGMEM = "NST3:30NDT,M3.2.0,M11.1.0";
-const char posix184[] PROGMEM = "AST4";
-const char posix185[] PROGMEM = "AST4";
-const char posix186[] PROGMEM = "AST4";
-const char posix187[] PROGMEM = "AST4";
-const char posix188[] PROGMEM = "CST6";
-const char posix189[] PROGMEM = "CST6";
-const char posix190[] PROGMEM = "AST4ADT,M3.2.0,M11.1.0";
-const char posix191[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix192[] PROGMEM = "PST8PDT,M3.2.0,M11.1.0";
-const char posix193[] PROGMEM = "EST5EDT,M3.2.0,M11.1.0";
-const char posix194[] PROGMEM = "AST4";
-const char posix195[] PROGMEM = "PST8PDT,M3.2.0,M11.1.0";
-const char posix196[] PROGMEM = "MST7";
-const char posix197[] PROGMEM = "CST6CDT,M3.2.0,M11.1.0";
-const char posix198[] PROGMEM = "AKST9AKDT,M3.2.0,M11.1.0";
-const char posix199[] PROGMEM = "MST7MDT,M3.2.0,M11.1.0";
-const char posix200[] PROGMEM = "<+11>-11";
-const char posix201[] PROGMEM = "<+07>-7";
-const char posix202[] PROGMEM = "<+10>-10";
-const char posix203[] PROGMEM = "AEST-10AEDT,M10.1.0,M4.1.0/3";
-const char posix204[] PROGMEM = "<+05>-5";
-const char posix205[] PROGMEM = "NZST-12NZDT,M9.5.0,M4.1.0/3";
-const char posix206[] PROGMEM = "<-03>3";
-const char posix207[] PROGMEM = "<-03>3";
-const char posix208[] PROGMEM = "<+03>-3";
-const char posix209[] PROGMEM = "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3";
-const char posix210[] PROGMEM = "<+06>-6";
-const char posix211[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix212[] PROGMEM = "<+03>-3";
-const char posix213[] PROGMEM = "<+06>-6";
-const char posix214[] PROGMEM = "EET-2EEST,M3.5.4/24,M10.5.5/1";
-const char posix215[] PROGMEM = "<+12>-12";
-const char posix216[] PROGMEM = "<+05>-5";
-const char posix217[] PROGMEM = "<+05>-5";
-const char posix218[] PROGMEM = "<+05>-5";
-const char posix219[] PROGMEM = "<+05>-5";
-const char posix220[] PROGMEM = "<+03>-3";
-const char posix221[] PROGMEM = "<+03>-3";
-const char posix222[] PROGMEM = "<+04>-4";
-const char posix223[] PROGMEM = "<+07>-7";
-const char posix224[] PROGMEM = "<+07>-7";
-const char posix225[] PROGMEM = "EET-2EEST,M3.5.0/0,M10.5.0/0";
-const char posix226[] PROGMEM = "<+06>-6";
-const char posix227[] PROGMEM = "<+08>-8";
-const char posix228[] PROGMEM = "<+09>-9";
-const char posix229[] PROGMEM = "<+08>-8";
-const char posix230[] PROGMEM = "<+0530>-5:30";
-const char posix231[] PROGMEM = "EET-2EEST,M3.5.5/0,M10.5.5/0";
-const char posix232[] PROGMEM = "<+06>-6";
-const char posix233[] PROGMEM = "<+09>-9";
-const char posix234[] PROGMEM = "<+04>-4";
-const char posix235[] PROGMEM = "<+05>-5";
-const char posix236[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix237[] PROGMEM = "EET-2EEST,M3.4.4/48,M10.4.4/49";
-const char posix238[] PROGMEM = "EET-2EEST,M3.4.4/48,M10.4.4/49";
-const char posix239[] PROGMEM = "<+07>-7";
-const char posix240[] PROGMEM = "HKT-8";
-const char posix241[] PROGMEM = "<+07>-7";
-const char posix242[] PROGMEM = "<+08>-8";
-const char posix243[] PROGMEM = "WIB-7";
-const char posix244[] PROGMEM = "WIT-9";
-const char posix245[] PROGMEM = "IST-2IDT,M3.4.4/26,M10.5.0";
-const char posix246[] PROGMEM = "<+0430>-4:30";
-const char posix247[] PROGMEM = "<+12>-12";
-const char posix248[] PROGMEM = "PKT-5";
-const char posix249[] PROGMEM = "<+0545>-5:45";
-const char posix250[] PROGMEM = "<+09>-9";
-const char posix251[] PROGMEM = "IST-5:30";
-const char posix252[] PROGMEM = "<+07>-7";
-const char posix253[] PROGMEM = "<+08>-8";
-const char posix254[] PROGMEM = "<+08>-8";
-const char posix255[] PROGMEM = "<+03>-3";
-const char posix256[] PROGMEM = "CST-8";
-const char posix257[] PROGMEM = "<+11>-11";
-const char posix258[] PROGMEM = "WITA-8";
-const char posix259[] PROGMEM = "PST-8";
-const char posix260[] PROGMEM = "<+04>-4";
-const char posix261[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix262[] PROGMEM = "<+07>-7";
-const char posix263[] PROGMEM = "<+07>-7";
-const char posix264[] PROGMEM = "<+06>-6";
-const char posix265[] PROGMEM = "<+05>-5";
-const char posix266[] PROGMEM = "<+07>-7";
-const char posix267[] PROGMEM = "WIB-7";
-const char posix268[] PROGMEM = "KST-9";
-const char posix269[] PROGMEM = "<+03>-3";
-const char posix270[] PROGMEM = "<+05>-5";
-const char posix271[] PROGMEM = "<+03>-3";
-const char posix272[] PROGMEM = "<+11>-11";
-const char posix273[] PROGMEM = "<+05>-5";
-const char posix274[] PROGMEM = "KST-9";
-const char posix275[] PROGMEM = "CST-8";
-const char posix276[] PROGMEM = "<+08>-8";
-const char posix277[] PROGMEM = "<+11>-11";
-const char posix278[] PROGMEM = "CST-8";
-const char posix279[] PROGMEM = "<+05>-5";
-const char posix280[] PROGMEM = "<+04>-4";
-const char posix281[] PROGMEM = "<+0330>-3:30<+0430>,J79/24,J263/24";
-const char posix282[] PROGMEM = "<+06>-6";
-const char posix283[] PROGMEM = "JST-9";
-const char posix284[] PROGMEM = "<+07>-7";
-const char posix285[] PROGMEM = "<+08>-8";
-const char posix286[] PROGMEM = "<+06>-6";
-const char posix287[] PROGMEM = "<+10>-10";
-const char posix288[] PROGMEM = "<+07>-7";
-const char posix289[] PROGMEM = "<+10>-10";
-const char posix290[] PROGMEM = "<+09>-9";
-const char posix291[] PROGMEM = "<+0630>-6:30";
-const char posix292[] PROGMEM = "<+05>-5";
-const char posix293[] PROGMEM = "<+04>-4";
-const char posix294[] PROGMEM = "<-01>1<+00>,M3.5.0/0,M10.5.0/1";
-const char posix295[] PROGMEM = "AST4ADT,M3.2.0,M11.1.0";
-const char posix296[] PROGMEM = "WET0WEST,M3.5.0/1,M10.5.0";
-const char posix297[] PROGMEM = "<-01>1";
-const char posix298[] PROGMEM = "WET0WEST,M3.5.0/1,M10.5.0";
-const char posix299[] PROGMEM = "WET0WEST,M3.5.0/1,M10.5.0";
-const char posix300[] PROGMEM = "GMT0";
-const char posix301[] PROGMEM = "<-02>2";
-const char posix302[] PROGMEM = "GMT0";
-const char posix303[] PROGMEM = "<-03>3";
-const char posix304[] PROGMEM = "ACST-9:30ACDT,M10.1.0,M4.1.0/3";
-const char posix305[] PROGMEM = "AEST-10";
-const char posix306[] PROGMEM = "ACST-9:30ACDT,M10.1.0,M4.1.0/3";
-const char posix307[] PROGMEM = "AEST-10AEDT,M10.1.0,M4.1.0/3";
-const char posix308[] PROGMEM = "ACST-9:30";
-const char posix309[] PROGMEM = "<+0845>-8:45";
-const char posix310[] PROGMEM = "AEST-10AEDT,M10.1.0,M4.1.0/3";
-const char posix311[] PROGMEM = "AEST-10";
-const char posix312[] PROGMEM = "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0";
-const char posix313[] PROGMEM = "AEST-10AEDT,M10.1.0,M4.1.0/3";
-const char posix314[] PROGMEM = "AWST-8";
-const char posix315[] PROGMEM = "AEST-10AEDT,M10.1.0,M4.1.0/3";
-const char posix316[] PROGMEM = "GMT0";
-const char posix317[] PROGMEM = "GMT0";
-const char posix318[] PROGMEM = "<-01>1";
-const char posix319[] PROGMEM = "<-10>10";
-const char posix320[] PROGMEM = "<-11>11";
-const char posix321[] PROGMEM = "<-12>12";
-const char posix322[] PROGMEM = "<-02>2";
-const char posix323[] PROGMEM = "<-03>3";
-const char posix324[] PROGMEM = "<-04>4";
-const char posix325[] PROGMEM = "<-05>5";
-const char posix326[] PROGMEM = "<-06>6";
-const char posix327[] PROGMEM = "<-07>7";
-const char posix328[] PROGMEM = "<-08>8";
-const char posix329[] PROGMEM = "<-09>9";
-const char posix330[] PROGMEM = "GMT0";
-const char posix331[] PROGMEM = "<+01>-1";
-const char posix332[] PROGMEM = "<+10>-10";
-const char posix333[] PROGMEM = "<+11>-11";
-const char posix334[] PROGMEM = "<+12>-12";
-const char posix335[] PROGMEM = "<+13>-13";
-const char posix336[] PROGMEM = "<+14>-14";
-const char posix337[] PROGMEM = "<+02>-2";
-const char posix338[] PROGMEM = "<+03>-3";
-const char posix339[] PROGMEM = "<+04>-4";
-const char posix340[] PROGMEM = "<+05>-5";
-const char posix341[] PROGMEM = "<+06>-6";
-const char posix342[] PROGMEM = "<+07>-7";
-const char posix343[] PROGMEM = "<+08>-8";
-const char posix344[] PROGMEM = "<+09>-9";
-const char posix345[] PROGMEM = "GMT0";
-const char posix346[] PROGMEM = "GMT0";
-const char posix347[] PROGMEM = "UTC0";
-const char posix348[] PROGMEM = "UTC0";
-const char posix349[] PROGMEM = "UTC0";
-const char posix350[] PROGMEM = "UTC0";
-const char posix351[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix352[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix353[] PROGMEM = "<+04>-4";
-const char posix354[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix355[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix356[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix357[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix358[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix359[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix360[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix361[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix362[] PROGMEM = "EET-2EEST,M3.5.0,M10.5.0/3";
-const char posix363[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix364[] PROGMEM = "IST-1GMT0,M10.5.0,M3.5.0/1";
-const char posix365[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix366[] PROGMEM = "GMT0BST,M3.5.0/1,M10.5.0";
-const char posix367[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix368[] PROGMEM = "GMT0BST,M3.5.0/1,M10.5.0";
-const char posix369[] PROGMEM = "<+03>-3";
-const char posix370[] PROGMEM = "GMT0BST,M3.5.0/1,M10.5.0";
-const char posix371[] PROGMEM = "EET-2";
-const char posix372[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix373[] PROGMEM = "<+03>-3";
-const char posix374[] PROGMEM = "WET0WEST,M3.5.0/1,M10.5.0";
-const char posix375[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix376[] PROGMEM = "GMT0BST,M3.5.0/1,M10.5.0";
-const char posix377[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix378[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix379[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix380[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix381[] PROGMEM = "<+03>-3";
-const char posix382[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix383[] PROGMEM = "MSK-3";
-const char posix384[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix385[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix386[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix387[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix388[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix389[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix390[] PROGMEM = "<+04>-4";
-const char posix391[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix392[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix393[] PROGMEM = "<+04>-4";
-const char posix394[] PROGMEM = "MSK-3";
-const char posix395[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix396[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix397[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix398[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix399[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix400[] PROGMEM = "<+04>-4";
-const char posix401[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix402[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix403[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix404[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix405[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix406[] PROGMEM = "<+04>-4";
-const char posix407[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix408[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix409[] PROGMEM = "EET-2EEST,M3.5.0/3,M10.5.0/4";
-const char posix410[] PROGMEM = "CET-1CEST,M3.5.0,M10.5.0/3";
-const char posix411[] PROGMEM = "EAT-3";
-const char posix412[] PROGMEM = "<+06>-6";
-const char posix413[] PROGMEM = "<+07>-7";
-const char posix414[] PROGMEM = "<+0630>-6:30";
-const char posix415[] PROGMEM = "EAT-3";
-const char posix416[] PROGMEM = "<+05>-5";
-const char posix417[] PROGMEM = "<+04>-4";
-const char posix418[] PROGMEM = "<+05>-5";
-const char posix419[] PROGMEM = "<+04>-4";
-const char posix420[] PROGMEM = "EAT-3";
-const char posix421[] PROGMEM = "<+04>-4";
-const char posix422[] PROGMEM = "<+13>-13<+14>,M9.5.0/3,M4.1.0/4";
-const char posix423[] PROGMEM = "NZST-12NZDT,M9.5.0,M4.1.0/3";
-const char posix424[] PROGMEM = "<+11>-11";
-const char posix425[] PROGMEM = "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45";
-const char posix426[] PROGMEM = "<+10>-10";
-const char posix427[] PROGMEM = "<-06>6<-05>,M9.1.6/22,M4.1.6/22";
-const char posix428[] PROGMEM = "<+11>-11";
-const char posix429[] PROGMEM = "<+13>-13";
-const char posix430[] PROGMEM = "<+13>-13";
-const char posix431[] PROGMEM = "<+12>-12<+13>,M11.2.0,M1.2.3/99";
-const char posix432[] PROGMEM = "<+12>-12";
-const char posix433[] PROGMEM = "<-06>6";
-const char posix434[] PROGMEM = "<-09>9";
-const char posix435[] PROGMEM = "<+11>-11";
-const char posix436[] PROGMEM = "ChST-10";
-const char posix437[] PROGMEM = "HST10";
-const char posix438[] PROGMEM = "<+14>-14";
-const char posix439[] PROGMEM = "<+11>-11";
-const char posix440[] PROGMEM = "<+12>-12";
-const char posix441[] PROGMEM = "<+12>-12";
-const char posix442[] PROGMEM = "<-0930>9:30";
-const char posix443[] PROGMEM = "SST11";
-const char posix444[] PROGMEM = "<+12>-12";
-const char posix445[] PROGMEM = "<-11>11";
-const char posix446[] PROGMEM = "<+11>-11<+12>,M10.1.0,M4.1.0/3";
-const char posix447[] PROGMEM = "<+11>-11";
-const char posix448[] PROGMEM = "SST11";
-const char posix449[] PROGMEM = "<+09>-9";
-const char posix450[] PROGMEM = "<-08>8";
-const char posix451[] PROGMEM = "<+11>-11";
-const char posix452[] PROGMEM = "<+10>-10";
-const char posix453[] PROGMEM = "<-10>10";
-const char posix454[] PROGMEM = "ChST-10";
-const char posix455[] PROGMEM = "<-10>10";
-const char posix456[] PROGMEM = "<+12>-12";
-const char posix457[] PROGMEM = "<+13>-13";
-const char posix458[] PROGMEM = "<+12>-12";
-const char posix459[] PROGMEM = "<+12>-12";
-
-const char *const location[] PROGMEM = {location0, location1, location2, location3, location4, location5, location6, location7, location8, location9, location10, location11, location12, location13, location14, location15, location16, location17, location18, location19, location20, location21, location22, location23, location24, location25, location26, location27, location28, location29, location30, location31, location32, location33, location34, location35, location36, location37, location38, location39, location40, location41, location42, location43, location44, location45, location46, location47, location48, location49, location50, location51, location52, location53, location54, location55, location56, location57, location58, location59, location60, location61, location62, location63, location64, location65, location66, location67, location68, location69, location70, location71, location72, location73, location74, location75, location76, location77, location78, location79, location80, location81, location82, location83, location84, location85, location86, location87, location88, location89, location90, location91, location92, location93, location94, location95, location96, location97, location98, location99, location100, location101, location102, location103, location104, location105, location106, location107, location108, location109, location110, location111, location112, location113, location114, location115, location116, location117, location118, location119, location120, location121, location122, location123, location124, location125, location126, location127, location128, location129, location130, location131, location132, location133, location134, location135, location136, location137, location138, location139, location140, location141, location142, location143, location144, location145, location146, location147, location148, location149, location150, location151, location152, location153, location154, location155, location156, location157, location158, location159, location160, location161, location162, location163, location164, location165, location166, location167, location168, location169, location170, location171, location172, location173, location174, location175, location176, location177, location178, location179, location180, location181, location182, location183, location184, location185, location186, location187, location188, location189, location190, location191, location192, location193, location194, location195, location196, location197, location198, location199, location200, location201, location202, location203, location204, location205, location206, location207, location208, location209, location210, location211, location212, location213, location214, location215, location216, location217, location218, location219, location220, location221, location222, location223, location224, location225, location226, location227, location228, location229, location230, location231, location232, location233, location234, location235, location236, location237, location238, location239, location240, location241, location242, location243, location244, location245, location246, location247, location248, location249, location250, location251, location252, location253, location254, location255, location256, location257, location258, location259, location260, location261, location262, location263, location264, location265, location266, location267, location268, location269, location270, location271, location272, location273, location274, location275, location276, location277, location278, location279, location280, location281, location282, location283, location284, location285, location286, location287, location288, location289, location290, location291, location292, location293, location294, location295, location296, location297, location298, location299, location300, location301, location302, location303, location304, location305, location306, location307, location308, location309, location310, location311, location312, location313, location314, location315, location316, location317, location318, location319, location320, location321, location322, location323, location324, location325, location326, location327, location328, location329, location330, location331, location332, location333, location334, location335, location336, location337, location338, location339, location340, location341, location342, location343, location344, location345, location346, location347, location348, location349, location350, location351, location352, location353, location354, location355, location356, location357, location358, location359, location360, location361, location362, location363, location364, location365, location366, location367, location368, location369, location370, location371, location372, location373, location374, location375, location376, location377, location378, location379, location380, location381, location382, location383, location384, location385, location386, location387, location388, location389, location390, location391, location392, location393, location394, location395, location396, location397, location398, location399, location400, location401, location402, location403, location404, location405, location406, location407, location408, location409, location410, location411, location412, location413, location414, location415, location416, location417, location418, location419, location420, location421, location422, location423, location424, location425, location426, location427, location428, location429, location430, location431, location432, location433, location434, location435, location436, location437, location438, location439, location440, location441, location442, location443, location444, location445, location446, location447, location448, location449, location450, location451, location452, location453, location454, location455, location456, location457, location458, location459};
-const char *const posix[] PROGMEM = {posix0, posix1, posix2, posix3, posix4, posix5, posix6, posix7, posix8, posix9, posix10, posix11, posix12, posix13, posix14, posix15, posix16, posix17, posix18, posix19, posix20, posix21, posix22, posix23, posix24, posix25, posix26, posix27, posix28, posix29, posix30, posix31, posix32, posix33, posix34, posix35, posix36, posix37, posix38, posix39, posix40, posix41, posix42, posix43, posix44, posix45, posix46, posix47, posix48, posix49, posix50, posix51, posix52, posix53, posix54, posix55, posix56, posix57, posix58, posix59, posix60, posix61, posix62, posix63, posix64, posix65, posix66, posix67, posix68, posix69, posix70, posix71, posix72, posix73, posix74, posix75, posix76, posix77, posix78, posix79, posix80, posix81, posix82, posix83, posix84, posix85, posix86, posix87, posix88, posix89, posix90, posix91, posix92, posix93, posix94, posix95, posix96, posix97, posix98, posix99, posix100, posix101, posix102, posix103, posix104, posix105, posix106, posix107, posix108, posix109, posix110, posix111, posix112, posix113, posix114, posix115, posix116, posix117, posix118, posix119, posix120, posix121, posix122, posix123, posix124, posix125, posix126, posix127, posix128, posix129, posix130, posix131, posix132, posix133, posix134, posix135, posix136, posix137, posix138, posix139, posix140, posix141, posix142, posix143, posix144, posix145, posix146, posix147, posix148, posix149, posix150, posix151, posix152, posix153, posix154, posix155, posix156, posix157, posix158, posix159, posix160, posix161, posix162, posix163, posix164, posix165, posix166, posix167, posix168, posix169, posix170, posix171, posix172, posix173, posix174, posix175, posix176, posix177, posix178, posix179, posix180, posix181, posix182, posix183, posix184, posix185, posix186, posix187, posix188, posix189, posix190, posix191, posix192, posix193, posix194, posix195, posix196, posix197, posix198, posix199, posix200, posix201, posix202, posix203, posix204, posix205, posix206, posix207, posix208, posix209, posix210, posix211, posix212, posix213, posix214, posix215, posix216, posix217, posix218, posix219, posix220, posix221, posix222, posix223, posix224, posix225, posix226, posix227, posix228, posix229, posix230, posix231, posix232, posix233, posix234, posix235, posix236, posix237, posix238, posix239, posix240, posix241, posix242, posix243, posix244, posix245, posix246, posix247, posix248, posix249, posix250, posix251, posix252, posix253, posix254, posix255, posix256, posix257, posix258, posix259, posix260, posix261, posix262, posix263, posix264, posix265, posix266, posix267, posix268, posix269, posix270, posix271, posix272, posix273, posix274, posix275, posix276, posix277, posix278, posix279, posix280, posix281, posix282, posix283, posix284, posix285, posix286, posix287, posix288, posix289, posix290, posix291, posix292, posix293, posix294, posix295, posix296, posix297, posix298, posix299, posix300, posix301, posix302, posix303, posix304, posix305, posix306, posix307, posix308, posix309, posix310, posix311, posix312, posix313, posix314, posix315, posix316, posix317, posix318, posix319, posix320, posix321, posix322, posix323, posix324, posix325, posix326, posix327, posix328, posix329, posix330, posix331, posix332, posix333, posix334, posix335, posix336, posix337, posix338, posix339, posix340, posix341, posix342, posix343, posix344, posix345, posix346, posix347, posix348, posix349, posix350, posix351, posix352, posix353, posix354, posix355, posix356, posix357, posix358, posix359, posix360, posix361, posix362, posix363, posix364, posix365, posix366, posix367, posix368, posix369, posix370, posix371, posix372, posix373, posix374, posix375, posix376, posix377, posix378, posix379, posix380, posix381, posix382, posix383, posix384, posix385, posix386, posix387, posix388, posix389, posix390, posix391, posix392, posix393, posix394, posix395, posix396, posix397, posix398, posix399, posix400, posix401, posix402, posix403, posix404, posix405, posix406, posix407, posix408, posix409, posix410, posix411, posix412, posix413, posix414, posix415, posix416, posix417, posix418, posix419, posix420, posix421, posix422, posix423, posix424, posix425, posix426, posix427, posix428, posix429, posix430, posix431, posix432, posix433, posix434, posix435, posix436, posix437, posix438, posix439, posix440, posix441, posix442, posix443, posix444, posix445, posix446, posix447, posix448, posix449, posix450, posix451, posix452, posix453, posix454, posix455, posix456, posix457, posix458, posix459};
-const char locationOptions[] PROGMEM = "data-options='Africa/Abidjan|Africa/Accra|Africa/Addis Ababa|Africa/Algiers|Africa/Asmara|Africa/Bamako|Africa/Bangui|Africa/Banjul|Africa/Bissau|Africa/Blantyre|Africa/Brazzaville|Africa/Bujumbura|Africa/Cairo|Africa/Casablanca|Africa/Ceuta|Africa/Conakry|Africa/Dakar|Africa/Dar es Salaam|Africa/Djibouti|Africa/Douala|Africa/El Aaiun|Africa/Freetown|Africa/Gaborone|Africa/Harare|Africa/Johannesburg|Africa/Juba|Africa/Kampala|Africa/Khartoum|Africa/Kigali|Africa/Kinshasa|Africa/Lagos|Africa/Libreville|Africa/Lome|Africa/Luanda|Africa/Lubumbashi|Africa/Lusaka|Africa/Malabo|Africa/Maputo|Africa/Maseru|Africa/Mbabane|Africa/Mogadishu|Africa/Monrovia|Africa/Nairobi|Africa/Ndjamena|Africa/Niamey|Africa/Nouakchott|Africa/Ouagadougou|Africa/Porto-Novo|Africa/Sao Tome|Africa/Tripoli|Africa/Tunis|Africa/Windhoek|America/Adak|America/Anchorage|America/Anguilla|America/Antigua|America/Araguaina|America/Argentina/Buenos Aires|America/Argentina/Catamarca|America/Argentina/Cordoba|America/Argentina/Jujuy|America/Argentina/La Rioja|America/Argentina/Mendoza|America/Argentina/Rio Gallegos|America/Argentina/Salta|America/Argentina/San Juan|America/Argentina/San Luis|America/Argentina/Tucuman|America/Argentina/Ushuaia|America/Aruba|America/Asuncion|America/Atikokan|America/Bahia|America/Bahia Banderas|America/Barbados|America/Belem|America/Belize|America/Blanc-Sablon|America/Boa Vista|America/Bogota|America/Boise|America/Cambridge Bay|America/Campo Grande|America/Cancun|America/Caracas|America/Cayenne|America/Cayman|America/Chicago|America/Chihuahua|America/Costa Rica|America/Creston|America/Cuiaba|America/Curacao|America/Danmarkshavn|America/Dawson|America/Dawson Creek|America/Denver|America/Detroit|America/Dominica|America/Edmonton|America/Eirunepe|America/El Salvador|America/Fort Nelson|America/Fortaleza|America/Glace Bay|America/Godthab|America/Goose Bay|America/Grand Turk|America/Grenada|America/Guadeloupe|America/Guatemala|America/Guayaquil|America/Guyana|America/Halifax|America/Havana|America/Hermosillo|America/Indiana/Indianapolis|America/Indiana/Knox|America/Indiana/Marengo|America/Indiana/Petersburg|America/Indiana/Tell City|America/Indiana/Vevay|America/Indiana/Vincennes|America/Indiana/Winamac|America/Inuvik|America/Iqaluit|America/Jamaica|America/Juneau|America/Kentucky/Louisville|America/Kentucky/Monticello|America/Kralendijk|America/La Paz|America/Lima|America/Los Angeles|America/Lower Princes|America/Maceio|America/Managua|America/Manaus|America/Marigot|America/Martinique|America/Matamoros|America/Mazatlan|America/Menominee|America/Merida|America/Metlakatla|America/Mexico City|America/Miquelon|America/Moncton|America/Monterrey|America/Montevideo|America/Montreal|America/Montserrat|America/Nassau|America/New York|America/Nipigon|America/Nome|America/Noronha|America/North Dakota/Beulah|America/North Dakota/Center|America/North Dakota/New Salem|America/Ojinaga|America/Panama|America/Pangnirtung|America/Paramaribo|America/Phoenix|America/Port-au-Prince|America/Port of Spain|America/Porto Velho|America/Puerto Rico|America/Punta Arenas|America/Rainy River|America/Rankin Inlet|America/Recife|America/Regina|America/Resolute|America/Rio Branco|America/Santarem|America/Santiago|America/Santo Domingo|America/Sao Paulo|America/Scoresbysund|America/Sitka|America/St Barthelemy|America/St Johns|America/St Kitts|America/St Lucia|America/St Thomas|America/St Vincent|America/Swift Current|America/Tegucigalpa|America/Thule|America/Thunder Bay|America/Tijuana|America/Toronto|America/Tortola|America/Vancouver|America/Whitehorse|America/Winnipeg|America/Yakutat|America/Yellowknife|Antarctica/Casey|Antarctica/Davis|Antarctica/DumontDUrville|Antarctica/Macquarie|Antarctica/Mawson|Antarctica/McMurdo|Antarctica/Palmer|Antarctica/Rothera|Antarctica/Syowa|Antarctica/Troll|Antarctica/Vostok|Arctic/Longyearbyen|Asia/Aden|Asia/Almaty|Asia/Amman|Asia/Anadyr|Asia/Aqtau|Asia/Aqtobe|Asia/Ashgabat|Asia/Atyrau|Asia/Baghdad|Asia/Bahrain|Asia/Baku|Asia/Bangkok|Asia/Barnaul|Asia/Beirut|Asia/Bishkek|Asia/Brunei|Asia/Chita|Asia/Choibalsan|Asia/Colombo|Asia/Damascus|Asia/Dhaka|Asia/Dili|Asia/Dubai|Asia/Dushanbe|Asia/Famagusta|Asia/Gaza|Asia/Hebron|Asia/Ho Chi Minh|Asia/Hong Kong|Asia/Hovd|Asia/Irkutsk|Asia/Jakarta|Asia/Jayapura|Asia/Jerusalem|Asia/Kabul|Asia/Kamchatka|Asia/Karachi|Asia/Kathmandu|Asia/Khandyga|Asia/Kolkata|Asia/Krasnoyarsk|Asia/Kuala Lumpur|Asia/Kuching|Asia/Kuwait|Asia/Macau|Asia/Magadan|Asia/Makassar|Asia/Manila|Asia/Muscat|Asia/Nicosia|Asia/Novokuznetsk|Asia/Novosibirsk|Asia/Omsk|Asia/Oral|Asia/Phnom Penh|Asia/Pontianak|Asia/Pyongyang|Asia/Qatar|Asia/Qyzylorda|Asia/Riyadh|Asia/Sakhalin|Asia/Samarkand|Asia/Seoul|Asia/Shanghai|Asia/Singapore|Asia/Srednekolymsk|Asia/Taipei|Asia/Tashkent|Asia/Tbilisi|Asia/Tehran|Asia/Thimphu|Asia/Tokyo|Asia/Tomsk|Asia/Ulaanbaatar|Asia/Urumqi|Asia/Ust-Nera|Asia/Vientiane|Asia/Vladivostok|Asia/Yakutsk|Asia/Yangon|Asia/Yekaterinburg|Asia/Yerevan|Atlantic/Azores|Atlantic/Bermuda|Atlantic/Canary|Atlantic/Cape Verde|Atlantic/Faroe|Atlantic/Madeira|Atlantic/Reykjavik|Atlantic/South Georgia|Atlantic/St Helena|Atlantic/Stanley|Australia/Adelaide|Australia/Brisbane|Australia/Broken Hill|Australia/Currie|Australia/Darwin|Australia/Eucla|Australia/Hobart|Australia/Lindeman|Australia/Lord Howe|Australia/Melbourne|Australia/Perth|Australia/Sydney|Etc/GMT|Etc/GMT+0|Etc/GMT+1|Etc/GMT+10|Etc/GMT+11|Etc/GMT+12|Etc/GMT+2|Etc/GMT+3|Etc/GMT+4|Etc/GMT+5|Etc/GMT+6|Etc/GMT+7|Etc/GMT+8|Etc/GMT+9|Etc/GMT-0|Etc/GMT-1|Etc/GMT-10|Etc/GMT-11|Etc/GMT-12|Etc/GMT-13|Etc/GMT-14|Etc/GMT-2|Etc/GMT-3|Etc/GMT-4|Etc/GMT-5|Etc/GMT-6|Etc/GMT-7|Etc/GMT-8|Etc/GMT-9|Etc/GMT0|Etc/Greenwich|Etc/UCT|Etc/UTC|Etc/Universal|Etc/Zulu|Europe/Amsterdam|Europe/Andorra|Europe/Astrakhan|Europe/Athens|Europe/Belgrade|Europe/Berlin|Europe/Bratislava|Europe/Brussels|Europe/Bucharest|Europe/Budapest|Europe/Busingen|Europe/Chisinau|Europe/Copenhagen|Europe/Dublin|Europe/Gibraltar|Europe/Guernsey|Europe/Helsinki|Europe/Isle of Man|Europe/Istanbul|Europe/Jersey|Europe/Kaliningrad|Europe/Kiev|Europe/Kirov|Europe/Lisbon|Europe/Ljubljana|Europe/London|Europe/Luxembourg|Europe/Madrid|Europe/Malta|Europe/Mariehamn|Europe/Minsk|Europe/Monaco|Europe/Moscow|Europe/Oslo|Europe/Paris|Europe/Podgorica|Europe/Prague|Europe/Riga|Europe/Rome|Europe/Samara|Europe/San Marino|Europe/Sarajevo|Europe/Saratov|Europe/Simferopol|Europe/Skopje|Europe/Sofia|Europe/Stockholm|Europe/Tallinn|Europe/Tirane|Europe/Ulyanovsk|Europe/Uzhgorod|Europe/Vaduz|Europe/Vatican|Europe/Vienna|Europe/Vilnius|Europe/Volgograd|Europe/Warsaw|Europe/Zagreb|Europe/Zaporozhye|Europe/Zurich|Indian/Antananarivo|Indian/Chagos|Indian/Christmas|Indian/Cocos|Indian/Comoro|Indian/Kerguelen|Indian/Mahe|Indian/Maldives|Indian/Mauritius|Indian/Mayotte|Indian/Reunion|Pacific/Apia|Pacific/Auckland|Pacific/Bougainville|Pacific/Chatham|Pacific/Chuuk|Pacific/Easter|Pacific/Efate|Pacific/Enderbury|Pacific/Fakaofo|Pacific/Fiji|Pacific/Funafuti|Pacific/Galapagos|Pacific/Gambier|Pacific/Guadalcanal|Pacific/Guam|Pacific/Honolulu|Pacific/Kiritimati|Pacific/Kosrae|Pacific/Kwajalein|Pacific/Majuro|Pacific/Marquesas|Pacific/Midway|Pacific/Nauru|Pacific/Niue|Pacific/Norfolk|Pacific/Noumea|Pacific/Pago Pago|Pacific/Palau|Pacific/Pitcairn|Pacific/Pohnpei|Pacific/Port Moresby|Pacific/Rarotonga|Pacific/Saipan|Pacific/Tahiti|Pacific/Tarawa|Pacific/Tongatapu|Pacific/Wake|Pacific/Wallis'";
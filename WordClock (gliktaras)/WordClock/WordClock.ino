@@ -1,10 +1,22 @@
 //#include "clock.h"
 #include "Display.h"
+#include "boot_state.h"
 #include "ClockFace.h"
+#include "ds3231.h"
+#include "health.h"
+#include "i2c_bus.h"
 #include "iot_config.h"
+#include "logging.h"
+#include "metrics.h"
+#include "power_manager.h"
+#include "render_tick.h"
+#include "sntp_system.h"
+#include "time_source.h"
+#include "tzdb.h"
 
 #include <IotWebConf.h>
 #include <NeoPixelBus.h>
+#include <Wire.h>
 
 // Baud rate of the serial output.
 #define SERIAL_BAUD_RATE 115200
@@ -41,11 +53,32 @@ namespace {
 //        NEOPIXEL_COUNT, NEOPIXEL_PIN);
 // Clock Display state.
 //WordClock word_clock(&led_strip);
-EnglishClockFace clockFace(ClockFace::LightSensorPosition::Bottom);
+#if !WORDCLOCK_HAS_LETTER_GRID
+#error "The word faces need an 11 x 10 letter grid, see geometry.h."
+#endif
+EnglishClockFace clockFace(ClockFace::Orientation::Rotate0);
 Display display(clockFace);
 // IoT configuration portal.
 //IotConfig iot_config(&word_clock);
 IotConfig iot_config(&display);
+// Clock state kept across restarts, to show a first frame right away.
+RetainedState retained_state;
+// Real time clock, on the default I2C pins.
+WireI2cBus i2c_bus(&Wire);
+Ds3231 rtc(&i2c_bus);
+// Sets the time from the RTC at boot and keeps the RTC in line with NTP.
+SystemSntpClock system_clock;
+TimeSource time_source(&rtc, &system_clock);
+// Paces the event loop at a fixed frame rate.
+RenderTick render_tick;
+RenderTickMetric render_tick_metric(&render_tick);
+// Slows the CPU down while the display is idle.
+PowerManager power_manager(&render_tick);
+PowerManagerMetric power_manager_metric(&power_manager);
+// Minute of the last retained state update, and whether the display was idle
+// on the previous tick.
+time_t retained_minute = 0;
+bool display_was_idle = true;
 
 }  // namespace
 
@@ -53,7 +86,8 @@ IotConfig iot_config(&display);
 void setup() {
     // Initialize serial output.
     Serial.begin(SERIAL_BAUD_RATE);
-    while (!Serial);
+    setupLogging();
+    markBootPhase(BOOT_PHASE_SETUP);
 
     // Initialize built-in board LED.
 //    pinMode(LEDC_PIN, OUTPUT);
@@ -64,20 +98,33 @@ void setup() {
     // Initialize light sensor.
 //    pinMode(LDR_PIN, INPUT);
 
-    // Initialize real time clock.
-//    const bool rtc_valid = rtc.begin();
-//    if (!rtc_valid) {
-//        Serial.println("[ERROR] Could not initialize RTC.");
-//    } else if (rtc.lostPower()) {
-//        Serial.println("[WARN] RTC lost power, resetting ");
-//        rtc.adjust(DEFAULT_DATETIME);
-//    }
+    // Initialize real time clock, which sets the time until NTP is up.
+    Wire.begin();
+    time_source.setup();
 
     // Initialize the remaining components.
 //    led_strip.Begin();
 //    word_clock.setup();
     display.setup();
+    tzdb::setup();
+
+    // Show the state of the last run until configuration and time are up.
+    if (retained_state.load()) {
+        iot_config.restoreTimezone(retained_state.timezone());
+        retained_state.face(&clockFace.editState());
+        display.restore(retained_state.color(), retained_state.shownColor());
+        markBootPhase(BOOT_PHASE_FIRST_FRAME);
+    }
+
     iot_config.setup();
+    markBootPhase(BOOT_PHASE_CONFIG_READY);
+
+    health::watchTask(xTaskGetCurrentTaskHandle());
+    health::watchTask(xTaskGetHandle("log"));
+    health::watchTask(xTaskGetHandle("net"));
+    health::setup();
+    render_tick.begin();
+    power_manager.begin();
 }
 
 // Prints program debug state to Serial output.
@@ -88,22 +135,38 @@ void setup() {
 //    Serial.println("");
 //}
 
-// Executes the event loop once.
+// Executes the event loop once per render tick.
 void loop() {
+  render_tick.wait();
+  TIME_SCOPE(metrics::loop_duration);
   //struct tm: tm_year, tm_mon, tm_mday, tm_hour, tm_min, tm_sec
   struct tm timeinfo;
 
-// NOTE: the second arg in getLocalTime() is the max [ms] the function waits 
-//       for the time to be received from the NTP server. Be aware to set it to
-//       a low value to prevent blocking issues!
-//       See the following resources:
-// https://github.com/espressif/arduino-esp32/blob/34125cee1d1c6a81cd1da07de27ce69d851f9389/cores/esp32/esp32-hal-time.c#L87
-// https://techtutorialsx.com/2021/09/01/esp32-system-time-and-sntp/
-// https://www.lucadentella.it/en/2017/05/11/esp32-17-sntp/
-  getLocalTime(&timeinfo, 10); 
-  display.updateForTime(timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+  // Keep the restored frame until the time is known.
+  const bool timeValid = iot_config.localTime(&timeinfo);
+  if (timeValid) {
+    markBootPhase(BOOT_PHASE_TIME_VALID);
+    display.updateForTime(timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+  }
+  // Retain the state when the minute turns or a new frame has settled, rather
+  // than on every tick. NVS is written by the network task.
+  const time_t now = time(nullptr);
+  const bool settled = display.isIdle() && !display_was_idle;
+  display_was_idle = display.isIdle();
+  if (timeValid && (now / 60 != retained_minute || settled)) {
+    retained_minute = now / 60;
+    if (retained_state.update(now, iot_config.getTimezone(),
+                              display.getColor(), display.getShownColor(),
+                              clockFace.getState())) {
+      iot_config.saveRetainedState(retained_state.data());
+    }
+  }
 
   iot_config.loop();
+  time_source.loop(iot_config.ntpSynchronized());
 //  word_clock.loop();
   display.loop();
+  health::loop();
+  power_manager.setEnabled(iot_config.powerSave());
+  power_manager.update(display.isIdle());
 }
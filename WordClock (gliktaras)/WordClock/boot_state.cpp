@@ -0,0 +1,153 @@
+// Boot timeline and clock state retained across restarts.
+
+#include "boot_state.h"
+#include "logging.h"
+#include "metrics.h"
+
+#include <Preferences.h>
+#include <esp_timer.h>
+
+namespace {
+
+// Marks a valid retained state.
+#define RETAINED_MAGIC 0x57434C4B  // "WCLK"
+// Version of the retained state layout.
+#define RETAINED_VERSION 1
+// NVS namespace and key of the retained state.
+#define RETAINED_NVS_NAMESPACE "wordclock"
+#define RETAINED_NVS_KEY "retained"
+
+// Names of the boot phases, as reported.
+const char* const BOOT_PHASE_NAMES[BOOT_PHASE_COUNT] = {
+    "setup", "first_frame", "config_ready", "wifi_connected", "time_valid",
+};
+
+// Microseconds since power-on at which every phase was reached, or 0.
+int64_t boot_phase_us[BOOT_PHASE_COUNT] = {0};
+
+// Copy of the retained state that survives resets. Kept as raw bytes, so that
+// no constructor clears it at startup.
+RTC_NOINIT_ATTR uint8_t rtc_copy[48 + RETAINED_FACE_BYTES];
+
+// Publishes the boot timeline on /metrics.
+class BootPhaseMetric : public metrics::Metric {
+  public:
+    BootPhaseMetric()
+        : Metric("wordclock_boot_phase_seconds",
+                 "Time since power-on at which a boot phase was reached.") {}
+
+    void writeTo(Print& out) const override {
+        writeHeader(out, "gauge");
+        for (int phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+            if (boot_phase_us[phase] == 0) continue;
+            out.printf("%s{phase=\"%s\"} %lu.%06lu\n", name_,
+                       LOG_STATIC(BOOT_PHASE_NAMES[phase]),
+                       static_cast<unsigned long>(boot_phase_us[phase] / 1000000),
+                       static_cast<unsigned long>(boot_phase_us[phase] % 1000000));
+        }
+    }
+};
+
+BootPhaseMetric boot_phase_metric;
+
+}  // namespace
+
+void markBootPhase(BootPhase phase) {
+    if (boot_phase_us[phase] != 0) return;
+    boot_phase_us[phase] = esp_timer_get_time();
+    LOGI("Boot phase %s reached after %lu ms",
+         LOG_STATIC(BOOT_PHASE_NAMES[phase]),
+         static_cast<unsigned long>(boot_phase_us[phase] / 1000));
+}
+
+RetainedState::RetainedState() {
+    memset(&data_, 0, sizeof(data_));
+    data_.timezone = -1;
+}
+
+uint32_t RetainedState::checksum(const Data& data) {
+    // FNV-1a, which is plenty to tell stale RTC memory from a saved state.
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < offsetof(Data, checksum); i++) {
+        hash = (hash ^ bytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool RetainedState::isValid(const Data& data) {
+    return data.magic == RETAINED_MAGIC && data.version == RETAINED_VERSION &&
+           data.checksum == checksum(data);
+}
+
+bool RetainedState::load() {
+    static_assert(sizeof(Data) <= sizeof(rtc_copy),
+                  "RTC copy is too small for the retained state.");
+    Data data;
+    memcpy(&data, rtc_copy, sizeof(data));
+    if (isValid(data)) {
+        LOGI("Restored clock state from RTC memory.");
+        data_ = data;
+        return true;
+    }
+
+    Preferences preferences;
+    preferences.begin(RETAINED_NVS_NAMESPACE, true);
+    const size_t length =
+        preferences.getBytes(RETAINED_NVS_KEY, &data, sizeof(data));
+    preferences.end();
+    if (length == sizeof(data) && isValid(data)) {
+        LOGI("Restored clock state from NVS.");
+        data_ = data;
+        last_nvs_utc_ = data.utc;
+        nvs_timezone_ = data.timezone;
+        nvs_color_ = data.color;
+        return true;
+    }
+    return false;
+}
+
+bool RetainedState::update(time_t utc, int timezone, const RgbColor& color,
+                           const WideColor& shown_color,
+                           const ClockFace::State& face) {
+    Data data;
+    memset(&data, 0, sizeof(data));
+    data.magic = RETAINED_MAGIC;
+    data.version = RETAINED_VERSION;
+    data.timezone = timezone;
+    // Minute resolution is enough, and keeps the state unchanged in between.
+    data.utc = utc - utc % 60;
+    data.color = color;
+    data.shown_color = shown_color;
+    for (size_t i = 0; i < face.size() && i < RETAINED_FACE_BYTES * 8; i++) {
+        if (face[i]) data.face[i / 8] |= 1 << (i % 8);
+    }
+    data.checksum = checksum(data);
+    if (data.checksum == data_.checksum) return false;
+
+    data_ = data;
+    memcpy(rtc_copy, &data_, sizeof(data_));
+
+    if (timezone == nvs_timezone_ && color == nvs_color_ &&
+        data_.utc - last_nvs_utc_ < RETAINED_NVS_PERIOD_S) {
+        return false;
+    }
+    last_nvs_utc_ = data_.utc;
+    nvs_timezone_ = data_.timezone;
+    nvs_color_ = data_.color;
+    return true;
+}
+
+void RetainedState::face(ClockFace::State* face) const {
+    for (size_t i = 0; i < face->size(); i++) {
+        (*face)[i] = i < RETAINED_FACE_BYTES * 8 &&
+                     (data_.face[i / 8] & (1 << (i % 8))) != 0;
+    }
+}
+
+void RetainedState::saveToNvs(const Data& data) {
+    Preferences preferences;
+    preferences.begin(RETAINED_NVS_NAMESPACE, false);
+    preferences.putBytes(RETAINED_NVS_KEY, &data, sizeof(data));
+    preferences.end();
+}
@@ -0,0 +1,107 @@
+#ifndef WORDCLOCK_BOOT_STATE_H_
+#define WORDCLOCK_BOOT_STATE_H_
+
+#include <Arduino.h>
+#include <NeoPixelBus.h>
+
+#include "ClockFace.h"
+#include "Dither.h"
+
+// Number of bytes of face state kept, one bit per LED. At least 16, so that
+// the layout does not change with small canvases.
+#define RETAINED_FACE_BYTES                 \
+    ((ClockFace::pixelCount() + 7) / 8 > 16 \
+         ? (ClockFace::pixelCount() + 7) / 8 \
+         : 16)
+// Minimum time between two writes of an unchanged configuration to NVS, in
+// seconds. Bounds flash wear while keeping the power-on frame recent.
+#define RETAINED_NVS_PERIOD_S (15 * 60)
+
+// Steps of the boot sequence whose time is recorded.
+enum BootPhase {
+    // setup() was entered.
+    BOOT_PHASE_SETUP,
+    // The first frame, restored from the last run, was sent to the LEDs.
+    BOOT_PHASE_FIRST_FRAME,
+    // The configuration portal was initialized.
+    BOOT_PHASE_CONFIG_READY,
+    // WiFi connection was established.
+    BOOT_PHASE_WIFI_CONNECTED,
+    // The clock obtained a valid time and shows it.
+    BOOT_PHASE_TIME_VALID,
+
+    BOOT_PHASE_COUNT,
+};
+
+// Records the time since power-on at which `phase` was reached. Only the first
+// call for every phase is kept. The timeline is logged and published on
+// /metrics.
+void markBootPhase(BootPhase phase);
+
+// State of the clock that survives a restart, so that the first frame can be
+// shown before the configuration, WiFi and NTP are up.
+//
+// A copy is kept in RTC memory, which survives resets but not power loss, and
+// a copy in NVS, which is written less often and used after a power cycle.
+class RetainedState {
+  public:
+    // Layout of the retained state. Changing it requires bumping the version.
+    struct Data {
+        uint32_t magic;
+        uint16_t version;
+        int16_t timezone;
+        uint32_t utc;
+        RgbColor color;
+        WideColor shown_color;
+        uint8_t face[RETAINED_FACE_BYTES];
+        uint32_t checksum;
+    };
+
+    RetainedState();
+
+    RetainedState(const RetainedState&) = delete;
+    RetainedState& operator=(const RetainedState&) = delete;
+
+    // Loads the state left by the previous run. Returns false if there is
+    // none, in which case the getters return defaults.
+    bool load();
+
+    // Records the current state in RTC memory. Returns true if data() should
+    // also be written to NVS with saveToNvs(), which happens at most every
+    // RETAINED_NVS_PERIOD_S unless the configuration changed. Meant to be
+    // called when the minute or the face changes, not on every frame.
+    bool update(time_t utc, int timezone, const RgbColor& color,
+                const WideColor& shown_color, const ClockFace::State& face);
+
+    // Writes `data` to NVS. Flash writes can take tens of milliseconds, so
+    // this is not called from the render loop.
+    static void saveToNvs(const Data& data);
+
+    // The current state.
+    const Data& data() const { return data_; }
+    // UTC time of the last update, or 0.
+    time_t utc() const { return data_.utc; }
+    // Index of the timezone in the timezone database, or -1.
+    int timezone() const { return data_.timezone; }
+    // Configured color.
+    RgbColor color() const { return data_.color; }
+    // Color the lit LEDs were shown with, dimming included.
+    WideColor shownColor() const { return data_.shown_color; }
+    // Copies the face state into `face`.
+    void face(ClockFace::State* face) const;
+
+  private:
+    // Returns the checksum of `data`, excluding the checksum field itself.
+    static uint32_t checksum(const Data& data);
+    // Returns whether `data` holds a complete state of the current version.
+    static bool isValid(const Data& data);
+
+    // The current state.
+    Data data_;
+    // UTC time, timezone and color of the last state handed to NVS.
+    uint32_t last_nvs_utc_ = 0;
+    int16_t nvs_timezone_ = -1;
+    RgbColor nvs_color_;
+};
+
+#endif  // WORDCLOCK_BOOT_STATE_H_
@@ -1,6 +1,7 @@
 // Clock's internal state and rendering.
 
 #include "clock.h"
+#include "logging.h"
 #include "time.h"
 
 #include <NeoPixelBus.h>
@@ -213,8 +214,12 @@ void WordClock::setDisplayStateToDateTime_(DateTime datetime) {
     // temp for debug
     struct tm timeinfo;
     getLTStatus = getLocalTime(&timeinfo, 10);
-    Serial.print(&timeinfo, " %A, %B %d %Y %H:%M:%S");
-    Serial.printf(" (%d)\n", getLTStatus);
+    LOGD("%04d-%02d-%02d %02d:%02d:%02d", timeinfo.tm_year + 1900,
+         timeinfo.tm_mon + 1, timeinfo.tm_mday, timeinfo.tm_hour,
+         timeinfo.tm_min, timeinfo.tm_sec);
+    if (!getLTStatus) {
+        LOGW("Local time is not available yet.");
+    }
     
     shown_words_[0] =
             WORD_QUALIFIER_START + QUALIFIER_WORD_OFFSETS[minute_block];
@@ -327,9 +332,12 @@ void WordClock::loop() {
     }
     const unsigned long current_ms = millis();
 
-    if (current_ms - last_tick_ms_ > CLOCK_UPDATE_PERIOD_MS) {
+    if (current_ms - last_tick_ms_ >= CLOCK_UPDATE_PERIOD_MS) {
       update_();
-      last_tick_ms_ = current_ms;
+      // Advance by whole periods, so that a late call does not delay all the
+      // following ticks.
+      last_tick_ms_ += (current_ms - last_tick_ms_) / CLOCK_UPDATE_PERIOD_MS *
+                       CLOCK_UPDATE_PERIOD_MS;
       tick_id_++;
     }
 
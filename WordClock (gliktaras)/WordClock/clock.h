@@ -89,8 +89,6 @@ class WordClock {
     // Whether the word clock was initialized.
     bool initialized_ = false;
 
-    // RTC chip interface.
-//    RTC_DS3231* rtc_ = nullptr;
     // Clock display mode.
     ClockMode clock_mode_ = ClockMode::REAL_TIME;
     // Whether daylight saving time is enabled.
@@ -0,0 +1,236 @@
+// Versioned binary configuration record.
+
+#include "config_store.h"
+
+#include <string.h>
+
+namespace {
+
+// Marks a configuration record.
+#define CONFIG_MAGIC 0x47464357  // "WCFG"
+// Largest payload of any schema version, in bytes.
+#define CONFIG_MAX_PAYLOAD_SIZE 256
+
+// Start of every record.
+struct Header {
+    uint32_t magic;
+    // Schema version of the payload.
+    uint16_t schema_version;
+    // Size of the payload that follows the header.
+    uint16_t payload_size;
+    // CRC-32 of the payload.
+    uint32_t crc;
+};
+
+// Payload of schema version 1.
+//
+// Each schema version appends fields to the previous one, and released
+// layouts never change, so that a payload of any version starts with the
+// fields of all older ones.
+struct PayloadV1 {
+    uint32_t color;
+    uint16_t timezone;
+    uint16_t fast_time_factor;
+    uint8_t palette_id;
+    uint8_t clock_mode;
+    uint8_t dst;
+    uint8_t period;
+};
+
+// Payload of schema version 2, which adds the MQTT settings.
+struct PayloadV2 {
+    PayloadV1 v1;
+    char mqtt_host[CONFIG_MQTT_HOST_SIZE];
+    char mqtt_user[CONFIG_MQTT_CREDENTIAL_SIZE];
+    char mqtt_password[CONFIG_MQTT_CREDENTIAL_SIZE];
+    char mqtt_topic[CONFIG_MQTT_TOPIC_SIZE];
+    uint16_t mqtt_port;
+    uint16_t mqtt_interval_s;
+};
+
+// Payload of schema version 3, which adds the LED current limit.
+struct PayloadV3 {
+    PayloadV2 v2;
+    uint16_t power_limit_ma;
+};
+
+// Payload of schema version 4, which adds the orientation.
+struct PayloadV4 {
+    PayloadV3 v3;
+    uint8_t orientation;
+};
+
+// Payload of schema version 5, which adds power saving.
+struct PayloadV5 {
+    PayloadV4 v4;
+    uint8_t power_save;
+};
+
+// Payload of schema version 6, which adds the transition effect.
+struct PayloadV6 {
+    PayloadV5 v5;
+    uint8_t transition;
+};
+
+static_assert(sizeof(PayloadV6) <= CONFIG_MAX_PAYLOAD_SIZE,
+              "Configuration payload is too large.");
+
+// CRC-32 as used by zlib. The record is small enough for a bitwise version.
+uint32_t crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// Copies the string `src` into the field `dst` of `size` bytes, zeroing the
+// rest of it. `src` may lack its terminating NUL if it comes from a corrupt
+// record.
+void copyString(char* dst, const char* src, size_t size) {
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = 0;
+}
+
+}  // namespace
+
+ClockConfig ClockConfig::defaults() {
+    ClockConfig config;
+    config.timezone = 351;  // Europe/Amsterdam
+    config.dst = false;
+    config.palette_id = 1;
+    config.color = 0xEFEBD8;
+    config.period = false;
+    config.clock_mode = 0;
+    config.fast_time_factor = 30;
+    config.mqtt_host[0] = 0;
+    config.mqtt_port = 1883;
+    config.mqtt_user[0] = 0;
+    config.mqtt_password[0] = 0;
+    strcpy(config.mqtt_topic, "wordclock");
+    config.mqtt_interval_s = 60;
+    // What a 2 A USB supply takes, a quarter of a fully white face.
+    config.power_limit_ma = 2000;
+    // Light sensor at the bottom.
+    config.orientation = 0;
+    config.power_save = false;
+    // Fade.
+    config.transition = 0;
+    return config;
+}
+
+bool ConfigStore::load(ClockConfig* config) {
+    uint8_t record[sizeof(Header) + CONFIG_MAX_PAYLOAD_SIZE];
+    const size_t size = store_->size(CONFIG_STORE_KEY);
+    if (size < sizeof(Header) || size > sizeof(record) ||
+        !store_->read(CONFIG_STORE_KEY, record, size)) {
+        return false;
+    }
+    Header header;
+    memcpy(&header, record, sizeof(header));
+    const uint8_t* payload = record + sizeof(header);
+    if (header.magic != CONFIG_MAGIC ||
+        header.payload_size != size - sizeof(header) ||
+        crc32(payload, header.payload_size) != header.crc) {
+        return false;
+    }
+
+    // Fields a record lacks keep their defaults. Records of a newer firmware
+    // lose the fields this one does not know.
+    ClockConfig loaded = ClockConfig::defaults();
+    if (header.schema_version < 1 || header.payload_size < sizeof(PayloadV1)) {
+        return false;
+    }
+    PayloadV1 v1;
+    memcpy(&v1, payload, sizeof(v1));
+    loaded.timezone = v1.timezone;
+    loaded.dst = v1.dst != 0;
+    loaded.palette_id = v1.palette_id;
+    loaded.color = v1.color;
+    loaded.period = v1.period != 0;
+    loaded.clock_mode = v1.clock_mode;
+    loaded.fast_time_factor = v1.fast_time_factor;
+
+    if (header.schema_version >= 2 &&
+        header.payload_size >= sizeof(PayloadV2)) {
+        PayloadV2 v2;
+        memcpy(&v2, payload, sizeof(v2));
+        copyString(loaded.mqtt_host, v2.mqtt_host, sizeof(loaded.mqtt_host));
+        copyString(loaded.mqtt_user, v2.mqtt_user, sizeof(loaded.mqtt_user));
+        copyString(loaded.mqtt_password, v2.mqtt_password,
+                   sizeof(loaded.mqtt_password));
+        copyString(loaded.mqtt_topic, v2.mqtt_topic, sizeof(loaded.mqtt_topic));
+        loaded.mqtt_port = v2.mqtt_port;
+        loaded.mqtt_interval_s = v2.mqtt_interval_s;
+    }
+    if (header.schema_version >= 3 &&
+        header.payload_size >= sizeof(PayloadV3)) {
+        PayloadV3 v3;
+        memcpy(&v3, payload, sizeof(v3));
+        loaded.power_limit_ma = v3.power_limit_ma;
+    }
+    if (header.schema_version >= 4 &&
+        header.payload_size >= sizeof(PayloadV4)) {
+        PayloadV4 v4;
+        memcpy(&v4, payload, sizeof(v4));
+        loaded.orientation = v4.orientation;
+    }
+    if (header.schema_version >= 5 &&
+        header.payload_size >= sizeof(PayloadV5)) {
+        PayloadV5 v5;
+        memcpy(&v5, payload, sizeof(v5));
+        loaded.power_save = v5.power_save != 0;
+    }
+    if (header.schema_version >= 6 &&
+        header.payload_size >= sizeof(PayloadV6)) {
+        PayloadV6 v6;
+        memcpy(&v6, payload, sizeof(v6));
+        loaded.transition = v6.transition;
+    }
+
+    *config = loaded;
+    return true;
+}
+
+bool ConfigStore::save(const ClockConfig& config) {
+    PayloadV6 payload;
+    memset(&payload, 0, sizeof(payload));
+    PayloadV5& v5 = payload.v5;
+    PayloadV4& v4 = v5.v4;
+    PayloadV3& v3 = v4.v3;
+    PayloadV2& v2 = v3.v2;
+    PayloadV1& v1 = v2.v1;
+    v1.color = config.color;
+    v1.timezone = config.timezone;
+    v1.fast_time_factor = config.fast_time_factor;
+    v1.palette_id = config.palette_id;
+    v1.clock_mode = config.clock_mode;
+    v1.dst = config.dst;
+    v1.period = config.period;
+    copyString(v2.mqtt_host, config.mqtt_host, sizeof(v2.mqtt_host));
+    copyString(v2.mqtt_user, config.mqtt_user, sizeof(v2.mqtt_user));
+    copyString(v2.mqtt_password, config.mqtt_password,
+               sizeof(v2.mqtt_password));
+    copyString(v2.mqtt_topic, config.mqtt_topic, sizeof(v2.mqtt_topic));
+    v2.mqtt_port = config.mqtt_port;
+    v2.mqtt_interval_s = config.mqtt_interval_s;
+    v3.power_limit_ma = config.power_limit_ma;
+    v4.orientation = config.orientation;
+    v5.power_save = config.power_save;
+    payload.transition = config.transition;
+
+    Header header;
+    header.magic = CONFIG_MAGIC;
+    header.schema_version = CONFIG_SCHEMA_VERSION;
+    header.payload_size = sizeof(payload);
+    header.crc = crc32(reinterpret_cast<const uint8_t*>(&payload),
+                       sizeof(payload));
+
+    uint8_t record[sizeof(header) + sizeof(payload)];
+    memcpy(record, &header, sizeof(header));
+    memcpy(record + sizeof(header), &payload, sizeof(payload));
+    return store_->write(CONFIG_STORE_KEY, record, sizeof(record));
+}
@@ -0,0 +1,101 @@
+#ifndef WORDCLOCK_CONFIG_STORE_H_
+#define WORDCLOCK_CONFIG_STORE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Version of the configuration record layout. Increment it whenever the
+// layout changes, and teach ConfigStore to read the previous one.
+#define CONFIG_SCHEMA_VERSION 6
+// Key of the configuration record.
+#define CONFIG_STORE_KEY "config"
+// Sizes of the MQTT settings' strings, including the terminating NUL.
+#define CONFIG_MQTT_HOST_SIZE 64
+#define CONFIG_MQTT_CREDENTIAL_SIZE 32
+#define CONFIG_MQTT_TOPIC_SIZE 32
+
+// Settings of the clock, in native types.
+struct ClockConfig {
+    // Index of the timezone in the timezone database.
+    uint16_t timezone;
+    // Whether daylight saving time is enabled.
+    bool dst;
+    // Id of the color palette.
+    uint8_t palette_id;
+    // Custom color, as 0xRRGGBB.
+    uint32_t color;
+    // Whether to render the period character.
+    bool period;
+    // Clock mode, 0 being real time.
+    uint8_t clock_mode;
+    // Speed factor of the fast time clock mode.
+    uint16_t fast_time_factor;
+    // MQTT broker's host name or address, empty to disable MQTT.
+    char mqtt_host[CONFIG_MQTT_HOST_SIZE];
+    // MQTT broker's port.
+    uint16_t mqtt_port;
+    // Credentials on the MQTT broker, empty if it needs none.
+    char mqtt_user[CONFIG_MQTT_CREDENTIAL_SIZE];
+    char mqtt_password[CONFIG_MQTT_CREDENTIAL_SIZE];
+    // Prefix of the clock's MQTT topics.
+    char mqtt_topic[CONFIG_MQTT_TOPIC_SIZE];
+    // Interval between two telemetry messages, in seconds.
+    uint16_t mqtt_interval_s;
+    // Current the LEDs may draw, in milliamps, or 0 for no limit.
+    uint16_t power_limit_ma;
+    // How the LED canvas is mounted, a ClockFace::Orientation.
+    uint8_t orientation;
+    // Whether to slow the CPU down while the display is idle.
+    bool power_save;
+    // Effect of the transitions between two times, a transition::Effect.
+    uint8_t transition;
+
+    // Returns the settings of a new clock.
+    static ClockConfig defaults();
+};
+
+// Stores binary blobs by key. Implemented with NVS on the clock, and with a
+// map in memory on a host.
+class KeyValueStore {
+  public:
+    virtual ~KeyValueStore() {}
+
+    // Returns the size of the blob stored under `key`, or 0 if there is none.
+    virtual size_t size(const char* key) = 0;
+    // Reads the blob stored under `key`, of `size` bytes. Returns false if it
+    // is missing or has another size.
+    virtual bool read(const char* key, void* data, size_t size) = 0;
+    // Replaces the blob stored under `key` and commits it: after a power loss
+    // at any point, `key` holds either the old blob or the new one. Returns
+    // false on failure, in which case `key` holds the old blob.
+    virtual bool write(const char* key, const void* data, size_t size) = 0;
+};
+
+// Keeps the clock's settings as a single typed record in a key value store.
+//
+// The record starts with a header holding a magic number, the schema version
+// and a CRC of the payload, and is written as one blob, so that a save is
+// atomic. Records of older schema versions are migrated when loaded, and
+// written back in the current one on the next save.
+//
+// Has no Arduino dependencies, so that migrations can be run on a host against
+// an emulated store.
+class ConfigStore {
+  public:
+    explicit ConfigStore(KeyValueStore* store) : store_(store) {}
+
+    ConfigStore(const ConfigStore&) = delete;
+    ConfigStore& operator=(const ConfigStore&) = delete;
+
+    // Loads the settings into `config`, migrating them from an older schema
+    // if needed. Returns false, leaving `config` unchanged, if there is no
+    // valid record.
+    bool load(ClockConfig* config);
+    // Saves `config` in the current schema. Returns false on failure.
+    bool save(const ClockConfig& config);
+
+  private:
+    KeyValueStore* store_;
+};
+
+#endif  // WORDCLOCK_CONFIG_STORE_H_
@@ -0,0 +1,150 @@
+// DS3231 real time clock driver.
+
+#include "ds3231.h"
+
+#include <math.h>
+
+namespace {
+
+// Registers.
+#define REG_SECONDS 0x00
+#define REG_CONTROL 0x0E
+#define REG_STATUS 0x0F
+#define REG_AGING 0x10
+// Number of time registers, seconds to year.
+#define TIME_REGISTER_COUNT 7
+// Control register: start a temperature conversion.
+#define CONTROL_CONV 0x20
+// Status register: oscillator stopped, and temperature conversion busy.
+#define STATUS_OSF 0x80
+#define STATUS_BSY 0x04
+// Hours register: 12 hour mode, and PM in 12 hour mode.
+#define HOURS_12H 0x40
+#define HOURS_PM 0x20
+// Month register: year is in the next century.
+#define MONTH_CENTURY 0x80
+
+#define SECONDS_PER_DAY 86400L
+
+uint8_t fromBcd(uint8_t value) {
+    return (value >> 4) * 10 + (value & 0x0F);
+}
+
+uint8_t toBcd(int value) {
+    return ((value / 10) << 4) | (value % 10);
+}
+
+// Returns the number of days from 1970-01-01 to the given date of the
+// proleptic Gregorian calendar.
+long daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const long era = (year >= 0 ? year : year - 399) / 400;
+    const long year_of_era = year - era * 400;
+    const long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 +
+                             day - 1;
+    const long day_of_era = year_of_era * 365 + year_of_era / 4 -
+                            year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+}  // namespace
+
+bool Ds3231::begin() {
+    uint8_t status;
+    return bus_->read(DS3231_ADDRESS, REG_STATUS, &status, 1);
+}
+
+bool Ds3231::lostPower() {
+    uint8_t status;
+    if (!bus_->read(DS3231_ADDRESS, REG_STATUS, &status, 1)) return true;
+    return (status & STATUS_OSF) != 0;
+}
+
+bool Ds3231::readTime(time_t* utc) {
+    uint8_t regs[TIME_REGISTER_COUNT];
+    if (!bus_->read(DS3231_ADDRESS, REG_SECONDS, regs, sizeof(regs))) {
+        return false;
+    }
+    const int second = fromBcd(regs[0] & 0x7F);
+    const int minute = fromBcd(regs[1] & 0x7F);
+    int hour;
+    if (regs[2] & HOURS_12H) {
+        hour = fromBcd(regs[2] & 0x1F) % 12 + (regs[2] & HOURS_PM ? 12 : 0);
+    } else {
+        hour = fromBcd(regs[2] & 0x3F);
+    }
+    const int day = fromBcd(regs[4] & 0x3F);
+    const int month = fromBcd(regs[5] & 0x1F);
+    const int year = 2000 + fromBcd(regs[6]) +
+                     (regs[5] & MONTH_CENTURY ? 100 : 0);
+    if (second > 59 || minute > 59 || hour > 23 || day < 1 || day > 31 ||
+        month < 1 || month > 12) {
+        return false;
+    }
+    *utc = static_cast<time_t>(daysFromCivil(year, month, day)) *
+               SECONDS_PER_DAY +
+           hour * 3600L + minute * 60L + second;
+    return true;
+}
+
+bool Ds3231::readSeconds(uint8_t* seconds) {
+    uint8_t value;
+    if (!bus_->read(DS3231_ADDRESS, REG_SECONDS, &value, 1)) return false;
+    *seconds = fromBcd(value & 0x7F);
+    return true;
+}
+
+bool Ds3231::writeTime(time_t utc) {
+    struct tm time;
+    gmtime_r(&utc, &time);
+    if (time.tm_year < 100 || time.tm_year > 299) return false;
+    const uint8_t regs[TIME_REGISTER_COUNT] = {
+        toBcd(time.tm_sec),
+        toBcd(time.tm_min),
+        toBcd(time.tm_hour),
+        static_cast<uint8_t>(time.tm_wday + 1),
+        toBcd(time.tm_mday),
+        static_cast<uint8_t>(toBcd(time.tm_mon + 1) |
+                             (time.tm_year >= 200 ? MONTH_CENTURY : 0)),
+        toBcd(time.tm_year % 100),
+    };
+    if (!bus_->write(DS3231_ADDRESS, REG_SECONDS, regs, sizeof(regs))) {
+        return false;
+    }
+
+    uint8_t status;
+    if (!bus_->read(DS3231_ADDRESS, REG_STATUS, &status, 1)) return false;
+    status &= ~STATUS_OSF;
+    return bus_->write(DS3231_ADDRESS, REG_STATUS, &status, 1);
+}
+
+bool Ds3231::readAgingOffset(int8_t* offset) {
+    uint8_t value;
+    if (!bus_->read(DS3231_ADDRESS, REG_AGING, &value, 1)) return false;
+    *offset = static_cast<int8_t>(value);
+    return true;
+}
+
+int8_t Ds3231::agingOffsetFor(int8_t offset, float drift_ppm) {
+    if (isnan(drift_ppm)) return offset;
+    // A fast clock needs a larger offset to slow down.
+    const float updated =
+        offset + roundf(drift_ppm * 1000 / DS3231_AGING_STEP_PPB);
+    if (updated <= -128) return -128;
+    if (updated >= 127) return 127;
+    return static_cast<int8_t>(updated);
+}
+
+bool Ds3231::writeAgingOffset(int8_t offset) {
+    const uint8_t value = static_cast<uint8_t>(offset);
+    if (!bus_->write(DS3231_ADDRESS, REG_AGING, &value, 1)) return false;
+
+    // A conversion in progress applies the new offset as well.
+    uint8_t status;
+    if (!bus_->read(DS3231_ADDRESS, REG_STATUS, &status, 1)) return false;
+    if (status & STATUS_BSY) return true;
+    uint8_t control;
+    if (!bus_->read(DS3231_ADDRESS, REG_CONTROL, &control, 1)) return false;
+    control |= CONTROL_CONV;
+    return bus_->write(DS3231_ADDRESS, REG_CONTROL, &control, 1);
+}
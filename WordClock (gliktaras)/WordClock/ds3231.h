@@ -0,0 +1,59 @@
+#ifndef WORDCLOCK_DS3231_H_
+#define WORDCLOCK_DS3231_H_
+
+#include <stdint.h>
+#include <time.h>
+
+#include "i2c_bus.h"
+
+// I2C address of the DS3231.
+#define DS3231_ADDRESS 0x68
+// Frequency change per step of the aging offset, in parts per billion, at
+// 25 degrees Celsius. Positive offsets slow the oscillator down.
+#define DS3231_AGING_STEP_PPB 100
+
+// Driver of the DS3231 temperature compensated real time clock, which keeps
+// UTC with a one second resolution.
+//
+// Talks to the chip through an I2cBus, so that it can run on a host against a
+// fake register file.
+class Ds3231 {
+  public:
+    explicit Ds3231(I2cBus* bus) : bus_(bus) {}
+
+    Ds3231(const Ds3231&) = delete;
+    Ds3231& operator=(const Ds3231&) = delete;
+
+    // Returns whether the chip answers.
+    bool begin();
+    // Returns whether the oscillator stopped since the time was last written,
+    // e.g. because the backup battery ran out, making the time invalid. Also
+    // true if the chip does not answer.
+    bool lostPower();
+
+    // Reads the time. Returns false if the chip does not answer or holds an
+    // invalid time.
+    bool readTime(time_t* utc);
+    // Reads the seconds register alone, cheap enough to poll for the start of
+    // a second.
+    bool readSeconds(uint8_t* seconds);
+    // Writes the time and clears the oscillator stop flag. The chip starts a
+    // new second on the write, which should therefore happen right at the
+    // start of second `utc`.
+    bool writeTime(time_t utc);
+
+    // Reads the aging offset, in DS3231_AGING_STEP_PPB steps.
+    bool readAgingOffset(int8_t* offset);
+    // Writes the aging offset and starts a temperature conversion, which
+    // applies it.
+    bool writeAgingOffset(int8_t offset);
+    // Returns the aging offset that corrects a drift of `drift_ppm`, positive
+    // if the clock runs fast, starting from `offset`. Clamped to the
+    // register's range.
+    static int8_t agingOffsetFor(int8_t offset, float drift_ppm);
+
+  private:
+    I2cBus* bus_;
+};
+
+#endif  // WORDCLOCK_DS3231_H_
@@ -0,0 +1,134 @@
+#ifndef WORDCLOCK_GEOMETRY_H_
+#define WORDCLOCK_GEOMETRY_H_
+
+#include <stdint.h>
+
+#include <NeoPixelBus.h>  // Only need NeoTopology
+
+// Geometry of the LED canvas, fixed at compile time.
+//
+// A canvas is a strip of signal LEDs, the minute corners, followed by one or
+// more panels chained left to right. Panels are matrices of LEDs wired in any
+// of NeoPixelBus' layouts, and all have the same height. Coordinates on the
+// canvas are mapped to strip indices with per-panel tables built at startup,
+// so mapping costs a few comparisons and a load.
+
+// A `W` x `H` matrix of LEDs wired as `Layout`, e.g.
+// ColumnMajorAlternating270Layout.
+template <int W, int H, typename Layout>
+class Panel {
+  public:
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int pixel_count = W * H;
+
+    static_assert(W > 0 && H > 0, "Panels must have LEDs");
+    static_assert(pixel_count <= 0xFFFF, "Panels must fit 16-bit indices");
+
+    Panel() {
+        const NeoTopology<Layout> topology(W, H);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W; x++) {
+                table_[y * W + x] = topology.Map(x, y);
+            }
+        }
+    }
+
+    Panel(const Panel&) = delete;
+    Panel& operator=(const Panel&) = delete;
+
+    // Returns the index, within the panel, of the LED at `x`, `y`.
+    uint16_t map(int x, int y) const { return table_[y * W + x]; }
+
+  private:
+    // Index of every LED, row by row.
+    uint16_t table_[W * H];
+};
+
+// Panels wired one after the other, the first one starting at strip index
+// `Offset`.
+template <int Offset, typename... Panels>
+class PanelChain;
+
+template <int Offset>
+class PanelChain<Offset> {
+  public:
+    static constexpr int width = 0;
+    static constexpr int height = 0;
+    static constexpr int pixel_count = 0;
+
+    uint16_t map(int x, int y) const { return Offset; }
+};
+
+template <int Offset, typename First, typename... Rest>
+class PanelChain<Offset, First, Rest...> {
+  public:
+    typedef PanelChain<Offset + First::pixel_count, Rest...> Next;
+
+    static constexpr int width = First::width + Next::width;
+    static constexpr int height = First::height;
+    static constexpr int pixel_count = First::pixel_count + Next::pixel_count;
+
+    static_assert(Next::pixel_count == 0 || Next::height == First::height,
+                  "Chained panels must have the same height");
+
+    // Returns the strip index of the LED at `x`, `y`.
+    uint16_t map(int x, int y) const {
+        return x < First::width ? Offset + first_.map(x, y)
+                                : next_.map(x - First::width, y);
+    }
+
+  private:
+    First first_;
+    Next next_;
+};
+
+// `Signals` minute corners followed by `Panels`, left to right.
+template <int Signals, typename... Panels>
+class Canvas {
+  public:
+    typedef PanelChain<Signals, Panels...> Chain;
+
+    static constexpr int signal_count = Signals;
+    static constexpr int width = Chain::width;
+    static constexpr int height = Chain::height;
+    static constexpr int pixel_count = Signals + Chain::pixel_count;
+
+    static_assert(Signals == 4, "The clock has four minute corners");
+    static_assert(sizeof...(Panels) > 0, "Canvases need a panel");
+    static_assert(pixel_count <= 0xFFFF, "Canvases must fit 16-bit indices");
+
+    Canvas() {}
+
+    Canvas(const Canvas&) = delete;
+    Canvas& operator=(const Canvas&) = delete;
+
+    // Returns the strip index of the LED at `x`, `y`, with the first corner
+    // at the top left and the strip's corners first.
+    uint16_t map(int x, int y) const { return chain_.map(x, y); }
+
+  private:
+    Chain chain_;
+};
+
+// The geometry the clock is built for. Define WORDCLOCK_GEOMETRY_16X16 or
+// WORDCLOCK_GEOMETRY_32X8 when building, e.g. with arduino-cli's
+// --build-property build.extra_flags=-DWORDCLOCK_GEOMETRY_16X16, to pick
+// another than the 11 x 10 letter matrix.
+//
+// WORDCLOCK_HAS_LETTER_GRID tells whether the word faces' 11 x 10 letter grid
+// fits the canvas. It is centered on larger ones.
+#if defined(WORDCLOCK_GEOMETRY_16X16)
+typedef Canvas<4, Panel<16, 16, ColumnMajorAlternating270Layout>> FaceGeometry;
+#define WORDCLOCK_HAS_LETTER_GRID 1
+#elif defined(WORDCLOCK_GEOMETRY_32X8)
+// Four 8 x 8 panels.
+typedef Panel<8, 8, ColumnMajorAlternating270Layout> Panel8x8;
+typedef Canvas<4, Panel8x8, Panel8x8, Panel8x8, Panel8x8> FaceGeometry;
+#define WORDCLOCK_HAS_LETTER_GRID 0
+#else
+typedef Canvas<4, Panel<11, 10, ColumnMajorAlternating270Layout>> FaceGeometry;
+#define WORDCLOCK_HAS_LETTER_GRID 1
+#endif
+
+#endif  // WORDCLOCK_GEOMETRY_H_
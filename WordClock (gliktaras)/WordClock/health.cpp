@@ -0,0 +1,209 @@
+// Heap, stack and allocation telemetry.
+
+#include "health.h"
+#include "logging.h"
+#include "metrics.h"
+
+#include <esp_heap_caps.h>
+
+namespace health {
+
+namespace {
+
+// Heap state at one point in time.
+struct Sample {
+    // Seconds since boot.
+    uint32_t uptime_s;
+    // Free heap, in bytes.
+    uint32_t free;
+    // Largest block that can be allocated, in bytes.
+    uint32_t largest_block;
+    // Lowest free heap since boot, in bytes.
+    uint32_t min_free;
+};
+
+// Heap usage attributed to a subsystem.
+struct Allocations {
+    // Drop of the global free heap across the subsystem's probes, negative if
+    // it grew. Approximate, as other tasks allocate meanwhile.
+    int32_t retained_bytes;
+    // Number of allocations made under the subsystem's probes, and the bytes
+    // they asked for. Only counted with heap hooks.
+    uint32_t count;
+    uint32_t bytes;
+};
+
+// Names of the subsystems, as reported.
+const char* const SUBSYSTEM_NAMES[SUBSYSTEM_COUNT] = {"portal"};
+
+// Heap history, oldest sample first once the ring has wrapped.
+Sample history[HEALTH_HISTORY_SIZE];
+// Index where the next sample is written.
+int next_sample = 0;
+// Number of valid samples in the history.
+int sample_count = 0;
+// millis() of the last sample.
+unsigned long last_sample_ms = 0;
+
+// Tasks whose stack is watched.
+TaskHandle_t tasks[HEALTH_MAX_TASKS];
+// Number of watched tasks.
+int task_count = 0;
+
+// Heap usage of every subsystem.
+Allocations allocations[SUBSYSTEM_COUNT];
+
+#if CONFIG_HEAP_USE_HOOKS
+// Task running a probe of every subsystem, or null.
+TaskHandle_t volatile probe_tasks[SUBSYSTEM_COUNT];
+#endif
+
+Sample takeSample() {
+    Sample sample;
+    sample.uptime_s = millis() / 1000;
+    sample.free = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    sample.largest_block = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    sample.min_free = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    return sample;
+}
+
+void recordSample() {
+    const Sample sample = takeSample();
+    history[next_sample] = sample;
+    next_sample = (next_sample + 1) % HEALTH_HISTORY_SIZE;
+    sample_count = min(sample_count + 1, HEALTH_HISTORY_SIZE);
+    last_sample_ms = millis();
+    LOGD("Heap free:%u largest:%u min:%u", sample.free, sample.largest_block,
+         sample.min_free);
+}
+
+// Publishes the current state on /metrics.
+class HealthMetric : public metrics::Metric {
+  public:
+    HealthMetric() : Metric("wordclock_health", "Heap and stack health.") {}
+
+    void writeTo(Print& out) const override {
+        const Sample sample = takeSample();
+        out.printf("# TYPE wordclock_heap_free_bytes gauge\n"
+                   "wordclock_heap_free_bytes %u\n"
+                   "# TYPE wordclock_heap_largest_free_block_bytes gauge\n"
+                   "wordclock_heap_largest_free_block_bytes %u\n"
+                   "# TYPE wordclock_heap_min_free_bytes gauge\n"
+                   "wordclock_heap_min_free_bytes %u\n",
+                   sample.free, sample.largest_block, sample.min_free);
+        out.printf("# TYPE wordclock_task_stack_min_free_bytes gauge\n");
+        for (int i = 0; i < task_count; i++) {
+            out.printf("wordclock_task_stack_min_free_bytes{task=\"%s\"} %u\n",
+                       pcTaskGetName(tasks[i]),
+                       uxTaskGetStackHighWaterMark(tasks[i]));
+        }
+        out.printf("# HELP wordclock_heap_approx_retained_bytes Drop of the "
+                   "global free heap across a subsystem's probes, including "
+                   "what other tasks allocated meanwhile.\n"
+                   "# TYPE wordclock_heap_approx_retained_bytes gauge\n");
+        for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+            out.printf("wordclock_heap_approx_retained_bytes{subsystem=\"%s\"} "
+                       "%d\n",
+                       SUBSYSTEM_NAMES[i], allocations[i].retained_bytes);
+        }
+#if CONFIG_HEAP_USE_HOOKS
+        out.printf("# TYPE wordclock_allocations_total counter\n");
+        for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+            out.printf("wordclock_allocations_total{subsystem=\"%s\"} %u\n",
+                       SUBSYSTEM_NAMES[i], allocations[i].count);
+        }
+        out.printf("# TYPE wordclock_allocated_bytes_total counter\n");
+        for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+            out.printf("wordclock_allocated_bytes_total{subsystem=\"%s\"} %u\n",
+                       SUBSYSTEM_NAMES[i], allocations[i].bytes);
+        }
+#endif
+    }
+};
+
+HealthMetric health_metric;
+
+}  // namespace
+
+HeapProbe::HeapProbe(Subsystem subsystem)
+    : subsystem_(subsystem),
+      free_before_(heap_caps_get_free_size(MALLOC_CAP_8BIT)) {
+#if CONFIG_HEAP_USE_HOOKS
+    probe_tasks[subsystem_] = xTaskGetCurrentTaskHandle();
+#endif
+}
+
+HeapProbe::~HeapProbe() {
+#if CONFIG_HEAP_USE_HOOKS
+    probe_tasks[subsystem_] = nullptr;
+#endif
+    const uint32_t free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    allocations[subsystem_].retained_bytes +=
+        static_cast<int32_t>(free_before_ - free_after);
+}
+
+void watchTask(TaskHandle_t task) {
+    if (task == nullptr || task_count == HEALTH_MAX_TASKS) return;
+    tasks[task_count++] = task;
+}
+
+void setup() {
+    recordSample();
+}
+
+void loop() {
+    if (millis() - last_sample_ms >= HEALTH_SAMPLE_PERIOD_MS) {
+        recordSample();
+    }
+}
+
+void writeJson(Print& out) {
+    const Sample sample = takeSample();
+    out.printf("{\"uptime_s\":%u,\"heap\":{\"free\":%u,\"largest_block\":%u,"
+               "\"min_free\":%u},\"tasks\":[",
+               sample.uptime_s, sample.free, sample.largest_block,
+               sample.min_free);
+    for (int i = 0; i < task_count; i++) {
+        out.printf("%s{\"name\":\"%s\",\"stack_min_free\":%u}", i ? "," : "",
+                   pcTaskGetName(tasks[i]),
+                   uxTaskGetStackHighWaterMark(tasks[i]));
+    }
+    out.print("],\"subsystems\":[");
+    for (int i = 0; i < SUBSYSTEM_COUNT; i++) {
+        out.printf("%s{\"name\":\"%s\",\"approx_retained_bytes\":%d",
+                   i ? "," : "",
+                   SUBSYSTEM_NAMES[i], allocations[i].retained_bytes);
+#if CONFIG_HEAP_USE_HOOKS
+        out.printf(",\"allocations\":%u,\"allocated_bytes\":%u",
+                   allocations[i].count, allocations[i].bytes);
+#endif
+        out.print("}");
+    }
+    out.printf("],\"history\":{\"period_s\":%lu,\"columns\":[\"uptime_s\","
+               "\"free\",\"largest_block\",\"min_free\"],\"samples\":[",
+               HEALTH_SAMPLE_PERIOD_MS / 1000);
+    const int first = (next_sample - sample_count + HEALTH_HISTORY_SIZE) %
+                      HEALTH_HISTORY_SIZE;
+    for (int i = 0; i < sample_count; i++) {
+        const Sample& s = history[(first + i) % HEALTH_HISTORY_SIZE];
+        out.printf("%s[%u,%u,%u,%u]", i ? "," : "", s.uptime_s, s.free,
+                   s.largest_block, s.min_free);
+    }
+    out.print("]}}");
+}
+
+}  // namespace health
+
+#if CONFIG_HEAP_USE_HOOKS
+// Called by the heap on every allocation, from any task or interrupt.
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size,
+                                                    uint32_t caps) {
+    const TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    for (int i = 0; i < health::SUBSYSTEM_COUNT; i++) {
+        if (health::probe_tasks[i] == task) {
+            health::allocations[i].count++;
+            health::allocations[i].bytes += size;
+        }
+    }
+}
+#endif
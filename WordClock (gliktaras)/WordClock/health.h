@@ -0,0 +1,66 @@
+#ifndef WORDCLOCK_HEALTH_H_
+#define WORDCLOCK_HEALTH_H_
+
+#include <Arduino.h>
+#include <Print.h>
+
+// Time between two samples of the heap history, in milliseconds.
+#define HEALTH_SAMPLE_PERIOD_MS (10 * 60 * 1000UL)
+// Number of samples kept in the heap history, 12 hours at the default period.
+#define HEALTH_HISTORY_SIZE 72
+// Maximum number of tasks whose stack usage is reported.
+#define HEALTH_MAX_TASKS 8
+
+// Heap, stack and allocation telemetry, published as JSON on /health and as
+// gauges on /metrics.
+//
+// A sample of the heap state is taken every HEALTH_SAMPLE_PERIOD_MS and kept in
+// a RAM ring, so that slow leaks and fragmentation show up as a trend without
+// attaching a serial cable.
+namespace health {
+
+// Parts of the firmware whose heap allocations are accounted separately.
+enum Subsystem {
+    SUBSYSTEM_PORTAL,
+    SUBSYSTEM_COUNT,
+};
+
+// Attributes the heap a scope keeps allocated to a subsystem.
+//
+// The free heap size is compared on construction and destruction, so memory
+// the scope allocates and frees again is not counted, and a growing total
+// hints at a leak. The free size is global, though: whatever WiFi, lwIP or
+// any other task allocates or frees meanwhile is counted too, so the total is
+// only an approximation, reported as such. Scopes should end once what they
+// allocated is released.
+//
+// If the framework calls heap hooks (CONFIG_HEAP_USE_HOOKS), every allocation
+// the scope's task makes is also counted, with its size, freed or not. Those
+// counts are exact. Probes of one subsystem must not be nested.
+class HeapProbe {
+  public:
+    explicit HeapProbe(Subsystem subsystem);
+    ~HeapProbe();
+
+    HeapProbe(const HeapProbe&) = delete;
+    HeapProbe& operator=(const HeapProbe&) = delete;
+
+  private:
+    const Subsystem subsystem_;
+    const uint32_t free_before_;
+};
+
+// Starts reporting the stack high-water mark of `task`.
+void watchTask(TaskHandle_t task);
+
+// Takes the first sample. Must be called from setup().
+void setup();
+// Takes a new sample when one is due. Must be called from loop().
+void loop();
+
+// Writes the current state and the sample history as a JSON object.
+void writeJson(Print& out);
+
+}  // namespace health
+
+#endif  // WORDCLOCK_HEALTH_H_
@@ -0,0 +1,24 @@
+#include "i2c_bus.h"
+
+#include <Wire.h>
+
+bool WireI2cBus::read(uint8_t address, uint8_t reg, uint8_t* data,
+                      size_t size) {
+    wire_->beginTransmission(address);
+    wire_->write(reg);
+    // Repeated start, so that no other master moves the register pointer.
+    if (wire_->endTransmission(false) != 0) return false;
+    if (wire_->requestFrom(address, static_cast<uint8_t>(size)) != size) {
+        return false;
+    }
+    for (size_t i = 0; i < size; i++) data[i] = wire_->read();
+    return true;
+}
+
+bool WireI2cBus::write(uint8_t address, uint8_t reg, const uint8_t* data,
+                       size_t size) {
+    wire_->beginTransmission(address);
+    wire_->write(reg);
+    wire_->write(data, size);
+    return wire_->endTransmission() == 0;
+}
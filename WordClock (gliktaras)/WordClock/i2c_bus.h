@@ -0,0 +1,43 @@
+#ifndef WORDCLOCK_I2C_BUS_H_
+#define WORDCLOCK_I2C_BUS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+class TwoWire;
+
+// Register access to devices on an I2C bus. Implemented with Wire on the
+// clock, and with a fake register file on a host.
+class I2cBus {
+  public:
+    virtual ~I2cBus() {}
+
+    // Reads `size` bytes from device `address`, starting at register `reg`.
+    // Returns false if the device does not answer.
+    virtual bool read(uint8_t address, uint8_t reg, uint8_t* data,
+                      size_t size) = 0;
+    // Writes `size` bytes to device `address`, starting at register `reg`.
+    // Returns false if the device does not acknowledge them.
+    virtual bool write(uint8_t address, uint8_t reg, const uint8_t* data,
+                       size_t size) = 0;
+};
+
+// I2C bus of the Arduino Wire library.
+class WireI2cBus : public I2cBus {
+  public:
+    // Constructs a bus on `wire`, which must be started with begin().
+    explicit WireI2cBus(TwoWire* wire) : wire_(wire) {}
+
+    WireI2cBus(const WireI2cBus&) = delete;
+    WireI2cBus& operator=(const WireI2cBus&) = delete;
+
+    bool read(uint8_t address, uint8_t reg, uint8_t* data,
+              size_t size) override;
+    bool write(uint8_t address, uint8_t reg, const uint8_t* data,
+               size_t size) override;
+
+  private:
+    TwoWire* wire_;
+};
+
+#endif  // WORDCLOCK_I2C_BUS_H_
@@ -1,11 +1,16 @@
 #include "iot_config.h"
 //#include "clock.h"
 #include "Display.h"
-#include "Timezones.h"
+#include "health.h"
+#include "json.h"
+#include "logging.h"
+#include "metrics.h"
+#include "portal_assets.h"
+#include "sntp_system.h"
+#include "tzdb.h"
 
 #include <IotWebConf.h>
 #include <WiFi.h>
-#include <RTClib.h> // RVG: only for data structures
 
 // Name of this IoT object.
 #define THING_NAME "WordClockLT"
@@ -14,7 +19,7 @@
 // IoT configuration version. Change this whenever IotWebConf object's
 // configuration structure changes.
 #define CONFIG_VERSION "v1"
-// Default timezone index from Timezones.h (Paris).
+// Default timezone index in the timezone database (Amsterdam).
 #define DEFAULT_TIMEZONE "351" // 351=Amsterdam 385=Paris 153=New York
 // Port used by the IotWebConf HTTP server.
 #define WEB_SERVER_PORT 80
@@ -36,162 +41,86 @@
 //    On continuously - Connected to NTP server, using NTP time for the clock
 #define NTP_STATUS_PIN 16
 #define NTP_BLINK_MS 300
-#define NTP_POLL_SHORT_DELAY_SECONDS 20 // Once every 20s
-#define NTP_POLL_LONG_DELAY_SECONDS 3*3600 // Once every 3 hours
+
+// Stack size of the network task, in bytes. HTTP handlers run on it.
+#define NETWORK_TASK_STACK_SIZE 8192
+// Priority of the network task, above the log drain task.
+#define NETWORK_TASK_PRIORITY (tskIDLE_PRIORITY + 2)
+// Core the network task runs on, with the WiFi and TCP/IP tasks and away from
+// the render loop.
+#define NETWORK_TASK_CORE 0
+// How long the network task sleeps between event loop iterations, in
+// milliseconds. Lets the lower priority tasks of core 0 run.
+#define NETWORK_TASK_PERIOD_MS 2
 
 // HTTP OK status code.
 #define HTTP_OK 200
+// HTTP not modified status code.
+#define HTTP_NOT_MODIFIED 304
+// HTTP bad request status code.
+#define HTTP_BAD_REQUEST 400
+// HTTP internal server error status code.
+#define HTTP_INTERNAL_ERROR 500
+// Cache lifetime of the static portal assets. Pages refer to them by URLs that
+// change with their content, so they never go stale.
+#define ASSET_CACHE_CONTROL "public, max-age=31536000, immutable"
 
 // HTTP MIME type.
 #define MIME_HTTP "text/html"
+// JSON MIME type.
+#define MIME_JSON "application/json"
+// Prometheus text exposition format MIME type.
+#define MIME_PROMETHEUS "text/plain; version=0.0.4"
+// Size of the buffer of API responses.
+#define API_RESPONSE_SIZE 192
+// Size of the buffer used to send chunked HTTP responses.
+#define HTTP_CHUNK_SIZE 512
+// Number of zones per page of timezone search results.
+#define TZ_SEARCH_PAGE_SIZE 8
+// Size of the buffer of the MQTT telemetry message.
+#define MQTT_TELEMETRY_SIZE 256
 
 // NTP CLOCK ========================================================================
-// NTP server. Maintains local time plus timezone settings
-#define NTP_SVR   "pool.ntp.org"
-// NTP servers
-//#define NTP_SVR   "pool.ntp.org"
-//#define NTP_SVR   "europe.pool.ntp.org"
-//#define NTP_SVR   "north-america.pool.ntp.org"
-
-// Time zone settings
-//#define CLK_TZ     "CET-1CEST,M3.5.0,M10.5.0/3" // Amsterdam
-#define CLK_TZ     "EST5EDT,M3.2.0,M11.1.0" // America/New-York
+// Number of NTP servers queried by the SNTP client.
+#define NTP_SERVER_COUNT 3
+
+// Earliest UTC time considered valid (2016-01-01). The system clock starts at
+// 0 until the first NTP response arrives.
+#define MIN_VALID_UTC 1451606400
 //#define NTP_LT_TIMEOUT 3000 // [ms] waiting time for time from NTP server
 
 namespace {
-  // An SVG logo for the Word Clock
-  const char LOGO_DATA_URI[] PROGMEM = "data:image/svg+xml,%3Csvg xmlns='http://www.w3.org/2000/svg' viewBox='0 0 480 480'%3E%3Cpath d='M0 0h480v480H0z'/%3E%3Cg fill='%23fff'%3E%3Cpath d='M150.692 163.411h-6.563l-11.522-38.242q-.82-2.54-1.836-6.406-1.016-3.867-1.055-4.649-.86 5.157-2.735 11.29L115.81 163.41h-6.563l-15.195-57.109h7.031l9.024 35.273q1.875 7.422 2.734 13.438 1.055-7.148 3.125-13.984l10.234-34.727h7.031l10.742 35.04q1.875 6.054 3.164 13.671.742-5.547 2.813-13.516l8.984-35.195h7.031z' aria-label='W'/%3E%3Cpath d='M268.677 134.718q0 13.711-6.954 21.562-6.914 7.852-19.258 7.852-12.617 0-19.492-7.695-6.835-7.735-6.835-21.797 0-13.945 6.875-21.602 6.875-7.696 19.53-7.696 12.306 0 19.22 7.813t6.914 21.562zm-45.508 0q0 11.602 4.921 17.617 4.961 5.977 14.375 5.977 9.493 0 14.336-5.977t4.844-17.617q0-11.523-4.844-17.46-4.804-5.977-14.258-5.977-9.492 0-14.453 6.015-4.922 5.977-4.922 17.422z' aria-label='O'/%3E%3Cpath d='M154.135 244.514q0 14.14-7.696 21.64-7.656 7.462-22.07 7.462h-15.82v-57.11h17.5q13.32 0 20.703 7.383t7.383 20.625zm-7.032.234q0-11.172-5.625-16.836-5.586-5.664-16.64-5.664h-9.65v45.625h8.087q11.875 0 17.852-5.82 5.976-5.86 5.976-17.305z' aria-label='D'/%3E%3Cpath d='M339.34 139.658v23.75h-6.641v-57.109h15.664q10.508 0 15.508 4.023 5.039 4.024 5.039 12.11 0 11.327-11.484 15.311l15.508 25.664h-7.852l-13.828-23.75zm0-5.703h9.101q7.031 0 10.312-2.773 3.281-2.813 3.281-8.399 0-5.664-3.36-8.164-3.32-2.5-10.702-2.5h-8.633z' aria-label='R'/%3E%3Cpath d='M245.577 219.873q-9.414 0-14.883 6.289-5.43 6.25-5.43 17.148 0 11.211 5.235 17.344 5.273 6.094 15 6.094 5.976 0 13.633-2.149v5.82q-5.938 2.227-14.648 2.227-12.617 0-19.492-7.656-6.836-7.656-6.836-21.758 0-8.828 3.281-15.469 3.32-6.64 9.531-10.234 6.25-3.594 14.688-3.594 8.985 0 15.703 3.282l-2.812 5.703q-6.485-3.047-12.97-3.047z' aria-label='C'/%3E%3Cpath d='M156.44 354.9q0 13.711-6.953 21.562-6.914 7.852-19.258 7.852-12.617 0-19.492-7.696-6.836-7.734-6.836-21.797 0-13.945 6.875-21.602 6.875-7.695 19.531-7.695 12.305 0 19.219 7.813t6.914 21.562zm-45.508 0q0 11.602 4.922 17.617 4.96 5.977 14.375 5.977 9.492 0 14.336-5.977t4.844-17.617q0-11.523-4.844-17.461-4.805-5.977-14.258-5.977-9.492 0-14.453 6.016-4.922 5.977-4.922 17.422z' aria-label='O'/%3E%3Cpath d='M336.73 273.613v-57.109h6.641v51.094h25.195v6.016z' aria-label='L'/%3E%3Cpath d='M373.956 383.337h-7.813l-20.82-27.695-5.976 5.312v22.383h-6.64v-57.109h6.64v28.32l25.898-28.32h7.852l-22.97 24.805z' aria-label='K'/%3E%3Cpath d='M245.577 329.87q-9.414 0-14.883 6.29-5.43 6.25-5.43 17.147 0 11.211 5.235 17.344 5.273 6.094 15 6.094 5.976 0 13.633-2.148v5.82q-5.938 2.226-14.648 2.226-12.617 0-19.492-7.656-6.836-7.656-6.836-21.758 0-8.828 3.281-15.469 3.32-6.64 9.531-10.234 6.25-3.594 14.688-3.594 8.985 0 15.703 3.282l-2.812 5.703q-6.485-3.047-12.97-3.047z' aria-label='C'/%3E%3C/g%3E%3Cg fill='%23fff'%3E%3Ccircle cx='37.785' cy='37.968' r='7.906'/%3E%3Ccircle cx='439.98' cy='38.047' r='7.906'/%3E%3Ccircle cx='37.785' cy='440.74' r='7.906'/%3E%3Ccircle cx='439.98' cy='440.82' r='7.906'/%3E%3C/g%3E%3C/svg%3E";
-  
-  // Custom meta tags to be inserted in the head.
-  const char CUSTOM_HTML_META_START[] = "<meta name=\"theme-color\" content=\"#121212\" />\n<link rel=\"icon\" href=\"";
-  const char CUSTOM_HTML_META_END[] = "\" type=\"image/svg+xml\" />\n";
-  
-  // Custom Javascript block that will be added to the header.
-  // See customconfig.js for human-readable version.
-  const char CUSTOMHTML_SCRIPT_INNER[] PROGMEM = "document.addEventListener(\"DOMContentLoaded\",function(d){if(d=document.querySelector(\"label[for=iwcThingName]\"))d.innerText=\"Clock name\";if(d=document.querySelector(\"label[for=iwcApPassword]\"))d.innerText=\"AP password (login: admin)\";document.querySelectorAll(\"input[type=password]\").forEach(function(a){var b=document.createElement(\"input\");b.classList.add(\"pwtoggle\");b.type=\"button\";b.value=\"\\ud83d\\udc41\\ufe0f\";a.insertAdjacentElement(\"afterend\",b);b.onclick=function(){\"password\"===a.type?(a.type=\
-  \"text\",b.value=\"\\ud83d\\udd12\"):(a.type=\"password\",b.value=\"\\ud83d\\udc41\\ufe0f\")}});(d=document.querySelector(\"form\"))&&d.addEventListener(\"submit\",function(){var a=document.querySelector(\"button[type=submit]\");a.innerText=\"Saving...\";a.toggleAttribute(\"disabled\",!0)});document.querySelectorAll(\"input[data-options]\").forEach(function(a){var b=a.value,h=a.getAttribute(\"data-options\").split(\"|\"),f=document.createElement(\"select\");f.name=a.name;f.id=a.id;\"\"===b&&f.appendChild(document.createElement(\"option\"));\
-  var c=null;h.forEach(function(m,n){var e=m.split(\"/\"),g=m;1<e.length?(g=e.splice(0,1)[0],c&&g==c.label||(c&&f.appendChild(c),c=document.createElement(\"optgroup\"),c.label=g),g=e.join(\" / \")):c&&(f.appendChild(c),c=null);e=document.createElement(\"option\");e.value=n;e.innerText=g;n==b&&e.toggleAttribute(\"selected\");c?c.appendChild(e):f.appendChild(e)});c&&f.appendChild(c);a.id+=\"-d\";a.insertAdjacentElement(\"beforebegin\",f);a.parentElement.removeChild(a)});document.querySelectorAll(\"input[type=range]\").forEach(function(a){var b=\
-  a.getAttribute(\"data-labels\"),h=b&&b.split(\"|\");b=function(){a.setAttribute(\"data-label\",h?h[parseInt(a.value,10)]||a.value:a.value)};a.oninput=b;b()});var k=document.getElementById(\"ntp_enabled\");if(k){var p=function(a){document.querySelectorAll(\"#date, #time\").forEach(function(b){b.parentElement.style.display=a?\"none\":\"\"});document.getElementById(\"timezone\").parentElement.style.display=a?\"\":\"none\"};k.addEventListener(\"change\",function(a){p(1==k.value)});p(1==k.value)}var l=document.querySelector(\"input[type=color]\");\
-  l&&(d=function(){document.querySelector(\".logoContainer\").style.backgroundColor=l.value},l.addEventListener(\"input\",d),d())});";
-  
-  // Custom style added to the style tag.
-  const char CUSTOMHTML_STYLE_INNER[] PROGMEM = "\n\
-  body {\
-    color: #eee;\
-    margin: 0;\
-  background: #121212;\
-    font: 100% system-ui;}\
-  a {\
-    color: #16a1e7;}\
-  div {\
-    padding: 0;}\
-  .logo {\
-    width: 80vw;\
-    max-width: 160px;\
-    display: block;\
-    mix-blend-mode: multiply;}\
-  .logoContainer {\
-    background: white;\
-    transition: background 3s;\
-    display: inline-block;\
-    margin: 40px auto;\
-    padding: 0;}\
-  .logoContainer, fieldset {\
-    box-shadow: 0px 0px 15px 1px #ffffff7d;}\
-  .pwtoggle {\
-    padding: 0 5px;\
-    position: absolute;\
-    right: 3px;\
-    top: 40px;\
-    border: none;\
-    background: transparent;\
-    height: 34px;\
-    outline: none;}\
-  fieldset {\
-    padding: 40px 15px 20px;\
-    margin-bottom: 40px;\
-    border: none;\
-    background: black;\
-    border-radius: 0;\
-    position: relative;\
-    width: calc(100vw - 100px);\
-    max-width: 440px;}\
-  fieldset > div {\
-    position: relative;\
-    margin: 0;\
-    padding: 0;\
-    display: flex;\
-    flex-direction: column;}\
-  input, select {\
-    margin: 0;\
-    padding: 5px;\
-    width: auto;\
-    line-height: 20px;}\
-  input[type=\"range\"] {\
-    margin-left: 30px;\
-    position: relative;\
-    padding: 0;}\
-  input[type=\"range\"]:before {\
-    content: attr(data-label);\
-    color: #eee;\
-    position: absolute;\
-    left: -30px;\
-    display: inline;\
-    width: 25px;\
-    line-height: 20px;}\
-  label {margin: 15px 0 5px;}\
-  legend, fieldset:first-child:after {\
-    font-weight: lighter;\
-    padding: 0;\
-    font-size: 1.2em;\
-    text-align: center;\
-    position: absolute;\
-    top: 15px;\
-    display: block;\
-    left: 0;\
-    right: 0;\
-    text-transform: uppercase;}\
-  fieldset:first-child:after {content: \"Network\";}\
-  button {\
-    border-radius: 0;\
-    text-transform: uppercase;}\
-  form + div {padding: 20px 0 15px 0;}\
-  body > div > div:last-child {\
-    margin-top: -20px;\
-    float: right;}\
-  }\n";
-  
-  // Custom HTML element will be added at the beginning of the body element.
-  const char CUSTOMHTML_BODY_INNER_START[] PROGMEM = "<header><div class=\"logoContainer\"><img class=\"logo\" src=\"";
-  const char CUSTOMHTML_BODY_INNER_END[] PROGMEM = "\"/></div></header>\n";
-  
+  // NTP servers. Different pool hosts resolve to different servers, which
+  // lets the SNTP client outvote a bad one.
+  // Other pools: "europe.pool.ntp.org", "north-america.pool.ntp.org"
+  const char* const NTP_SERVERS[NTP_SERVER_COUNT] = {
+    "0.pool.ntp.org", "1.pool.ntp.org", "2.pool.ntp.org"};
+
+  // IotWebConf's head, titled with the clock's name at compile time rather
+  // than by replacing "{v}" on every request.
+  const char CUSTOM_HTML_HEAD[] PROGMEM =
+    "<!DOCTYPE html><html lang=\"en\"><head><meta name=\"viewport\" "
+    "content=\"width=device-width, initial-scale=1, user-scalable=no\"/>"
+    "<title>" THING_NAME "</title>\n";
+
+  // The rest of the page's own HTML comes from portal_assets.h with the asset
+  // URLs filled in. IotWebConf 2 assembles the form page into a String and
+  // sends it with a Content-Length, so each part is copied from flash once,
+  // without any replacing or concatenation of our own.
   class CustomHtmlFormatProvider : public IotWebConfHtmlFormatProvider
   {
     protected:
       String getHead() override
       {
-        String head = IotWebConfHtmlFormatProvider::getHead();
-        head.replace("{v}", THING_NAME);
-        return head + String(FPSTR(CUSTOM_HTML_META_START)) +
-               String(FPSTR(LOGO_DATA_URI)) +
-               String(FPSTR(CUSTOM_HTML_META_END));
-      }
-      String getScriptInner() override
-      {
-        return IotWebConfHtmlFormatProvider::getScriptInner() +
-               String(FPSTR(CUSTOMHTML_SCRIPT_INNER));
+        return String(FPSTR(CUSTOM_HTML_HEAD));
       }
-      String getStyleInner() override
+      String getHeadExtension() override
       {
-        return IotWebConfHtmlFormatProvider::getStyleInner() +
-               String(FPSTR(CUSTOMHTML_STYLE_INNER));
+        return String(FPSTR(portal::HTML_HEAD_EXTENSION));
       }
       String getBodyInner() override
       {
-        return String(FPSTR(CUSTOMHTML_BODY_INNER_START)) +
-               String(FPSTR(LOGO_DATA_URI)) +
-               String(FPSTR(CUSTOMHTML_BODY_INNER_END)) +
-               IotWebConfHtmlFormatProvider::getBodyInner();
+        return String(FPSTR(portal::HTML_BODY_INNER));
       }
   };
   // An instance must be created from the class defined above.
@@ -275,20 +204,29 @@ namespace {
   //}
   
   // Attempts to parse `str` as a color in "#RRGGBB" format. If it succeeds,
-  // returns the parsed value. If it fails, returns `default_value`.
-  RgbColor parseColorValue(const char* str, const RgbColor& default_value) {
-    bool has_error = str[0] != '#' || str[7] != 0;
+  // returns true and sets `color` to 0xRRGGBB. If it fails, returns false and
+  // leaves `color` unchanged.
+  bool parseColor(const char* str, uint32_t* color) {
+    if (str[0] != '#') return false;
     for (int i = 1; i <= 6; i++) {
-      has_error &= !isxdigit(str[i]);
+      if (!isxdigit(str[i])) return false;
     }
-    if (has_error) {
+    if (str[7] != 0) return false;
+    *color = strtol(str + 1, nullptr, 16);
+    return true;
+  }
+
+  // Attempts to parse `str` as a color in "#RRGGBB" format. If it succeeds,
+  // returns the parsed value. If it fails, returns `default_value`.
+  RgbColor parseColorValue(const char* str, const RgbColor& default_value) {
+    uint32_t parsed_value;
+    if (!parseColor(str, &parsed_value)) {
       Serial.print("[INFO] Could not parse color value \"");
       Serial.print(str);
       Serial.println("\".");
       return default_value;
     }
   
-    const int parsed_value = strtol(str + 1, nullptr, 16);
     const uint8_t red = (parsed_value >> 16) & 0xFF;
     const uint8_t green = (parsed_value >> 8) & 0xFF;
     const uint8_t blue = parsed_value & 0xFF;
@@ -311,6 +249,147 @@ namespace {
     return parsed_value;
   }
   
+  // Attempts to copy `str` into `value`, a buffer of `size` bytes. Succeeds if
+  // `str` fits and only holds printable ASCII characters, none of them in
+  // `excluded`. If it fails, returns false and leaves `value` unchanged.
+  bool parseTextValue(const char* str, char* value, size_t size,
+                      const char* excluded) {
+    for (const char* c = str; *c != 0; c++) {
+      if (*c < ' ' || *c > '~' || strchr(excluded, *c) != nullptr ||
+          static_cast<size_t>(c - str) + 1 >= size) {
+        Serial.println("[INFO] Could not parse text value.");
+        return false;
+      }
+    }
+    strlcpy(value, str, size);
+    return true;
+  }
+
+  // Returns the mean of the observations `histogram` recorded since the totals
+  // in `count` and `sum_us`, which are updated, in microseconds, or -1 if
+  // there were none.
+  int meanSinceUs(const metrics::Histogram& histogram, uint32_t* count,
+                  uint64_t* sum_us) {
+    const uint32_t new_count = histogram.count();
+    const uint64_t new_sum_us = histogram.sumUs();
+    int mean = -1;
+    if (new_count != *count) {
+      mean = (new_sum_us - *sum_us) / (new_count - *count);
+    }
+    *count = new_count;
+    *sum_us = new_sum_us;
+    return mean;
+  }
+
+  // Returns the change mask of the fields that differ between `a` and `b`.
+  uint32_t changedFields(const ClockConfig& a, const ClockConfig& b) {
+    uint32_t changed = 0;
+    if (a.dst != b.dst) changed |= 1u << CONFIG_DST;
+    if (a.timezone != b.timezone) changed |= 1u << CONFIG_TIMEZONE;
+    if (a.palette_id != b.palette_id) changed |= 1u << CONFIG_PALETTE_ID;
+    if (a.color != b.color) changed |= 1u << CONFIG_COLOR;
+    if (a.period != b.period) changed |= 1u << CONFIG_PERIOD;
+    if (a.clock_mode != b.clock_mode) changed |= 1u << CONFIG_CLOCK_MODE;
+    if (a.fast_time_factor != b.fast_time_factor) {
+      changed |= 1u << CONFIG_FAST_TIME_FACTOR;
+    }
+    if (strcmp(a.mqtt_host, b.mqtt_host) != 0 || a.mqtt_port != b.mqtt_port ||
+        strcmp(a.mqtt_user, b.mqtt_user) != 0 ||
+        strcmp(a.mqtt_password, b.mqtt_password) != 0 ||
+        strcmp(a.mqtt_topic, b.mqtt_topic) != 0) {
+      changed |= 1u << CONFIG_MQTT;
+    }
+    if (a.mqtt_interval_s != b.mqtt_interval_s) {
+      changed |= 1u << CONFIG_MQTT_INTERVAL;
+    }
+    if (a.power_limit_ma != b.power_limit_ma) {
+      changed |= 1u << CONFIG_POWER_LIMIT;
+    }
+    if (a.orientation != b.orientation) {
+      changed |= 1u << CONFIG_ORIENTATION;
+    }
+    if (a.power_save != b.power_save) {
+      changed |= 1u << CONFIG_POWER_SAVE;
+    }
+    if (a.transition != b.transition) {
+      changed |= 1u << CONFIG_TRANSITION;
+    }
+    return changed;
+  }
+
+  // Reads the JSON object in `body`, calling `handle(key, json)` for each of
+  // its members, which must read the member's value from `json` and return
+  // whether it is valid. Returns false if `body` is not a single object or
+  // `handle` returns false.
+  template <typename Handler>
+  bool readJsonObject(const String& body, Handler handle) {
+    JsonReader json(body.c_str(), body.length());
+    if (json.next() != JsonToken::BEGIN_OBJECT) return false;
+    char key[JSON_STRING_LENGTH + 1];
+    for (;;) {
+      const JsonToken token = json.next();
+      if (token == JsonToken::END_OBJECT) break;
+      if (token != JsonToken::KEY) return false;
+      strlcpy(key, json.string(), sizeof(key));
+      if (!handle(key, &json)) return false;
+    }
+    return json.next() == JsonToken::END;
+  }
+
+  // Reads an integer in the interval `[min_value, max_value]` from `json`.
+  bool readJsonNumber(JsonReader* json, int min_value, int max_value,
+                      int* value) {
+    if (json->next() != JsonToken::NUMBER || json->number() < min_value ||
+        json->number() > max_value) {
+      return false;
+    }
+    *value = json->number();
+    return true;
+  }
+
+  // Reads a boolean from `json`.
+  bool readJsonBool(JsonReader* json, bool* value) {
+    const JsonToken token = json->next();
+    if (token != JsonToken::TRUE && token != JsonToken::FALSE) return false;
+    *value = token == JsonToken::TRUE;
+    return true;
+  }
+
+  // Sends everything printed to it as the body of a chunked HTTP response,
+  // so that large responses do not need to be built in a String first.
+  class ChunkedResponse : public Print {
+    public:
+      // Sends the response headers.
+      ChunkedResponse(WebServer* server, const char* content_type)
+          : server_(server) {
+        server_->setContentLength(CONTENT_LENGTH_UNKNOWN);
+        server_->send(HTTP_OK, content_type, "");
+      }
+      // Sends the remaining data and terminates the response.
+      ~ChunkedResponse() {
+        flush();
+        server_->sendContent("");
+      }
+
+      size_t write(uint8_t c) override {
+        if (length_ == sizeof(buffer_)) flush();
+        buffer_[length_++] = c;
+        return 1;
+      }
+      using Print::write;
+
+      void flush() {
+        if (length_ == 0) return;
+        server_->sendContent(buffer_, length_);
+        length_ = 0;
+      }
+
+    private:
+      WebServer* server_;
+      char buffer_[HTTP_CHUNK_SIZE];
+      size_t length_ = 0;
+  };
+
 //  // Attempts to parse `str` as a number 0 or 1 and casts it as a boolean. If it
 //  // fails, returns false.
 //  bool parseBooleanValue(const char *str)
@@ -321,7 +400,11 @@ namespace {
 }  // namespace
 
 IotConfig::IotConfig(Display* display)
-  : web_server_(WEB_SERVER_PORT), display_(display),
+  : sntp_(&sntp_transport_, &sntp_clock_), sntp_metric_(&sntp_),
+    mqtt_(&mqtt_transport_), mqtt_metric_(&mqtt_),
+    nvs_store_(IOT_CONFIG_NVS_NAMESPACE), config_store_(&nvs_store_),
+    config_(ClockConfig::defaults()),
+    web_server_(WEB_SERVER_PORT), display_(display),
     datetime_separator_("Date and time"),
     date_param_("Date", "date", date_value_, IOT_CONFIG_VALUE_LENGTH, "date",
                 "yyyy-mm-dd", nullptr, "pattern='\\d{4}-\\d{1,2}-\\d{1,2}'"),
@@ -333,7 +416,8 @@ IotConfig::IotConfig(Display* display)
                "pattern='[01]' min='0' max='1' "
                "style='max-width: 2em; display: block;'"),
     timezone_param_("Time zone", "timezone", timezone_value_, IOT_CONFIG_VALUE_LENGTH,
-                    "number", DEFAULT_TIMEZONE, DEFAULT_TIMEZONE, locationOptions),
+                    "number", DEFAULT_TIMEZONE, DEFAULT_TIMEZONE,
+                    "data-search='api/tz'"),
     display_separator_("Display"),
 //    show_ampm_param_(
 //        "AM/PM indicator", "show_ampm", show_ampm_value_,
@@ -357,6 +441,27 @@ IotConfig::IotConfig(Display* display)
                   IOT_CONFIG_VALUE_LENGTH, "number", "0", "0",
                   "pattern='[01]' min='0' max='1' "
                   "style='max-width: 2em; display: block;'"),
+    power_limit_param_(
+      "LED current limit (mA, 0=none)", "power_limit", power_limit_value_,
+      IOT_CONFIG_VALUE_LENGTH, "number", "2000", "2000",
+      "pattern='\\d+' min='0' max='10000' step='100' "
+      "style='max-width: 5em; display: block;'"),
+    orientation_param_(
+      "Orientation (0-3=quarter turns, 4-7=mirrored)", "orientation",
+      orientation_value_, IOT_CONFIG_VALUE_LENGTH, "number", "0", "0",
+      "pattern='[0-7]' min='0' max='7' "
+      "style='max-width: 2em; display: block;'"),
+    power_save_param_(
+      "Power saving (0=off, 1=on)", "power_save", power_save_value_,
+      IOT_CONFIG_VALUE_LENGTH, "number", "0", "0",
+      "pattern='[01]' min='0' max='1' "
+      "style='max-width: 2em; display: block;'"),
+    transition_param_(
+      "Minute transition (0=fade, 1=wipe, 2=cascade, 3=typewriter, "
+      "4=sparkle, 5=rain)", "transition", transition_value_,
+      IOT_CONFIG_VALUE_LENGTH, "number", "0", "0",
+      "pattern='[0-5]' min='0' max='5' "
+      "style='max-width: 2em; display: block;'"),
     debug_separator_("Debug"),
     clock_mode_param_(
       "Clock mode (0=real clock)", "clock_mode", clock_mode_value_,
@@ -368,6 +473,26 @@ IotConfig::IotConfig(Display* display)
       IOT_CONFIG_VALUE_LENGTH, "number", "30", "30",
       "pattern='\\d+' min='1' max='3600' "
       "style='max-width: 4em; display: block;'"),
+    mqtt_separator_("MQTT"),
+    mqtt_host_param_("Broker host (empty to disable)", "mqtt_host",
+                     mqtt_host_value_, CONFIG_MQTT_HOST_SIZE, "text",
+                     "broker.local", "", "pattern='[^ ]*'"),
+    mqtt_port_param_("Broker port", "mqtt_port", mqtt_port_value_,
+                     IOT_CONFIG_VALUE_LENGTH, "number", "1883", "1883",
+                     "min='1' max='65535' "
+                     "style='max-width: 5em; display: block;'"),
+    mqtt_user_param_("User", "mqtt_user", mqtt_user_value_,
+                     CONFIG_MQTT_CREDENTIAL_SIZE, "text", nullptr, ""),
+    mqtt_password_param_("Password", "mqtt_password", mqtt_password_value_,
+                         CONFIG_MQTT_CREDENTIAL_SIZE, "password", nullptr, ""),
+    mqtt_topic_param_("Topic prefix", "mqtt_topic", mqtt_topic_value_,
+                      CONFIG_MQTT_TOPIC_SIZE, "text", "wordclock", "wordclock",
+                      "pattern='[^ +#]+'"),
+    mqtt_interval_param_(
+      "Telemetry interval (seconds)", "mqtt_interval", mqtt_interval_value_,
+      IOT_CONFIG_VALUE_LENGTH, "number", "60", "60",
+      "pattern='\\d+' min='5' max='3600' "
+      "style='max-width: 4em; display: block;'"),
     iot_web_conf_(THING_NAME, &dns_server_, &web_server_,
                   INITIAL_WIFI_AP_PASSWORD, CONFIG_VERSION)
 {
@@ -385,8 +510,160 @@ void IotConfig::clearTransientParams_() {
 // Note that IotWebConf does not currently work with parameters that require an
 // HTML checkbox input to set in the configuration portal, so we have to use the
 // workaround of representing booleans as 0 or 1 integers.
-void IotConfig::updateClockFromParams_() {
-  Serial.println("=IotConfig::updateClockFromParams_()");
+void IotConfig::readParams_(ClockConfig* config) {
+  config->dst = parseNumberValue(dst_value_, 0, 1, config->dst);
+  config->timezone = parseNumberValue(timezone_value_, 0, tzdb::count() - 1,
+                                      config->timezone);
+  config->palette_id = parseNumberValue(palette_id_value_, 0, 7,
+                                        config->palette_id);
+  const RgbColor color = parseColorValue(
+      color_value_, RgbColor(config->color >> 16, (config->color >> 8) & 0xFF,
+                             config->color & 0xFF));
+  config->color = (static_cast<uint32_t>(color.R) << 16) | (color.G << 8) |
+                  color.B;
+  config->period = parseNumberValue(period_value_, 0, 1, config->period);
+  config->power_limit_ma = parseNumberValue(power_limit_value_, 0, 10000,
+                                            config->power_limit_ma);
+  const int orientation = parseNumberValue(
+      orientation_value_, 0, ClockFace::orientationCount - 1,
+      config->orientation);
+  // Quarter turns need a square canvas.
+  if (ClockFace::supportsOrientation(
+          static_cast<ClockFace::Orientation>(orientation))) {
+    config->orientation = orientation;
+  }
+  config->power_save = parseNumberValue(power_save_value_, 0, 1,
+                                        config->power_save);
+  config->transition = parseNumberValue(
+      transition_value_, 0, TRANSITION_EFFECT_COUNT - 1, config->transition);
+  config->clock_mode = parseNumberValue(clock_mode_value_, 0, 255,
+                                        config->clock_mode);
+  config->fast_time_factor = parseNumberValue(fast_time_factor_value_, 1, 3600,
+                                              config->fast_time_factor);
+  parseTextValue(mqtt_host_value_, config->mqtt_host,
+                 sizeof(config->mqtt_host), " ");
+  config->mqtt_port = parseNumberValue(mqtt_port_value_, 1, 65535,
+                                       config->mqtt_port);
+  parseTextValue(mqtt_user_value_, config->mqtt_user,
+                 sizeof(config->mqtt_user), "");
+  parseTextValue(mqtt_password_value_, config->mqtt_password,
+                 sizeof(config->mqtt_password), "");
+  // Wildcards would make the prefix a filter, which cannot be published to.
+  if (mqtt_topic_value_[0] != 0) {
+    parseTextValue(mqtt_topic_value_, config->mqtt_topic,
+                   sizeof(config->mqtt_topic), " +#");
+  }
+  config->mqtt_interval_s = parseNumberValue(mqtt_interval_value_, 5, 3600,
+                                             config->mqtt_interval_s);
+}
+
+void IotConfig::writeParams_(const ClockConfig& config) {
+  snprintf(dst_value_, IOT_CONFIG_VALUE_LENGTH, "%d", config.dst);
+  snprintf(timezone_value_, IOT_CONFIG_VALUE_LENGTH, "%u", config.timezone);
+  snprintf(palette_id_value_, IOT_CONFIG_VALUE_LENGTH, "%u",
+           config.palette_id);
+  snprintf(color_value_, IOT_CONFIG_VALUE_LENGTH, "#%06X",
+           static_cast<unsigned int>(config.color));
+  snprintf(period_value_, IOT_CONFIG_VALUE_LENGTH, "%d", config.period);
+  snprintf(power_limit_value_, IOT_CONFIG_VALUE_LENGTH, "%u",
+           config.power_limit_ma);
+  snprintf(orientation_value_, IOT_CONFIG_VALUE_LENGTH, "%u",
+           config.orientation);
+  snprintf(power_save_value_, IOT_CONFIG_VALUE_LENGTH, "%d",
+           config.power_save);
+  snprintf(transition_value_, IOT_CONFIG_VALUE_LENGTH, "%u",
+           config.transition);
+  snprintf(clock_mode_value_, IOT_CONFIG_VALUE_LENGTH, "%u",
+           config.clock_mode);
+  snprintf(fast_time_factor_value_, IOT_CONFIG_VALUE_LENGTH, "%u",
+           config.fast_time_factor);
+  strlcpy(mqtt_host_value_, config.mqtt_host, sizeof(mqtt_host_value_));
+  snprintf(mqtt_port_value_, IOT_CONFIG_VALUE_LENGTH, "%u", config.mqtt_port);
+  strlcpy(mqtt_user_value_, config.mqtt_user, sizeof(mqtt_user_value_));
+  strlcpy(mqtt_password_value_, config.mqtt_password,
+          sizeof(mqtt_password_value_));
+  strlcpy(mqtt_topic_value_, config.mqtt_topic, sizeof(mqtt_topic_value_));
+  snprintf(mqtt_interval_value_, IOT_CONFIG_VALUE_LENGTH, "%u",
+           config.mqtt_interval_s);
+}
+
+void IotConfig::updateClockFromConfig_(uint32_t changed) {
+  LOGD("=IotConfig::updateClockFromConfig_(0x%x)", changed);
+  // Timezone
+  // Timezone is handled within the iot_config class rather than by the
+  // word_clock object. NTP keeps the clock in UTC and needs no restart.
+  // Rules may live in the tzdata partition, which only the network task
+  // updates, so they are parsed here and only the result is handed over.
+  //    word_clock_->setTimezone(
+  //            parseNumberValue(timezone_value_, DEFAULT_TIMEZONE, 0, 459));
+  const int tz = configuredTimezone_();
+  PosixTimezone timezone;
+  if (changed & (1u << CONFIG_TIMEZONE)) {
+    // Only the index is logged, as the rules may be unmapped by an update
+    // before the log is drained.
+    LOGI(" Setting Timezone %d (%s timezones)", tz,
+         LOG_STATIC(tzdb::version()));
+    if (!timezone.set(tzdb::rule(tz), time(nullptr))) {
+      LOGW("Invalid rule for timezone %d, using UTC.", tz);
+    }
+  }
+
+  portENTER_CRITICAL(&pending_mux_);
+  pending_config_ = config_;
+  pending_config_.timezone = tz;
+  pending_changes_ |= changed;
+  if (changed & (1u << CONFIG_TIMEZONE)) {
+    pending_timezone_ = timezone;
+  }
+  portEXIT_CRITICAL(&pending_mux_);
+  if (changed & (1u << CONFIG_TIMEZONE)) {
+    network_timezone_ = timezone;
+  }
+  if (changed & (1u << CONFIG_MQTT)) {
+    updateMqtt_();
+  }
+}
+
+void IotConfig::loop() {
+  if (!initialized_) {
+    Serial.println("[ERROR] IotConfig not initialized, loop aborted.");
+    return;
+  }
+
+  preview_server_.capture(display_->getClockFace(), display_->getFrame().data());
+
+  portENTER_CRITICAL(&pending_mux_);
+  const uint32_t changed = pending_changes_;
+  pending_changes_ = 0;
+  const ClockConfig config = pending_config_;
+  if (changed & (1u << CONFIG_TIMEZONE)) {
+    timezone_ = pending_timezone_;
+  }
+  const bool brightness_changed = pending_brightness_changed_;
+  pending_brightness_changed_ = false;
+  const int brightness = pending_brightness_;
+  const bool text_changed = pending_text_changed_;
+  pending_text_changed_ = false;
+  char text[IOT_CONFIG_TEXT_LENGTH + 1];
+  if (text_changed) memcpy(text, pending_text_, sizeof(text));
+  portEXIT_CRITICAL(&pending_mux_);
+
+  if (brightness_changed) {
+    display_->setBrightness(brightness);
+  }
+  if (text_changed) {
+    if (text[0] == 0) {
+      display_->clearText();
+    } else if (!display_->showText(text)) {
+      LOGW("The clock face cannot spell the text.");
+    }
+  }
+  if (changed == 0) return;
+
+  if (changed & (1u << CONFIG_TIMEZONE)) {
+    timezone_index_ = config.timezone;
+  }
+
   //parseAndSetDateTime(word_clock_, date_value_, time_value_);
 
 //  word_clock_->setClockMode(static_cast<ClockMode>(
@@ -396,13 +673,6 @@ void IotConfig::updateClockFromParams_() {
 //  word_clock_->setDst(static_cast<bool>(
 //                        parseNumberValue(dst_value_, 0, 1, 0)));
 
-  // Timezone
-  // Timezone is handled within the iot_config class, so we call the local NTP
-  // member function rather than calling the word_clock object
-  //    word_clock_->setTimezone(
-  //            parseNumberValue(timezone_value_, DEFAULT_TIMEZONE, 0, 459));
-  connectNTP_();
-
 //  word_clock_->setFastTimeFactor(
 //    parseNumberValue(fast_time_factor_value_, 1, 3600, 30));
 //  word_clock_->setPaletteId(
@@ -413,14 +683,33 @@ void IotConfig::updateClockFromParams_() {
 //   RgbColor(190, 9, 0)));
 //   RgbColor(203, 91, 10)));
 //   RgbColor(254, 204, 92)));
-  display_->setColor(parseColorValue(color_value_, RgbColor(239, 235, 216)));
+  if (changed & (1u << CONFIG_COLOR)) {
+    display_->setColor(RgbColor(config.color >> 16,
+                                (config.color >> 8) & 0xFF,
+                                config.color & 0xFF));
+  }
+  if (changed & (1u << CONFIG_POWER_LIMIT)) {
+    display_->setPowerLimit(config.power_limit_ma);
+  }
+  if ((changed & (1u << CONFIG_ORIENTATION)) &&
+      !display_->setOrientation(
+          static_cast<ClockFace::Orientation>(config.orientation))) {
+    LOGW("Orientation %d does not fit the LED canvas.", config.orientation);
+  }
+  if (changed & (1u << CONFIG_POWER_SAVE)) {
+    power_save_ = config.power_save;
+  }
+  if (changed & (1u << CONFIG_TRANSITION)) {
+    display_->setTransition(
+        static_cast<transition::Effect>(config.transition));
+  }
 //  display_->setShowAmPm(static_cast<bool>(
 //                        parseNumberValue(show_ampm_value_, 0, 1, 0)));
 //  display_->setSensorSensitivity(parseNumberValue(ldr_sensitivity_value_, 0, 10, 5));  
 }
 
 void IotConfig::handleHttpToRoot_() {
-  static const char html[] =
+  static const char html[] PROGMEM =
     "<!DOCTYPE html>"
     "<html lang='en'>"
     "<head>"
@@ -430,12 +719,118 @@ void IotConfig::handleHttpToRoot_() {
     "</head>"
     "<body>"
     "<h1>Word Clock LT</h1>"
-    "<ul><li><a href='config'>Settings</a></li></ul>"
+    "<ul><li><a href='config'>Settings</a></li>"
+    "<li><a href='" PORTAL_URL_PREVIEW_HTML "'>Live preview</a></li></ul>"
     "</body>"
     "</html>\n";
 
   if (iot_web_conf_.handleCaptivePortal()) return;
-  web_server_.send(HTTP_OK, MIME_HTTP, html);
+  web_server_.send_P(HTTP_OK, MIME_HTTP, html, sizeof(html) - 1);
+}
+
+void IotConfig::handleHttpToMetrics_() {
+  ChunkedResponse response(&web_server_, MIME_PROMETHEUS);
+  metrics::writeAll(response);
+}
+
+void IotConfig::handleHttpToHealth_() {
+  ChunkedResponse response(&web_server_, MIME_JSON);
+  health::writeJson(response);
+}
+
+void IotConfig::handleHttpToTimezoneSearch_() {
+  int indices[TZ_SEARCH_PAGE_SIZE];
+  int total;
+  int count;
+  int page = 0;
+  if (web_server_.hasArg("i")) {
+    // Lookup of a single zone, e.g. the configured one.
+    indices[0] = parseNumberValue(web_server_.arg("i").c_str(), 0,
+                                  tzdb::count() - 1, -1);
+    total = count = indices[0] < 0 ? 0 : 1;
+  } else {
+    char query[TZDB_NAME_LENGTH];
+    strlcpy(query, web_server_.arg("q").c_str(), sizeof(query));
+    page = parseNumberValue(web_server_.arg("page").c_str(), 0,
+                            tzdb::count() / TZ_SEARCH_PAGE_SIZE, 0);
+    total = tzdb::search(query, page * TZ_SEARCH_PAGE_SIZE, indices,
+                         TZ_SEARCH_PAGE_SIZE);
+    count = constrain(total - page * TZ_SEARCH_PAGE_SIZE, 0,
+                      TZ_SEARCH_PAGE_SIZE);
+  }
+
+  ChunkedResponse response(&web_server_, MIME_JSON);
+  response.printf("{\"total\":%d,\"page\":%d,\"page_size\":%d,\"zones\":[",
+                  total, page, TZ_SEARCH_PAGE_SIZE);
+  char name[TZDB_NAME_LENGTH];
+  for (int i = 0; i < count; i++) {
+    // Names never need escaping, tzdb_gen.py rejects the ones that would.
+    tzdb::name(indices[i], name, sizeof(name));
+    response.printf("%s{\"index\":%d,\"name\":\"%s\"}", i ? "," : "",
+                    indices[i], name);
+  }
+  response.print("]}");
+}
+
+void IotConfig::handleHttpToTimezoneData_() {
+  if (!web_server_.authenticate(
+          IOTWEBCONF_ADMIN_USER_NAME,
+          iot_web_conf_.getApPasswordParameter()->valueBuffer)) {
+    web_server_.requestAuthentication();
+    return;
+  }
+  const bool uploaded = web_server_.method() == HTTP_POST;
+  const bool ok = !uploaded || tzdata_upload_ok_;
+  tzdata_upload_ok_ = false;
+  if (uploaded && ok) {
+    // Same index, possibly new rules.
+    updateClockFromConfig_(1u << CONFIG_TIMEZONE);
+  }
+
+  char response[96];
+  snprintf(response, sizeof(response),
+           "{\"ok\":%s,\"version\":\"%s\",\"zones\":%d}",
+           ok ? "true" : "false", tzdb::version(), tzdb::count());
+  web_server_.send(ok ? HTTP_OK : HTTP_BAD_REQUEST, MIME_JSON, response);
+}
+
+void IotConfig::handleTimezoneDataUpload_() {
+  HTTPUpload& upload = web_server_.upload();
+  switch (upload.status) {
+    case UPLOAD_FILE_START:
+      tzdata_upload_ok_ =
+          web_server_.authenticate(
+              IOTWEBCONF_ADMIN_USER_NAME,
+              iot_web_conf_.getApPasswordParameter()->valueBuffer) &&
+          tzdb::beginUpdate();
+      break;
+    case UPLOAD_FILE_WRITE:
+      tzdata_upload_ok_ = tzdata_upload_ok_ &&
+                          tzdb::writeUpdate(upload.buf, upload.currentSize);
+      break;
+    case UPLOAD_FILE_END:
+      tzdata_upload_ok_ = tzdata_upload_ok_ && tzdb::endUpdate();
+      break;
+    case UPLOAD_FILE_ABORTED:
+    default:
+      tzdb::abortUpdate();
+      tzdata_upload_ok_ = false;
+      break;
+  }
+}
+
+void IotConfig::handleHttpToAsset_(int asset) {
+  const portal::Asset& file = portal::assets[asset];
+  web_server_.sendHeader("ETag", file.etag);
+  web_server_.sendHeader("Cache-Control", ASSET_CACHE_CONTROL);
+  if (web_server_.header("If-None-Match") == file.etag) {
+    web_server_.send(HTTP_NOT_MODIFIED);
+    return;
+  }
+  // Every browser accepts gzip, so the assets are only stored compressed.
+  web_server_.sendHeader("Content-Encoding", "gzip");
+  web_server_.send_P(HTTP_OK, file.content_type,
+                     reinterpret_cast<const char*>(file.data), file.size);
 }
 
 void IotConfig::handleHttpToConfig_() {
@@ -444,59 +839,421 @@ void IotConfig::handleHttpToConfig_() {
 }
 
 void IotConfig::handleConfigSaved_() {
-  updateClockFromParams_();
+  ClockConfig updated = config_;
+  readParams_(&updated);
+  applyConfig_(updated);
+}
+
+void IotConfig::applyConfig_(const ClockConfig& updated) {
+  const uint32_t changed = changedFields(config_, updated);
+  if (changed == 0) return;
+  if (!config_store_.save(updated)) {
+    LOGE("Could not save the configuration.");
+  }
+  config_ = updated;
+  writeParams_(config_);
+  // Only the subsystems whose settings changed are updated, so that e.g. a
+  // new color does not touch the network.
+  updateClockFromConfig_(changed);
+}
+
+void IotConfig::setBrightness_(int brightness) {
+  if (brightness == brightness_) return;
+  brightness_ = brightness;
+  portENTER_CRITICAL(&pending_mux_);
+  pending_brightness_ = brightness;
+  pending_brightness_changed_ = true;
+  portEXIT_CRITICAL(&pending_mux_);
+}
+
+bool IotConfig::setText_(const char* text) {
+  if (strlen(text) > IOT_CONFIG_TEXT_LENGTH ||
+      (text[0] != 0 && !display_->getClockFace().canSpell(text))) {
+    return false;
+  }
+  strcpy(text_, text);
+  portENTER_CRITICAL(&pending_mux_);
+  strcpy(pending_text_, text);
+  pending_text_changed_ = true;
+  portEXIT_CRITICAL(&pending_mux_);
+  return true;
+}
+
+bool IotConfig::authorizeApiWrite_() {
+  if (web_server_.authenticate(
+          IOTWEBCONF_ADMIN_USER_NAME,
+          iot_web_conf_.getApPasswordParameter()->valueBuffer)) {
+    return true;
+  }
+  web_server_.requestAuthentication();
+  return false;
+}
+
+void IotConfig::sendApiJson_(const JsonWriter& json) {
+  if (!json.ok()) {
+    LOGE("API response does not fit its buffer.");
+    web_server_.send(HTTP_INTERNAL_ERROR, MIME_JSON, "{}");
+    return;
+  }
+  web_server_.send(HTTP_OK, MIME_JSON, json.c_str());
+}
+
+void IotConfig::sendApiError_(const char* message) {
+  char response[API_RESPONSE_SIZE];
+  JsonWriter json(response, sizeof(response));
+  json.beginObject();
+  json.key("error");
+  json.stringValue(message);
+  json.endObject();
+  web_server_.send(HTTP_BAD_REQUEST, MIME_JSON, json.c_str());
+}
+
+void IotConfig::handleHttpToDisplayApi_() {
+  if (web_server_.method() == HTTP_PUT) {
+    if (!authorizeApiWrite_()) return;
+    ClockConfig updated = config_;
+    const bool valid = readJsonObject(
+        web_server_.arg("plain"),
+        [&updated](const char* key, JsonReader* json) {
+          int number;
+          bool flag;
+          if (strcmp(key, "color") == 0) {
+            return json->next() == JsonToken::STRING &&
+                   parseColor(json->string(), &updated.color);
+          } else if (strcmp(key, "palette_id") == 0) {
+            if (!readJsonNumber(json, 0, 7, &number)) return false;
+            updated.palette_id = number;
+          } else if (strcmp(key, "period") == 0) {
+            if (!readJsonBool(json, &flag)) return false;
+            updated.period = flag;
+          } else {
+            return false;
+          }
+          return true;
+        });
+    if (!valid) {
+      sendApiError_("Expected {\"color\":\"#RRGGBB\",\"palette_id\":0-7,"
+                    "\"period\":true|false}, all optional.");
+      return;
+    }
+    applyConfig_(updated);
+  }
+
+  char color[8];
+  snprintf(color, sizeof(color), "#%06X",
+           static_cast<unsigned int>(config_.color));
+  char response[API_RESPONSE_SIZE];
+  JsonWriter json(response, sizeof(response));
+  json.beginObject();
+  json.key("color");
+  json.stringValue(color);
+  json.key("palette_id");
+  json.numberValue(config_.palette_id);
+  json.key("period");
+  json.boolValue(config_.period);
+  json.endObject();
+  sendApiJson_(json);
+}
+
+void IotConfig::handleHttpToBrightnessApi_() {
+  if (web_server_.method() == HTTP_PUT) {
+    if (!authorizeApiWrite_()) return;
+    bool has_auto = false;
+    bool automatic = false;
+    bool has_level = false;
+    int level = 0;
+    const bool valid = readJsonObject(
+        web_server_.arg("plain"),
+        [&](const char* key, JsonReader* json) {
+          if (strcmp(key, "auto") == 0) {
+            has_auto = true;
+            return readJsonBool(json, &automatic);
+          } else if (strcmp(key, "level") == 0) {
+            has_level = true;
+            return readJsonNumber(json, 0, 255, &level);
+          }
+          return false;
+        });
+    if (!valid || (has_auto && automatic && has_level)) {
+      sendApiError_("Expected {\"auto\":true} or {\"level\":0-255}.");
+      return;
+    }
+    int brightness = brightness_;
+    if (has_level) {
+      brightness = level;
+    } else if (has_auto) {
+      // Turning the sensor off keeps the last fixed brightness.
+      brightness = automatic ? -1 : (brightness_ >= 0 ? brightness_ : 255);
+    }
+    setBrightness_(brightness);
+  }
+
+  char response[API_RESPONSE_SIZE];
+  JsonWriter json(response, sizeof(response));
+  json.beginObject();
+  json.key("auto");
+  json.boolValue(brightness_ < 0);
+  json.key("level");
+  if (brightness_ < 0) {
+    json.nullValue();
+  } else {
+    json.numberValue(brightness_);
+  }
+  json.endObject();
+  sendApiJson_(json);
+}
+
+void IotConfig::handleHttpToTimeApi_() {
+  if (web_server_.method() == HTTP_PUT) {
+    if (!authorizeApiWrite_()) return;
+    ClockConfig updated = config_;
+    const bool valid = readJsonObject(
+        web_server_.arg("plain"),
+        [&updated](const char* key, JsonReader* json) {
+          int number;
+          if (strcmp(key, "timezone") != 0 ||
+              !readJsonNumber(json, 0, tzdb::count() - 1, &number)) {
+            return false;
+          }
+          updated.timezone = number;
+          return true;
+        });
+    if (!valid) {
+      sendApiError_("Expected {\"timezone\":<index>}.");
+      return;
+    }
+    applyConfig_(updated);
+  }
+
+  const time_t now = time(nullptr);
+  char response[API_RESPONSE_SIZE];
+  JsonWriter json(response, sizeof(response));
+  json.beginObject();
+  json.key("utc");
+  if (now < MIN_VALID_UTC) {
+    json.nullValue();
+    json.key("local");
+    json.nullValue();
+  } else {
+    json.numberValue(now);
+    struct tm local;
+    network_timezone_.toLocal(now, &local);
+    char text[20];
+    strftime(text, sizeof(text), "%Y-%m-%dT%H:%M:%S", &local);
+    json.key("local");
+    json.stringValue(text);
+  }
+  json.key("timezone");
+  json.numberValue(configuredTimezone_());
+  json.key("synchronized");
+  json.boolValue(sntp_.synchronized());
+  json.endObject();
+  sendApiJson_(json);
+}
+
+void IotConfig::handleHttpToTextApi_() {
+  if (web_server_.method() == HTTP_PUT) {
+    if (!authorizeApiWrite_()) return;
+    char text[IOT_CONFIG_TEXT_LENGTH + 1];
+    bool has_text = false;
+    const bool valid = readJsonObject(
+        web_server_.arg("plain"),
+        [&](const char* key, JsonReader* json) {
+          if (strcmp(key, "text") != 0 ||
+              json->next() != JsonToken::STRING) {
+            return false;
+          }
+          strcpy(text, json->string());
+          has_text = true;
+          return true;
+        });
+    if (!valid || !has_text) {
+      sendApiError_("Expected {\"text\":<text>}, empty to show the time.");
+      return;
+    }
+    if (!setText_(text)) {
+      sendApiError_("The clock face cannot spell this text.");
+      return;
+    }
+  }
+
+  char response[API_RESPONSE_SIZE];
+  JsonWriter json(response, sizeof(response));
+  json.beginObject();
+  json.key("text");
+  if (text_[0] == 0) {
+    json.nullValue();
+  } else {
+    json.stringValue(text_);
+  }
+  json.endObject();
+  sendApiJson_(json);
+}
+
+void IotConfig::updateMqtt_() {
+  snprintf(mqtt_status_topic_, sizeof(mqtt_status_topic_), "%s/status",
+           config_.mqtt_topic);
+  snprintf(mqtt_command_filter_, sizeof(mqtt_command_filter_), "%s/set/+",
+           config_.mqtt_topic);
+  snprintf(mqtt_telemetry_topic_, sizeof(mqtt_telemetry_topic_),
+           "%s/telemetry", config_.mqtt_topic);
+  mqtt_.setServer(config_.mqtt_host, config_.mqtt_port, mqtt_client_id_,
+                  config_.mqtt_user, config_.mqtt_password);
+  telemetry_due_ = true;
+}
+
+void IotConfig::mqttLoop_() {
+  TIME_SCOPE(metrics::mqtt_loop_duration);
+  const uint32_t now = millis();
+  mqtt_.loop(now);
+  if (!mqtt_.connected()) return;
+  if (!telemetry_due_ &&
+      now - telemetry_ms_ < config_.mqtt_interval_s * 1000UL) {
+    return;
+  }
+  telemetry_due_ = false;
+  telemetry_ms_ = now;
+  publishTelemetry_();
+}
+
+// All readings go into a single message per interval, rather than a topic
+// each, so that the clock sends one packet instead of a burst.
+void IotConfig::publishTelemetry_() {
+  char payload[MQTT_TELEMETRY_SIZE];
+  JsonWriter json(payload, sizeof(payload));
+  json.beginObject();
+  json.key("uptime_s");
+  json.numberValue(millis() / 1000);
+  json.key("free_heap");
+  json.numberValue(ESP.getFreeHeap());
+  json.key("brightness");
+  if (brightness_ < 0) {
+    json.stringValue("auto");
+  } else {
+    json.numberValue(brightness_);
+  }
+  // In thousandths, as the writer only takes integers.
+  json.key("light");
+  json.numberValue(static_cast<int>(display_->getLightLevel() * 1000));
+  json.key("led_ma");
+  json.numberValue(display_->getCurrentMa());
+  json.key("ntp_synchronized");
+  json.boolValue(sntp_.synchronized());
+  json.key("ntp_offset_us");
+  json.numberValue(sntp_.lastOffsetUs());
+  json.key("ntp_poll_s");
+  json.numberValue(sntp_.pollIntervalS());
+  json.key("loop_us");
+  json.numberValue(meanSinceUs(metrics::loop_duration, &telemetry_loop_count_,
+                               &telemetry_loop_sum_us_));
+  json.key("display_loop_us");
+  json.numberValue(meanSinceUs(metrics::display_loop_duration,
+                               &telemetry_display_count_,
+                               &telemetry_display_sum_us_));
+  json.key("mqtt_dropped");
+  json.numberValue(mqtt_.dropped());
+  json.endObject();
+  if (!json.ok()) {
+    LOGE("Telemetry does not fit its buffer.");
+    return;
+  }
+  mqtt_.publish(mqtt_telemetry_topic_, json.c_str());
+}
+
+void IotConfig::handleMqttCommand_(const char* topic, const char* payload) {
+  // Messages may still arrive for the filter of a previous prefix.
+  const size_t prefix_length = strlen(config_.mqtt_topic);
+  if (strncmp(topic, config_.mqtt_topic, prefix_length) != 0 ||
+      strncmp(topic + prefix_length, "/set/", 5) != 0) {
+    return;
+  }
+  const char* command = topic + prefix_length + 5;
+  if (strcmp(command, "color") == 0) {
+    ClockConfig updated = config_;
+    if (!parseColor(payload, &updated.color)) {
+      LOGW("MQTT color command expects #RRGGBB.");
+      return;
+    }
+    applyConfig_(updated);
+  } else if (strcmp(command, "brightness") == 0) {
+    if (strcmp(payload, "auto") == 0) {
+      setBrightness_(-1);
+    } else {
+      const int level = parseNumberValue(payload, 0, 255, -1);
+      if (level < 0) {
+        LOGW("MQTT brightness command expects auto or 0-255.");
+        return;
+      }
+      setBrightness_(level);
+    }
+  } else if (strcmp(command, "text") == 0) {
+    if (!setText_(payload)) {
+      LOGW("MQTT text command expects a text the clock face can spell.");
+      return;
+    }
+  } else {
+    LOGW("Unknown MQTT command.");
+    return;
+  }
+  // Reports the new state right away.
+  telemetry_due_ = true;
 }
 
 void IotConfig::handleWifiConnected_() {
-  Serial.println("WiFi connected. Initiating NTP proces...");
+  markBootPhase(BOOT_PHASE_WIFI_CONNECTED);
+  LOGI("WiFi connected. Initiating NTP proces...");
   NTPState_ = NTP_Connecting;
   connectNTP_();
 }
 
-// Default NTP poll time is SNTP_UPDATE_DELAY (sntp.c, value 3600000 ms or 1 hour).
-// Change with sntp_set_update_delay(ms)
-//  RVG changed this since Arduino time implementation doesn't seem to support the function prototype below
-//  configTime(CLK_TZ, CLK_SVR1, CLK_SVR2, CLK_SVR3);
+// The system clock is kept in UTC by sntp_, which polls on its own schedule
+// once started; this only asks for an early poll. The timezone is applied by
+// updateClockFromConfig_() and restoreTimezone(), not here.
 void IotConfig::connectNTP_() {
-  struct tm timeinfo;
-  bool gotLocalTime = false;
-  //  String timezone(CLK_TZ);
-
   if (WiFi.status() != WL_CONNECTED)
   {
-    Serial.println("Wifi not connected, cannot set time from NTP server.");
+    LOGW("Wifi not connected, cannot set time from NTP server.");
     NTPState_ = NTP_Waiting;
     return;
   }
 
-  Serial.println((String)"connectNTP_: Connecting to NTP server: " + NTP_SVR);
-  configTime(0, 0, NTP_SVR);    // First connect to NTP server, with 0 TZ offset
-
-  // Timezone
-  int tz = parseNumberValue(timezone_value_, 0, 459, 0);
-  Serial.printf(" Setting Timezone to %s (%d)\n",  posix[tz], tz);
-  configTzTime(posix[tz], NTP_SVR);
-  //  Serial.printf(" Setting Timezone to %s\n",  timezone.c_str());
-  //  setenv("TZ", timezone.c_str(),1);  //  Now adjust the TZ.  Clock settings are adjusted to show the new local time
-  //  tzset();
-
-  //  Serial.print(" NTP: Obtaining local time");
-  //  gotLocalTime = getLocalTime(&timeinfo, 10);
-  //  Serial.print(&timeinfo, " %A, %B %d %Y %H:%M:%S");
-  //  Serial.printf(" (%d)\n", gotLocalTime);
+  LOGI("connectNTP_: Polling %d NTP servers", NTP_SERVER_COUNT);
+  sntp_.pollNow();
 
   if (isNTPConnected_()) {
     NTPState_ = NTP_Connected;
   } else {
     NTPState_ = NTP_Connecting;
   }
-  lastNTPConnect_ = millis();
+}
+
+int IotConfig::configuredTimezone_() const {
+  return config_.timezone < tzdb::count() ? config_.timezone : 0;
+}
+
+// Called before the network task starts, so tzdb can be read here.
+void IotConfig::restoreTimezone(int tz) {
+  if (tz < 0 || tz >= tzdb::count()) return;
+  timezone_.set(tzdb::rule(tz), time(nullptr));
+  timezone_index_ = tz;
+}
+
+bool IotConfig::localTime(struct tm* local) {
+  const time_t now = time(nullptr);
+  if (now < MIN_VALID_UTC) return false;
+  timezone_.toLocal(now, local);
+  return true;
+}
+
+void IotConfig::saveRetainedState(const RetainedState::Data& data) {
+  portENTER_CRITICAL(&pending_mux_);
+  pending_retained_ = data;
+  pending_retained_save_ = true;
+  portEXIT_CRITICAL(&pending_mux_);
 }
 
 bool IotConfig::isNTPConnected_() {
-  struct tm timeinfo;
-  bool getLTStatus = getLocalTime(&timeinfo, 10);
-  return getLTStatus;
+  return sntp_.synchronized();
 }
 
 void IotConfig::updateNTPLEDStatus_() {
@@ -534,6 +1291,7 @@ void IotConfig::setup() {
   // Getting NTP time is not in iot_web_conf. So pin config here
   pinMode(NTP_STATUS_PIN, OUTPUT);
   updateNTPLEDStatus_();
+  sntp_.setServers(NTP_SERVERS, NTP_SERVER_COUNT);
 
   // Here we can set IotWebConf's status and config reset pins, if available.
   // iot_web_conf_.setStatusPin(LEDC_PIN);
@@ -551,9 +1309,20 @@ void IotConfig::setup() {
   iot_web_conf_.addParameter(&palette_id_param_);
   iot_web_conf_.addParameter(&color_param_);
   iot_web_conf_.addParameter(&period_param_);
+  iot_web_conf_.addParameter(&power_limit_param_);
+  iot_web_conf_.addParameter(&orientation_param_);
+  iot_web_conf_.addParameter(&power_save_param_);
+  iot_web_conf_.addParameter(&transition_param_);
   iot_web_conf_.addParameter(&debug_separator_);
   iot_web_conf_.addParameter(&clock_mode_param_);
   iot_web_conf_.addParameter(&fast_time_factor_param_);
+  iot_web_conf_.addParameter(&mqtt_separator_);
+  iot_web_conf_.addParameter(&mqtt_host_param_);
+  iot_web_conf_.addParameter(&mqtt_port_param_);
+  iot_web_conf_.addParameter(&mqtt_user_param_);
+  iot_web_conf_.addParameter(&mqtt_password_param_);
+  iot_web_conf_.addParameter(&mqtt_topic_param_);
+  iot_web_conf_.addParameter(&mqtt_interval_param_);
 
   iot_web_conf_.setConfigSavedCallback([this]() {
     handleConfigSaved_();
@@ -564,9 +1333,30 @@ void IotConfig::setup() {
   iot_web_conf_.setHtmlFormatProvider(&customHtmlFormatProvider);
 
   iot_web_conf_.init();
+  preview_server_.begin();
+
+  uint8_t mac[6];
+  WiFi.macAddress(mac);
+  snprintf(mqtt_client_id_, sizeof(mqtt_client_id_), "wordclock-%02x%02x%02x",
+           mac[3], mac[4], mac[5]);
+  mqtt_.setStatusTopic(mqtt_status_topic_);
+  mqtt_.subscribe(mqtt_command_filter_);
+  mqtt_.onMessage([this](const char* topic, const char* payload, size_t) {
+    handleMqttCommand_(topic, payload);
+  });
 
   clearTransientParams_();
-  updateClockFromParams_();
+  // The stored configuration survives CONFIG_VERSION changes, which reset the
+  // portal's values to their defaults.
+  if (!config_store_.load(&config_)) {
+    LOGI("No stored configuration, importing the portal's values.");
+    readParams_(&config_);
+    if (!config_store_.save(config_)) {
+      LOGE("Could not save the configuration.");
+    }
+  }
+  writeParams_(config_);
+  updateClockFromConfig_(~0u);
 
   web_server_.on("/", [this]() {
     handleHttpToRoot_();
@@ -574,39 +1364,87 @@ void IotConfig::setup() {
   web_server_.on("/config", [this]() {
     handleHttpToConfig_();
   });
+  web_server_.on("/metrics", [this]() {
+    handleHttpToMetrics_();
+  });
+  web_server_.on("/health", [this]() {
+    handleHttpToHealth_();
+  });
+  web_server_.on("/api/tz", [this]() {
+    handleHttpToTimezoneSearch_();
+  });
+  web_server_.on("/api/tzdata", HTTP_GET, [this]() {
+    handleHttpToTimezoneData_();
+  });
+  web_server_.on("/api/tzdata", HTTP_POST, [this]() {
+    handleHttpToTimezoneData_();
+  }, [this]() {
+    handleTimezoneDataUpload_();
+  });
+  web_server_.on("/api/display", [this]() {
+    handleHttpToDisplayApi_();
+  });
+  web_server_.on("/api/brightness", [this]() {
+    handleHttpToBrightnessApi_();
+  });
+  web_server_.on("/api/time", [this]() {
+    handleHttpToTimeApi_();
+  });
+  web_server_.on("/api/text", [this]() {
+    handleHttpToTextApi_();
+  });
+  for (int i = 0; i < PORTAL_ASSET_COUNT; i++) {
+    web_server_.on(portal::assets[i].path, HTTP_GET, [this, i]() {
+      handleHttpToAsset_(i);
+    });
+  }
   web_server_.onNotFound([this]() {
     iot_web_conf_.handleNotFound();
   });
+  // Needed to answer revalidations of the static assets with 304.
+  const char* headers[] = {"If-None-Match"};
+  web_server_.collectHeaders(headers, 1);
 
   initialized_ = true;
+  xTaskCreatePinnedToCore(networkTask_, "net", NETWORK_TASK_STACK_SIZE, this,
+                          NETWORK_TASK_PRIORITY, &network_task_,
+                          NETWORK_TASK_CORE);
 }
 
-void IotConfig::loop() {
-  unsigned long now;
-
-  if (!initialized_) {
-    Serial.println("[ERROR] IotConfig not initialized, loop aborted.");
-    return;
+void IotConfig::networkTask_(void* arg) {
+  IotConfig* config = static_cast<IotConfig*>(arg);
+  for (;;) {
+    config->networkLoop_();
+    vTaskDelay(pdMS_TO_TICKS(NETWORK_TASK_PERIOD_MS));
   }
+}
 
-  now = millis();
-  // Do a regular NTP re-connect as long as we're not connected to the NTP server
-  if (NTPState_ == NTP_Connecting &&
-      now - lastNTPConnect_ > NTP_POLL_SHORT_DELAY_SECONDS * 1000) {
-    connectNTP_();
-  }
-  // Every so many hours, we want to reconnect to the NTP server
-  if (now - lastNTPConnect_ > NTP_POLL_LONG_DELAY_SECONDS * 1000) {
-    connectNTP_();
+void IotConfig::networkLoop_() {
+  // Retries and regular re-synchronization are scheduled by the client
+  if (WiFi.status() == WL_CONNECTED) {
+    sntp_.loop();
+    mqttLoop_();
   }
 
   updateNTPLEDStatus_(); // controls the LED pin
   if (NTPState_ == NTP_Connecting) {
     if (isNTPConnected_()) {
-      Serial.println("NTP connection succesful");
+      LOGI("NTP connection succesful");
       NTPState_ = NTP_Connected;
     }
   }
 
+  preview_server_.loop();
+
+  portENTER_CRITICAL(&pending_mux_);
+  const bool save_retained = pending_retained_save_;
+  pending_retained_save_ = false;
+  const RetainedState::Data retained = pending_retained_;
+  portEXIT_CRITICAL(&pending_mux_);
+  if (save_retained) RetainedState::saveToNvs(retained);
+
+  TIME_SCOPE(metrics::web_conf_loop_duration);
+  // Responses are sent and their strings freed by the time doLoop() returns.
+  health::HeapProbe heap_probe(health::SUBSYSTEM_PORTAL);
   iot_web_conf_.doLoop();
 }
@@ -3,17 +3,58 @@
 
 //#include "clock.h"
 #include "Display.h"
+#include "boot_state.h"
+#include "config_store.h"
+#include "json.h"
+#include "mqtt_system.h"
+#include "nvs_store.h"
+#include "posix_tz.h"
+#include "preview_server.h"
+#include "sntp_system.h"
 
 #include <IotWebConf.h>
 
 // Maximum length of a single IoT configuration value.
 #define IOT_CONFIG_VALUE_LENGTH 16
+// Maximum length of a text shown instead of the time, as long as the JSON
+// reader's strings.
+#define IOT_CONFIG_TEXT_LENGTH JSON_STRING_LENGTH
 
 enum NTPState {NTP_Waiting, NTP_Connecting, NTP_Connected};
 
+// NVS namespace of the stored configuration.
+#define IOT_CONFIG_NVS_NAMESPACE "wordclock"
+
+// Fields of ClockConfig. A change mask has bit `1 << field` set for every
+// field that changed.
+enum ConfigField {
+    CONFIG_DST,
+    CONFIG_TIMEZONE,
+    CONFIG_PALETTE_ID,
+    CONFIG_COLOR,
+    CONFIG_PERIOD,
+    CONFIG_CLOCK_MODE,
+    CONFIG_FAST_TIME_FACTOR,
+    // Broker, credentials and topic prefix.
+    CONFIG_MQTT,
+    CONFIG_MQTT_INTERVAL,
+    CONFIG_POWER_LIMIT,
+    CONFIG_ORIENTATION,
+    CONFIG_POWER_SAVE,
+    CONFIG_TRANSITION,
+
+    CONFIG_FIELD_COUNT,
+};
+
 // Manages clock's configuration portal and propagates settings to the word
 // clock.
 //
+// The portal, its DNS server and the SNTP and MQTT clients are serviced by a
+// task of their own on core 0, so that a slow HTTP client or broker never
+// delays a frame. That task only ever touches the network side; settings that
+// affect rendering are handed over to loop(), which applies them from the
+// render loop.
+//
 // Some of the configuration parameters are transient, which means that they do
 // not retain their values and must be explicitly set every time.
 class IotConfig {
@@ -29,23 +70,105 @@ class IotConfig {
     IotConfig(IotConfig&&) = delete;
     IotConfig& operator=(IotConfig&&) = delete;
 
-    // Initializes the IoT configuration portal. Expects dependencies to be
-    // initialized.
+    // Initializes the IoT configuration portal and starts the task servicing
+    // it. Expects dependencies to be initialized.
     void setup();
-    // Executes configuration portal's event loop. Expects the object itself to
-    // be initialized.
+    // Applies the settings changed through the portal to the word clock.
+    // Expects the object itself to be initialized. Must be called from the
+    // render loop, as must all other public methods.
     void loop();
 
+    // Returns the index of the timezone in effect in the timezone database.
+    int getTimezone() const { return timezone_index_; }
+    // Applies the timezone with index `tz` to local time conversions before
+    // the configuration is loaded, e.g. from the state of the last run.
+    void restoreTimezone(int tz);
+    // Converts the current time to local time in the configured timezone.
+    // Returns false if the time is not known yet.
+    bool localTime(struct tm* local);
+    // Returns whether the system clock follows NTP time.
+    bool ntpSynchronized() const { return sntp_.synchronized(); }
+    // Returns whether the CPU should slow down while the display is idle.
+    bool powerSave() const { return power_save_; }
+    // Has the network task write `data` to NVS, so that the flash write does
+    // not stall the render loop.
+    void saveRetainedState(const RetainedState::Data& data);
+
   private:
+    // Body of the network task.
+    static void networkTask_(void* arg);
+    // Executes configuration portal's, SNTP and MQTT clients' event loops
+    // once.
+    void networkLoop_();
+    // Returns the index of config_'s timezone in the timezone database.
+    int configuredTimezone_() const;
     // Clears the values of transient parameters.
     void clearTransientParams_();
-    // Updates word clock's state to match the current configuration values.
-    void updateClockFromParams_();
+    // Parses the portal's parameter values into `config`. Values that do not
+    // parse keep their value in `config`.
+    void readParams_(ClockConfig* config);
+    // Formats `config` into the portal's parameter values.
+    void writeParams_(const ClockConfig& config);
+    // Sets a fixed brightness from 0 to 255, or follows the light sensor if
+    // `brightness` is negative. Not stored.
+    void setBrightness_(int brightness);
+    // Shows `text` instead of the time, or the time again if `text` is empty.
+    // Returns false if the clock face cannot spell it. Not stored.
+    bool setText_(const char* text);
+    // Saves `updated` as the configuration in effect, updates the portal's
+    // parameter values and applies the fields that changed.
+    void applyConfig_(const ClockConfig& updated);
+    // Hands the fields of config_ in the `changed` mask over to loop(), which
+    // updates the parts of word clock's state that depend on them.
+    void updateClockFromConfig_(uint32_t changed);
 
     // Handles HTTP requests to web server's "/" path.
     void handleHttpToRoot_();
     // Handles HTTP requests to web server's "/config" path.
     void handleHttpToConfig_();
+    // Handles HTTP requests to web server's "/metrics" path.
+    void handleHttpToMetrics_();
+    // Handles HTTP requests to web server's "/health" path.
+    void handleHttpToHealth_();
+    // Handles HTTP requests to the path of static portal asset number
+    // `asset`.
+    void handleHttpToAsset_(int asset);
+    // Handles HTTP requests to web server's "/api/tz" path: searches zone
+    // names with ?q=<text>&page=<n>, or looks up a zone with ?i=<index>.
+    void handleHttpToTimezoneSearch_();
+    // Handles HTTP requests to web server's "/api/tzdata" path: describes the
+    // timezone database in use.
+    void handleHttpToTimezoneData_();
+    // Handles the upload of a timezone database blob to "/api/tzdata".
+    void handleTimezoneDataUpload_();
+    // Handles GET and PUT requests to web server's "/api/display" path: the
+    // color, palette and period settings.
+    void handleHttpToDisplayApi_();
+    // Handles GET and PUT requests to web server's "/api/brightness" path:
+    // a fixed brightness, or following the light sensor.
+    void handleHttpToBrightnessApi_();
+    // Handles GET and PUT requests to web server's "/api/time" path: the
+    // current time and the timezone.
+    void handleHttpToTimeApi_();
+    // Handles GET and PUT requests to web server's "/api/text" path: the text
+    // shown instead of the time.
+    void handleHttpToTextApi_();
+    // Checks the credentials of requests that change settings. Returns false,
+    // having asked for authentication, if they are missing or wrong.
+    bool authorizeApiWrite_();
+    // Answers an API request with `json`, or with an error if it did not fit.
+    void sendApiJson_(const JsonWriter& json);
+    // Answers an API request with a bad request error.
+    void sendApiError_(const char* message);
+    // Reconnects the MQTT client with config_'s broker and topics.
+    void updateMqtt_();
+    // Executes the MQTT client's event loop once, and publishes telemetry
+    // when due.
+    void mqttLoop_();
+    // Publishes the telemetry message.
+    void publishTelemetry_();
+    // Handles a message on the command topics.
+    void handleMqttCommand_(const char* topic, const char* payload);
     // Handles configuration changes.
     void handleConfigSaved_();
     // Handles after WiFi connection is established.
@@ -59,20 +182,96 @@ class IotConfig {
 
     // Whether IoT configuration was initialized.
     bool initialized_ = false;
+    // Task servicing the portal and the SNTP client.
+    TaskHandle_t network_task_ = nullptr;
+
+    // Settings handed over from the network task to loop(), and back. Guarded
+    // by pending_mux_, which is only held to copy them.
+    portMUX_TYPE pending_mux_ = portMUX_INITIALIZER_UNLOCKED;
+    // Mask of the fields of pending_config_ that changed since loop() last
+    // applied them.
+    uint32_t pending_changes_ = 0;
+    ClockConfig pending_config_;
+    // pending_config_'s timezone, parsed by the network task, which owns the
+    // timezone database.
+    PosixTimezone pending_timezone_;
+    // Whether pending_brightness_ changed since loop() last applied it.
+    bool pending_brightness_changed_ = false;
+    int pending_brightness_ = -1;
+    // Whether pending_text_ changed since loop() last applied it.
+    bool pending_text_changed_ = false;
+    char pending_text_[IOT_CONFIG_TEXT_LENGTH + 1] = "";
+    // Whether pending_retained_ is to be written to NVS by the network task,
+    // the one handover the other way round.
+    bool pending_retained_save_ = false;
+    RetainedState::Data pending_retained_;
+
+    // Fixed brightness set through the API, or -1 to follow the light sensor.
+    // Not stored, so that frequent changes do not wear the flash.
+    int brightness_ = -1;
+    // Text set through the API, or empty to show the time. Not stored.
+    char text_[IOT_CONFIG_TEXT_LENGTH + 1] = "";
+    // Copy of the timezone in effect, for the network task.
+    PosixTimezone network_timezone_;
+    // Whether the timezone database upload in progress is authenticated and
+    // still succeeding.
+    bool tzdata_upload_ok_ = false;
     // Whether NTP connection needs to be established.
     bool needNTPConnect_ = false;
     // NTP status
     NTPState NTPState_ = NTP_Waiting;
-    // For updating NTP connection regularly
-    unsigned long lastNTPConnect_ = 0;
+
+    // Network and clock access of the SNTP client.
+    WiFiSntpTransport sntp_transport_;
+    SystemSntpClock sntp_clock_;
+    // SNTP client disciplining the system clock.
+    SntpClient sntp_;
+    // Publishes sntp_'s state on /metrics.
+    SntpMetric sntp_metric_;
+
+    // MQTT client publishing telemetry and receiving commands, and its
+    // network access. Only used by the network task.
+    WiFiMqttTransport mqtt_transport_;
+    MqttClient mqtt_;
+    // Publishes mqtt_'s state on /metrics.
+    MqttMetric mqtt_metric_;
+    // Client identifier, unique per clock.
+    char mqtt_client_id_[24];
+    // Topics under config_'s prefix, which mqtt_ keeps pointers to.
+    char mqtt_status_topic_[CONFIG_MQTT_TOPIC_SIZE + 8];
+    char mqtt_command_filter_[CONFIG_MQTT_TOPIC_SIZE + 8];
+    char mqtt_telemetry_topic_[CONFIG_MQTT_TOPIC_SIZE + 12];
+    // When telemetry was last published, in milliseconds, and whether it is
+    // due now, e.g. after a command.
+    uint32_t telemetry_ms_ = 0;
+    bool telemetry_due_ = true;
+    // Totals of the loop duration histograms at the last telemetry message.
+    uint32_t telemetry_loop_count_ = 0;
+    uint64_t telemetry_loop_sum_us_ = 0;
+    uint32_t telemetry_display_count_ = 0;
+    uint64_t telemetry_display_sum_us_ = 0;
+
+    // Local time conversion of the timezone in effect, and its index. Only
+    // used by the render loop.
+    PosixTimezone timezone_;
+    int timezone_index_ = 0;
+    // Power saving setting in effect. Only used by the render loop.
+    bool power_save_ = false;
+
+    // Storage of the configuration in NVS.
+    NvsKeyValueStore nvs_store_;
+    ConfigStore config_store_;
+    // Configuration in effect. The portal's parameter values are only parsed
+    // when the portal saves them.
+    ClockConfig config_;
 
     // Configuration portal's DNS server.
     DNSServer dns_server_;
     // Configuration portal's web server.
     WebServer web_server_;
+    // Streams the display's frames to browsers.
+    PreviewServer preview_server_;
 
-    // RTC chip interface.
-//    RTC_DS3231* rtc_ = nullptr;
     // Word clock state.
 //    WordClock* word_clock_ = nullptr;
     Display* display_ = nullptr;
@@ -128,6 +327,26 @@ class IotConfig {
     // Period parameter value.
     char period_value_[IOT_CONFIG_VALUE_LENGTH];
 
+    // Configuration portal's LED current limit parameter definition.
+    IotWebConfParameter power_limit_param_;
+    // LED current limit parameter value.
+    char power_limit_value_[IOT_CONFIG_VALUE_LENGTH];
+
+    // Configuration portal's orientation parameter definition.
+    IotWebConfParameter orientation_param_;
+    // Orientation parameter value.
+    char orientation_value_[IOT_CONFIG_VALUE_LENGTH];
+
+    // Configuration portal's power saving parameter definition.
+    IotWebConfParameter power_save_param_;
+    // Power saving parameter value.
+    char power_save_value_[IOT_CONFIG_VALUE_LENGTH];
+
+    // Configuration portal's transition effect parameter definition.
+    IotWebConfParameter transition_param_;
+    // Transition effect parameter value.
+    char transition_value_[IOT_CONFIG_VALUE_LENGTH];
+
     // Configuration portal's debug parameter separator.
     IotWebConfSeparator debug_separator_;
 
@@ -141,6 +360,39 @@ class IotConfig {
     // Fast time factor parameter value.
     char fast_time_factor_value_[IOT_CONFIG_VALUE_LENGTH];
 
+    // Configuration portal's MQTT parameter separator.
+    IotWebConfSeparator mqtt_separator_;
+
+    // Configuration portal's MQTT broker host parameter definition.
+    IotWebConfParameter mqtt_host_param_;
+    // MQTT broker host parameter value.
+    char mqtt_host_value_[CONFIG_MQTT_HOST_SIZE];
+
+    // Configuration portal's MQTT broker port parameter definition.
+    IotWebConfParameter mqtt_port_param_;
+    // MQTT broker port parameter value.
+    char mqtt_port_value_[IOT_CONFIG_VALUE_LENGTH];
+
+    // Configuration portal's MQTT user parameter definition.
+    IotWebConfParameter mqtt_user_param_;
+    // MQTT user parameter value.
+    char mqtt_user_value_[CONFIG_MQTT_CREDENTIAL_SIZE];
+
+    // Configuration portal's MQTT password parameter definition.
+    IotWebConfParameter mqtt_password_param_;
+    // MQTT password parameter value.
+    char mqtt_password_value_[CONFIG_MQTT_CREDENTIAL_SIZE];
+
+    // Configuration portal's MQTT topic prefix parameter definition.
+    IotWebConfParameter mqtt_topic_param_;
+    // MQTT topic prefix parameter value.
+    char mqtt_topic_value_[CONFIG_MQTT_TOPIC_SIZE];
+
+    // Configuration portal's telemetry interval parameter definition.
+    IotWebConfParameter mqtt_interval_param_;
+    // Telemetry interval parameter value.
+    char mqtt_interval_value_[IOT_CONFIG_VALUE_LENGTH];
+
     // IotWebConf interface handle.
     IotWebConf iot_web_conf_;
 };
@@ -0,0 +1,348 @@
+// Allocation free JSON reader and writer.
+
+#include "json.h"
+
+#include <stdio.h>
+#include <string.h>
+
+JsonReader::JsonReader(const char* data, size_t size)
+    : data_(data), end_(data + size) {
+    string_[0] = 0;
+}
+
+JsonToken JsonReader::next() {
+    if (failed_) return JsonToken::ERROR;
+    for (;;) {
+        if (!skipWhitespace_()) {
+            return expect_ == Expect::DONE ? JsonToken::END : fail_();
+        }
+        const char c = *data_;
+        switch (expect_) {
+            case Expect::VALUE:
+                return readValue_();
+            case Expect::VALUE_OR_END:
+                if (c == ']') return endContainer_('[', JsonToken::END_ARRAY);
+                return readValue_();
+            case Expect::KEY_OR_END:
+                if (c == '}') return endContainer_('{', JsonToken::END_OBJECT);
+                // Fall through.
+            case Expect::KEY:
+                if (c != '"') return fail_();
+                data_++;
+                if (!readString_()) return fail_();
+                expect_ = Expect::COLON;
+                return JsonToken::KEY;
+            case Expect::COLON:
+                if (c != ':') return fail_();
+                data_++;
+                expect_ = Expect::VALUE;
+                break;
+            case Expect::COMMA_OR_END:
+                if (c == '}') return endContainer_('{', JsonToken::END_OBJECT);
+                if (c == ']') return endContainer_('[', JsonToken::END_ARRAY);
+                if (c != ',') return fail_();
+                data_++;
+                expect_ = stack_[depth_ - 1] == '{' ? Expect::KEY
+                                                    : Expect::VALUE;
+                break;
+            case Expect::DONE:
+                return fail_();
+        }
+    }
+}
+
+bool JsonReader::skipValue(JsonToken token) {
+    if (token != JsonToken::BEGIN_OBJECT && token != JsonToken::BEGIN_ARRAY) {
+        return token != JsonToken::ERROR && token != JsonToken::END &&
+               token != JsonToken::KEY;
+    }
+    const int depth = depth_ - 1;
+    while (depth_ > depth) {
+        if (next() == JsonToken::ERROR) return false;
+    }
+    return true;
+}
+
+bool JsonReader::skipWhitespace_() {
+    while (data_ < end_ && (*data_ == ' ' || *data_ == '\t' ||
+                            *data_ == '\n' || *data_ == '\r')) {
+        data_++;
+    }
+    return data_ < end_;
+}
+
+JsonToken JsonReader::readValue_() {
+    const char c = *data_++;
+    switch (c) {
+        case '{':
+        case '[':
+            if (depth_ == JSON_MAX_DEPTH) return fail_();
+            stack_[depth_++] = c;
+            expect_ = c == '{' ? Expect::KEY_OR_END : Expect::VALUE_OR_END;
+            return c == '{' ? JsonToken::BEGIN_OBJECT : JsonToken::BEGIN_ARRAY;
+        case '"':
+            if (!readString_()) return fail_();
+            afterValue_();
+            return JsonToken::STRING;
+        case 't':
+            if (!readLiteral_("true")) return fail_();
+            afterValue_();
+            return JsonToken::TRUE;
+        case 'f':
+            if (!readLiteral_("false")) return fail_();
+            afterValue_();
+            return JsonToken::FALSE;
+        case 'n':
+            if (!readLiteral_("null")) return fail_();
+            afterValue_();
+            return JsonToken::NUL;
+        default:
+            data_--;
+            if (!readNumber_()) return fail_();
+            afterValue_();
+            return JsonToken::NUMBER;
+    }
+}
+
+JsonToken JsonReader::endContainer_(char open, JsonToken token) {
+    if (depth_ == 0 || stack_[depth_ - 1] != open) return fail_();
+    data_++;
+    depth_--;
+    afterValue_();
+    return token;
+}
+
+bool JsonReader::readString_() {
+    string_length_ = 0;
+    while (data_ < end_) {
+        const uint8_t c = *data_++;
+        if (c == '"') {
+            string_[string_length_] = 0;
+            return true;
+        }
+        if (c < 0x20) return false;
+        if (c != '\\') {
+            if (string_length_ == JSON_STRING_LENGTH) return false;
+            string_[string_length_++] = c;
+            continue;
+        }
+        if (data_ == end_) return false;
+        uint32_t code;
+        switch (*data_++) {
+            case '"': code = '"'; break;
+            case '\\': code = '\\'; break;
+            case '/': code = '/'; break;
+            case 'b': code = '\b'; break;
+            case 'f': code = '\f'; break;
+            case 'n': code = '\n'; break;
+            case 'r': code = '\r'; break;
+            case 't': code = '\t'; break;
+            case 'u': {
+                if (!readHex4_(&code)) return false;
+                if (code >= 0xDC00 && code <= 0xDFFF) return false;
+                if (code >= 0xD800 && code <= 0xDBFF) {
+                    // A surrogate pair.
+                    uint32_t low;
+                    if (end_ - data_ < 2 || data_[0] != '\\' ||
+                        data_[1] != 'u') {
+                        return false;
+                    }
+                    data_ += 2;
+                    if (!readHex4_(&low) || low < 0xDC00 || low > 0xDFFF) {
+                        return false;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                break;
+            }
+            default:
+                return false;
+        }
+        if (!appendUtf8_(code)) return false;
+    }
+    return false;
+}
+
+bool JsonReader::readHex4_(uint32_t* code) {
+    if (end_ - data_ < 4) return false;
+    *code = 0;
+    for (int i = 0; i < 4; i++) {
+        const char c = *data_++;
+        uint32_t digit;
+        if (c >= '0' && c <= '9') {
+            digit = c - '0';
+        } else if (c >= 'a' && c <= 'f') {
+            digit = c - 'a' + 10;
+        } else if (c >= 'A' && c <= 'F') {
+            digit = c - 'A' + 10;
+        } else {
+            return false;
+        }
+        *code = (*code << 4) | digit;
+    }
+    return true;
+}
+
+bool JsonReader::appendUtf8_(uint32_t code) {
+    char bytes[4];
+    size_t count;
+    if (code < 0x80) {
+        bytes[0] = code;
+        count = 1;
+    } else if (code < 0x800) {
+        bytes[0] = 0xC0 | (code >> 6);
+        bytes[1] = 0x80 | (code & 0x3F);
+        count = 2;
+    } else if (code < 0x10000) {
+        bytes[0] = 0xE0 | (code >> 12);
+        bytes[1] = 0x80 | ((code >> 6) & 0x3F);
+        bytes[2] = 0x80 | (code & 0x3F);
+        count = 3;
+    } else {
+        bytes[0] = 0xF0 | (code >> 18);
+        bytes[1] = 0x80 | ((code >> 12) & 0x3F);
+        bytes[2] = 0x80 | ((code >> 6) & 0x3F);
+        bytes[3] = 0x80 | (code & 0x3F);
+        count = 4;
+    }
+    if (string_length_ + count > JSON_STRING_LENGTH) return false;
+    memcpy(string_ + string_length_, bytes, count);
+    string_length_ += count;
+    return true;
+}
+
+bool JsonReader::readNumber_() {
+    const bool negative = data_ < end_ && *data_ == '-';
+    if (negative) data_++;
+    if (data_ == end_ || *data_ < '0' || *data_ > '9') return false;
+    // Leading zeros are not allowed.
+    if (*data_ == '0' && end_ - data_ > 1 && data_[1] >= '0' &&
+        data_[1] <= '9') {
+        return false;
+    }
+    // Accumulated negatively, so that INT32_MIN fits.
+    int64_t value = 0;
+    while (data_ < end_ && *data_ >= '0' && *data_ <= '9') {
+        value = value * 10 - (*data_++ - '0');
+        if (value < INT32_MIN) return false;
+    }
+    if (data_ < end_ && (*data_ == '.' || *data_ == 'e' || *data_ == 'E')) {
+        return false;
+    }
+    if (!negative) {
+        value = -value;
+        if (value > INT32_MAX) return false;
+    }
+    number_ = value;
+    return true;
+}
+
+bool JsonReader::readLiteral_(const char* word) {
+    const size_t rest = strlen(word) - 1;
+    if (static_cast<size_t>(end_ - data_) < rest ||
+        memcmp(data_, word + 1, rest) != 0) {
+        return false;
+    }
+    data_ += rest;
+    return true;
+}
+
+void JsonReader::afterValue_() {
+    expect_ = depth_ == 0 ? Expect::DONE : Expect::COMMA_OR_END;
+}
+
+JsonToken JsonReader::fail_() {
+    failed_ = true;
+    return JsonToken::ERROR;
+}
+
+JsonWriter::JsonWriter(char* buffer, size_t size)
+    : buffer_(buffer), size_(size) {
+    if (size_ > 0) buffer_[0] = 0;
+    ok_ = size_ > 0;
+}
+
+void JsonWriter::beginObject() {
+    separate_();
+    write_('{');
+    first_ = true;
+}
+
+void JsonWriter::endObject() {
+    write_('}');
+    first_ = false;
+}
+
+void JsonWriter::beginArray() {
+    separate_();
+    write_('[');
+    first_ = true;
+}
+
+void JsonWriter::endArray() {
+    write_(']');
+    first_ = false;
+}
+
+void JsonWriter::key(const char* name) {
+    stringValue(name);
+    write_(':');
+    first_ = true;
+}
+
+void JsonWriter::stringValue(const char* text) {
+    separate_();
+    write_('"');
+    for (const char* c = text; *c; c++) {
+        const uint8_t byte = *c;
+        if (byte == '"' || byte == '\\') {
+            write_('\\');
+            write_(*c);
+        } else if (byte < 0x20) {
+            char escape[7];
+            snprintf(escape, sizeof(escape), "\\u%04x", byte);
+            write_(escape);
+        } else {
+            write_(*c);
+        }
+    }
+    write_('"');
+    first_ = false;
+}
+
+void JsonWriter::numberValue(int64_t number) {
+    separate_();
+    char digits[21];
+    snprintf(digits, sizeof(digits), "%lld", static_cast<long long>(number));
+    write_(digits);
+    first_ = false;
+}
+
+void JsonWriter::boolValue(bool flag) {
+    separate_();
+    write_(flag ? "true" : "false");
+    first_ = false;
+}
+
+void JsonWriter::nullValue() {
+    separate_();
+    write_("null");
+    first_ = false;
+}
+
+void JsonWriter::separate_() {
+    if (!first_) write_(',');
+}
+
+void JsonWriter::write_(char c) {
+    if (length_ + 1 >= size_) {
+        ok_ = false;
+        return;
+    }
+    buffer_[length_++] = c;
+    buffer_[length_] = 0;
+}
+
+void JsonWriter::write_(const char* text) {
+    for (; *text; text++) write_(*text);
+}
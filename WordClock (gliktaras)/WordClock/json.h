@@ -0,0 +1,156 @@
+#ifndef WORDCLOCK_JSON_H_
+#define WORDCLOCK_JSON_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Longest string value or key JsonReader accepts, in bytes, excluding the
+// terminating NUL.
+#define JSON_STRING_LENGTH 31
+// Deepest nesting of objects and arrays JsonReader accepts.
+#define JSON_MAX_DEPTH 8
+
+// Kinds of tokens read by JsonReader.
+enum class JsonToken {
+    BEGIN_OBJECT,
+    END_OBJECT,
+    BEGIN_ARRAY,
+    END_ARRAY,
+    // An object member name, in string().
+    KEY,
+    // A string value, in string().
+    STRING,
+    // A number value, in number().
+    NUMBER,
+    TRUE,
+    FALSE,
+    NUL,
+    // The end of the document.
+    END,
+    // Malformed or unsupported input. Every later token is an error too.
+    ERROR,
+};
+
+// Pull parser of a JSON document.
+//
+// Validates the document while reading it token by token, and never allocates:
+// strings are unescaped into a fixed buffer and nesting is tracked in a fixed
+// stack. Strings longer than JSON_STRING_LENGTH and numbers that are not
+// integers within int32_t are reported as errors, as the clock has no use for
+// them.
+//
+// Has no Arduino dependencies, so that it can be tested on a host.
+class JsonReader {
+  public:
+    // Reads the `size` bytes at `data`, which must outlive the reader.
+    JsonReader(const char* data, size_t size);
+
+    JsonReader(const JsonReader&) = delete;
+    JsonReader& operator=(const JsonReader&) = delete;
+
+    // Reads the next token.
+    JsonToken next();
+    // Skips the rest of the value `token` starts, where `token` was just
+    // returned by next(). Returns false on malformed input.
+    bool skipValue(JsonToken token);
+
+    // Returns the last KEY or STRING token, unescaped and NUL-terminated.
+    const char* string() const { return string_; }
+    // Returns the last NUMBER token.
+    int32_t number() const { return number_; }
+
+  private:
+    // What the next token may be.
+    enum class Expect {
+        VALUE,
+        // After "[".
+        VALUE_OR_END,
+        // After ",".
+        KEY,
+        // After "{".
+        KEY_OR_END,
+        COLON,
+        COMMA_OR_END,
+        // After the top level value.
+        DONE,
+    };
+
+    // Skips whitespace. Returns false at the end of the input.
+    bool skipWhitespace_();
+    // Reads the token of a value starting at the current character.
+    JsonToken readValue_();
+    // Pops the container closed by the current character, if it matches.
+    JsonToken endContainer_(char open, JsonToken token);
+    // Reads a string into string_, starting after its opening quote.
+    bool readString_();
+    // Reads four hex digits of a \u escape.
+    bool readHex4_(uint32_t* code);
+    // Appends `code` to string_ in UTF-8.
+    bool appendUtf8_(uint32_t code);
+    // Reads a number into number_.
+    bool readNumber_();
+    // Reads the rest of the literal `word`, whose first letter was read.
+    bool readLiteral_(const char* word);
+    // Sets what may follow a complete value.
+    void afterValue_();
+    // Marks the document as malformed.
+    JsonToken fail_();
+
+    const char* data_;
+    const char* end_;
+    Expect expect_ = Expect::VALUE;
+    // Opening characters of the enclosing containers.
+    char stack_[JSON_MAX_DEPTH];
+    int depth_ = 0;
+    bool failed_ = false;
+
+    char string_[JSON_STRING_LENGTH + 1];
+    size_t string_length_ = 0;
+    int32_t number_ = 0;
+};
+
+// Writes a JSON document into a fixed buffer.
+//
+// Inserts commas and colons, escapes strings and keeps the buffer
+// NUL-terminated. Output that does not fit is dropped and reported by ok().
+class JsonWriter {
+  public:
+    // Writes into the `size` bytes at `buffer`.
+    JsonWriter(char* buffer, size_t size);
+
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    // Writes an object member name. Its value must follow.
+    void key(const char* name);
+    void stringValue(const char* text);
+    void numberValue(int64_t number);
+    void boolValue(bool flag);
+    void nullValue();
+
+    // Returns whether everything fit into the buffer.
+    bool ok() const { return ok_; }
+    // Returns the document.
+    const char* c_str() const { return buffer_; }
+    // Returns the length of the document, in bytes.
+    size_t length() const { return length_; }
+
+  private:
+    // Writes a comma if a value preceded this one in the same container.
+    void separate_();
+    void write_(char c);
+    void write_(const char* text);
+
+    char* buffer_;
+    size_t size_;
+    size_t length_ = 0;
+    bool ok_ = true;
+    // Whether the next value is the first of its container, or follows a key.
+    bool first_ = true;
+};
+
+#endif  // WORDCLOCK_JSON_H_
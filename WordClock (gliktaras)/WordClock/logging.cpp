@@ -0,0 +1,155 @@
+// Ring buffered logging, drained to Serial by a low priority task.
+
+#include "logging.h"
+
+#include <Arduino.h>
+
+namespace logging {
+
+namespace {
+
+// Stack size of the drain task, in bytes.
+#define LOG_TASK_STACK_SIZE 3072
+// Priority of the drain task, just above the idle task.
+#define LOG_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
+// Core the drain task runs on, away from the render loop.
+#define LOG_TASK_CORE 0
+// How long the drain task sleeps once the buffer is empty, in milliseconds.
+#define LOG_DRAIN_PERIOD_MS 20
+// Length of the longest formatted line. Longer lines are truncated.
+#define LOG_LINE_LENGTH 160
+
+// Level value of records that hold DLOG text.
+#define LOG_LEVEL_TEXT 0xFF
+
+// A single log entry, either a deferred printf call or a piece of text.
+struct Record {
+    // millis() when the record was written.
+    uint32_t ms;
+    // printf format, or nullptr for a text record.
+    const char* format;
+    // LOG_LEVEL_* value, or LOG_LEVEL_TEXT.
+    uint8_t level;
+    // Number of arguments, or number of characters for a text record.
+    uint8_t count;
+    union {
+        uintptr_t args[LOG_MAX_ARGS];
+        char text[LOG_MAX_TEXT];
+    };
+};
+
+// Tags printed in front of the records of each level.
+const char* const LEVEL_TAGS[] = {"", "[ERROR] ", "[WARN] ", "[INFO] ",
+                                  "[DEBUG] "};
+
+// Records waiting to be printed.
+Record ring[LOG_RING_SIZE];
+// Index of the next record to write.
+volatile uint16_t head = 0;
+// Index of the next record to print.
+volatile uint16_t tail = 0;
+// Number of records dropped because the ring was full.
+volatile uint32_t dropped = 0;
+// Guards head, tail and the ring slots between them.
+portMUX_TYPE ring_mux = portMUX_INITIALIZER_UNLOCKED;
+// The drain task, once started.
+TaskHandle_t drain_task = nullptr;
+
+// Copies `record` into the ring. Never blocks beyond the spinlock, which is
+// only held for the copy.
+bool push(const Record& record) {
+    bool pushed = false;
+    portENTER_CRITICAL(&ring_mux);
+    const uint16_t next = (head + 1) % LOG_RING_SIZE;
+    if (next == tail) {
+        dropped++;
+    } else {
+        ring[head] = record;
+        head = next;
+        pushed = true;
+    }
+    portEXIT_CRITICAL(&ring_mux);
+    return pushed;
+}
+
+// Moves the oldest record into `record`. Returns false if the ring is empty.
+bool pop(Record* record) {
+    bool popped = false;
+    portENTER_CRITICAL(&ring_mux);
+    if (tail != head) {
+        *record = ring[tail];
+        tail = (tail + 1) % LOG_RING_SIZE;
+        popped = true;
+    }
+    portEXIT_CRITICAL(&ring_mux);
+    return popped;
+}
+
+// Formats and prints a single record.
+void print(const Record& record) {
+    if (record.level == LOG_LEVEL_TEXT) {
+        Serial.write(reinterpret_cast<const uint8_t*>(record.text),
+                     record.count);
+        return;
+    }
+
+    char line[LOG_LINE_LENGTH];
+    int length = snprintf(line, sizeof(line), "%lu %s",
+                          static_cast<unsigned long>(record.ms),
+                          LEVEL_TAGS[record.level]);
+    const uintptr_t* a = record.args;
+    length += snprintf(line + length, sizeof(line) - length, record.format,
+                       a[0], a[1], a[2], a[3], a[4], a[5]);
+    length = min(length, static_cast<int>(sizeof(line)) - 1);
+    Serial.write(reinterpret_cast<const uint8_t*>(line), length);
+    Serial.write('\n');
+}
+
+void drain(void*) {
+    uint32_t reported_dropped = 0;
+    Record record;
+    for (;;) {
+        while (pop(&record)) {
+            print(record);
+        }
+        if (dropped != reported_dropped) {
+            Serial.printf("[WARN] Log buffer full, dropped %lu records.\n",
+                          static_cast<unsigned long>(dropped - reported_dropped));
+            reported_dropped = dropped;
+        }
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_PERIOD_MS));
+    }
+}
+
+}  // namespace
+
+void setup() {
+    if (drain_task != nullptr) return;
+    xTaskCreatePinnedToCore(drain, "log", LOG_TASK_STACK_SIZE, nullptr,
+                            LOG_TASK_PRIORITY, &drain_task, LOG_TASK_CORE);
+}
+
+bool write(uint8_t level, const char* format, uint8_t count,
+           const uintptr_t* args) {
+    Record record;
+    record.ms = millis();
+    record.format = format;
+    record.level = level;
+    record.count = count;
+    for (int i = 0; i < LOG_MAX_ARGS; i++) {
+        record.args[i] = i < count ? args[i] : 0;
+    }
+    return push(record);
+}
+
+bool writeText(const char* text, size_t length) {
+    Record record;
+    record.ms = millis();
+    record.format = nullptr;
+    record.level = LOG_LEVEL_TEXT;
+    record.count = min(length, static_cast<size_t>(LOG_MAX_TEXT));
+    memcpy(record.text, text, record.count);
+    return push(record);
+}
+
+}  // namespace logging
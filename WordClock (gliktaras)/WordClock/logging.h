@@ -1,19 +1,162 @@
 #pragma once
 
-// Define debug to turn on debug logging.
-// #define DEBUG 1
+#include <Print.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
 
+// Logging goes through a RAM ring buffer that a low priority task drains to
+// Serial, so that a log line costs the caller a few microseconds instead of
+// the milliseconds it takes to send it at 115200 baud.
+//
+// LOGE, LOGW, LOGI and LOGD take a printf format and up to LOG_MAX_ARGS
+// integer or string arguments. Formatting is deferred to the drain task, so
+// the format and any %s argument must outlive the call. String arguments must
+// therefore be wrapped in LOG_STATIC(), which only string literals and
+// terminated strings of static storage may be; a plain pointer does not
+// compile. A static buffer written again before the drain task gets to the
+// record prints its new content. Stack buffers and String contents would be
+// gone by then: log those with DLOG, or not at all.
+// Levels above LOG_LEVEL compile to nothing.
+//
 // DLOG and DLOGLN are equivalent of Serial.print and println, but turned off by
-// the DEBUG macro absence.
+// the DEBUG macro absence. They format right away into the record, so they
+// take any string, but only the first LOG_MAX_TEXT bytes of each call.
 // DCHECK only log if the first parameter is false.
-// setupLogin() must be called from setup() for everything to work.
+// setupLogging() must be called from setup() for anything to be printed.
 
+// Define debug to turn on debug logging.
+// #define DEBUG 1
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
 #ifdef DEBUG
+#define LOG_LEVEL LOG_LEVEL_DEBUG
+#else
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+#endif
+
+// Number of records the ring buffer holds. Records logged while it is full are
+// dropped and counted.
+#define LOG_RING_SIZE 64
+// Maximum number of arguments of a deferred record.
+#define LOG_MAX_ARGS 6
+// Maximum number of bytes of a DLOG text record, 24 on the ESP32. Longer text
+// is cut to fit, and ends with "…" to show it.
+#define LOG_MAX_TEXT (LOG_MAX_ARGS * sizeof(uintptr_t))
 
-#include <HardwareSerial.h>
+// Marks `s`, a string literal or a terminated string of static storage, as
+// fit to be passed for a %s.
+#define LOG_STATIC(s) (logging::StaticString{(s)})
 
-#define DLOG(...) Serial.print(__VA_ARGS__)
-#define DLOGLN(...) Serial.println(__VA_ARGS__)
+namespace logging {
+
+// A string argument of a deferred record. See LOG_STATIC().
+struct StaticString {
+    const char* value;
+};
+
+// Converts a log argument to the word stored in the record. Floating point
+// values are not supported, since the drain task could not tell them apart.
+template <typename T>
+uintptr_t toArg(T value) {
+    static_assert((std::is_integral<T>::value || std::is_enum<T>::value) &&
+                      sizeof(T) <= sizeof(uintptr_t),
+                  "Log arguments must be integers or LOG_STATIC() strings.");
+    return static_cast<uintptr_t>(value);
+}
+inline uintptr_t toArg(StaticString value) {
+    return reinterpret_cast<uintptr_t>(value.value);
+}
+
+// Starts the task that drains the ring buffer to Serial.
+void setup();
+
+// Appends a record to the ring buffer without blocking. Returns false if the
+// buffer was full and the record was dropped.
+bool write(uint8_t level, const char* format, uint8_t count,
+           const uintptr_t* args);
+
+// Appends `length` bytes of preformatted text to the ring buffer.
+bool writeText(const char* text, size_t length);
+
+// Packs the arguments of a deferred record.
+template <typename... Args>
+bool logf(uint8_t level, const char* format, Args... args) {
+    static_assert(sizeof...(Args) <= LOG_MAX_ARGS, "Too many log arguments.");
+    const uintptr_t packed[] = {0, toArg(args)...};
+    return write(level, format, sizeof...(Args), packed + 1);
+}
+
+// Collects the output of Print methods into a single text record.
+class TextRecord : public Print {
+  public:
+    size_t write(uint8_t c) override {
+        if (length_ == LOG_MAX_TEXT) {
+            truncated_ = true;
+            newline_ = newline_ || c == '\n';
+            return 0;
+        }
+        text_[length_++] = c;
+        return 1;
+    }
+    using Print::write;
+
+    ~TextRecord() {
+        if (truncated_) {
+            // Ends with an ellipsis, and the line break that was cut.
+            static const char ELLIPSIS[] = "\xE2\x80\xA6\r\n";
+            const size_t size = sizeof(ELLIPSIS) - (newline_ ? 1 : 3);
+            memcpy(text_ + LOG_MAX_TEXT - size, ELLIPSIS, size);
+        }
+        writeText(text_, length_);
+    }
+
+  private:
+    char text_[LOG_MAX_TEXT];
+    size_t length_ = 0;
+    // Whether text was cut, and whether what was cut held a line break.
+    bool truncated_ = false;
+    bool newline_ = false;
+};
+
+}  // namespace logging
+
+#define setupLogging() logging::setup()
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOGE(format, ...) logging::logf(LOG_LEVEL_ERROR, format, ##__VA_ARGS__)
+#else
+#define LOGE(...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOGW(format, ...) logging::logf(LOG_LEVEL_WARN, format, ##__VA_ARGS__)
+#else
+#define LOGW(...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOGI(format, ...) logging::logf(LOG_LEVEL_INFO, format, ##__VA_ARGS__)
+#else
+#define LOGI(...)
+#endif
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOGD(format, ...) logging::logf(LOG_LEVEL_DEBUG, format, ##__VA_ARGS__)
+#else
+#define LOGD(...)
+#endif
+
+#ifdef DEBUG
+
+#define DLOG(...) logging::TextRecord().print(__VA_ARGS__)
+#define DLOGLN(...) logging::TextRecord().println(__VA_ARGS__)
 #define DCHECK(condition, ...) \
     if (!(condition))          \
     {                          \
@@ -25,19 +168,10 @@
         DLOGLN(__VA_ARGS__);   \
     }
 
-#define setupLogging()              \
-    {                               \
-        Serial.begin(115200);       \
-        delay(2000);                \
-        DLOGLN("Logging started."); \
-    }
-
 #else
 
 #define DLOG(...)
 #define DLOGLN(...)
 #define DCHECK(condition, ...)
 
-#define setupLogging()
-
 #endif // DEBUG
@@ -0,0 +1,102 @@
+// Timing histograms published in Prometheus text format.
+
+#include "metrics.h"
+
+namespace metrics {
+
+namespace {
+
+// Upper bounds of the histogram buckets, in microseconds.
+const uint32_t BUCKET_BOUNDS_US[METRICS_BUCKET_COUNT] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000,
+};
+
+// Prints `us` microseconds as seconds, the base unit Prometheus expects.
+void printSeconds(Print& out, uint64_t us) {
+    out.printf("%lu.%06lu", static_cast<unsigned long>(us / 1000000),
+               static_cast<unsigned long>(us % 1000000));
+}
+
+}  // namespace
+
+Metric* Metric::first_ = nullptr;
+
+Metric::Metric(const char* name, const char* help) : name_(name), help_(help) {
+    // Keep registration order, so that the output is stable.
+    Metric** last = &first_;
+    while (*last != nullptr) last = &(*last)->next_;
+    *last = this;
+}
+
+void Metric::writeHeader(Print& out, const char* type) const {
+    out.printf("# HELP %s %s\n# TYPE %s %s\n", name_, help_, name_, type);
+}
+
+void Histogram::observe(uint32_t us) {
+    int bucket = 0;
+    while (bucket < METRICS_BUCKET_COUNT && us > BUCKET_BOUNDS_US[bucket]) {
+        bucket++;
+    }
+    counts_[bucket]++;
+    sum_us_ += us;
+}
+
+uint32_t Histogram::count() const {
+    uint32_t total = 0;
+    for (int bucket = 0; bucket <= METRICS_BUCKET_COUNT; bucket++) {
+        total += counts_[bucket];
+    }
+    return total;
+}
+
+void Histogram::writeTo(Print& out) const {
+    writeHeader(out, "histogram");
+    uint32_t cumulative = 0;
+    for (int bucket = 0; bucket < METRICS_BUCKET_COUNT; bucket++) {
+        cumulative += counts_[bucket];
+        out.printf("%s_bucket{le=\"", name_);
+        printSeconds(out, BUCKET_BOUNDS_US[bucket]);
+        out.printf("\"} %lu\n", static_cast<unsigned long>(cumulative));
+    }
+    cumulative += counts_[METRICS_BUCKET_COUNT];
+    out.printf("%s_bucket{le=\"+Inf\"} %lu\n%s_sum ", name_,
+               static_cast<unsigned long>(cumulative), name_);
+    printSeconds(out, sum_us_);
+    out.printf("\n%s_count %lu\n", name_, static_cast<unsigned long>(cumulative));
+}
+
+void writeAll(Print& out) {
+    for (const Metric* metric = Metric::first(); metric != nullptr;
+         metric = metric->next()) {
+        metric->writeTo(out);
+    }
+}
+
+Histogram loop_duration("wordclock_loop_duration_seconds",
+                        "Duration of one iteration of the main loop.");
+Histogram display_loop_duration("wordclock_display_loop_duration_seconds",
+                                "Duration of Display::loop().");
+Histogram show_duration("wordclock_pixels_show_duration_seconds",
+                        "Duration of sending a frame to the LEDs.");
+Histogram web_conf_loop_duration(
+    "wordclock_web_conf_loop_duration_seconds",
+    "Duration of the configuration portal event loop.");
+Histogram state_for_time_duration(
+    "wordclock_state_for_time_duration_seconds",
+    "Duration of computing the clock face state for a time.");
+Histogram state_for_text_duration(
+    "wordclock_state_for_text_duration_seconds",
+    "Duration of computing the clock face state for a text.");
+Histogram transition_frame_duration(
+    "wordclock_transition_frame_duration_seconds",
+    "Duration of drawing one frame of a transition between two faces.");
+Histogram preview_capture_duration(
+    "wordclock_preview_capture_duration_seconds",
+    "Duration of copying a frame for the preview stream.");
+Histogram render_tick_jitter(
+    "wordclock_render_tick_jitter_seconds",
+    "Delay between a render tick and the render loop waking up for it.");
+Histogram mqtt_loop_duration("wordclock_mqtt_loop_duration_seconds",
+                             "Duration of the MQTT client event loop.");
+
+}  // namespace metrics
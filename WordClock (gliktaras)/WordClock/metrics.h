@@ -0,0 +1,125 @@
+#ifndef WORDCLOCK_METRICS_H_
+#define WORDCLOCK_METRICS_H_
+
+#include <Arduino.h>
+#include <Print.h>
+#include <esp_timer.h>
+
+// Define to compile out all timing instrumentation.
+// #define DISABLE_METRICS
+
+// Number of finite histogram buckets. Observations above the last bound only
+// land in the implicit +Inf bucket.
+#define METRICS_BUCKET_COUNT 12
+
+namespace metrics {
+
+// A metric published on the /metrics endpoint. Every metric is expected to be
+// a global object; it adds itself to the list returned by first() when
+// constructed.
+class Metric {
+  public:
+    Metric(const char* name, const char* help);
+
+    Metric(const Metric&) = delete;
+    Metric& operator=(const Metric&) = delete;
+
+    // Writes the metric in Prometheus text exposition format.
+    virtual void writeTo(Print& out) const = 0;
+
+    // Returns the first registered metric, or nullptr if there is none.
+    static const Metric* first() { return first_; }
+    // Returns the metric registered after this one, or nullptr.
+    const Metric* next() const { return next_; }
+
+  protected:
+    // Writes the HELP and TYPE lines of the metric.
+    void writeHeader(Print& out, const char* type) const;
+
+    // Metric name, including the unit suffix.
+    const char* name_;
+    // One line description of the metric.
+    const char* help_;
+
+  private:
+    static Metric* first_;
+    Metric* next_ = nullptr;
+};
+
+// Distribution of durations over fixed buckets, from 50 us to 250 ms.
+class Histogram : public Metric {
+  public:
+    Histogram(const char* name, const char* help) : Metric(name, help) {}
+
+    // Records a duration in microseconds.
+    void observe(uint32_t us);
+
+    // Returns the number of observations.
+    uint32_t count() const;
+    // Returns the sum of all observations, in microseconds.
+    uint64_t sumUs() const { return sum_us_; }
+
+    void writeTo(Print& out) const override;
+
+  private:
+    // Number of observations per bucket, not cumulative. The last entry is
+    // the +Inf bucket.
+    uint32_t counts_[METRICS_BUCKET_COUNT + 1] = {0};
+    // Sum of all observations, in microseconds.
+    uint64_t sum_us_ = 0;
+};
+
+// Records the time spent in the enclosing scope into a histogram. Timed with
+// esp_timer rather than the CPU cycle counter, whose rate changes with the CPU
+// frequency.
+class ScopedTimer {
+  public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram_(histogram), start_us_(esp_timer_get_time()) {}
+    ~ScopedTimer() { histogram_.observe(esp_timer_get_time() - start_us_); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+  private:
+    Histogram& histogram_;
+    const int64_t start_us_;
+};
+
+// Writes all registered metrics in Prometheus text exposition format.
+void writeAll(Print& out);
+
+// Duration of a whole iteration of the Arduino loop().
+extern Histogram loop_duration;
+// Duration of Display::loop(), including the LED update.
+extern Histogram display_loop_duration;
+// Duration of sending the frame to the LEDs.
+extern Histogram show_duration;
+// Duration of the IotWebConf event loop, including HTTP request handling.
+extern Histogram web_conf_loop_duration;
+// Duration of ClockFace::stateForTime().
+extern Histogram state_for_time_duration;
+// Duration of ClockFace::stateForText().
+extern Histogram state_for_text_duration;
+// Duration of drawing one frame of a transition between two faces.
+extern Histogram transition_frame_duration;
+// Duration of copying a frame for the preview stream.
+extern Histogram preview_capture_duration;
+// Delay between a render tick and the render loop waking up for it.
+extern Histogram render_tick_jitter;
+// Duration of the MQTT client's event loop, including connection attempts.
+extern Histogram mqtt_loop_duration;
+
+}  // namespace metrics
+
+#ifdef DISABLE_METRICS
+#define TIME_SCOPE(histogram)
+#else
+#define METRICS_CONCAT_(a, b) a##b
+#define METRICS_CONCAT(a, b) METRICS_CONCAT_(a, b)
+// Records the time until the end of the current scope into `histogram`.
+#define TIME_SCOPE(histogram) \
+    metrics::ScopedTimer METRICS_CONCAT(scoped_timer_, __LINE__)(histogram)
+#endif
+
+#endif  // WORDCLOCK_METRICS_H_
@@ -0,0 +1,316 @@
+// MQTT 3.1.1 client.
+
+#include "mqtt_client.h"
+
+#include <string.h>
+
+namespace {
+
+// Packet types, in the high nibble of the first byte.
+#define MQTT_CONNECT 0x10
+#define MQTT_CONNACK 0x20
+#define MQTT_PUBLISH 0x30
+#define MQTT_SUBSCRIBE 0x82
+#define MQTT_PINGREQ 0xC0
+#define MQTT_DISCONNECT 0xE0
+// Flags of the PUBLISH packet type.
+#define MQTT_PUBLISH_RETAIN 0x01
+#define MQTT_PUBLISH_QOS_MASK 0x06
+// Flags of the CONNECT packet.
+#define MQTT_CONNECT_USER 0x80
+#define MQTT_CONNECT_PASSWORD 0x40
+#define MQTT_CONNECT_WILL_RETAIN 0x20
+#define MQTT_CONNECT_WILL 0x04
+#define MQTT_CONNECT_CLEAN_SESSION 0x02
+// Longest topic of a received message, in bytes.
+#define MQTT_TOPIC_LENGTH 127
+
+// Payloads of the status topic.
+const char STATUS_ONLINE[] = "online";
+const char STATUS_OFFLINE[] = "offline";
+
+}  // namespace
+
+void MqttClient::setServer(const char* host, uint16_t port,
+                           const char* client_id, const char* user,
+                           const char* password) {
+    if (state_ == State::CONNECTED) {
+        queue_(MQTT_DISCONNECT, nullptr, nullptr, nullptr, 0);
+        flush_();
+    }
+    if (state_ != State::DISABLED) transport_->stop();
+    host_ = host;
+    port_ = port;
+    client_id_ = client_id;
+    user_ = user;
+    password_ = password;
+    state_ = host_[0] ? State::DISCONNECTED : State::DISABLED;
+    // Connect on the next loop() call.
+    backoff_ms_ = MQTT_MIN_BACKOFF_MS;
+    retry_ms_ = 0;
+}
+
+bool MqttClient::subscribe(const char* filter) {
+    if (subscription_count_ == MQTT_MAX_SUBSCRIPTIONS) return false;
+    subscriptions_[subscription_count_++] = filter;
+    return true;
+}
+
+bool MqttClient::publish(const char* topic, const char* payload,
+                         bool retain) {
+    if (state_ != State::CONNECTED) return false;
+    const uint8_t* parts[] = {reinterpret_cast<const uint8_t*>(topic),
+                              reinterpret_cast<const uint8_t*>(payload)};
+    const size_t sizes[] = {strlen(topic), strlen(payload)};
+    const bool prefixed[] = {true, false};
+    if (!queue_(MQTT_PUBLISH | (retain ? MQTT_PUBLISH_RETAIN : 0), parts,
+                sizes, prefixed, 2)) {
+        dropped_++;
+        return false;
+    }
+    return true;
+}
+
+void MqttClient::loop(uint32_t now_ms) {
+    switch (state_) {
+        case State::DISABLED:
+            return;
+        case State::DISCONNECTED:
+            if (now_ms - state_ms_ >= retry_ms_) connect_(now_ms);
+            return;
+        case State::CONNECTING:
+        case State::CONNECTED:
+            break;
+    }
+
+    if (!transport_->connected() || !flush_() || !receive_(now_ms)) {
+        disconnect_(now_ms);
+        return;
+    }
+    if (state_ == State::CONNECTING) {
+        if (now_ms - state_ms_ > MQTT_CONNACK_TIMEOUT_MS) disconnect_(now_ms);
+        return;
+    }
+    if (now_ms - received_ms_ > MQTT_KEEPALIVE_S * 1500UL) {
+        // The broker stopped answering pings.
+        disconnect_(now_ms);
+        return;
+    }
+    if (now_ms - sent_ms_ >= MQTT_KEEPALIVE_S * 500UL &&
+        queue_(MQTT_PINGREQ, nullptr, nullptr, nullptr, 0)) {
+        sent_ms_ = now_ms;
+    }
+    if (!flush_()) disconnect_(now_ms);
+}
+
+void MqttClient::connect_(uint32_t now_ms) {
+    state_ms_ = now_ms;
+    if (!transport_->connect(host_, port_)) {
+        disconnect_(now_ms);
+        return;
+    }
+    out_length_ = 0;
+    in_length_ = 0;
+    skip_ = 0;
+
+    // Variable header: protocol name and level, flags, keep alive.
+    uint8_t header[] = {0, 4, 'M', 'Q', 'T', 'T', 4, MQTT_CONNECT_CLEAN_SESSION,
+                        MQTT_KEEPALIVE_S >> 8, MQTT_KEEPALIVE_S & 0xFF};
+    uint8_t& flags = header[7];
+    const uint8_t* parts[6];
+    size_t sizes[6];
+    bool prefixed[6];
+    int count = 0;
+    const auto add = [&](const void* data, size_t size, bool with_length) {
+        parts[count] = static_cast<const uint8_t*>(data);
+        sizes[count] = size;
+        prefixed[count++] = with_length;
+    };
+    add(header, sizeof(header), false);
+    add(client_id_, strlen(client_id_), true);
+    if (status_topic_ != nullptr) {
+        flags |= MQTT_CONNECT_WILL | MQTT_CONNECT_WILL_RETAIN;
+        add(status_topic_, strlen(status_topic_), true);
+        add(STATUS_OFFLINE, strlen(STATUS_OFFLINE), true);
+    }
+    if (user_[0]) {
+        flags |= MQTT_CONNECT_USER;
+        add(user_, strlen(user_), true);
+        if (password_[0]) {
+            flags |= MQTT_CONNECT_PASSWORD;
+            add(password_, strlen(password_), true);
+        }
+    }
+    if (!queue_(MQTT_CONNECT, parts, sizes, prefixed, count)) {
+        disconnect_(now_ms);
+        return;
+    }
+    state_ = State::CONNECTING;
+    received_ms_ = now_ms;
+    sent_ms_ = now_ms;
+}
+
+void MqttClient::disconnect_(uint32_t now_ms) {
+    transport_->stop();
+    // A connection that was up is retried quickly, a broker that cannot be
+    // reached less and less often.
+    if (state_ == State::CONNECTED) backoff_ms_ = MQTT_MIN_BACKOFF_MS;
+    retry_ms_ = backoff_ms_;
+    backoff_ms_ = backoff_ms_ * 2 > MQTT_MAX_BACKOFF_MS ? MQTT_MAX_BACKOFF_MS
+                                                       : backoff_ms_ * 2;
+    state_ = State::DISCONNECTED;
+    state_ms_ = now_ms;
+}
+
+void MqttClient::start_() {
+    for (int i = 0; i < subscription_count_; i++) {
+        const uint8_t id[] = {static_cast<uint8_t>(packet_id_ >> 8),
+                              static_cast<uint8_t>(packet_id_ & 0xFF)};
+        const uint8_t qos = 0;
+        const uint8_t* parts[] = {
+            id, reinterpret_cast<const uint8_t*>(subscriptions_[i]), &qos};
+        const size_t sizes[] = {sizeof(id), strlen(subscriptions_[i]), 1};
+        const bool prefixed[] = {false, true, false};
+        queue_(MQTT_SUBSCRIBE, parts, sizes, prefixed, 3);
+        packet_id_ = packet_id_ == 0xFFFF ? 1 : packet_id_ + 1;
+    }
+    if (status_topic_ != nullptr) publish(status_topic_, STATUS_ONLINE, true);
+}
+
+bool MqttClient::queue_(uint8_t type, const uint8_t* const* parts,
+                        const size_t* sizes, const bool* prefixed,
+                        int count) {
+    size_t remaining = 0;
+    for (int i = 0; i < count; i++) {
+        remaining += sizes[i] + (prefixed[i] ? 2 : 0);
+    }
+    uint8_t header[5] = {type};
+    size_t header_size = 1;
+    size_t length = remaining;
+    do {
+        header[header_size] = length & 0x7F;
+        length >>= 7;
+        if (length > 0) header[header_size] |= 0x80;
+        header_size++;
+    } while (length > 0 && header_size < sizeof(header));
+    if (out_length_ + header_size + remaining > sizeof(out_)) return false;
+
+    memcpy(out_ + out_length_, header, header_size);
+    out_length_ += header_size;
+    for (int i = 0; i < count; i++) {
+        if (prefixed[i]) {
+            out_[out_length_++] = sizes[i] >> 8;
+            out_[out_length_++] = sizes[i] & 0xFF;
+        }
+        memcpy(out_ + out_length_, parts[i], sizes[i]);
+        out_length_ += sizes[i];
+    }
+    return true;
+}
+
+bool MqttClient::flush_() {
+    while (out_length_ > 0) {
+        const int written = transport_->write(out_, out_length_);
+        if (written < 0) return false;
+        if (written == 0) return true;
+        memmove(out_, out_ + written, out_length_ - written);
+        out_length_ -= written;
+    }
+    return true;
+}
+
+bool MqttClient::receive_(uint32_t now_ms) {
+    for (;;) {
+        const int read = transport_->read(in_ + in_length_,
+                                          MQTT_BUFFER_SIZE - in_length_);
+        if (read < 0) return false;
+        in_length_ += read;
+        if (skip_ > 0) {
+            const size_t skipped = skip_ < in_length_ ? skip_ : in_length_;
+            memmove(in_, in_ + skipped, in_length_ - skipped);
+            in_length_ -= skipped;
+            skip_ -= skipped;
+        }
+
+        // Process the complete packets.
+        size_t start = 0;
+        for (;;) {
+            const uint8_t* packet = in_ + start;
+            const size_t available = in_length_ - start;
+            size_t remaining = 0;
+            size_t header_size = 1;
+            bool complete_length = false;
+            while (header_size < available && header_size <= 4) {
+                const uint8_t byte = packet[header_size];
+                remaining |= static_cast<size_t>(byte & 0x7F)
+                             << (7 * (header_size - 1));
+                header_size++;
+                if ((byte & 0x80) == 0) {
+                    complete_length = true;
+                    break;
+                }
+            }
+            if (!complete_length) {
+                if (header_size > 4) return false;
+                break;
+            }
+            const size_t size = header_size + remaining;
+            if (size > MQTT_BUFFER_SIZE) {
+                // Too large to ever fit: drop it as it arrives.
+                skip_ = size - available;
+                start = in_length_;
+                break;
+            }
+            if (size > available) break;
+            received_ms_ = now_ms;
+            if (!process_(packet[0], packet + header_size, remaining)) {
+                return false;
+            }
+            start += size;
+        }
+        memmove(in_, in_ + start, in_length_ - start);
+        in_length_ -= start;
+        if (read == 0) return true;
+    }
+}
+
+bool MqttClient::process_(uint8_t type, const uint8_t* body, size_t size) {
+    switch (type & 0xF0) {
+        case MQTT_CONNACK:
+            if (state_ != State::CONNECTING || size < 2 || body[1] != 0) {
+                return false;
+            }
+            state_ = State::CONNECTED;
+            connections_++;
+            backoff_ms_ = MQTT_MIN_BACKOFF_MS;
+            start_();
+            return true;
+        case MQTT_PUBLISH: {
+            if (size < 2) return false;
+            const size_t topic_length = (body[0] << 8) | body[1];
+            // Subscriptions are at QoS 0, so are deliveries, but a packet
+            // identifier would follow the topic otherwise.
+            const size_t id_length =
+                (type & MQTT_PUBLISH_QOS_MASK) != 0 ? 2 : 0;
+            if (2 + topic_length + id_length > size) return false;
+            if (topic_length > MQTT_TOPIC_LENGTH || !callback_) return true;
+            char topic[MQTT_TOPIC_LENGTH + 1];
+            memcpy(topic, body + 2, topic_length);
+            topic[topic_length] = 0;
+            // The byte after the packet is spare or starts the next one, so it
+            // is saved while the payload is NUL-terminated in place.
+            uint8_t* payload = const_cast<uint8_t*>(body) + 2 + topic_length +
+                               id_length;
+            const size_t payload_size = size - 2 - topic_length - id_length;
+            const uint8_t saved = payload[payload_size];
+            payload[payload_size] = 0;
+            callback_(topic, reinterpret_cast<const char*>(payload),
+                      payload_size);
+            payload[payload_size] = saved;
+            return true;
+        }
+        default:
+            // SUBACK, PINGRESP and anything unexpected.
+            return true;
+    }
+}
@@ -0,0 +1,164 @@
+#ifndef WORDCLOCK_MQTT_CLIENT_H_
+#define WORDCLOCK_MQTT_CLIENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+
+// Size of the buffers of outgoing and incoming packets, in bytes. Incoming
+// packets that do not fit are dropped.
+#define MQTT_BUFFER_SIZE 512
+// Maximum number of topic filters subscribed to.
+#define MQTT_MAX_SUBSCRIPTIONS 4
+// Keep alive interval negotiated with the broker, in seconds.
+#define MQTT_KEEPALIVE_S 60
+// Time the broker has to accept a connection, in milliseconds.
+#define MQTT_CONNACK_TIMEOUT_MS 5000
+// Bounds of the wait between two connection attempts, in milliseconds. The
+// wait doubles after every failed attempt.
+#define MQTT_MIN_BACKOFF_MS 2000
+#define MQTT_MAX_BACKOFF_MS 120000
+
+// Carries the MQTT byte stream. Implemented with WiFiClient on the clock and
+// with sockets on a host.
+class MqttTransport {
+  public:
+    virtual ~MqttTransport() {}
+
+    // Opens a connection to `host` and `port`. Returns false on failure. May
+    // block for a bounded time, as it resolves `host`.
+    virtual bool connect(const char* host, uint16_t port) = 0;
+    // Returns whether the connection is open.
+    virtual bool connected() = 0;
+    // Writes up to `size` bytes. Returns the number of bytes written, 0 if
+    // the connection cannot take any now, or -1 on failure. Must not block.
+    virtual int write(const uint8_t* data, size_t size) = 0;
+    // Reads up to `size` bytes. Returns the number of bytes read, 0 if none
+    // are pending, or -1 on failure. Must not block.
+    virtual int read(uint8_t* data, size_t size) = 0;
+    // Closes the connection.
+    virtual void stop() = 0;
+};
+
+// MQTT 3.1.1 client that publishes and receives at QoS 0.
+//
+// Connects on its own and reconnects with an exponential backoff. Packets are
+// queued into a fixed buffer and sent as the connection takes them, so
+// publishing never blocks: a message that does not fit is dropped and
+// counted. Subscriptions are renewed on every connection.
+//
+// When a status topic is set, the broker publishes "offline" to it, retained,
+// if the clock disappears, and the client publishes "online" once connected.
+//
+// Has no Arduino dependencies, so that it can run on a host against a local
+// broker such as mosquitto, see tests/mqtt_runner.cpp.
+class MqttClient {
+  public:
+    // Receives a message published on a subscribed topic. `payload` is
+    // NUL-terminated.
+    typedef std::function<void(const char* topic, const char* payload,
+                               size_t size)>
+        MessageCallback;
+
+    explicit MqttClient(MqttTransport* transport) : transport_(transport) {}
+
+    MqttClient(const MqttClient&) = delete;
+    MqttClient& operator=(const MqttClient&) = delete;
+
+    // Sets the broker and the credentials, and reconnects. An empty `host`
+    // disables the client. `user` and `password` may be empty. The strings
+    // must outlive the client, or the next call.
+    void setServer(const char* host, uint16_t port, const char* client_id,
+                   const char* user, const char* password);
+    // Sets the status topic. The string must outlive the client.
+    void setStatusTopic(const char* topic) { status_topic_ = topic; }
+    // Subscribes to `filter`, which may contain wildcards. The string must
+    // outlive the client. Returns false if there are too many subscriptions.
+    bool subscribe(const char* filter);
+    // Sets the receiver of the messages on subscribed topics.
+    void onMessage(MessageCallback callback) { callback_ = callback; }
+
+    // Queues a message. Returns false, dropping it, if the client is not
+    // connected or the message does not fit the buffer.
+    bool publish(const char* topic, const char* payload, bool retain = false);
+
+    // Connects, sends and receives. `now_ms` is a monotonic time. Must be
+    // called often; only blocks while opening a connection.
+    void loop(uint32_t now_ms);
+
+    // Returns whether the broker accepted the connection.
+    bool connected() const { return state_ == State::CONNECTED; }
+    // Number of connections the broker accepted.
+    uint32_t connections() const { return connections_; }
+    // Number of messages dropped because the buffer was full.
+    uint32_t dropped() const { return dropped_; }
+
+  private:
+    // Connection states.
+    enum class State {
+        // No broker set.
+        DISABLED,
+        // Waiting for the next connection attempt.
+        DISCONNECTED,
+        // Waiting for the broker to accept the connection.
+        CONNECTING,
+        CONNECTED,
+    };
+
+    // Opens a connection and sends the CONNECT packet.
+    void connect_(uint32_t now_ms);
+    // Closes the connection and schedules the next attempt.
+    void disconnect_(uint32_t now_ms);
+    // Sends the subscriptions and the status, once connected.
+    void start_();
+    // Queues a packet of `type`, built from `parts` of the given sizes, each
+    // prefixed with its 16-bit length where `prefixed` is set.
+    bool queue_(uint8_t type, const uint8_t* const* parts, const size_t* sizes,
+                const bool* prefixed, int count);
+    // Sends as much of the queued packets as the connection takes. Returns
+    // false on failure.
+    bool flush_();
+    // Reads and processes incoming packets. Returns false on failure.
+    bool receive_(uint32_t now_ms);
+    // Processes a complete packet.
+    bool process_(uint8_t type, const uint8_t* body, size_t size);
+
+    MqttTransport* transport_;
+    MessageCallback callback_;
+
+    const char* host_ = "";
+    uint16_t port_ = 0;
+    const char* client_id_ = "";
+    const char* user_ = "";
+    const char* password_ = "";
+    const char* status_topic_ = nullptr;
+    const char* subscriptions_[MQTT_MAX_SUBSCRIPTIONS];
+    int subscription_count_ = 0;
+
+    State state_ = State::DISABLED;
+    // When the current state was entered, in milliseconds.
+    uint32_t state_ms_ = 0;
+    // Wait before the next connection attempt, and before the one after if
+    // it fails, in milliseconds.
+    uint32_t retry_ms_ = 0;
+    uint32_t backoff_ms_ = MQTT_MIN_BACKOFF_MS;
+    // When a packet was last sent and received, in milliseconds.
+    uint32_t sent_ms_ = 0;
+    uint32_t received_ms_ = 0;
+    // Identifier of the next SUBSCRIBE packet.
+    uint16_t packet_id_ = 1;
+
+    uint8_t out_[MQTT_BUFFER_SIZE];
+    size_t out_length_ = 0;
+    // Incoming bytes, with room to NUL-terminate a payload, and the number of
+    // bytes still to skip of a packet that does not fit.
+    uint8_t in_[MQTT_BUFFER_SIZE + 1];
+    size_t in_length_ = 0;
+    size_t skip_ = 0;
+
+    uint32_t connections_ = 0;
+    uint32_t dropped_ = 0;
+};
+
+#endif  // WORDCLOCK_MQTT_CLIENT_H_
@@ -0,0 +1,46 @@
+#include "mqtt_system.h"
+
+#include "logging.h"
+
+#include <lwip/sockets.h>
+
+bool WiFiMqttTransport::connect(const char* host, uint16_t port) {
+    if (!client_.connect(host, port, MQTT_CONNECT_TIMEOUT_MS)) {
+        LOGW("Cannot connect to the MQTT broker.");
+        return false;
+    }
+    // Packets are queued whole, so Nagle's algorithm only adds latency.
+    client_.setNoDelay(true);
+    return true;
+}
+
+bool WiFiMqttTransport::connected() {
+    return client_.connected();
+}
+
+int WiFiMqttTransport::write(const uint8_t* data, size_t size) {
+    const int sent = send(client_.fd(), data, size, MSG_DONTWAIT);
+    if (sent >= 0) return sent;
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+int WiFiMqttTransport::read(uint8_t* data, size_t size) {
+    if (size == 0 || client_.available() <= 0) return 0;
+    const int read = client_.read(data, size);
+    return read > 0 ? read : 0;
+}
+
+void WiFiMqttTransport::stop() {
+    client_.stop();
+}
+
+void MqttMetric::writeTo(Print& out) const {
+    out.printf("# TYPE wordclock_mqtt_connected gauge\n"
+               "wordclock_mqtt_connected %d\n"
+               "# TYPE wordclock_mqtt_connections_total counter\n"
+               "wordclock_mqtt_connections_total %u\n"
+               "# TYPE wordclock_mqtt_dropped_total counter\n"
+               "wordclock_mqtt_dropped_total %u\n",
+               client_->connected() ? 1 : 0, client_->connections(),
+               client_->dropped());
+}
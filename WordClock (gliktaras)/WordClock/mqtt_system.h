@@ -0,0 +1,42 @@
+#ifndef WORDCLOCK_MQTT_SYSTEM_H_
+#define WORDCLOCK_MQTT_SYSTEM_H_
+
+#include "metrics.h"
+#include "mqtt_client.h"
+
+#include <WiFi.h>
+
+// Time allowed to open a connection to the broker, in milliseconds. The
+// network task is blocked meanwhile.
+#define MQTT_CONNECT_TIMEOUT_MS 1000
+
+// Carries MQTT over a WiFi TCP connection.
+//
+// Writes go straight to the socket without blocking, so that a broker that
+// stops reading fills the client's buffer instead of stalling the network
+// task.
+class WiFiMqttTransport : public MqttTransport {
+  public:
+    bool connect(const char* host, uint16_t port) override;
+    bool connected() override;
+    int write(const uint8_t* data, size_t size) override;
+    int read(uint8_t* data, size_t size) override;
+    void stop() override;
+
+  private:
+    WiFiClient client_;
+};
+
+// Publishes the state of an MQTT client on /metrics.
+class MqttMetric : public metrics::Metric {
+  public:
+    explicit MqttMetric(const MqttClient* client)
+        : Metric("wordclock_mqtt", "MQTT client state."), client_(client) {}
+
+    void writeTo(Print& out) const override;
+
+  private:
+    const MqttClient* client_;
+};
+
+#endif  // WORDCLOCK_MQTT_SYSTEM_H_
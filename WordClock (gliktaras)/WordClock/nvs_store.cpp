@@ -0,0 +1,29 @@
+#include "nvs_store.h"
+
+#include <Preferences.h>
+
+size_t NvsKeyValueStore::size(const char* key) {
+    Preferences preferences;
+    if (!preferences.begin(name_, true)) return 0;
+    const size_t length = preferences.getBytesLength(key);
+    preferences.end();
+    return length;
+}
+
+bool NvsKeyValueStore::read(const char* key, void* data, size_t size) {
+    Preferences preferences;
+    if (!preferences.begin(name_, true)) return false;
+    const bool ok = preferences.getBytesLength(key) == size &&
+                    preferences.getBytes(key, data, size) == size;
+    preferences.end();
+    return ok;
+}
+
+bool NvsKeyValueStore::write(const char* key, const void* data, size_t size) {
+    Preferences preferences;
+    if (!preferences.begin(name_, false)) return false;
+    // Commits before returning.
+    const bool ok = preferences.putBytes(key, data, size) == size;
+    preferences.end();
+    return ok;
+}
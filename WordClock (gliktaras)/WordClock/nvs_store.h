@@ -0,0 +1,26 @@
+#ifndef WORDCLOCK_NVS_STORE_H_
+#define WORDCLOCK_NVS_STORE_H_
+
+#include "config_store.h"
+
+// Key value store in a namespace of the NVS partition.
+//
+// NVS writes a new copy of an entry before erasing the old one, which makes
+// every write atomic.
+class NvsKeyValueStore : public KeyValueStore {
+  public:
+    explicit NvsKeyValueStore(const char* name) : name_(name) {}
+
+    NvsKeyValueStore(const NvsKeyValueStore&) = delete;
+    NvsKeyValueStore& operator=(const NvsKeyValueStore&) = delete;
+
+    size_t size(const char* key) override;
+    bool read(const char* key, void* data, size_t size) override;
+    bool write(const char* key, const void* data, size_t size) override;
+
+  private:
+    // NVS namespace.
+    const char* name_;
+};
+
+#endif  // WORDCLOCK_NVS_STORE_H_
@@ -0,0 +1,365 @@
+#ifndef WORDCLOCK_PORTAL_ASSETS_H_
+#define WORDCLOCK_PORTAL_ASSETS_H_
+
+// This file was generated by tools/portal_gen.py from portal/. Do not edit it
+// by hand.
+
+#include <Arduino.h>
+
+// Number of assets.
+#define PORTAL_ASSET_COUNT 4
+
+// URLs to refer to the assets by, which change with their content.
+#define PORTAL_URL_LOGO_SVG "/static/logo.svg?v=a2a1fd915e14288b"
+#define PORTAL_URL_PORTAL_CSS "/static/portal.css?v=7e5241e3b7bc451f"
+#define PORTAL_URL_PORTAL_JS "/static/portal.js?v=5117b5cd903bf646"
+#define PORTAL_URL_PREVIEW_HTML "/static/preview.html?v=86842797d95d1804"
+
+namespace portal {
+
+// A static file of the configuration portal.
+struct Asset {
+    // Path the asset is served at.
+    const char* path;
+    const char* content_type;
+    // Strong ETag, quoted.
+    const char* etag;
+    // Content, gzip-compressed.
+    const uint8_t* data;
+    size_t size;
+};
+
+namespace data {
+
+// logo.svg, 2923 bytes uncompressed.
+const uint8_t logo_svg[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xd5, 0x56, 0x4d, 0x6f, 0xdc, 0x36,
+    0x10, 0xbd, 0xf7, 0x57, 0x10, 0xe8, 0x41, 0x27, 0x72, 0x39, 0xc3, 0xe1, 0x57, 0xe0, 0xf5, 0xa1,
+    0xed, 0xa1, 0x40, 0x53, 0x14, 0xe8, 0xa5, 0x67, 0xc7, 0xb5, 0x2d, 0x03, 0x72, 0x13, 0x39, 0x0b,
+    0x6d, 0xea, 0x5f, 0xdf, 0x37, 0xa4, 0xec, 0xec, 0xae, 0x1d, 0xc0, 0x49, 0x4f, 0x39, 0xec, 0x62,
+    0x48, 0x0d, 0xe7, 0xe3, 0xf1, 0xcd, 0x93, 0xce, 0x3e, 0x2e, 0x37, 0xe6, 0xd3, 0xdd, 0xf4, 0xcf,
+    0xc7, 0xed, 0x30, 0xee, 0x76, 0x1f, 0xde, 0x6c, 0x36, 0xfb, 0xfd, 0xde, 0xed, 0x83, 0x7b, 0x7f,
+    0x7f, 0xb3, 0x61, 0xef, 0xfd, 0x06, 0x1e, 0x83, 0x59, 0x6e, 0xaf, 0xf6, 0x3f, 0xbd, 0xff, 0xb4,
+    0x1d, 0xbc, 0xf1, 0x46, 0x4a, 0xfb, 0x0d, 0xe7, 0x67, 0x1f, 0x2e, 0x76, 0xa3, 0xf9, 0x7b, 0x3b,
+    0xfc, 0x8e, 0xed, 0x11, 0x5b, 0x0b, 0x7e, 0xbf, 0xfa, 0x87, 0x61, 0x73, 0x7e, 0x76, 0x63, 0xae,
+    0x6f, 0xa7, 0x69, 0x3b, 0xfc, 0x78, 0x7d, 0x7d, 0x7d, 0xe8, 0x49, 0xd1, 0xbb, 0x54, 0xd9, 0x50,
+    0x0a, 0x4e, 0x88, 0x46, 0x9b, 0x5c, 0x4c, 0x61, 0xb2, 0x44, 0x2e, 0x32, 0xdb, 0x50, 0x1c, 0x0b,
+    0xcf, 0xd6, 0x15, 0xb6, 0xec, 0xa2, 0x58, 0x72, 0x25, 0x24, 0x38, 0x89, 0x4f, 0xb0, 0x3d, 0x25,
+    0x1b, 0x5c, 0x49, 0x59, 0xed, 0x18, 0xad, 0xb8, 0x24, 0x15, 0xce, 0xc9, 0x44, 0x47, 0x31, 0xe3,
+    0x48, 0x0e, 0xd1, 0x20, 0x16, 0xd7, 0xb7, 0x44, 0xd1, 0x15, 0x5a, 0x13, 0x7d, 0xce, 0x03, 0xc7,
+    0x1a, 0x6d, 0xcc, 0x8e, 0x7c, 0x1d, 0xb3, 0xf3, 0x81, 0xa6, 0xea, 0x3c, 0x8b, 0x09, 0xd1, 0x71,
+    0x0e, 0x33, 0x12, 0xe6, 0x68, 0xb2, 0x13, 0x66, 0xa3, 0xe1, 0xc4, 0x10, 0x02, 0x84, 0x62, 0x7a,
+    0x46, 0x9c, 0x93, 0x62, 0x82, 0x23, 0x8e, 0x16, 0x0f, 0x6a, 0x91, 0x89, 0xbc, 0xe3, 0x20, 0x36,
+    0x88, 0xcb, 0x9c, 0xd7, 0x90, 0xd8, 0xcb, 0xc2, 0x1a, 0xd3, 0xcb, 0x1a, 0x32, 0xe1, 0xbc, 0xe8,
+    0xc9, 0xd4, 0x42, 0xa6, 0x4c, 0xea, 0x62, 0x23, 0xba, 0xcc, 0xc8, 0x54, 0x28, 0x68, 0xc0, 0x48,
+    0x69, 0x2a, 0x1a, 0xd6, 0x86, 0x56, 0x69, 0x8f, 0xf7, 0x30, 0x98, 0x8b, 0xfb, 0xdb, 0x0b, 0x3b,
+    0x5d, 0xbc, 0xbb, 0x02, 0xa8, 0x7f, 0x29, 0xc2, 0x4f, 0x90, 0x72, 0x2a, 0x88, 0x96, 0x11, 0x14,
+    0x15, 0x50, 0x99, 0xbd, 0x86, 0xcf, 0x44, 0x68, 0xb9, 0x22, 0x23, 0x03, 0xd9, 0xc4, 0xba, 0x20,
+    0x41, 0x5f, 0x25, 0xb2, 0xa5, 0xea, 0x38, 0x96, 0xc7, 0x05, 0xbb, 0x44, 0xd9, 0x78, 0xdd, 0x95,
+    0xca, 0xe8, 0x30, 0x01, 0xa0, 0x04, 0xdc, 0xb5, 0x5b, 0xe0, 0xb9, 0xda, 0x88, 0x93, 0x6b, 0xf3,
+    0x43, 0xdb, 0xa2, 0xfd, 0xa0, 0x2b, 0xdd, 0x4d, 0x9e, 0xd7, 0x85, 0x1e, 0x4d, 0x06, 0x71, 0x62,
+    0x78, 0xb4, 0xd9, 0x05, 0x9f, 0x40, 0x1a, 0x4d, 0xc9, 0x9a, 0x91, 0xc2, 0xae, 0x97, 0xd2, 0xeb,
+    0x7a, 0xb8, 0xb3, 0x02, 0x08, 0x7c, 0x31, 0x5e, 0x0b, 0xef, 0xd1, 0xc4, 0x55, 0xc6, 0xcd, 0xe5,
+    0x56, 0x18, 0x16, 0x89, 0x70, 0xbf, 0x55, 0x5b, 0x14, 0x17, 0x00, 0x65, 0x5f, 0x68, 0xb9, 0x41,
+    0x43, 0x63, 0x13, 0x1c, 0x69, 0x9b, 0x3b, 0x71, 0x45, 0xc0, 0x9a, 0x76, 0x74, 0xf6, 0x9d, 0x56,
+    0xc1, 0x3e, 0xed, 0x4a, 0x52, 0xdb, 0x4b, 0xf7, 0xb6, 0x38, 0x0a, 0x20, 0xd6, 0x45, 0x6b, 0x5f,
+    0xfb, 0x13, 0x27, 0x31, 0xe8, 0x7d, 0x91, 0x32, 0xac, 0xa2, 0xee, 0xee, 0xd0, 0x6d, 0x6a, 0xdc,
+    0x38, 0xb9, 0x91, 0x3f, 0x8e, 0x6e, 0x84, 0xa2, 0x38, 0x02, 0x11, 0x59, 0x04, 0x17, 0x2a, 0x73,
+    0xab, 0x91, 0x64, 0xc5, 0x44, 0x21, 0x6b, 0x76, 0x4c, 0xca, 0x33, 0xdc, 0x0d, 0xb3, 0xf3, 0xb9,
+    0xdb, 0xa3, 0x32, 0xb4, 0xf0, 0xd2, 0x18, 0x4a, 0x23, 0x92, 0xc5, 0x19, 0x80, 0x07, 0x14, 0x66,
+    0x18, 0xa4, 0xf2, 0x01, 0x7e, 0xa1, 0x84, 0x5d, 0xfb, 0xd7, 0xad, 0xc4, 0x11, 0x20, 0x2a, 0x4d,
+    0x58, 0x79, 0xd8, 0x9b, 0xa6, 0xac, 0xcc, 0x4a, 0x4a, 0xd2, 0xd4, 0x26, 0x08, 0x18, 0x17, 0xfd,
+    0x4f, 0x48, 0x8d, 0xad, 0x24, 0xdd, 0x1e, 0xd1, 0x75, 0x8a, 0x8b, 0x34, 0xdf, 0xb1, 0x38, 0x5f,
+    0xf2, 0x4c, 0x9d, 0xaf, 0x5e, 0x3b, 0x55, 0x82, 0x68, 0x3d, 0x0d, 0x01, 0x3d, 0xdf, 0x46, 0x4d,
+    0x4d, 0x3c, 0x0c, 0x3e, 0x9e, 0xc0, 0xf0, 0xcb, 0x11, 0x0c, 0x21, 0x54, 0xd7, 0xe6, 0x47, 0x73,
+    0x94, 0x85, 0xc1, 0xca, 0xa8, 0x83, 0x98, 0x84, 0x96, 0xc7, 0x09, 0xa4, 0x56, 0xc6, 0x8c, 0x79,
+    0x69, 0x1c, 0x30, 0xd4, 0xc9, 0x20, 0x18, 0xc9, 0x80, 0x4c, 0x3e, 0xd4, 0x66, 0xcb, 0x6a, 0x83,
+    0x4f, 0x44, 0xa6, 0x11, 0x25, 0x70, 0xd6, 0x4e, 0xa5, 0x88, 0x1e, 0x0a, 0x84, 0xa1, 0xeb, 0x67,
+    0x79, 0xed, 0xac, 0x55, 0x3f, 0x29, 0x5d, 0x0b, 0x17, 0xdb, 0xb2, 0x3f, 0xdc, 0x79, 0xf4, 0x00,
+    0x10, 0xc7, 0x8a, 0xec, 0x34, 0xb7, 0xe1, 0xd2, 0x70, 0x1e, 0x01, 0x54, 0x71, 0x72, 0x0e, 0x18,
+    0x51, 0x2e, 0x64, 0xdb, 0x44, 0xae, 0x76, 0x71, 0xa1, 0x56, 0xe3, 0x57, 0xf8, 0x70, 0x1b, 0x09,
+    0x5b, 0xd4, 0xcd, 0xa6, 0x53, 0x56, 0xe7, 0xdd, 0x37, 0x73, 0xc4, 0xa3, 0x14, 0xc2, 0x09, 0x30,
+    0x7f, 0x1e, 0x4f, 0xac, 0x52, 0x1e, 0x0c, 0x66, 0x4c, 0x45, 0x81, 0xe6, 0x28, 0xf5, 0x30, 0x11,
+    0x8d, 0x7a, 0xa5, 0x28, 0xf5, 0xb8, 0x54, 0x64, 0x93, 0x66, 0xc6, 0x6e, 0x51, 0x97, 0x9e, 0xd6,
+    0x3b, 0x93, 0x4e, 0x04, 0xab, 0xd6, 0xe1, 0x1a, 0x44, 0xd1, 0x81, 0x76, 0x29, 0x65, 0xab, 0xa2,
+    0xb1, 0x1a, 0xed, 0xa2, 0x4c, 0x93, 0x03, 0x54, 0x84, 0xe2, 0x48, 0xea, 0xa2, 0xb7, 0x39, 0x2b,
+    0xe3, 0x21, 0x69, 0x20, 0x0c, 0xb7, 0x21, 0x48, 0xf2, 0xb4, 0x78, 0xae, 0x06, 0x31, 0xd9, 0xce,
+    0xa1, 0x43, 0x5b, 0xd5, 0x00, 0x12, 0xe2, 0xd1, 0x2d, 0xd0, 0x5d, 0x71, 0xc2, 0x05, 0x48, 0xaa,
+    0xa6, 0xa1, 0xa2, 0xd7, 0x6c, 0x54, 0x09, 0xc8, 0x76, 0x81, 0xec, 0xad, 0x40, 0xe1, 0xb4, 0x44,
+    0xa4, 0x2c, 0x65, 0x5d, 0xa8, 0xdc, 0xc5, 0x7e, 0xf5, 0x4a, 0x6f, 0x0d, 0x85, 0x6b, 0x53, 0xfc,
+    0x95, 0x76, 0xd8, 0x9a, 0x55, 0xff, 0x8b, 0x9e, 0xf5, 0xd2, 0x2a, 0xac, 0xb9, 0xdb, 0x27, 0x20,
+    0xff, 0x7c, 0x32, 0x84, 0x38, 0xa5, 0xb2, 0x8e, 0xb1, 0x3d, 0xd6, 0xc4, 0xf0, 0x4d, 0x9a, 0xf8,
+    0x19, 0x05, 0xbc, 0x14, 0x0e, 0x50, 0x78, 0x85, 0x26, 0xc6, 0xae, 0x89, 0xf4, 0xb8, 0x50, 0x51,
+    0x8c, 0xab, 0x28, 0x52, 0xfd, 0x1a, 0x55, 0xe4, 0x43, 0x55, 0xfc, 0x92, 0x28, 0xf2, 0x57, 0x8b,
+    0x22, 0x35, 0x55, 0x8c, 0xaf, 0x54, 0xc5, 0xf4, 0x6d, 0xaa, 0x88, 0x7a, 0x00, 0x9d, 0x01, 0x51,
+    0x51, 0x47, 0x78, 0x52, 0x80, 0xae, 0x07, 0x91, 0x94, 0xb2, 0x23, 0xb7, 0x97, 0xde, 0xd2, 0xb2,
+    0x9c, 0x04, 0x7b, 0x7b, 0x1c, 0x0c, 0x51, 0x2a, 0x04, 0x14, 0x22, 0x88, 0x46, 0x73, 0x9b, 0x76,
+    0xc2, 0xfb, 0x1d, 0x82, 0xa8, 0x9f, 0x0e, 0xfd, 0x25, 0xd6, 0x07, 0x40, 0xc5, 0x81, 0x17, 0x68,
+    0x2c, 0x7c, 0xbb, 0xfc, 0x1c, 0xe5, 0x5e, 0x18, 0xe3, 0xcd, 0x13, 0x32, 0x97, 0x0a, 0x99, 0xd0,
+    0xc5, 0xb8, 0x4a, 0x07, 0x2b, 0xd5, 0xa0, 0xe2, 0x8a, 0xcd, 0x49, 0x35, 0xbf, 0xbd, 0x38, 0xd0,
+    0x81, 0x75, 0xa0, 0x5f, 0x9a, 0xe7, 0x97, 0xc7, 0x39, 0xff, 0xcf, 0x71, 0x2e, 0xcf, 0xc6, 0x39,
+    0x1d, 0x8e, 0x73, 0xfa, 0xfe, 0xc7, 0x79, 0x73, 0xf3, 0xec, 0x5b, 0xf2, 0xf2, 0xf6, 0xfe, 0x72,
+    0xba, 0x32, 0x97, 0xf8, 0x1c, 0x0d, 0x18, 0xc6, 0x12, 0x07, 0x73, 0xf9, 0x6f, 0xb3, 0x6b, 0x2a,
+    0x83, 0xb9, 0xdf, 0x0e, 0xb0, 0x7c, 0xd2, 0xd3, 0x07, 0xae, 0x82, 0xb7, 0x50, 0x2d, 0xab, 0x6b,
+    0xd1, 0x74, 0x5f, 0x74, 0x3d, 0x8c, 0x2a, 0xa2, 0x5f, 0x72, 0xaf, 0x8a, 0xaa, 0xae, 0x85, 0x8f,
+    0x5d, 0xb5, 0x7c, 0xfd, 0x84, 0x3e, 0xff, 0xe1, 0x3f, 0x18, 0xdb, 0x17, 0xb8, 0x6b, 0x0b, 0x00,
+    0x00,
+};
+
+// portal.css, 1805 bytes uncompressed.
+const uint8_t portal_css[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x55, 0x51, 0x6f, 0x9b, 0x30,
+    0x10, 0x7e, 0xcf, 0xaf, 0xb0, 0x52, 0x4d, 0xea, 0xb4, 0xba, 0x82, 0x34, 0x6d, 0x27, 0xaa, 0xed,
+    0x65, 0xef, 0xfb, 0x03, 0xd3, 0x1e, 0x0c, 0x3e, 0x88, 0x55, 0x63, 0x23, 0xdb, 0x84, 0xa4, 0xd3,
+    0xfe, 0xfb, 0xec, 0xb3, 0x49, 0x08, 0xa1, 0xea, 0x12, 0x01, 0xc2, 0x3e, 0xdf, 0x7d, 0xf7, 0xdd,
+    0x7d, 0x47, 0xa9, 0xf9, 0x91, 0xfc, 0x59, 0x11, 0x52, 0x69, 0xa9, 0x4d, 0x41, 0x6e, 0x00, 0xe0,
+    0xc5, 0xbf, 0xb6, 0xcc, 0x34, 0x42, 0x15, 0x24, 0x0b, 0x2f, 0x25, 0xab, 0x5e, 0x1b, 0xa3, 0x7b,
+    0xc5, 0xbd, 0x41, 0xbe, 0x09, 0xff, 0xb0, 0x5c, 0x6b, 0xe5, 0x0a, 0x92, 0x67, 0xd9, 0x27, 0x62,
+    0x8f, 0xd6, 0x41, 0x4b, 0x7b, 0xf1, 0xb2, 0xfa, 0xbb, 0x5a, 0xb1, 0x0b, 0x8f, 0xf9, 0x13, 0xcb,
+    0xe1, 0x19, 0x37, 0xb8, 0xd8, 0xe3, 0x56, 0xc7, 0x38, 0x17, 0xaa, 0x41, 0xf7, 0x7e, 0xf9, 0x5e,
+    0xea, 0x46, 0xe3, 0xc6, 0x20, 0xb8, 0xdb, 0x15, 0xe4, 0x6b, 0xb6, 0x1f, 0x22, 0x8a, 0x03, 0x4d,
+    0x4b, 0xf9, 0x53, 0xd6, 0x1d, 0xc2, 0x1a, 0x17, 0xb6, 0x93, 0xec, 0x58, 0x90, 0x52, 0xea, 0xea,
+    0x15, 0xad, 0xc4, 0x81, 0x96, 0x12, 0x14, 0xa7, 0xad, 0xe6, 0x50, 0x90, 0xb6, 0x97, 0x4e, 0x74,
+    0xf2, 0x78, 0xf6, 0xfd, 0xc3, 0x23, 0x65, 0x42, 0x81, 0xc1, 0x20, 0xd3, 0x74, 0x86, 0x9d, 0x70,
+    0x98, 0xb0, 0x33, 0x4c, 0x59, 0xe1, 0x84, 0xf6, 0x49, 0x9f, 0x0d, 0xc8, 0x83, 0xbd, 0x88, 0x29,
+    0x94, 0xf4, 0x6e, 0xe8, 0x39, 0x74, 0xa2, 0x69, 0xeb, 0xc1, 0x11, 0xd6, 0x3b, 0xfd, 0xf2, 0x4e,
+    0x76, 0x27, 0x04, 0x77, 0xa4, 0x16, 0x20, 0xb9, 0x05, 0x17, 0xb1, 0xe8, 0x03, 0xb5, 0x3b, 0xc6,
+    0xf5, 0xe0, 0xcd, 0xbd, 0x8f, 0x70, 0xe5, 0x8f, 0xe1, 0xe6, 0xaf, 0x9b, 0x1a, 0x7f, 0xcf, 0x3c,
+    0xfa, 0xe9, 0x06, 0xa7, 0x9b, 0x46, 0xc2, 0x8c, 0x42, 0xf2, 0x18, 0x89, 0xe9, 0xf4, 0x88, 0x9f,
+    0x95, 0x56, 0xcb, 0x3e, 0xe6, 0x65, 0x44, 0xb3, 0xf3, 0x55, 0x7a, 0x88, 0x36, 0x4e, 0x77, 0x11,
+    0x2c, 0x96, 0x55, 0x1b, 0x0e, 0xbe, 0x42, 0x4a, 0x2b, 0x98, 0x97, 0x19, 0xe9, 0xe8, 0x98, 0x01,
+    0xe5, 0xc2, 0xd6, 0x0e, 0x92, 0x9b, 0x6d, 0x3c, 0xaa, 0x7b, 0x17, 0x88, 0x18, 0xcf, 0x7a, 0x74,
+    0x17, 0x59, 0x9d, 0xc0, 0x6d, 0x4f, 0xf9, 0x6c, 0x52, 0xd0, 0xc8, 0x18, 0x2d, 0xb5, 0x73, 0xba,
+    0xfd, 0x3f, 0x2c, 0xa5, 0x64, 0x91, 0xed, 0x68, 0x44, 0x0d, 0xe3, 0xa2, 0xb7, 0xa9, 0x37, 0xcf,
+    0x59, 0x1b, 0x90, 0xcc, 0x89, 0x3d, 0x1e, 0x4f, 0x4d, 0x53, 0x31, 0x59, 0xdd, 0xfa, 0x06, 0xdd,
+    0x0f, 0x84, 0x86, 0x46, 0xed, 0x0e, 0x9f, 0x67, 0x6d, 0xb5, 0x8d, 0x00, 0xa6, 0x09, 0x7c, 0x27,
+    0xa7, 0x36, 0x5d, 0xf4, 0x7d, 0x21, 0x8d, 0x69, 0xad, 0x27, 0x7d, 0x52, 0x4b, 0xc0, 0xb4, 0xc2,
+    0x93, 0x72, 0x61, 0xa0, 0x8a, 0x7e, 0xbc, 0x26, 0xfa, 0x56, 0x61, 0x3c, 0xa1, 0xba, 0xde, 0xdd,
+    0x11, 0x0b, 0xd2, 0x6f, 0x62, 0xb8, 0x65, 0xc7, 0xa9, 0xba, 0x09, 0xef, 0xd8, 0x63, 0xd8, 0x86,
+    0x63, 0x55, 0x36, 0x63, 0x0e, 0xe8, 0xf3, 0x97, 0x3b, 0x76, 0xf0, 0x6d, 0xed, 0x0b, 0xd8, 0xc0,
+    0xfa, 0xf7, 0xc4, 0x33, 0x95, 0x50, 0x87, 0x1a, 0x66, 0xf3, 0x7e, 0x99, 0x66, 0x37, 0x6b, 0xde,
+    0x05, 0x8f, 0x45, 0x09, 0xb5, 0x36, 0x90, 0x34, 0xae, 0x1c, 0x84, 0x29, 0xc0, 0x9c, 0x33, 0xb7,
+    0x9c, 0x39, 0x46, 0x25, 0x2b, 0x41, 0x22, 0xcd, 0xb3, 0x91, 0xb2, 0xdc, 0x9f, 0x11, 0x13, 0x7d,
+    0x98, 0xab, 0x3b, 0x2a, 0x6d, 0x92, 0xf9, 0x26, 0x11, 0xb1, 0x9c, 0x39, 0x46, 0xbd, 0x60, 0x11,
+    0xbb, 0x2e, 0x89, 0x23, 0xa8, 0xc7, 0xbd, 0x49, 0x61, 0x1d, 0x29, 0x7b, 0xdf, 0x78, 0x0a, 0x2d,
+    0xaf, 0x27, 0xc9, 0x38, 0x6b, 0xfc, 0x48, 0x43, 0xb5, 0xc0, 0xc1, 0x51, 0x26, 0x45, 0xe3, 0xdd,
+    0x05, 0x9c, 0xa7, 0x35, 0x54, 0x87, 0x27, 0xa1, 0x9d, 0x08, 0x40, 0x42, 0xe3, 0x47, 0xd0, 0x59,
+    0xde, 0x45, 0x2d, 0x8c, 0x75, 0xb4, 0xda, 0x09, 0xc9, 0x0b, 0x56, 0xbb, 0x34, 0x7c, 0xc2, 0xd0,
+    0xa4, 0x43, 0x82, 0x2f, 0xc3, 0x03, 0xcc, 0x75, 0x23, 0xa1, 0x95, 0x15, 0x6f, 0x5e, 0x61, 0xf9,
+    0xfd, 0x06, 0xda, 0x39, 0x9a, 0xca, 0x93, 0x9e, 0xce, 0x2d, 0xb2, 0x8a, 0x3a, 0xcf, 0x1f, 0xdf,
+    0x9b, 0x98, 0x91, 0xf4, 0x6c, 0x32, 0x1f, 0xb2, 0xa5, 0xdc, 0xfa, 0xae, 0x03, 0x53, 0x31, 0x7b,
+    0xa9, 0xf0, 0x77, 0x12, 0x3b, 0xb5, 0xc2, 0xfa, 0x27, 0xb8, 0x41, 0x9b, 0xd7, 0x35, 0x9e, 0x9a,
+    0xf0, 0xbd, 0x24, 0xdf, 0x0f, 0x42, 0xfa, 0x35, 0xf2, 0x85, 0x5c, 0x7d, 0x36, 0x36, 0x38, 0x2a,
+    0x53, 0x89, 0x63, 0x98, 0xf0, 0x1d, 0x8b, 0xca, 0xc5, 0x7b, 0x21, 0xd9, 0x88, 0x71, 0xaa, 0x00,
+    0xe4, 0x85, 0x8e, 0xb3, 0xa8, 0x96, 0x9a, 0x79, 0xc0, 0x48, 0x41, 0xf0, 0xf2, 0x0f, 0x8e, 0x88,
+    0x4b, 0x12, 0x0d, 0x07, 0x00, 0x00,
+};
+
+// portal.js, 4644 bytes uncompressed.
+const uint8_t portal_js[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xad, 0x18, 0x6b, 0x6f, 0xdb, 0x36,
+    0xf0, 0xaf, 0x38, 0x2c, 0x10, 0x48, 0xb3, 0xab, 0x3a, 0xdd, 0x3e, 0x0c, 0xd1, 0xb4, 0x20, 0x4b,
+    0x33, 0x24, 0x40, 0x5f, 0x68, 0x32, 0x0c, 0x58, 0x5a, 0x14, 0xb2, 0x74, 0xb6, 0xd9, 0xd2, 0xa4,
+    0x2a, 0x51, 0x4e, 0xd3, 0xc4, 0xff, 0x7d, 0x77, 0x3c, 0x4a, 0x96, 0x5f, 0x71, 0x06, 0xec, 0x8b,
+    0x25, 0xdd, 0xfb, 0xcd, 0xa3, 0x45, 0x5d, 0x41, 0xaf, 0xb2, 0xa5, 0xcc, 0xac, 0x88, 0xc7, 0xb5,
+    0xce, 0xac, 0x34, 0xba, 0x57, 0x82, 0x4a, 0x47, 0xa0, 0x82, 0xf0, 0x7e, 0x9e, 0x96, 0x3d, 0xf7,
+    0x9e, 0xe4, 0x26, 0xab, 0x67, 0xa0, 0x6d, 0xf4, 0xad, 0x86, 0xf2, 0xee, 0x0a, 0x14, 0x64, 0xd6,
+    0x94, 0x81, 0x70, 0xd8, 0x9b, 0xb1, 0x29, 0x13, 0x79, 0x9b, 0x5d, 0x4f, 0xa5, 0x9e, 0xbc, 0x4d,
+    0x67, 0xf0, 0x49, 0x84, 0xb1, 0x1c, 0x07, 0x0e, 0x19, 0xba, 0xdf, 0x48, 0x6a, 0x0d, 0xe5, 0x35,
+    0x7c, 0xb7, 0x89, 0x38, 0x53, 0x26, 0xfb, 0xda, 0xd3, 0x48, 0x27, 0xe2, 0xff, 0x20, 0xfd, 0xb4,
+    0x78, 0x9f, 0x56, 0xd5, 0xad, 0x29, 0xf3, 0xc7, 0xc5, 0x9f, 0xbe, 0xef, 0x15, 0x9e, 0xb0, 0x17,
+    0x28, 0x33, 0x91, 0xfa, 0xb8, 0x97, 0xe6, 0x33, 0xa9, 0x43, 0x11, 0x2f, 0x5a, 0x27, 0xd3, 0x3c,
+    0x6f, 0xc4, 0x5d, 0x9b, 0xc9, 0x44, 0x41, 0xe5, 0xfd, 0xbd, 0xb8, 0x7c, 0xf5, 0xea, 0xfc, 0x6d,
+    0x22, 0x3e, 0xd6, 0xf9, 0xaf, 0x3f, 0xe7, 0xf8, 0x9b, 0xfd, 0x72, 0xf4, 0xb1, 0x1e, 0xc3, 0x70,
+    0x2c, 0x62, 0xc2, 0x5f, 0x5d, 0xbc, 0xfb, 0xbb, 0x8b, 0xce, 0x8f, 0x5e, 0x8a, 0x78, 0xbb, 0x03,
+    0xa7, 0x4a, 0x05, 0x42, 0xea, 0xa2, 0xb6, 0x37, 0xf6, 0xae, 0x80, 0xa4, 0x58, 0xda, 0x1f, 0xa1,
+    0x53, 0xe7, 0x69, 0x36, 0x0d, 0x1a, 0x83, 0x02, 0x47, 0xc7, 0x26, 0x58, 0x67, 0xd0, 0x32, 0x2a,
+    0x59, 0x09, 0xa9, 0x85, 0x73, 0x05, 0xf4, 0xe5, 0x25, 0x62, 0x08, 0x98, 0x2c, 0xca, 0x14, 0x8a,
+    0x7d, 0x2d, 0x2b, 0x1b, 0xa1, 0x4f, 0x81, 0x28, 0x6e, 0x19, 0xbe, 0x24, 0x70, 0xba, 0xc5, 0xa8,
+    0xb6, 0xd6, 0x68, 0xd1, 0x00, 0xe7, 0xa9, 0xaa, 0x21, 0x61, 0x67, 0x63, 0x27, 0x11, 0x63, 0x58,
+    0x41, 0x69, 0x4f, 0xf3, 0x2f, 0x69, 0x86, 0x7a, 0x5a, 0x75, 0xe9, 0xd8, 0x42, 0x09, 0x3a, 0x17,
+    0x03, 0x66, 0x6d, 0xe5, 0x1a, 0x9d, 0x29, 0x99, 0x7d, 0x4d, 0x5a, 0x17, 0xd8, 0xfa, 0xa9, 0xcc,
+    0x73, 0xd0, 0x09, 0xcb, 0x74, 0xba, 0x93, 0x44, 0x34, 0xae, 0x8b, 0xb8, 0x03, 0x67, 0xca, 0x13,
+    0x61, 0x31, 0x6f, 0xe2, 0xb8, 0x43, 0xb3, 0x62, 0xa3, 0xa7, 0x72, 0x71, 0x3f, 0xf6, 0x06, 0x2f,
+    0xe2, 0x45, 0xd8, 0x49, 0x66, 0x2e, 0xab, 0x74, 0xa4, 0xe0, 0xaa, 0x1e, 0xcd, 0xa4, 0x7d, 0xa7,
+    0xaf, 0xd2, 0x39, 0x78, 0x63, 0x30, 0xcc, 0xb3, 0x9d, 0xe5, 0x45, 0x48, 0x2e, 0xa5, 0x03, 0x7a,
+    0x0d, 0x4b, 0xb0, 0x75, 0xa9, 0x63, 0x7a, 0xa7, 0x58, 0x9e, 0xcf, 0x91, 0x87, 0x02, 0x0b, 0x58,
+    0x5b, 0x81, 0xa8, 0x9c, 0x74, 0x31, 0x58, 0x73, 0x97, 0xe3, 0xba, 0x53, 0x07, 0xa3, 0x39, 0xff,
+    0x2c, 0x81, 0xaa, 0x97, 0xa1, 0xdd, 0xaa, 0x45, 0x9b, 0xb1, 0x79, 0xa2, 0x28, 0x12, 0x0d, 0x92,
+    0x83, 0x70, 0x6a, 0xb1, 0x3d, 0x11, 0x02, 0x81, 0xf0, 0x5e, 0x52, 0x22, 0xca, 0x1a, 0xd3, 0xb0,
+    0x12, 0x02, 0xb4, 0x97, 0x95, 0x52, 0x1d, 0xef, 0x2d, 0xc7, 0x3c, 0xb5, 0xe9, 0x73, 0x53, 0x10,
+    0x67, 0xb5, 0xaf, 0x1a, 0x39, 0x0b, 0x9c, 0x36, 0xf7, 0xee, 0xda, 0xc0, 0x33, 0x7b, 0xf8, 0x04,
+    0x6c, 0xd7, 0xd0, 0x8e, 0x74, 0x14, 0x5e, 0x15, 0x4a, 0x62, 0x1d, 0x3d, 0xa0, 0xdf, 0xc4, 0x59,
+    0x39, 0x73, 0x76, 0x56, 0x37, 0xa3, 0x91, 0x96, 0x5f, 0x22, 0x9a, 0x13, 0x5e, 0x0b, 0xbd, 0x36,
+    0x60, 0x99, 0x7b, 0xa0, 0xcc, 0x29, 0x81, 0x6c, 0x24, 0x16, 0x9a, 0x08, 0x3d, 0x41, 0x5a, 0x14,
+    0x58, 0xb4, 0x67, 0x53, 0xa9, 0xf2, 0x60, 0x97, 0x2e, 0xb6, 0x51, 0x84, 0x6c, 0xd8, 0xa4, 0x34,
+    0x75, 0x91, 0xe8, 0x5a, 0xa9, 0xd8, 0x1b, 0xbf, 0x19, 0x17, 0x46, 0x0c, 0xa4, 0xce, 0xe1, 0x3b,
+    0x87, 0xa7, 0x48, 0x4b, 0x5b, 0x25, 0x0c, 0x6f, 0x5c, 0x7d, 0xe1, 0x5d, 0xa5, 0xc2, 0xf6, 0x28,
+    0x32, 0xd2, 0x91, 0x46, 0x0a, 0xf4, 0xc4, 0x4e, 0x7f, 0x3f, 0x62, 0x76, 0xa7, 0xf4, 0xb5, 0x9b,
+    0x82, 0x8c, 0xae, 0xa6, 0x72, 0x6c, 0x03, 0xae, 0x4a, 0x87, 0x7c, 0x78, 0x70, 0x8f, 0xc8, 0x0d,
+    0xba, 0x83, 0x64, 0xc9, 0x10, 0xde, 0x23, 0x8d, 0xfb, 0xdc, 0xe6, 0x33, 0x23, 0x62, 0x76, 0xea,
+    0x91, 0x00, 0x38, 0x02, 0xe1, 0x09, 0x59, 0x49, 0x47, 0x47, 0xbc, 0x70, 0x3e, 0xb0, 0x69, 0x5f,
+    0x8c, 0xd4, 0x81, 0xe8, 0xbd, 0xe8, 0x21, 0xf9, 0x02, 0x14, 0x9e, 0x1d, 0xad, 0x01, 0xf7, 0xfb,
+    0x2c, 0x70, 0x61, 0x5d, 0x90, 0xc7, 0xc0, 0xca, 0x93, 0x7d, 0x49, 0x89, 0x3d, 0x61, 0xd4, 0x14,
+    0x20, 0x86, 0xbc, 0x85, 0x2d, 0x3b, 0x87, 0xec, 0xa3, 0x60, 0x39, 0x7c, 0x92, 0x38, 0xe2, 0xb0,
+    0x21, 0xdb, 0xe8, 0x21, 0x36, 0x13, 0x7b, 0x28, 0x8c, 0x03, 0x1f, 0x5d, 0x06, 0x85, 0x2b, 0xa6,
+    0x7b, 0x7e, 0xd7, 0x63, 0x4f, 0x08, 0x72, 0x53, 0x89, 0xfd, 0x44, 0x3c, 0x6f, 0x47, 0xdc, 0x8e,
+    0x71, 0x3a, 0x02, 0x2c, 0x2a, 0x18, 0x01, 0x9e, 0x4b, 0x62, 0xe0, 0x75, 0x7b, 0x0e, 0x8c, 0xf2,
+    0x92, 0x32, 0x2a, 0x61, 0x66, 0xe6, 0xc0, 0x7a, 0xb8, 0x1d, 0x37, 0x3a, 0xfe, 0x1f, 0xa3, 0xe1,
+    0x0a, 0xd2, 0x32, 0x9b, 0xc2, 0xd3, 0xdb, 0xbe, 0x72, 0x0c, 0xfb, 0xba, 0xbe, 0x2e, 0xd5, 0xee,
+    0xde, 0x66, 0x11, 0x6d, 0x3f, 0xd3, 0xc7, 0xde, 0xd3, 0xca, 0xed, 0x12, 0x38, 0x4c, 0x77, 0x12,
+    0xe6, 0x72, 0xde, 0xb4, 0x8d, 0x9c, 0x41, 0xc9, 0x0c, 0x48, 0x80, 0x2c, 0xc3, 0xe5, 0x72, 0x32,
+    0xc6, 0x3c, 0x07, 0xce, 0xbf, 0x41, 0x91, 0x4e, 0x00, 0x23, 0x88, 0x1f, 0x3a, 0x83, 0xf0, 0x7e,
+    0x0c, 0x16, 0x7d, 0x41, 0xbb, 0xfb, 0x0e, 0xdd, 0x17, 0x87, 0x44, 0x90, 0x88, 0x3e, 0x3d, 0xc2,
+    0xc8, 0x4e, 0x41, 0x2f, 0x3d, 0x2d, 0xa1, 0x2a, 0xb0, 0xc1, 0x91, 0x8d, 0x87, 0x7e, 0xaf, 0x01,
+    0x44, 0x5f, 0x2a, 0x1a, 0xed, 0x18, 0xea, 0x4d, 0x8e, 0x5a, 0x59, 0xd7, 0x73, 0x8d, 0xce, 0x83,
+    0x24, 0x61, 0x03, 0x9b, 0x93, 0x83, 0x7a, 0xd6, 0x69, 0x23, 0x47, 0xb9, 0x46, 0x2f, 0xae, 0xdf,
+    0xbc, 0xc6, 0xa9, 0x14, 0x33, 0x7b, 0xf4, 0x03, 0x33, 0xb6, 0x65, 0xac, 0x10, 0x78, 0xfb, 0x71,
+    0xb2, 0x16, 0x24, 0x7f, 0x8a, 0xb7, 0x27, 0xc8, 0xea, 0xd9, 0xbe, 0x71, 0xac, 0x90, 0x5c, 0x1e,
+    0x9b, 0x1e, 0xb5, 0xe5, 0xcc, 0xee, 0x4c, 0x76, 0xa6, 0xe7, 0x4e, 0xe3, 0xb4, 0x76, 0xe1, 0x4e,
+    0xce, 0xa6, 0x67, 0x0b, 0x86, 0x75, 0xdb, 0x82, 0x95, 0x35, 0xdd, 0x13, 0x50, 0x48, 0xfa, 0x47,
+    0xe1, 0x4f, 0x3e, 0x06, 0xf4, 0xf9, 0xb9, 0x92, 0x3f, 0xe0, 0x37, 0x0f, 0xb0, 0xc6, 0xa6, 0x8a,
+    0xdd, 0x9f, 0x61, 0x6f, 0xec, 0x77, 0x9e, 0xa8, 0xd6, 0x5c, 0x77, 0xa0, 0xce, 0x79, 0xfa, 0x86,
+    0xbe, 0xe9, 0x34, 0x75, 0x88, 0x2d, 0x6e, 0x3b, 0xa3, 0xbb, 0x3d, 0x46, 0x84, 0x61, 0xbc, 0x56,
+    0x5f, 0xfd, 0xa3, 0x65, 0x85, 0x6d, 0xf3, 0x94, 0x99, 0x16, 0xd4, 0x98, 0x3e, 0x60, 0x6c, 0x96,
+    0xef, 0x90, 0x26, 0x8a, 0x85, 0xc2, 0x21, 0x30, 0x35, 0x2a, 0x87, 0x12, 0x8f, 0x7a, 0x07, 0xeb,
+    0x65, 0xd2, 0xde, 0xf5, 0x4c, 0x89, 0x95, 0x37, 0xa1, 0x79, 0xd7, 0x90, 0xa6, 0xb5, 0x35, 0x99,
+    0x99, 0x15, 0x0a, 0x2c, 0xca, 0x31, 0x63, 0x5c, 0x3b, 0x9d, 0x56, 0xb7, 0xe6, 0xd1, 0x72, 0x9d,
+    0x08, 0xfb, 0x83, 0x20, 0x2b, 0xab, 0x94, 0xe0, 0x2d, 0x49, 0x3c, 0x75, 0x95, 0x23, 0x01, 0xe1,
+    0x53, 0x89, 0xd9, 0x32, 0x8c, 0x4d, 0xdb, 0x61, 0xe2, 0x44, 0x62, 0x63, 0x75, 0x2a, 0xe7, 0x7f,
+    0xed, 0x2f, 0xdf, 0xf5, 0x49, 0x32, 0x3c, 0x3c, 0x5c, 0xe9, 0x1b, 0x3e, 0x3a, 0xe9, 0xb0, 0xe9,
+    0xd4, 0x66, 0x97, 0xe2, 0x66, 0xf8, 0x89, 0xcb, 0x94, 0x32, 0xe2, 0xa9, 0x8c, 0x76, 0x76, 0x76,
+    0x73, 0x9f, 0x29, 0x44, 0x5d, 0xe3, 0x94, 0x31, 0xb5, 0x0d, 0xdc, 0xb4, 0x69, 0x46, 0x19, 0xa7,
+    0x3a, 0xe9, 0xf7, 0xd9, 0x86, 0xd8, 0x21, 0x93, 0x0a, 0x6c, 0x43, 0xdd, 0x6d, 0x1c, 0x9a, 0x04,
+    0x4b, 0x43, 0x70, 0x02, 0x51, 0xed, 0x88, 0x93, 0x6f, 0x18, 0x1a, 0x94, 0x62, 0x72, 0xf8, 0xeb,
+    0xc3, 0xe5, 0x19, 0xa6, 0x12, 0x2d, 0xc3, 0x80, 0xae, 0xd0, 0x0e, 0x86, 0xdd, 0xba, 0xa2, 0xb3,
+    0xf4, 0x7e, 0x4b, 0x67, 0x2d, 0x06, 0x2f, 0x87, 0xc3, 0x70, 0x7d, 0xdb, 0xc5, 0xc1, 0xff, 0x21,
+    0xd5, 0x13, 0x70, 0x07, 0xf4, 0x93, 0xe6, 0xbe, 0x2b, 0x91, 0x92, 0x78, 0xf6, 0x8d, 0x7d, 0x77,
+    0xfe, 0x3f, 0xb2, 0xd5, 0x31, 0x1e, 0x5b, 0xd0, 0x13, 0xf2, 0xe3, 0xf0, 0x90, 0x9f, 0xdd, 0x55,
+    0xaf, 0x35, 0xb7, 0x2e, 0x90, 0x13, 0xda, 0x41, 0x53, 0xed, 0x10, 0x8a, 0x35, 0xe9, 0x64, 0x9c,
+    0xf0, 0xe3, 0x06, 0x0f, 0xc3, 0x0a, 0x2e, 0x31, 0x6e, 0x9d, 0x2a, 0x1b, 0x1c, 0x0d, 0xc3, 0x4f,
+    0x0f, 0x0f, 0x1d, 0xc8, 0x71, 0xb7, 0x06, 0xe3, 0x05, 0x7f, 0x35, 0x19, 0x67, 0xcd, 0x71, 0x63,
+    0xc0, 0x6a, 0x14, 0x79, 0x35, 0xa0, 0xb4, 0xfe, 0x29, 0x41, 0xe5, 0xcd, 0xf5, 0x4f, 0xdb, 0xce,
+    0xb6, 0x84, 0x01, 0xf0, 0xed, 0xf0, 0xc7, 0xdd, 0x25, 0xa6, 0x16, 0x91, 0x9f, 0x41, 0xf3, 0x12,
+    0xce, 0x1b, 0x1a, 0x42, 0xda, 0x6b, 0xc3, 0x86, 0xc3, 0x6e, 0xdb, 0x61, 0xf2, 0x04, 0x09, 0x7d,
+    0xbd, 0x26, 0x47, 0x8f, 0x5d, 0x17, 0x9f, 0x11, 0xef, 0xa0, 0xf7, 0x8c, 0x0a, 0x6f, 0x5b, 0xae,
+    0xc6, 0x64, 0x2c, 0x95, 0x1a, 0x3e, 0xd6, 0x16, 0x86, 0xca, 0xde, 0xe1, 0xa5, 0x09, 0x6f, 0x09,
+    0x38, 0x6d, 0xee, 0x12, 0xaf, 0xf8, 0x44, 0x68, 0x2c, 0x3f, 0xbc, 0x5d, 0x09, 0x72, 0x7f, 0xa7,
+    0x67, 0xa4, 0x8e, 0x3a, 0x08, 0x55, 0x3e, 0x49, 0x28, 0x0a, 0x74, 0x72, 0xe3, 0x05, 0x39, 0xb6,
+    0x79, 0x59, 0xca, 0xa6, 0x54, 0x6d, 0x62, 0xc0, 0xb1, 0x08, 0x3b, 0x39, 0x68, 0xc3, 0x54, 0x94,
+    0x30, 0x97, 0x70, 0x7b, 0x66, 0x14, 0xde, 0x93, 0x38, 0x58, 0x19, 0xbd, 0xef, 0xbc, 0x4a, 0x75,
+    0x6a, 0xd9, 0x11, 0xfa, 0xbf, 0x01, 0x0e, 0xdc, 0xc7, 0xee, 0x2c, 0xec, 0x12, 0x17, 0x29, 0x33,
+    0x31, 0x67, 0x46, 0xdb, 0x54, 0xa2, 0xc9, 0x74, 0x4f, 0x71, 0xae, 0x8e, 0xd2, 0xec, 0x2b, 0xad,
+    0x75, 0x38, 0xe1, 0x9d, 0x35, 0x4e, 0xba, 0xbf, 0xf8, 0x2c, 0xf8, 0x63, 0xd3, 0x5d, 0x5e, 0x72,
+    0xb6, 0x78, 0xdb, 0x2a, 0xdf, 0xe4, 0x79, 0xf5, 0xee, 0x0d, 0x69, 0x27, 0x98, 0x49, 0x73, 0xba,
+    0xd6, 0x75, 0x66, 0x4b, 0xfb, 0x1f, 0x4c, 0xbc, 0xed, 0x8f, 0x8a, 0x78, 0xeb, 0x85, 0x37, 0xee,
+    0xde, 0x01, 0xe3, 0x8d, 0xf5, 0x30, 0x5e, 0x9f, 0x1b, 0xf1, 0x66, 0x0b, 0xc4, 0xab, 0x49, 0xa1,
+    0x92, 0xf9, 0x17, 0x8d, 0xbe, 0x84, 0x57, 0x24, 0x12, 0x00, 0x00,
+};
+
+// preview.html, 2564 bytes uncompressed.
+const uint8_t preview_html[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x7d, 0x56, 0x6d, 0x6f, 0xdb, 0x36,
+    0x10, 0xfe, 0xae, 0x5f, 0x71, 0xd3, 0xd0, 0x42, 0x6e, 0x1d, 0x49, 0x76, 0x53, 0xa0, 0xb3, 0x6c,
+    0x17, 0x5b, 0x92, 0x0f, 0x05, 0x3a, 0x2c, 0x68, 0x3a, 0x14, 0x43, 0x11, 0x0c, 0xb4, 0x74, 0x92,
+    0x89, 0xca, 0x94, 0x41, 0xd1, 0x8e, 0x85, 0xd6, 0xff, 0xbd, 0x77, 0x24, 0x2d, 0x2b, 0x59, 0xbb,
+    0x18, 0x01, 0xc9, 0xe3, 0xdd, 0x73, 0xef, 0x27, 0xce, 0x7f, 0xb9, 0xfe, 0xeb, 0xea, 0xe3, 0x3f,
+    0xb7, 0x37, 0xb0, 0x36, 0x9b, 0x7a, 0x19, 0xcc, 0x79, 0x81, 0x5a, 0xa8, 0x6a, 0x11, 0xa2, 0x0a,
+    0x99, 0x80, 0xa2, 0xa0, 0x65, 0x83, 0x46, 0x80, 0x12, 0x1b, 0x5c, 0x84, 0x7b, 0x89, 0x0f, 0xdb,
+    0x46, 0x9b, 0x10, 0xf2, 0x46, 0x19, 0x54, 0x66, 0x11, 0x3e, 0xc8, 0xc2, 0xac, 0x17, 0x05, 0xee,
+    0x65, 0x8e, 0x17, 0xf6, 0x30, 0x06, 0xa9, 0xa4, 0x91, 0xa2, 0xbe, 0x68, 0x73, 0x51, 0xe3, 0x62,
+    0x12, 0x26, 0x84, 0x62, 0xa4, 0xa9, 0x71, 0xf9, 0xa9, 0xd1, 0x05, 0xe4, 0x75, 0x93, 0x7f, 0x81,
+    0xad, 0x46, 0x86, 0x9b, 0x27, 0xee, 0x26, 0x98, 0xb7, 0xa6, 0xe3, 0x75, 0xd5, 0x14, 0x1d, 0x7c,
+    0x0d, 0x80, 0x54, 0xd4, 0x8d, 0x9e, 0xc1, 0xaf, 0x88, 0x98, 0xd1, 0x71, 0x23, 0x74, 0x25, 0xd5,
+    0x0c, 0x52, 0x3e, 0xac, 0x44, 0xfe, 0xa5, 0xd2, 0xcd, 0x4e, 0x15, 0xc4, 0x30, 0x99, 0xf2, 0x8f,
+    0xc9, 0x25, 0x59, 0x35, 0x83, 0x49, 0x9a, 0x3e, 0x83, 0xb6, 0x6b, 0x0d, 0x6e, 0x2e, 0x76, 0x92,
+    0xe9, 0x06, 0x0f, 0xe6, 0x42, 0xd4, 0xb2, 0x22, 0xf9, 0x9c, 0xcc, 0x46, 0x9d, 0x05, 0xc7, 0x20,
+    0xc8, 0x85, 0xda, 0x8b, 0xd6, 0x2a, 0xb3, 0x96, 0xcf, 0xe0, 0xb7, 0x74, 0xbf, 0x91, 0x8a, 0x45,
+    0xd6, 0x28, 0xab, 0xb5, 0x19, 0x52, 0x9c, 0x01, 0x17, 0xa6, 0xd9, 0xce, 0xe0, 0xd2, 0x11, 0x8f,
+    0xc1, 0x3c, 0xf1, 0x66, 0xcf, 0x13, 0x1f, 0x2e, 0xb6, 0x9f, 0x16, 0x8f, 0x2d, 0x8b, 0x45, 0x58,
+    0x8a, 0x1c, 0x43, 0xa7, 0x61, 0x11, 0xbe, 0x9e, 0xa6, 0xa1, 0x07, 0x77, 0x87, 0xe5, 0x3c, 0x71,
+    0xbc, 0x24, 0xb4, 0xb5, 0xfc, 0xad, 0x11, 0x66, 0xd7, 0x86, 0xcb, 0xab, 0x46, 0x29, 0xcc, 0x8d,
+    0x54, 0x55, 0x1c, 0xc7, 0xf3, 0x64, 0xcb, 0x31, 0xca, 0xb5, 0xdc, 0x9a, 0x65, 0x10, 0xee, 0x5a,
+    0x84, 0xd6, 0x68, 0x99, 0x9b, 0x30, 0x0b, 0x92, 0x04, 0xae, 0xb5, 0x78, 0x68, 0xc1, 0xac, 0x11,
+    0x4a, 0x4d, 0xa9, 0x6a, 0xf9, 0x12, 0x69, 0x53, 0xc0, 0xaa, 0x83, 0x5b, 0x17, 0xea, 0x3b, 0xd4,
+    0x7b, 0xd4, 0x31, 0xdc, 0x21, 0x9e, 0xa2, 0xff, 0x6f, 0xeb, 0x68, 0x6b, 0x0a, 0x9d, 0x66, 0x71,
+    0xc6, 0x22, 0xf1, 0x56, 0x54, 0xc8, 0xa4, 0x8d, 0x30, 0x71, 0x40, 0xb9, 0x6e, 0x0d, 0x78, 0x87,
+    0x16, 0x50, 0x34, 0xf9, 0x6e, 0x43, 0x41, 0x8c, 0x2b, 0x34, 0x37, 0x35, 0xf2, 0xf6, 0x8f, 0xee,
+    0x5d, 0x11, 0x39, 0x3f, 0x47, 0xd9, 0x89, 0x9f, 0x2b, 0xe4, 0x60, 0x48, 0xc0, 0x49, 0x32, 0xfb,
+    0x95, 0xa3, 0x45, 0xe1, 0xb4, 0x38, 0x33, 0x3a, 0x77, 0xff, 0x0f, 0xd8, 0x07, 0xa4, 0x97, 0x28,
+    0xb7, 0xcc, 0xae, 0xf0, 0x01, 0xfe, 0xfe, 0xf0, 0xfe, 0x0e, 0x85, 0xce, 0xd7, 0xb7, 0x82, 0xdc,
+    0x6e, 0x23, 0xaa, 0x2c, 0x61, 0x64, 0xa3, 0xe2, 0xd6, 0x52, 0x47, 0x0c, 0x45, 0x86, 0x6d, 0x49,
+    0x18, 0xbe, 0x7d, 0xa3, 0xca, 0xc8, 0x82, 0x1a, 0x8d, 0xcb, 0x05, 0x41, 0xa4, 0x63, 0x9f, 0x0a,
+    0xb7, 0xcf, 0x1b, 0xad, 0x50, 0xb7, 0xa7, 0x03, 0x95, 0x1f, 0xef, 0x3f, 0xdf, 0x67, 0x41, 0x50,
+    0xee, 0x54, 0xce, 0xc0, 0x50, 0x50, 0xa0, 0x23, 0xa9, 0x0a, 0x3c, 0x8c, 0x7c, 0x95, 0x5a, 0x67,
+    0xb1, 0xae, 0xcf, 0x9e, 0x3a, 0xf8, 0x04, 0x22, 0xb7, 0x79, 0x09, 0xd3, 0x11, 0x17, 0x10, 0x6b,
+    0x3e, 0x8c, 0xa1, 0xe3, 0xbd, 0x2c, 0xc1, 0xa1, 0xc0, 0xdc, 0x5b, 0xf3, 0xc2, 0x9b, 0xe2, 0x60,
+    0x01, 0x0e, 0x84, 0x37, 0x21, 0x59, 0xc7, 0xf5, 0xcc, 0x71, 0x65, 0xf6, 0xaa, 0xf3, 0x57, 0x7f,
+    0x0a, 0xb3, 0x8e, 0xcb, 0xba, 0x69, 0xb4, 0xc7, 0x4a, 0x1c, 0x97, 0xd5, 0x76, 0x04, 0xac, 0xa9,
+    0x48, 0x1c, 0x18, 0x65, 0xf5, 0xca, 0x39, 0x37, 0x76, 0xed, 0xf7, 0x20, 0x5b, 0x2e, 0x95, 0x66,
+    0x63, 0x6b, 0x86, 0x6a, 0x9a, 0xac, 0x2b, 0x0d, 0x34, 0x0a, 0x63, 0x2b, 0x70, 0xca, 0x21, 0xcb,
+    0x90, 0x36, 0x07, 0x7f, 0xf1, 0xc4, 0xd4, 0xac, 0x37, 0xf4, 0xc4, 0xb8, 0x60, 0xc3, 0x28, 0xd0,
+    0x83, 0xf3, 0x14, 0xde, 0xc2, 0x29, 0x0e, 0x13, 0xf0, 0xfd, 0xeb, 0x7c, 0xf0, 0x5c, 0x4b, 0xc7,
+    0xe4, 0x33, 0x31, 0xe0, 0x3a, 0xba, 0xf8, 0x72, 0xc9, 0xc4, 0xa5, 0xac, 0xeb, 0x3b, 0x6e, 0x35,
+    0x2b, 0xc7, 0xa9, 0xf9, 0x6c, 0x8d, 0xba, 0xcf, 0x06, 0x4c, 0x2b, 0xa4, 0x0e, 0xbd, 0xa5, 0xa8,
+    0x44, 0xa3, 0x21, 0x99, 0x4a, 0x21, 0x8a, 0x0e, 0x84, 0x9c, 0xc6, 0xaf, 0x47, 0x64, 0x3d, 0x67,
+    0x6b, 0x0c, 0x51, 0xf7, 0x94, 0x62, 0xb3, 0xf8, 0x82, 0x68, 0x97, 0x63, 0xae, 0x80, 0x29, 0xed,
+    0x6d, 0x88, 0x6f, 0xdf, 0x3d, 0x82, 0x63, 0x53, 0x58, 0xc1, 0x71, 0x50, 0x16, 0xba, 0x5a, 0x45,
+    0x85, 0x30, 0x62, 0x0c, 0x4d, 0x59, 0xb6, 0xe8, 0xb3, 0xc8, 0x8d, 0x29, 0xf4, 0x17, 0x78, 0x7f,
+    0x73, 0xcd, 0x1d, 0x29, 0x3a, 0xd8, 0xcb, 0x56, 0xae, 0xc8, 0x09, 0xea, 0xa4, 0x66, 0x67, 0x6a,
+    0xa9, 0xa8, 0x55, 0x9b, 0xd2, 0x26, 0xa1, 0xd2, 0xb2, 0x88, 0xfb, 0x8a, 0xe2, 0xa8, 0x5b, 0xe5,
+    0x1b, 0x71, 0xb0, 0xc8, 0x9f, 0x1d, 0xf0, 0x3d, 0xd9, 0x75, 0x39, 0x1a, 0x43, 0xf5, 0x93, 0x7b,
+    0x8e, 0x9f, 0xe7, 0xb1, 0x71, 0xe6, 0xbf, 0xd5, 0xcf, 0x79, 0xa7, 0x8e, 0x97, 0xdd, 0xd3, 0x68,
+    0x76, 0x5a, 0x41, 0xc8, 0xae, 0x84, 0x74, 0xa5, 0xe9, 0x3f, 0x1c, 0xf3, 0xae, 0xea, 0x77, 0x2b,
+    0xde, 0x8d, 0xc2, 0xc7, 0xbe, 0xe7, 0x6e, 0x4e, 0x45, 0xc3, 0x86, 0x68, 0xa9, 0xc6, 0xd0, 0xf8,
+    0x2e, 0xfd, 0x84, 0xab, 0x3b, 0x7b, 0x8e, 0xc2, 0x87, 0x76, 0x96, 0x24, 0x8c, 0xd4, 0x77, 0xea,
+    0xba, 0x69, 0x0d, 0x7f, 0x5d, 0x18, 0x79, 0xf6, 0x66, 0x92, 0xbc, 0xa5, 0x6e, 0x5d, 0x30, 0x07,
+    0xad, 0xd6, 0x2e, 0x07, 0x15, 0xaf, 0xa4, 0x12, 0xba, 0xfb, 0xd8, 0x6d, 0xb9, 0x02, 0x42, 0xa1,
+    0xb5, 0xe8, 0x56, 0xbb, 0xb2, 0x44, 0x1d, 0x0e, 0x98, 0x1a, 0xd5, 0x6c, 0x51, 0x11, 0x03, 0x19,
+    0xb3, 0x58, 0xc2, 0x57, 0x3f, 0x5c, 0x62, 0xce, 0xdb, 0x95, 0xfb, 0x64, 0xb1, 0xf4, 0x7b, 0xb9,
+    0xa7, 0x14, 0x18, 0xf0, 0x6a, 0x58, 0x35, 0xaf, 0x61, 0x06, 0xc7, 0x47, 0x60, 0xd4, 0x2a, 0x2d,
+    0x9e, 0xd1, 0x6c, 0x40, 0x7f, 0x8c, 0x78, 0x2d, 0x5b, 0x1f, 0x06, 0x2c, 0xc6, 0x1c, 0x4a, 0xdd,
+    0xb9, 0xb9, 0x1d, 0xba, 0x72, 0xa7, 0x68, 0x7f, 0x94, 0x1b, 0xa4, 0x9c, 0x47, 0x9e, 0x8f, 0xe2,
+    0x9e, 0xa6, 0xa9, 0x6b, 0xd5, 0x47, 0x4a, 0x4f, 0xe3, 0x97, 0xd4, 0xe2, 0x9e, 0xe0, 0x07, 0xba,
+    0x5d, 0x6c, 0x39, 0x83, 0xa7, 0xf9, 0x27, 0x95, 0x79, 0xf3, 0x3b, 0xc7, 0xc2, 0xf1, 0xc6, 0x7c,
+    0x37, 0x72, 0x2a, 0x79, 0xc4, 0xd8, 0x64, 0xa7, 0xf7, 0xb6, 0x11, 0xd3, 0xd3, 0x64, 0x81, 0x7e,
+    0xfe, 0xd9, 0xeb, 0xc9, 0x7d, 0xe6, 0xc9, 0xfd, 0x2c, 0xb4, 0xf4, 0x69, 0x4f, 0x3f, 0xcf, 0x45,
+    0x7b, 0xf1, 0x6a, 0x70, 0xe1, 0x3a, 0x22, 0xaf, 0x69, 0xdc, 0x7e, 0xe0, 0x1a, 0x48, 0x6d, 0xe7,
+    0x0c, 0xe7, 0x60, 0x7f, 0xf2, 0xe3, 0xed, 0x2c, 0x3b, 0x98, 0xaf, 0x8e, 0xc4, 0xdf, 0xa0, 0x88,
+    0xa7, 0xa4, 0xe4, 0x11, 0x9c, 0xc1, 0x25, 0x8f, 0x3f, 0x6a, 0xc2, 0x57, 0x34, 0x24, 0x59, 0x73,
+    0x5c, 0xa3, 0xaa, 0x68, 0x08, 0x82, 0x7c, 0xf9, 0xf2, 0xec, 0x0c, 0xf4, 0xf3, 0x80, 0xfc, 0x1c,
+    0x34, 0x62, 0x2f, 0xdd, 0xab, 0x04, 0x3f, 0xbd, 0x7b, 0xc2, 0xd1, 0xae, 0x7e, 0x52, 0x3e, 0x8d,
+    0xd7, 0x04, 0x9e, 0x3f, 0xf7, 0x91, 0x5a, 0x0e, 0x83, 0xd7, 0x5b, 0xe9, 0x9b, 0x88, 0x38, 0x33,
+    0xe8, 0x1b, 0xea, 0x3f, 0xb6, 0x9e, 0x6e, 0x16, 0x70, 0xf9, 0x03, 0x9b, 0x87, 0x9d, 0xfd, 0xd8,
+    0xfc, 0x73, 0x3b, 0x3f, 0xb5, 0x7f, 0x28, 0xf3, 0xd4, 0x15, 0x57, 0x4d, 0xfc, 0xb6, 0x39, 0x35,
+    0x65, 0xc6, 0x6f, 0x14, 0xff, 0x6c, 0x98, 0x27, 0xfe, 0x75, 0x92, 0xb8, 0x37, 0xdf, 0x77, 0xb2,
+    0x09, 0xda, 0x1a, 0x04, 0x0a, 0x00, 0x00,
+};
+
+}  // namespace data
+
+const Asset assets[PORTAL_ASSET_COUNT] = {
+    {"/static/logo.svg", "image/svg+xml", "\"a2a1fd915e14288b\"",
+     data::logo_svg, sizeof(data::logo_svg)},
+    {"/static/portal.css", "text/css", "\"7e5241e3b7bc451f\"",
+     data::portal_css, sizeof(data::portal_css)},
+    {"/static/portal.js", "application/javascript", "\"5117b5cd903bf646\"",
+     data::portal_js, sizeof(data::portal_js)},
+    {"/static/preview.html", "text/html", "\"86842797d95d1804\"",
+     data::preview_html, sizeof(data::preview_html)},
+};
+
+// HTML of the configuration pages, with the asset URLs filled in.
+const char HTML_HEAD_EXTENSION[] PROGMEM =
+    "<meta name=\"theme-color\" content=\"#121212\" />\n"
+    "<link rel=\"icon\" href=\"/static/logo.svg?v=a2a1fd915e14288b\" type=\"image/svg+xml\" />\n"
+    "<link rel=\"stylesheet\" href=\"/static/portal.css?v=7e5241e3b7bc451f\" />\n"
+    "<script src=\"/static/portal.js?v=5117b5cd903bf646\" defer></script>\n";
+
+const char HTML_BODY_INNER[] PROGMEM =
+    "<header><div class=\"logoContainer\"><img class=\"logo\" src=\"/static/logo.svg?v=a2a1fd915e14288b\"/></div></header>\n"
+    "<div style='text-align:left;display:inline-block;min-width:260px;'>\n";
+
+}  // namespace portal
+
+#endif  // WORDCLOCK_PORTAL_ASSETS_H_
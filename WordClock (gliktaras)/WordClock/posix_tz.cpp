@@ -0,0 +1,271 @@
+// POSIX TZ string evaluation with a precomputed transition table.
+
+#include "posix_tz.h"
+
+#include <ctype.h>
+
+namespace {
+
+#define SECONDS_PER_DAY 86400L
+#define SECONDS_PER_HOUR 3600L
+// Offset of daylight saving time relative to standard time when the TZ string
+// does not specify it.
+#define DEFAULT_DST_SHIFT SECONDS_PER_HOUR
+// Local time of a rule when the TZ string does not specify it.
+#define DEFAULT_RULE_TIME (2 * SECONDS_PER_HOUR)
+// Margin kept at both ends of the covered range, so that transitions close to
+// the turn of a year are never missed.
+#define RANGE_MARGIN (2 * SECONDS_PER_DAY)
+
+bool isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+int daysInMonth(int year, int month) {
+    static const int8_t DAYS[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    return month == 2 && isLeapYear(year) ? 29 : DAYS[month - 1];
+}
+
+// Returns the number of days from 1970-01-01 to the given date of the
+// proleptic Gregorian calendar.
+long daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;
+    const long era = (year >= 0 ? year : year - 399) / 400;
+    const long year_of_era = year - era * 400;
+    const long day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 +
+                             day - 1;
+    const long day_of_era = year_of_era * 365 + year_of_era / 4 -
+                            year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// Parses an unsigned decimal number of at most `max_digits` digits.
+bool parseNumber(const char** tz, int max_digits, int* value) {
+    if (!isdigit(static_cast<unsigned char>(**tz))) return false;
+    *value = 0;
+    for (int digits = 0;
+         digits < max_digits && isdigit(static_cast<unsigned char>(**tz));
+         digits++) {
+        *value = *value * 10 + (*(*tz)++ - '0');
+    }
+    return true;
+}
+
+}  // namespace
+
+PosixTimezone::PosixTimezone() {
+    set("UTC0", 0);
+}
+
+bool PosixTimezone::parseName_(const char** tz) {
+    const char* p = *tz;
+    if (*p == '<') {
+        while (*p != '\0' && *p != '>') p++;
+        if (*p != '>') return false;
+        *tz = p + 1;
+        return true;
+    }
+    while (isalpha(static_cast<unsigned char>(*p))) p++;
+    if (p - *tz < 3) return false;
+    *tz = p;
+    return true;
+}
+
+bool PosixTimezone::parseTime_(const char** tz, int32_t* seconds) {
+    int sign = 1;
+    if (**tz == '+' || **tz == '-') {
+        sign = *(*tz)++ == '-' ? -1 : 1;
+    }
+    int hours;
+    int minutes = 0;
+    int secs = 0;
+    if (!parseNumber(tz, 3, &hours)) return false;
+    if (**tz == ':') {
+        (*tz)++;
+        if (!parseNumber(tz, 2, &minutes)) return false;
+        if (**tz == ':') {
+            (*tz)++;
+            if (!parseNumber(tz, 2, &secs)) return false;
+        }
+    }
+    *seconds = sign * (hours * SECONDS_PER_HOUR + minutes * 60L + secs);
+    return true;
+}
+
+bool PosixTimezone::parseRule_(const char** tz, Rule* rule) {
+    if (**tz != ',') return false;
+    (*tz)++;
+
+    int value;
+    if (**tz == 'M') {
+        (*tz)++;
+        int week;
+        int weekday;
+        if (!parseNumber(tz, 2, &value) || *(*tz)++ != '.' ||
+            !parseNumber(tz, 1, &week) || *(*tz)++ != '.' ||
+            !parseNumber(tz, 1, &weekday)) {
+            return false;
+        }
+        if (value < 1 || value > 12 || week < 1 || week > 5 || weekday > 6) {
+            return false;
+        }
+        rule->kind = 'M';
+        rule->month = value;
+        rule->week = week;
+        rule->weekday = weekday;
+    } else {
+        rule->kind = 'D';
+        if (**tz == 'J') {
+            rule->kind = 'J';
+            (*tz)++;
+        }
+        if (!parseNumber(tz, 3, &value)) return false;
+        if (rule->kind == 'J' ? value < 1 || value > 365 : value > 365) {
+            return false;
+        }
+        rule->day = value;
+    }
+
+    rule->time = DEFAULT_RULE_TIME;
+    if (**tz == '/') {
+        (*tz)++;
+        return parseTime_(tz, &rule->time);
+    }
+    return true;
+}
+
+bool PosixTimezone::set(const char* tz, time_t now) {
+    const char* p = tz;
+    int32_t std_west;
+    int32_t dst_west;
+    bool valid = parseName_(&p) && parseTime_(&p, &std_west);
+    has_dst_ = valid && *p != '\0';
+    if (has_dst_) {
+        valid = parseName_(&p);
+        dst_west = std_west - DEFAULT_DST_SHIFT;
+        if (valid && *p != ',' && *p != '\0') {
+            valid = parseTime_(&p, &dst_west);
+        }
+        if (valid && *p == '\0') {
+            // No rules given, use the US ones like the C library does.
+            const char* us_rules = ",M3.2.0,M11.1.0";
+            valid = parseRule_(&us_rules, &start_) &&
+                    parseRule_(&us_rules, &end_);
+        } else if (valid) {
+            valid = parseRule_(&p, &start_) && parseRule_(&p, &end_) &&
+                    *p == '\0';
+        }
+    } else if (valid) {
+        valid = *p == '\0';
+    }
+
+    if (!valid) {
+        std_offset_ = 0;
+        has_dst_ = false;
+    } else {
+        std_offset_ = -std_west;
+        dst_offset_ = has_dst_ ? -dst_west : std_offset_;
+    }
+    transition_count_ = 0;
+    table_begin_ = table_end_ = 0;
+    computeTransitions_(now);
+    return valid;
+}
+
+time_t PosixTimezone::ruleDay_(const Rule& rule, int year) {
+    long day;
+    switch (rule.kind) {
+        case 'J':
+            // Day 60 is March 1st, whether or not the year is a leap year.
+            day = daysFromCivil(year, 1, 1) + rule.day - 1 +
+                  (isLeapYear(year) && rule.day >= 60 ? 1 : 0);
+            break;
+        case 'D':
+            day = daysFromCivil(year, 1, 1) + rule.day;
+            break;
+        case 'M':
+        default: {
+            const long first = daysFromCivil(year, rule.month, 1);
+            // 1970-01-01 was a Thursday.
+            const int first_weekday = ((first + 4) % 7 + 7) % 7;
+            int mday = 1 + (rule.weekday - first_weekday + 7) % 7 +
+                       (rule.week - 1) * 7;
+            if (mday > daysInMonth(year, rule.month)) mday -= 7;
+            day = first + mday - 1;
+            break;
+        }
+    }
+    return static_cast<time_t>(day) * SECONDS_PER_DAY;
+}
+
+void PosixTimezone::computeTransitions_(time_t utc) {
+    transition_count_ = 0;
+    if (!has_dst_) {
+        table_begin_ = 0;
+        table_end_ = 0;
+        return;
+    }
+
+    struct tm date;
+    gmtime_r(&utc, &date);
+    const int first_year = date.tm_year + 1900 - 1;
+    for (int year = first_year; year < first_year + POSIX_TZ_YEARS; year++) {
+        // DST starts at a standard local time and ends at a DST local time.
+        const Transition year_transitions[] = {
+            {ruleDay_(start_, year) + start_.time - std_offset_, dst_offset_,
+             true},
+            {ruleDay_(end_, year) + end_.time - dst_offset_, std_offset_,
+             false},
+        };
+        // Insertion keeps the table sorted. On a tie, the start of DST goes
+        // last, so that zones with DST all year round stay on DST.
+        for (const Transition& transition : year_transitions) {
+            int i = transition_count_++;
+            while (i > 0 && (transitions_[i - 1].utc > transition.utc ||
+                             (transitions_[i - 1].utc == transition.utc &&
+                              transitions_[i - 1].dst && !transition.dst))) {
+                transitions_[i] = transitions_[i - 1];
+                i--;
+            }
+            transitions_[i] = transition;
+        }
+    }
+    table_begin_ = daysFromCivil(first_year, 1, 1) * SECONDS_PER_DAY +
+                   RANGE_MARGIN;
+    table_end_ = daysFromCivil(first_year + POSIX_TZ_YEARS, 1, 1) *
+                     SECONDS_PER_DAY - RANGE_MARGIN;
+}
+
+const PosixTimezone::Transition* PosixTimezone::find_(time_t utc) {
+    if (!has_dst_) return nullptr;
+    if (utc < table_begin_ || utc >= table_end_) computeTransitions_(utc);
+
+    // Last transition at or before `utc`.
+    int low = 0;
+    int high = transition_count_;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        if (transitions_[middle].utc <= utc) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low > 0 ? &transitions_[low - 1] : nullptr;
+}
+
+int32_t PosixTimezone::offsetAt(time_t utc) {
+    const Transition* transition = find_(utc);
+    if (transition != nullptr) return transition->offset;
+    // Before the first transition, the opposite of it is in effect.
+    if (has_dst_ && !transitions_[0].dst) return dst_offset_;
+    return std_offset_;
+}
+
+void PosixTimezone::toLocal(time_t utc, struct tm* local) {
+    const int32_t offset = offsetAt(utc);
+    const time_t local_time = utc + offset;
+    gmtime_r(&local_time, local);
+    local->tm_isdst = has_dst_ && offset == dst_offset_ &&
+                      dst_offset_ != std_offset_;
+}
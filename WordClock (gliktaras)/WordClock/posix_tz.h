@@ -0,0 +1,96 @@
+#ifndef WORDCLOCK_POSIX_TZ_H_
+#define WORDCLOCK_POSIX_TZ_H_
+
+#include <stdint.h>
+#include <time.h>
+
+// Number of years of transitions computed at once, starting from the year
+// before the requested time. Lookups outside of the range recompute it.
+#define POSIX_TZ_YEARS 4
+// Maximum number of UTC offset transitions in the table.
+#define POSIX_TZ_MAX_TRANSITIONS (POSIX_TZ_YEARS * 2)
+
+// Converts UTC to local time according to a POSIX TZ string, such as
+// "CET-1CEST,M3.5.0,M10.5.0/3".
+//
+// The DST rules are evaluated once, into a sorted table of the UTC offset
+// transitions of a few years. A conversion is then a binary search and an
+// addition, instead of newlib evaluating the rules on every localtime() call.
+//
+// Has no Arduino dependencies, so that it can be compared against the C
+// library's TZ handling on a host.
+class PosixTimezone {
+  public:
+    PosixTimezone();
+
+    // Parses `tz` and computes the transitions around `now`. Returns false and
+    // falls back to UTC if `tz` is not a valid POSIX TZ string.
+    bool set(const char* tz, time_t now);
+
+    // Returns the UTC offset in seconds, east of Greenwich, at `utc`.
+    int32_t offsetAt(time_t utc);
+
+    // Converts `utc` to broken-down local time. tm_isdst is set according to
+    // the rules.
+    void toLocal(time_t utc, struct tm* local);
+
+  private:
+    // A start or end of daylight saving time, as given in the TZ string.
+    struct Rule {
+        // 'J' for Julian day without leap day, 'D' for zero-based day of the
+        // year, 'M' for month, week and day of week.
+        char kind;
+        // Day of the year for 'J' and 'D' rules.
+        int16_t day;
+        // Month (1-12), week (1-5, 5 being the last) and weekday (0-6, 0 being
+        // Sunday) for 'M' rules.
+        int8_t month;
+        int8_t week;
+        int8_t weekday;
+        // Local time of the change, in seconds after midnight.
+        int32_t time;
+    };
+
+    // A change of the UTC offset.
+    struct Transition {
+        // Moment of the change.
+        time_t utc;
+        // Offset in effect from then on.
+        int32_t offset;
+        // Whether daylight saving time is in effect from then on.
+        bool dst;
+    };
+
+    // Parses a zone name, plain or enclosed in angle brackets.
+    static bool parseName_(const char** tz);
+    // Parses [+-]hh[:mm[:ss]] into seconds.
+    static bool parseTime_(const char** tz, int32_t* seconds);
+    // Parses a ,start[/time] or ,end[/time] rule.
+    static bool parseRule_(const char** tz, Rule* rule);
+    // Returns the seconds since the epoch of midnight UTC of the day `rule`
+    // selects in `year`.
+    static time_t ruleDay_(const Rule& rule, int year);
+
+    // Fills the transition table for the years around `utc`.
+    void computeTransitions_(time_t utc);
+    // Returns the transition in effect at `utc`, or nullptr if none.
+    const Transition* find_(time_t utc);
+
+    // Standard and daylight saving offsets, east of Greenwich.
+    int32_t std_offset_ = 0;
+    int32_t dst_offset_ = 0;
+    // Whether the zone observes daylight saving time.
+    bool has_dst_ = false;
+    // Start and end of daylight saving time.
+    Rule start_;
+    Rule end_;
+
+    // UTC offset changes, sorted by time.
+    Transition transitions_[POSIX_TZ_MAX_TRANSITIONS];
+    int transition_count_ = 0;
+    // Range of time covered by the table.
+    time_t table_begin_ = 0;
+    time_t table_end_ = 0;
+};
+
+#endif  // WORDCLOCK_POSIX_TZ_H_
@@ -0,0 +1,45 @@
+// Current estimate and limit of the LEDs.
+
+#include "power_budget.h"
+
+void PowerBudget::endFrame(uint32_t elapsed_us) {
+    // The frame shown until now drew draw_ma_.
+    energy_uj_ += static_cast<uint64_t>(draw_ma_) * LED_SUPPLY_MV *
+                  elapsed_us / 1000000;
+
+    const uint32_t idle_ma = led_count_ * LED_IDLE_MA;
+    const uint32_t channel_ma =
+        static_cast<uint64_t>(level_sum_) * LED_CHANNEL_MA / 0xFF00;
+    demand_ma_ = idle_ma + channel_ma;
+    if (limit_ma_ == 0 || demand_ma_ <= limit_ma_) {
+        scale_ = POWER_SCALE_ONE;
+        draw_ma_ = demand_ma_;
+        return;
+    }
+    // Only the channels' share of the current can be scaled down.
+    const uint32_t channel_limit_ma = limit_ma_ > idle_ma ? limit_ma_ - idle_ma
+                                                          : 0;
+    scale_ = channel_ma == 0 ? POWER_SCALE_ONE
+                             : static_cast<uint64_t>(channel_limit_ma) *
+                                   POWER_SCALE_ONE / channel_ma;
+    draw_ma_ = idle_ma + channel_limit_ma;
+    limited_frames_++;
+}
+
+void PowerMetric::writeTo(Print& out) const {
+    const uint64_t energy_uj = budget_->energyUj();
+    out.printf("# TYPE wordclock_led_current_milliamps gauge\n"
+               "wordclock_led_current_milliamps %u\n"
+               "# TYPE wordclock_led_demand_milliamps gauge\n"
+               "wordclock_led_demand_milliamps %u\n"
+               "# TYPE wordclock_led_current_limit_milliamps gauge\n"
+               "wordclock_led_current_limit_milliamps %u\n"
+               "# TYPE wordclock_led_limited_frames_total counter\n"
+               "wordclock_led_limited_frames_total %u\n"
+               "# TYPE wordclock_led_energy_joules_total counter\n"
+               "wordclock_led_energy_joules_total %lu.%06lu\n",
+               budget_->drawMa(), budget_->demandMa(), budget_->limitMa(),
+               budget_->limitedFrames(),
+               static_cast<unsigned long>(energy_uj / 1000000),
+               static_cast<unsigned long>(energy_uj % 1000000));
+}
@@ -0,0 +1,83 @@
+#ifndef WORDCLOCK_POWER_BUDGET_H_
+#define WORDCLOCK_POWER_BUDGET_H_
+
+#include "Dither.h"
+#include "metrics.h"
+
+#include <stdint.h>
+
+// Supply voltage of the LEDs, in millivolts.
+#define LED_SUPPLY_MV 5000
+// Current drawn by one color channel of an LED at full duty, in milliamps.
+#define LED_CHANNEL_MA 20
+// Current drawn by an LED's controller with all channels off, in milliamps.
+#define LED_IDLE_MA 1
+// Scale factor that leaves colors unchanged, in 16.16 fixed point.
+#define POWER_SCALE_ONE 0x10000
+
+// Estimates the current the LEDs draw and keeps it under a limit.
+//
+// The estimate follows the frame incrementally: every pixel write reports the
+// old and the new color to change(), so finishing a frame costs the same
+// whatever the number of LEDs. When the estimate exceeds the limit, scale()
+// returns the factor that brings all pixels down to it, which keeps the
+// colors' ratios, where clipping the brightest pixels would not.
+//
+// The estimate is linear in the duty of each channel, which is what the LEDs'
+// constant current drivers do, so it ignores the supply's and wiring's losses.
+class PowerBudget {
+  public:
+    explicit PowerBudget(int led_count) : led_count_(led_count) {}
+
+    PowerBudget(const PowerBudget&) = delete;
+    PowerBudget& operator=(const PowerBudget&) = delete;
+
+    // Sets the current limit of the LEDs, in milliamps, or 0 for none.
+    void setLimitMa(uint32_t limit_ma) { limit_ma_ = limit_ma; }
+    // Accounts for a pixel changing from `from` to `to`.
+    void change(const WideColor& from, const WideColor& to) {
+        level_sum_ += (to.R + to.G + to.B) - (from.R + from.G + from.B);
+    }
+    // Computes the scale of the frame about to be sent, and adds the energy
+    // the previous one used while shown for `elapsed_us`.
+    void endFrame(uint32_t elapsed_us);
+
+    // Returns the factor to scale the frame's channels by, in 16.16 fixed
+    // point.
+    uint32_t scale() const { return scale_; }
+    // Returns the current the frame would draw unscaled, in milliamps.
+    uint32_t demandMa() const { return demand_ma_; }
+    // Returns the current the frame draws once scaled, in milliamps.
+    uint32_t drawMa() const { return draw_ma_; }
+    uint32_t limitMa() const { return limit_ma_; }
+    // Returns the energy the LEDs used, in microjoules.
+    uint64_t energyUj() const { return energy_uj_; }
+    // Returns the number of frames that were scaled down.
+    uint32_t limitedFrames() const { return limited_frames_; }
+
+  private:
+    const int led_count_;
+    uint32_t limit_ma_ = 0;
+    // Sum of all channels of all pixels, in 8.8 fixed point.
+    int32_t level_sum_ = 0;
+    uint32_t scale_ = POWER_SCALE_ONE;
+    uint32_t demand_ma_ = 0;
+    uint32_t draw_ma_ = 0;
+    uint64_t energy_uj_ = 0;
+    uint32_t limited_frames_ = 0;
+};
+
+// Publishes the state of a power budget on /metrics.
+class PowerMetric : public metrics::Metric {
+  public:
+    explicit PowerMetric(const PowerBudget* budget)
+        : Metric("wordclock_led_power", "LED power estimate."),
+          budget_(budget) {}
+
+    void writeTo(Print& out) const override;
+
+  private:
+    const PowerBudget* budget_;
+};
+
+#endif  // WORDCLOCK_POWER_BUDGET_H_
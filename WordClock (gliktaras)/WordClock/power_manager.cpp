@@ -0,0 +1,172 @@
+// CPU frequency scaling and light sleep while the display is idle.
+
+#include "power_manager.h"
+
+#include "logging.h"
+
+#include <esp_timer.h>
+#if CONFIG_PM_ENABLE
+#include <esp_idf_version.h>
+#endif
+
+namespace {
+
+#if CONFIG_PM_ENABLE
+// Lets esp_pm scale the frequency down to POWER_IDLE_CPU_MHZ with light sleep
+// if `saving`, or keeps the CPU at full speed. Returns false on failure.
+bool configurePm(bool saving) {
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t config = {};
+#else
+    esp_pm_config_esp32_t config = {};
+#endif
+    config.max_freq_mhz = POWER_MAX_CPU_MHZ;
+    config.min_freq_mhz = saving ? POWER_IDLE_CPU_MHZ : POWER_MAX_CPU_MHZ;
+    config.light_sleep_enable = saving;
+    return esp_pm_configure(&config) == ESP_OK;
+}
+#endif
+
+#if POWER_SLEEP_STATS
+// Time spent in light sleep, in microseconds, and the number of light sleeps.
+// Updated by onLightSleepExit() from the idle task of either core.
+portMUX_TYPE sleep_mux = portMUX_INITIALIZER_UNLOCKED;
+uint64_t slept_us = 0;
+uint32_t sleeps = 0;
+
+// Accounts for a light sleep of `sleep_time_us`, as measured by esp_pm.
+esp_err_t IRAM_ATTR onLightSleepExit(int64_t sleep_time_us, void* arg) {
+    portENTER_CRITICAL_ISR(&sleep_mux);
+    slept_us += sleep_time_us;
+    sleeps++;
+    portEXIT_CRITICAL_ISR(&sleep_mux);
+    return ESP_OK;
+}
+#endif
+
+}  // namespace
+
+void PowerManager::begin() {
+#if CONFIG_PM_ENABLE
+    if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "render", &lock_) !=
+        ESP_OK) {
+        lock_ = nullptr;
+    } else if (!configurePm(false)) {
+        esp_pm_lock_delete(lock_);
+        lock_ = nullptr;
+    } else {
+        esp_pm_lock_acquire(lock_);
+        light_sleep_ = true;
+#if POWER_SLEEP_STATS
+        esp_pm_sleep_cbs_register_config_t callbacks = {};
+        callbacks.exit_cb = onLightSleepExit;
+        if (esp_pm_light_sleep_register_cbs(&callbacks) != ESP_OK) {
+            LOGW("Cannot measure light sleep.");
+        }
+        window_start_us_ = esp_timer_get_time();
+#endif
+        return;
+    }
+#endif
+    LOGI("No esp_pm, power saving only switches the CPU frequency.");
+}
+
+void PowerManager::setEnabled(bool enabled) {
+    if (enabled == enabled_) return;
+    enabled_ = enabled;
+    idle_ticks_ = 0;
+#if CONFIG_PM_ENABLE
+    if (light_sleep_ && !configurePm(enabled)) {
+        LOGW("Cannot configure esp_pm.");
+    }
+#endif
+    if (!enabled) setSpeed_(true);
+}
+
+void PowerManager::update(bool idle) {
+#if POWER_SLEEP_STATS
+    const int64_t now_us = esp_timer_get_time();
+    if (now_us - window_start_us_ >= POWER_SLEEP_WINDOW_US) {
+        const uint64_t sleep_us = lightSleepUs();
+        sleep_permille_ =
+            (sleep_us - window_sleep_us_) * 1000 / (now_us - window_start_us_);
+        window_start_us_ = now_us;
+        window_sleep_us_ = sleep_us;
+    }
+#endif
+
+    if (!enabled_) return;
+    if (!idle) {
+        idle_ticks_ = 0;
+        setSpeed_(true);
+    } else if (full_speed_ && ++idle_ticks_ >= POWER_IDLE_TICKS) {
+        setSpeed_(false);
+    }
+}
+
+#if POWER_SLEEP_STATS
+uint64_t PowerManager::lightSleepUs() const {
+    portENTER_CRITICAL(&sleep_mux);
+    const uint64_t us = slept_us;
+    portEXIT_CRITICAL(&sleep_mux);
+    return us;
+}
+
+uint32_t PowerManager::lightSleeps() const {
+    portENTER_CRITICAL(&sleep_mux);
+    const uint32_t count = sleeps;
+    portEXIT_CRITICAL(&sleep_mux);
+    return count;
+}
+#endif
+
+void PowerManager::setSpeed_(bool full) {
+    if (full == full_speed_) return;
+    full_speed_ = full;
+    switches_++;
+    // Woken up by the display's first busy tick, at most a second late.
+    tick_->setResting(!full);
+#if CONFIG_PM_ENABLE
+    if (light_sleep_) {
+        if (full) {
+            esp_pm_lock_acquire(lock_);
+        } else {
+            esp_pm_lock_release(lock_);
+        }
+        return;
+    }
+#endif
+    const uint32_t mhz = full ? POWER_MAX_CPU_MHZ : POWER_IDLE_CPU_MHZ;
+    if (!setCpuFrequencyMhz(mhz)) {
+        LOGW("Cannot set the CPU frequency to %u MHz.", mhz);
+        return;
+    }
+    cpu_mhz_ = mhz;
+}
+
+void PowerManagerMetric::writeTo(Print& out) const {
+    out.printf("# TYPE wordclock_power_saving gauge\n"
+               "wordclock_power_saving %d\n"
+               "# TYPE wordclock_power_light_sleep gauge\n"
+               "wordclock_power_light_sleep %d\n"
+               "# TYPE wordclock_power_cpu_frequency_hertz gauge\n"
+               "wordclock_power_cpu_frequency_hertz %u000000\n"
+               "# TYPE wordclock_power_speed_switches_total counter\n"
+               "wordclock_power_speed_switches_total %u\n",
+               manager_->enabled(),
+               manager_->enabled() && manager_->lightSleep(),
+               manager_->cpuMhz(), manager_->switches());
+#if POWER_SLEEP_STATS
+    const uint64_t sleep_us = manager_->lightSleepUs();
+    out.printf("# TYPE wordclock_power_light_sleep_seconds_total counter\n"
+               "wordclock_power_light_sleep_seconds_total %lu.%06lu\n"
+               "# TYPE wordclock_power_light_sleeps_total counter\n"
+               "wordclock_power_light_sleeps_total %u\n"
+               "# TYPE wordclock_power_light_sleep_ratio gauge\n"
+               "wordclock_power_light_sleep_ratio %u.%03u\n",
+               static_cast<unsigned long>(sleep_us / 1000000),
+               static_cast<unsigned long>(sleep_us % 1000000),
+               manager_->lightSleeps(), manager_->lightSleepPermille() / 1000,
+               manager_->lightSleepPermille() % 1000);
+#endif
+}
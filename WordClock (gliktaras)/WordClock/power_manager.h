@@ -0,0 +1,122 @@
+#ifndef WORDCLOCK_POWER_MANAGER_H_
+#define WORDCLOCK_POWER_MANAGER_H_
+
+#include "metrics.h"
+#include "render_tick.h"
+
+#include <Arduino.h>
+#if CONFIG_PM_ENABLE
+#include <esp_pm.h>
+#endif
+
+// CPU frequency while the display is busy, in MHz.
+#define POWER_MAX_CPU_MHZ 240
+// CPU frequency while the display is idle, in MHz. The lowest that keeps the
+// APB clock, which the LED, UART and WiFi timings derive from, at 80 MHz.
+#define POWER_IDLE_CPU_MHZ 80
+// Number of idle render ticks in a row before slowing down, so that short
+// pauses of the display do not switch the frequency back and forth.
+#define POWER_IDLE_TICKS 20
+// Window over which the light sleep ratio is measured, in microseconds.
+#define POWER_SLEEP_WINDOW_US 10000000
+// Whether the time spent in light sleep is measured, which needs esp_pm's light
+// sleep callbacks.
+#if CONFIG_PM_ENABLE && CONFIG_PM_LIGHT_SLEEP_CALLBACKS
+#define POWER_SLEEP_STATS 1
+#else
+#define POWER_SLEEP_STATS 0
+#endif
+
+// Lowers the CPU's power draw while the display is idle, e.g. between two
+// minute changes.
+//
+// When power saving is on and the display is idle, the render tick rests,
+// waking the render loop once a second instead of every frame, and the CPU
+// runs at POWER_IDLE_CPU_MHZ. As soon as the display is busy again, both are
+// back at full speed. If the framework was built with power management
+// (CONFIG_PM_ENABLE), esp_pm scales the frequency and enters automatic light
+// sleep whenever every task is blocked, until a timer, the ADC or WiFi wakes
+// the chip up; the render loop holds a lock for full speed while busy.
+// Otherwise, the frequency is switched with setCpuFrequencyMhz(), without light
+// sleep.
+//
+// The time actually spent in light sleep is reported if esp_pm calls back on
+// every light sleep (CONFIG_PM_LIGHT_SLEEP_CALLBACKS). Nothing else is a
+// measure of the power saved: the render loop waiting for its ticks does not
+// mean that the CPU sleeps.
+class PowerManager {
+  public:
+    explicit PowerManager(RenderTick* tick) : tick_(tick) {}
+
+    PowerManager(const PowerManager&) = delete;
+    PowerManager& operator=(const PowerManager&) = delete;
+
+    // Sets power management up, with power saving off. Must be called from
+    // setup(), from the render loop's task.
+    void begin();
+    // Turns power saving on or off. Called from the render loop.
+    void setEnabled(bool enabled);
+    // Accounts for a render tick, during which the display was `idle` or
+    // not, and switches the CPU frequency if needed. Called from the render
+    // loop once per tick.
+    void update(bool idle);
+
+    // Returns whether power saving is on.
+    bool enabled() const { return enabled_; }
+    // Returns whether esp_pm scales the frequency, with light sleep.
+    bool lightSleep() const { return light_sleep_; }
+    // Returns the frequency the CPU was last set to, in MHz, or its highest
+    // one with esp_pm.
+    uint32_t cpuMhz() const { return cpu_mhz_; }
+#if POWER_SLEEP_STATS
+    // Returns the time spent in light sleep since begin(), in microseconds.
+    uint64_t lightSleepUs() const;
+    // Returns the number of light sleeps since begin().
+    uint32_t lightSleeps() const;
+    // Returns the share of the last window spent in light sleep, in
+    // thousandths.
+    uint32_t lightSleepPermille() const { return sleep_permille_; }
+#endif
+    // Returns the number of switches between full and reduced speed.
+    uint32_t switches() const { return switches_; }
+
+  private:
+    // Runs at full speed, or lets the CPU slow down.
+    void setSpeed_(bool full);
+
+    RenderTick* tick_;
+#if CONFIG_PM_ENABLE
+    // Held for full speed while the display is busy.
+    esp_pm_lock_handle_t lock_ = nullptr;
+#endif
+    bool enabled_ = false;
+    bool light_sleep_ = false;
+    bool full_speed_ = true;
+    uint32_t cpu_mhz_ = POWER_MAX_CPU_MHZ;
+    // Number of idle ticks in a row.
+    uint32_t idle_ticks_ = 0;
+    uint32_t switches_ = 0;
+
+#if POWER_SLEEP_STATS
+    // Start of the current light sleep ratio window, and the time spent in
+    // light sleep then, in microseconds.
+    int64_t window_start_us_ = 0;
+    uint64_t window_sleep_us_ = 0;
+    uint32_t sleep_permille_ = 0;
+#endif
+};
+
+// Publishes the state of a power manager on /metrics.
+class PowerManagerMetric : public metrics::Metric {
+  public:
+    explicit PowerManagerMetric(const PowerManager* manager)
+        : Metric("wordclock_power", "Power management state."),
+          manager_(manager) {}
+
+    void writeTo(Print& out) const override;
+
+  private:
+    const PowerManager* manager_;
+};
+
+#endif  // WORDCLOCK_POWER_MANAGER_H_
@@ -0,0 +1,391 @@
+// WebSocket stream of the display's frames.
+
+#include "preview_server.h"
+
+#include "logging.h"
+#include "metrics.h"
+
+#include <lwip/sockets.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/version.h>
+#include <string.h>
+
+namespace {
+
+// Appended to the client's key to compute the handshake answer (RFC 6455).
+#define WEBSOCKET_GUID "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+// Opcodes of the WebSocket frames used.
+#define WEBSOCKET_OPCODE_BINARY 0x2
+#define WEBSOCKET_OPCODE_CLOSE 0x8
+#define WEBSOCKET_OPCODE_PING 0x9
+#define WEBSOCKET_OPCODE_PONG 0xA
+// First byte of a keyframe and of a delta message.
+#define PREVIEW_KEYFRAME 0
+#define PREVIEW_DELTA 1
+// Corners of the face, in the order they are sent.
+const ClockFace::Corners CORNERS[] = {
+    ClockFace::TopLeft, ClockFace::TopRight, ClockFace::BottomRight,
+    ClockFace::BottomLeft};
+#define PREVIEW_CORNER_COUNT 4
+
+// Returns the 8 bit level closest to the 8.8 fixed point `level`.
+uint8_t round8(uint16_t level) {
+    return level >= 0xFF80 ? 0xFF : (level + 0x80) >> 8;
+}
+
+// Finds header `name` in the NUL-terminated `request` and copies its trimmed
+// value into `value`. Returns false if it is missing or too long.
+bool findHeader(const char* request, const char* name, char* value,
+                size_t size) {
+    const size_t name_length = strlen(name);
+    for (const char* line = strstr(request, "\r\n"); line != nullptr;
+         line = strstr(line, "\r\n")) {
+        line += 2;
+        if (strncasecmp(line, name, name_length) != 0 ||
+            line[name_length] != ':') {
+            continue;
+        }
+        const char* start = line + name_length + 1;
+        while (*start == ' ') start++;
+        const char* end = strstr(start, "\r\n");
+        while (end > start && end[-1] == ' ') end--;
+        if (static_cast<size_t>(end - start) >= size) return false;
+        memcpy(value, start, end - start);
+        value[end - start] = 0;
+        return true;
+    }
+    return false;
+}
+
+// Computes the Sec-WebSocket-Accept value for `key`.
+bool acceptKey(const char* key, char* accept, size_t size) {
+    char input[64 + sizeof(WEBSOCKET_GUID)];
+    const int length = snprintf(input, sizeof(input), "%s" WEBSOCKET_GUID,
+                                key);
+    if (length >= static_cast<int>(sizeof(input))) return false;
+    unsigned char digest[20];
+#if MBEDTLS_VERSION_NUMBER >= 0x03000000
+    mbedtls_sha1(reinterpret_cast<const unsigned char*>(input), length,
+                 digest);
+#else
+    mbedtls_sha1_ret(reinterpret_cast<const unsigned char*>(input), length,
+                     digest);
+#endif
+    size_t written;
+    if (mbedtls_base64_encode(reinterpret_cast<unsigned char*>(accept),
+                              size - 1, &written, digest,
+                              sizeof(digest)) != 0) {
+        return false;
+    }
+    accept[written] = 0;
+    return true;
+}
+
+}  // namespace
+
+PreviewServer::PreviewServer()
+    : server_(PREVIEW_SERVER_PORT),
+      latest_(ClockFace::pixelCount() * 3),
+      captured_(ClockFace::pixelCount() * 3),
+      frame_(ClockFace::pixelCount() * 3) {
+    for (Client& client : clients_) {
+        client.shown.resize(ClockFace::pixelCount() * 3);
+    }
+}
+
+void PreviewServer::begin() {
+    server_.begin();
+    server_.setNoDelay(true);
+}
+
+void PreviewServer::capture(const ClockFace& face, const WideColor* frame) {
+    const uint32_t interval_ms = capture_interval_ms_;
+    if (interval_ms == 0) return;
+    const uint32_t now = millis();
+    if (now - captured_ms_ < interval_ms) return;
+    captured_ms_ = now;
+
+    TIME_SCOPE(metrics::preview_capture_duration);
+    uint8_t* out = captured_.data();
+    const auto put = [&out](const WideColor& color) {
+        *out++ = round8(color.R);
+        *out++ = round8(color.G);
+        *out++ = round8(color.B);
+    };
+    for (int y = 0; y < ClockFace::gridHeight(); y++) {
+        for (int x = 0; x < ClockFace::gridWidth(); x++) {
+            put(frame[face.map(x, y)]);
+        }
+    }
+    for (ClockFace::Corners corner : CORNERS) {
+        put(frame[face.mapMinute(corner)]);
+    }
+
+    portENTER_CRITICAL(&mux_);
+    memcpy(latest_.data(), captured_.data(), latest_.size());
+    latest_sequence_++;
+    portEXIT_CRITICAL(&mux_);
+}
+
+void PreviewServer::loop() {
+    accept_();
+    for (Client& client : clients_) {
+        if (client.state == State::FREE) continue;
+        if (!client.socket.connected() || !flush_(&client)) {
+            close_(&client);
+            continue;
+        }
+        switch (client.state) {
+            case State::HANDSHAKE:
+                readHandshake_(&client);
+                break;
+            case State::OPEN:
+                readFrames_(&client);
+                if (client.state == State::OPEN) sendFrame_(&client);
+                break;
+            case State::CLOSING:
+                if (client.out_sent == client.out_length ||
+                    millis() - client.state_ms > PREVIEW_HANDSHAKE_TIMEOUT_MS) {
+                    close_(&client);
+                }
+                break;
+            case State::FREE:
+                break;
+        }
+    }
+}
+
+void PreviewServer::accept_() {
+    WiFiClient socket = server_.available();
+    if (!socket) return;
+    for (Client& client : clients_) {
+        if (client.state != State::FREE) continue;
+        client.socket = socket;
+        client.state = State::HANDSHAKE;
+        client.state_ms = millis();
+        client.request_length = 0;
+        client.in_length = 0;
+        client.out_length = client.out_sent = 0;
+        client.has_shown = false;
+        return;
+    }
+    LOGW("Preview client turned away, %d already connected.",
+         PREVIEW_MAX_CLIENTS);
+    socket.stop();
+}
+
+void PreviewServer::readHandshake_(Client* client) {
+    const int available = client->socket.available();
+    const size_t room = sizeof(client->request) - 1 - client->request_length;
+    if (available > 0 && room > 0) {
+        const int read = client->socket.read(
+            reinterpret_cast<uint8_t*>(client->request) +
+                client->request_length,
+            min(static_cast<size_t>(available), room));
+        if (read > 0) client->request_length += read;
+        client->request[client->request_length] = 0;
+    }
+    if (strstr(client->request, "\r\n\r\n") != nullptr) {
+        answerHandshake_(client);
+    } else if (client->request_length == sizeof(client->request) - 1 ||
+               millis() - client->state_ms > PREVIEW_HANDSHAKE_TIMEOUT_MS) {
+        close_(client);
+    }
+}
+
+void PreviewServer::answerHandshake_(Client* client) {
+    static const char BAD_REQUEST[] =
+        "HTTP/1.1 400 Bad Request\r\nConnection: close\r\n\r\n";
+    char key[64];
+    char accept[32];
+    if (strncmp(client->request, "GET ", 4) != 0 ||
+        !findHeader(client->request, "Sec-WebSocket-Key", key, sizeof(key)) ||
+        !acceptKey(key, accept, sizeof(accept))) {
+        memcpy(client->out, BAD_REQUEST, sizeof(BAD_REQUEST) - 1);
+        client->out_length = sizeof(BAD_REQUEST) - 1;
+        client->state = State::CLOSING;
+        client->state_ms = millis();
+        return;
+    }
+
+    // The frame rate is the only parameter of the request line.
+    int fps = PREVIEW_DEFAULT_FPS;
+    const char* line_end = strstr(client->request, "\r\n");
+    const char* parameter = strstr(client->request, "fps=");
+    if (parameter != nullptr && parameter < line_end) {
+        fps = constrain(atoi(parameter + 4), 1, PREVIEW_MAX_FPS);
+    }
+    client->interval_ms = 1000 / fps;
+
+    client->out_length = snprintf(
+        reinterpret_cast<char*>(client->out), sizeof(client->out),
+        "HTTP/1.1 101 Switching Protocols\r\n"
+        "Upgrade: websocket\r\n"
+        "Connection: Upgrade\r\n"
+        "Sec-WebSocket-Accept: %s\r\n\r\n",
+        accept);
+    client->state = State::OPEN;
+    // The first frame is sent as soon as one is captured.
+    client->sent_ms = millis() - client->interval_ms;
+    client->sequence = frame_sequence_;
+    updateInterval_();
+    LOGI("Preview client connected at %d fps.", fps);
+}
+
+void PreviewServer::readFrames_(Client* client) {
+    const int available = client->socket.available();
+    const size_t room = sizeof(client->in) - client->in_length;
+    if (available > 0 && room > 0) {
+        const int read = client->socket.read(client->in + client->in_length,
+                                             min(static_cast<size_t>(available),
+                                                 room));
+        if (read > 0) client->in_length += read;
+    }
+
+    while (client->in_length >= 2) {
+        const uint8_t opcode = client->in[0] & 0x0F;
+        const bool masked = client->in[1] & 0x80;
+        const size_t length = client->in[1] & 0x7F;
+        // Clients have no reason to send anything longer than a control frame.
+        if (!masked || length > 125) {
+            close_(client);
+            return;
+        }
+        const size_t size = 2 + 4 + length;
+        if (client->in_length < size) return;
+
+        uint8_t* payload = client->in + 6;
+        for (size_t i = 0; i < length; i++) {
+            payload[i] ^= client->in[2 + i % 4];
+        }
+        if (opcode == WEBSOCKET_OPCODE_CLOSE) {
+            // Echo the close frame, then hang up once it is sent.
+            client->out_length = client->out_sent = 0;
+            queueMessage_(client, WEBSOCKET_OPCODE_CLOSE, payload,
+                          min(length, static_cast<size_t>(2)));
+            client->state = State::CLOSING;
+            client->state_ms = millis();
+            updateInterval_();
+            LOGI("Preview client disconnected.");
+            return;
+        }
+        // A ping that finds a frame being sent is dropped; browsers ping again.
+        if (opcode == WEBSOCKET_OPCODE_PING &&
+            client->out_sent == client->out_length) {
+            client->out_length = client->out_sent = 0;
+            queueMessage_(client, WEBSOCKET_OPCODE_PONG, payload, length);
+        }
+        memmove(client->in, client->in + size, client->in_length - size);
+        client->in_length -= size;
+    }
+}
+
+void PreviewServer::sendFrame_(Client* client) {
+    if (client->out_sent != client->out_length) return;
+    const uint32_t now = millis();
+    if (now - client->sent_ms < client->interval_ms) return;
+
+    if (frame_sequence_ != latest_sequence_) {
+        portENTER_CRITICAL(&mux_);
+        memcpy(frame_.data(), latest_.data(), frame_.size());
+        frame_sequence_ = latest_sequence_;
+        portEXIT_CRITICAL(&mux_);
+    }
+    if (client->sequence == frame_sequence_) return;
+    client->sequence = frame_sequence_;
+
+    const size_t pixels = frame_.size() / 3;
+    uint8_t message[PREVIEW_MESSAGE_SIZE - 4];
+    size_t size = 0;
+    size_t changed = 0;
+    if (client->has_shown && pixels <= 256) {
+        for (size_t i = 0; i < pixels; i++) {
+            if (memcmp(&frame_[i * 3], &client->shown[i * 3], 3) != 0) {
+                changed++;
+            }
+        }
+        if (changed == 0) return;
+    }
+    if (client->has_shown && pixels <= 256 && 1 + changed * 4 < 4 + pixels * 3) {
+        message[size++] = PREVIEW_DELTA;
+        for (size_t i = 0; i < pixels; i++) {
+            if (memcmp(&frame_[i * 3], &client->shown[i * 3], 3) == 0) continue;
+            message[size++] = i;
+            memcpy(message + size, &frame_[i * 3], 3);
+            size += 3;
+        }
+    } else {
+        if (4 + frame_.size() > sizeof(message)) {
+            LOGE("Preview keyframe does not fit its buffer.");
+            close_(client);
+            return;
+        }
+        message[size++] = PREVIEW_KEYFRAME;
+        message[size++] = ClockFace::gridWidth();
+        message[size++] = ClockFace::gridHeight();
+        message[size++] = PREVIEW_CORNER_COUNT;
+        memcpy(message + size, frame_.data(), frame_.size());
+        size += frame_.size();
+    }
+
+    client->out_length = client->out_sent = 0;
+    queueMessage_(client, WEBSOCKET_OPCODE_BINARY, message, size);
+    memcpy(client->shown.data(), frame_.data(), frame_.size());
+    client->has_shown = true;
+    client->sent_ms = now;
+    flush_(client);
+}
+
+void PreviewServer::queueMessage_(Client* client, uint8_t opcode,
+                                  const uint8_t* payload, size_t size) {
+    uint8_t* out = client->out;
+    *out++ = 0x80 | opcode;
+    if (size < 126) {
+        *out++ = size;
+    } else {
+        *out++ = 126;
+        *out++ = size >> 8;
+        *out++ = size & 0xFF;
+    }
+    memcpy(out, payload, size);
+    client->out_length = out - client->out + size;
+    client->out_sent = 0;
+}
+
+bool PreviewServer::flush_(Client* client) {
+    while (client->out_sent < client->out_length) {
+        const int sent = send(client->socket.fd(),
+                              client->out + client->out_sent,
+                              client->out_length - client->out_sent,
+                              MSG_DONTWAIT);
+        if (sent > 0) {
+            client->out_sent += sent;
+        } else if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // The client fell behind. Frames captured meanwhile are skipped.
+            return true;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PreviewServer::close_(Client* client) {
+    if (client->state == State::FREE) return;
+    if (client->state == State::OPEN) LOGI("Preview client disconnected.");
+    client->socket.stop();
+    client->state = State::FREE;
+    updateInterval_();
+}
+
+void PreviewServer::updateInterval_() {
+    uint32_t interval_ms = 0;
+    for (const Client& client : clients_) {
+        if (client.state != State::OPEN) continue;
+        if (interval_ms == 0 || client.interval_ms < interval_ms) {
+            interval_ms = client.interval_ms;
+        }
+    }
+    capture_interval_ms_ = interval_ms;
+}
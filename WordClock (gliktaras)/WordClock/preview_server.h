@@ -0,0 +1,152 @@
+#ifndef WORDCLOCK_PREVIEW_SERVER_H_
+#define WORDCLOCK_PREVIEW_SERVER_H_
+
+#include "ClockFace.h"
+#include "Dither.h"
+
+#include <WiFi.h>
+
+#include <vector>
+
+// Port of the preview's WebSocket server.
+#define PREVIEW_SERVER_PORT 81
+// Number of clients served at once. Others are turned away.
+#define PREVIEW_MAX_CLIENTS 2
+// Frame rate of clients that do not ask for one, in frames per second.
+#define PREVIEW_DEFAULT_FPS 10
+// Highest frame rate a client may ask for, in frames per second.
+#define PREVIEW_MAX_FPS 25
+// Time a client has to complete the WebSocket handshake, and to take the last
+// message before being disconnected, in milliseconds.
+#define PREVIEW_HANDSHAKE_TIMEOUT_MS 2000
+// Size of the buffer of the handshake request, in bytes.
+#define PREVIEW_REQUEST_SIZE 512
+// Size of the buffer of a frame received from a client, in bytes. Fits the
+// largest control frame.
+#define PREVIEW_CONTROL_SIZE 131
+// Size of the buffer of a message sent to a client, in bytes. Fits a keyframe
+// of every LED with its header, and the handshake response.
+#define PREVIEW_MESSAGE_SIZE                   \
+    (8 + ClockFace::pixelCount() * 3 > 384     \
+         ? 8 + ClockFace::pixelCount() * 3     \
+         : 384)
+
+// Streams what the display shows to browsers over WebSocket, e.g. to see a
+// clock remotely during a support call.
+//
+// Clients connect to ws://<clock>:81/?fps=<rate>. Each binary message is
+// either a keyframe,
+//
+//     0, grid width, grid height, corner count, RGB of every LED
+//
+// or a delta against the previous message,
+//
+//     1, then index and RGB of every LED that changed
+//
+// where LEDs are ordered row by row over the grid, followed by the corners
+// clockwise from the top left one. Colors are the display's frame before
+// dithering, rounded to 8 bits. Canvases of more than 256 LEDs are only sent
+// keyframes, as deltas index LEDs with a byte.
+//
+// The render loop calls capture(), which only converts a frame when a client
+// is due for one. The network task calls loop(), which sends the latest frame
+// to each client whose previous message was fully sent, so a slow client
+// skips frames instead of queueing them, and never blocks the task.
+class PreviewServer {
+  public:
+    PreviewServer();
+
+    PreviewServer(const PreviewServer&) = delete;
+    PreviewServer& operator=(const PreviewServer&) = delete;
+
+    // Starts listening. Must be called once the network stack is up.
+    void begin();
+    // Takes a copy of `frame`, the color of every LED of `face` in strip
+    // order, if a client is due for one. Called from the render loop.
+    void capture(const ClockFace& face, const WideColor* frame);
+    // Accepts clients, completes handshakes and sends frames. Called from the
+    // network task.
+    void loop();
+
+  private:
+    // Connection states of a client.
+    enum class State {
+        FREE,
+        // Waiting for the whole handshake request.
+        HANDSHAKE,
+        // Receiving frames.
+        OPEN,
+        // Closing once the last message is sent.
+        CLOSING,
+    };
+
+    struct Client {
+        WiFiClient socket;
+        State state = State::FREE;
+        // When the client entered its current state, in milliseconds.
+        uint32_t state_ms = 0;
+        char request[PREVIEW_REQUEST_SIZE];
+        size_t request_length = 0;
+        // Shortest time between two frames, in milliseconds.
+        uint32_t interval_ms = 0;
+        // When the last frame was sent, in milliseconds.
+        uint32_t sent_ms = 0;
+        // Sequence number of the last frame sent.
+        uint32_t sequence = 0;
+        // Whether `shown` holds the last frame sent, which deltas are
+        // relative to.
+        bool has_shown = false;
+        std::vector<uint8_t> shown;
+        // Partial frame received from the client.
+        uint8_t in[PREVIEW_CONTROL_SIZE];
+        size_t in_length = 0;
+        // Message being sent, and how much of it was sent.
+        uint8_t out[PREVIEW_MESSAGE_SIZE];
+        size_t out_length = 0;
+        size_t out_sent = 0;
+    };
+
+    // Accepts a waiting connection, if any.
+    void accept_();
+    // Reads the handshake request, and answers it once complete.
+    void readHandshake_(Client* client);
+    // Answers a complete handshake request.
+    void answerHandshake_(Client* client);
+    // Reads and answers frames sent by the client.
+    void readFrames_(Client* client);
+    // Queues the latest frame, as a keyframe or a delta, if one is due.
+    void sendFrame_(Client* client);
+    // Queues a message of `size` bytes at `payload` with a WebSocket header.
+    // The message buffer must be empty.
+    void queueMessage_(Client* client, uint8_t opcode, const uint8_t* payload,
+                       size_t size);
+    // Sends as much of the queued message as the socket takes without
+    // blocking. Returns false if the connection failed.
+    bool flush_(Client* client);
+    // Closes the connection.
+    void close_(Client* client);
+    // Updates capture_interval_ms_ from the open clients.
+    void updateInterval_();
+
+    WiFiServer server_;
+    Client clients_[PREVIEW_MAX_CLIENTS];
+
+    // Latest captured frame and its sequence number, guarded by mux_, which
+    // is only held to copy them.
+    portMUX_TYPE mux_ = portMUX_INITIALIZER_UNLOCKED;
+    std::vector<uint8_t> latest_;
+    volatile uint32_t latest_sequence_ = 0;
+    // Shortest interval any open client wants frames at, in milliseconds, or
+    // 0 if there is none, in which case nothing is captured.
+    volatile uint32_t capture_interval_ms_ = 0;
+
+    // Render loop side: conversion buffer and time of the last capture.
+    std::vector<uint8_t> captured_;
+    uint32_t captured_ms_ = 0;
+
+    // Network task side: copy of latest_ and its sequence number.
+    std::vector<uint8_t> frame_;
+    uint32_t frame_sequence_ = 0;
+};
+
+#endif  // WORDCLOCK_PREVIEW_SERVER_H_
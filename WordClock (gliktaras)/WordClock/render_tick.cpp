@@ -0,0 +1,97 @@
+#include "render_tick.h"
+
+#include "logging.h"
+
+#include <sys/time.h>
+
+bool RenderTick::begin() {
+    task_ = xTaskGetCurrentTaskHandle();
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer_;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "render";
+    if (esp_timer_create(&args, &timer_) != ESP_OK) {
+        LOGE("Cannot create the render timer.");
+        timer_ = nullptr;
+        return false;
+    }
+    if (!startPeriodic_()) {
+        LOGE("Cannot start the render timer.");
+        esp_timer_delete(timer_);
+        timer_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+uint32_t RenderTick::wait() {
+    if (timer_ == nullptr) return 1;
+    const int64_t wait_us = esp_timer_get_time();
+    uint32_t timeout_us = period_us_ * 4;
+    if (resting_) {
+        struct timeval now;
+        gettimeofday(&now, nullptr);
+        const uint32_t delay_us = RENDER_TICK_REST_PERIOD_US -
+                                  now.tv_usec % RENDER_TICK_REST_PERIOD_US;
+        // Stopped first, in case the last one-shot tick timed out.
+        esp_timer_stop(timer_);
+        esp_timer_start_once(timer_, delay_us);
+        rest_due_us_ = wait_us + delay_us;
+        timeout_us += delay_us;
+    }
+    // Bounded, so that a stalled timer slows the loop down instead of
+    // stopping it.
+    const uint32_t count =
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_us / 1000) + 1);
+    const int64_t now_us = esp_timer_get_time();
+    idle_us_ += now_us - wait_us;
+    if (count == 0) return 0;
+    ticks_ += count;
+
+    int64_t due_us = rest_due_us_;
+    if (!resting_) {
+        late_frames_ += count - 1;
+        scheduled_ticks_ += count;
+        due_us = start_us_ + static_cast<int64_t>(scheduled_ticks_) * period_us_;
+    }
+    const int64_t late_us = now_us - due_us;
+    metrics::render_tick_jitter.observe(late_us > 0 ? late_us : 0);
+    return count;
+}
+
+void RenderTick::setResting(bool resting) {
+    if (timer_ == nullptr || resting == resting_) return;
+    resting_ = resting;
+    esp_timer_stop(timer_);
+    // Drops a tick of the previous schedule that was not waited for yet.
+    ulTaskNotifyTake(pdTRUE, 0);
+    if (!resting && !startPeriodic_()) {
+        LOGE("Cannot restart the render timer.");
+    }
+}
+
+bool RenderTick::startPeriodic_() {
+    start_us_ = esp_timer_get_time();
+    scheduled_ticks_ = 0;
+    return esp_timer_start_periodic(timer_, period_us_) == ESP_OK;
+}
+
+void RenderTick::onTimer_(void* arg) {
+    xTaskNotifyGive(static_cast<RenderTick*>(arg)->task_);
+}
+
+void RenderTickMetric::writeTo(Print& out) const {
+    out.printf("# TYPE wordclock_render_tick_period_seconds gauge\n"
+               "wordclock_render_tick_period_seconds %.6f\n"
+               "# TYPE wordclock_render_ticks_total counter\n"
+               "wordclock_render_ticks_total %u\n"
+               "# TYPE wordclock_render_late_frames_total counter\n"
+               "wordclock_render_late_frames_total %u\n"
+               "# TYPE wordclock_render_idle_seconds_total counter\n"
+               "wordclock_render_idle_seconds_total %.6f\n"
+               "# TYPE wordclock_render_tick_resting gauge\n"
+               "wordclock_render_tick_resting %d\n",
+               tick_->periodUs() / 1e6, tick_->ticks(), tick_->lateFrames(),
+               tick_->idleUs() / 1e6, tick_->resting());
+}
@@ -0,0 +1,94 @@
+#ifndef WORDCLOCK_RENDER_TICK_H_
+#define WORDCLOCK_RENDER_TICK_H_
+
+#include "metrics.h"
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+// Time between two frames, in microseconds. Fast enough for the temporal
+// dithering cycle not to flicker, and longer than sending a frame to the LEDs.
+#define RENDER_TICK_PERIOD_US 5000
+// Time between two ticks while resting, in microseconds. Ticks then fall on
+// whole seconds of the system clock, when the time shown can change.
+#define RENDER_TICK_REST_PERIOD_US 1000000
+
+// Wakes the render loop at exact intervals.
+//
+// A periodic esp_timer notifies the task that called begin(), which blocks in
+// wait() until then, so frames are evenly spaced whatever else the loop did and
+// the interval does not drift with the loop's duration. Every wake-up records
+// how late it came against the timer's schedule into
+// metrics::render_tick_jitter. When an iteration overruns, the ticks it missed
+// are counted as late frames and wait() returns at once, so the loop catches up
+// instead of falling behind. The time spent blocked in wait() is the render
+// loop's idle time.
+//
+// While resting, e.g. when the display is still, the periodic timer is stopped
+// and every wait() arms a one-shot timer for the next whole second instead, so
+// that the CPU is not woken up 200 times a second for nothing.
+class RenderTick {
+  public:
+    explicit RenderTick(uint32_t period_us = RENDER_TICK_PERIOD_US)
+        : period_us_(period_us) {}
+
+    RenderTick(const RenderTick&) = delete;
+    RenderTick& operator=(const RenderTick&) = delete;
+
+    // Starts the timer. The calling task is the one woken up. Returns false
+    // on failure, in which case wait() returns at once.
+    bool begin();
+    // Blocks until the next tick. Returns the number of ticks since the
+    // previous call, more than 1 if the loop overran, or 0 if the timer
+    // stalled.
+    uint32_t wait();
+    // Ticks every RENDER_TICK_REST_PERIOD_US if `resting`, or every period
+    // again. Called from the task that called begin().
+    void setResting(bool resting);
+
+    // Returns whether the tick is resting.
+    bool resting() const { return resting_; }
+
+    // Returns the interval between two ticks, in microseconds.
+    uint32_t periodUs() const { return period_us_; }
+    // Returns the number of ticks since begin().
+    uint32_t ticks() const { return ticks_; }
+    // Returns the number of ticks that passed while the loop was busy.
+    uint32_t lateFrames() const { return late_frames_; }
+    // Returns the time spent waiting for ticks, in microseconds.
+    uint64_t idleUs() const { return idle_us_; }
+
+  private:
+    // Notifies task_. Runs on the esp_timer task.
+    static void onTimer_(void* arg);
+    // Starts the periodic timer. Returns false on failure.
+    bool startPeriodic_();
+
+    const uint32_t period_us_;
+    esp_timer_handle_t timer_ = nullptr;
+    TaskHandle_t task_ = nullptr;
+    bool resting_ = false;
+    // When the periodic timer was started, from which its ticks are
+    // scheduled, and the number of them since, in microseconds.
+    int64_t start_us_ = 0;
+    uint32_t scheduled_ticks_ = 0;
+    // When the one-shot timer of a resting tick is due, in microseconds.
+    int64_t rest_due_us_ = 0;
+    uint32_t ticks_ = 0;
+    uint32_t late_frames_ = 0;
+    uint64_t idle_us_ = 0;
+};
+
+// Publishes the counters of a render tick on /metrics.
+class RenderTickMetric : public metrics::Metric {
+  public:
+    explicit RenderTickMetric(const RenderTick* tick)
+        : Metric("wordclock_render", "Render tick state."), tick_(tick) {}
+
+    void writeTo(Print& out) const override;
+
+  private:
+    const RenderTick* tick_;
+};
+
+#endif  // WORDCLOCK_RENDER_TICK_H_
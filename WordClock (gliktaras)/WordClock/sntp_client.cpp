@@ -0,0 +1,312 @@
+// SNTP client with server filtering and clock slewing.
+
+#include "sntp_client.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+namespace {
+
+// Seconds from the NTP epoch (1900) to the Unix epoch (1970).
+#define NTP_UNIX_OFFSET_S 2208988800LL
+// First byte of a request: no leap warning, version 4, client mode.
+#define NTP_REQUEST_HEADER 0x23
+// Modes of the first byte.
+#define NTP_MODE_MASK 0x07
+#define NTP_MODE_SERVER 4
+// Leap indicator of an unsynchronized server.
+#define NTP_LEAP_UNSYNCHRONIZED 3
+// Offsets of the fields in a packet.
+#define NTP_STRATUM_OFFSET 1
+#define NTP_ORIGIN_OFFSET 24
+#define NTP_RECEIVE_OFFSET 32
+#define NTP_TRANSMIT_OFFSET 40
+// Highest valid stratum. Stratum 0 is a kiss-o'-death reply.
+#define NTP_MAX_STRATUM 15
+// Growth of a sample's uncertainty with age, in microseconds per second
+// (NTP's 15 ppm).
+#define SAMPLE_AGING_US_PER_S 15
+// Time until the next poll while the clock is not synchronized, in seconds.
+#define SNTP_RETRY_S 16
+// Time between corrections at which half of the residual offset is attributed
+// to drift, in milliseconds. Shorter baselines have noisier offsets, and count
+// for less.
+#define DRIFT_TIME_CONSTANT_MS (4 * SNTP_MIN_POLL_S * 1000.0f)
+
+uint64_t readTimestamp(const uint8_t* bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) value = (value << 8) | bytes[i];
+    return value;
+}
+
+void writeTimestamp(uint64_t value, uint8_t* bytes) {
+    for (int i = 7; i >= 0; i--) {
+        bytes[i] = value & 0xFF;
+        value >>= 8;
+    }
+}
+
+int compareOffsets(const void* a, const void* b) {
+    const int64_t left = *static_cast<const int64_t*>(a);
+    const int64_t right = *static_cast<const int64_t*>(b);
+    return left < right ? -1 : left > right ? 1 : 0;
+}
+
+}  // namespace
+
+SntpClient::SntpClient(SntpTransport* transport, SntpClock* clock)
+    : transport_(transport), clock_(clock) {
+    memset(servers_, 0, sizeof(servers_));
+}
+
+void SntpClient::setServers(const char* const* hosts, int count) {
+    server_count_ = count < SNTP_MAX_SERVERS ? count : SNTP_MAX_SERVERS;
+    memset(servers_, 0, sizeof(servers_));
+    for (int i = 0; i < server_count_; i++) {
+        servers_[i].host = hosts[i];
+        transport_->forget(i);
+    }
+    polling_ = false;
+    poll_now_ = true;
+}
+
+void SntpClient::pollNow() {
+    poll_now_ = true;
+}
+
+uint64_t SntpClient::toNtp_(int64_t unix_us) {
+    const int64_t seconds = unix_us / 1000000;
+    const uint64_t micros = unix_us % 1000000;
+    // Wraps into the next era after 2036, as NTP timestamps do.
+    const uint32_t ntp_seconds = static_cast<uint32_t>(seconds +
+                                                       NTP_UNIX_OFFSET_S);
+    return (static_cast<uint64_t>(ntp_seconds) << 32) |
+           ((micros << 32) / 1000000);
+}
+
+int64_t SntpClient::fromNtp_(uint64_t ntp) {
+    int64_t seconds = ntp >> 32;
+    // Timestamps with the high bit clear are from era 1, 2036 to 2104.
+    if (seconds < 0x80000000LL) seconds += 1LL << 32;
+    const int64_t micros = ((ntp & 0xFFFFFFFFULL) * 1000000) >> 32;
+    return (seconds - NTP_UNIX_OFFSET_S) * 1000000 + micros;
+}
+
+void SntpClient::loop() {
+    receiveReplies_();
+    const uint32_t now = clock_->monotonicMs();
+    if (polling_) {
+        bool answered = true;
+        for (int i = 0; i < server_count_; i++) {
+            if (servers_[i].pending_timestamp != 0) answered = false;
+        }
+        if (answered || now - poll_ms_ >= SNTP_TIMEOUT_MS) finishPoll_();
+        return;
+    }
+    if (server_count_ == 0) return;
+
+    const uint32_t interval_s = synchronized_ ? poll_interval_s_ : SNTP_RETRY_S;
+    if (poll_now_ || now - poll_ms_ >= interval_s * 1000UL) {
+        sendRequests_();
+    } else if (synchronized_ &&
+               now - last_compensation_ms_ >= SNTP_DRIFT_PERIOD_MS) {
+        compensateDrift_();
+    }
+}
+
+void SntpClient::sendRequests_() {
+    poll_now_ = false;
+    polling_ = true;
+    poll_ms_ = clock_->monotonicMs();
+    for (int i = 0; i < server_count_; i++) {
+        Server& server = servers_[i];
+        server.reach <<= 1;
+        uint8_t packet[SNTP_PACKET_SIZE] = {NTP_REQUEST_HEADER};
+        server.sent_us = clock_->realtimeUs();
+        // The server echoes the transmit timestamp, which identifies the
+        // reply. The lowest bits, far below the clock's resolution, make it
+        // unique per server.
+        server.pending_timestamp = (toNtp_(server.sent_us) & ~0x3ULL) | i;
+        writeTimestamp(server.pending_timestamp, packet + NTP_TRANSMIT_OFFSET);
+        if (!transport_->send(i, server.host, packet, sizeof(packet))) {
+            server.pending_timestamp = 0;
+        }
+    }
+}
+
+void SntpClient::receiveReplies_() {
+    uint8_t packet[SNTP_PACKET_SIZE];
+    size_t size;
+    while ((size = transport_->receive(packet, sizeof(packet))) != 0) {
+        if (size >= SNTP_PACKET_SIZE) {
+            processReply_(packet, clock_->realtimeUs());
+        }
+    }
+}
+
+void SntpClient::processReply_(const uint8_t* packet, int64_t received_us) {
+    const uint64_t origin = readTimestamp(packet + NTP_ORIGIN_OFFSET);
+    Server* server = nullptr;
+    for (int i = 0; i < server_count_; i++) {
+        if (origin != 0 && servers_[i].pending_timestamp == origin) {
+            server = &servers_[i];
+        }
+    }
+    // Stale, duplicate or forged.
+    if (server == nullptr) return;
+    server->pending_timestamp = 0;
+
+    const uint8_t stratum = packet[NTP_STRATUM_OFFSET];
+    if ((packet[0] & NTP_MODE_MASK) != NTP_MODE_SERVER ||
+        packet[0] >> 6 == NTP_LEAP_UNSYNCHRONIZED || stratum == 0 ||
+        stratum > NTP_MAX_STRATUM) {
+        return;
+    }
+
+    const int64_t t1 = server->sent_us;
+    const int64_t t2 = fromNtp_(readTimestamp(packet + NTP_RECEIVE_OFFSET));
+    const int64_t t3 = fromNtp_(readTimestamp(packet + NTP_TRANSMIT_OFFSET));
+    const int64_t t4 = received_us;
+    const int64_t delay = (t4 - t1) - (t3 - t2);
+
+    Sample& sample = server->samples[server->next_sample];
+    sample.offset_us = ((t2 - t1) + (t3 - t4)) / 2;
+    sample.delay_us = delay > 0 ? delay : 0;
+    sample.time_ms = clock_->monotonicMs();
+    sample.used = false;
+    server->next_sample = (server->next_sample + 1) % SNTP_FILTER_SIZE;
+    if (server->sample_count < SNTP_FILTER_SIZE) server->sample_count++;
+    server->reach |= 1;
+}
+
+int SntpClient::bestSample_(const Server& server, uint32_t now_ms) {
+    int best = -1;
+    uint64_t best_score = 0;
+    for (int i = 0; i < server.sample_count; i++) {
+        const Sample& sample = server.samples[i];
+        // Older samples are less trustworthy, whatever their round trip.
+        const uint64_t score =
+            sample.delay_us +
+            static_cast<uint64_t>(now_ms - sample.time_ms) / 1000 *
+                SAMPLE_AGING_US_PER_S;
+        if (best < 0 || score < best_score) {
+            best = i;
+            best_score = score;
+        }
+    }
+    return best;
+}
+
+void SntpClient::finishPoll_() {
+    polling_ = false;
+    const uint32_t now = clock_->monotonicMs();
+    poll_ms_ = now;
+
+    // Servers that answered this poll, and their best samples.
+    Sample* samples[SNTP_MAX_SERVERS];
+    uint32_t best_delay = UINT32_MAX;
+    for (int i = 0; i < server_count_; i++) {
+        Server& server = servers_[i];
+        server.pending_timestamp = 0;
+        server.selected = false;
+        if (server.reach == 0) transport_->forget(i);
+        const int best = (server.reach & 1) ? bestSample_(server, now) : -1;
+        samples[i] = best >= 0 ? &server.samples[best] : nullptr;
+        if (samples[i] != nullptr && samples[i]->delay_us < best_delay) {
+            best_delay = samples[i]->delay_us;
+        }
+    }
+
+    // Servers much further away than the best one are the most likely to see
+    // asymmetric delays. A sample that was used before has nothing new to
+    // tell: its server sits this poll out until a better sample arrives or the
+    // old one leaves the filter.
+    int64_t offsets[SNTP_MAX_SERVERS];
+    int count = 0;
+    for (int i = 0; i < server_count_; i++) {
+        if (samples[i] == nullptr || samples[i]->used ||
+            samples[i]->delay_us > 2 * best_delay + SNTP_DELAY_MARGIN_US) {
+            continue;
+        }
+        servers_[i].selected = true;
+        samples[i]->used = true;
+        offsets[count++] = samples[i]->offset_us;
+    }
+    if (count == 0) return;
+
+    qsort(offsets, count, sizeof(offsets[0]), compareOffsets);
+    last_offset_us_ = count % 2 == 1
+                          ? offsets[count / 2]
+                          : (offsets[count / 2 - 1] + offsets[count / 2]) / 2;
+    last_delay_us_ = best_delay;
+    correct_(last_offset_us_);
+}
+
+void SntpClient::correct_(int64_t offset_us) {
+    const uint32_t now = clock_->monotonicMs();
+    const int64_t magnitude = offset_us < 0 ? -offset_us : offset_us;
+    if (!synchronized_ || magnitude > SNTP_STEP_THRESHOLD_US) {
+        clock_->step(offset_us);
+        steps_++;
+        poll_interval_s_ = SNTP_MIN_POLL_S;
+    } else {
+        clock_->slew(offset_us);
+        slews_++;
+        // What drift compensation missed since the last correction.
+        const float elapsed_ms = now - last_correction_ms_;
+        if (elapsed_ms > 0) {
+            const float gain = elapsed_ms / (elapsed_ms + DRIFT_TIME_CONSTANT_MS);
+            drift_ppm_ += gain * offset_us * 1000.0f / elapsed_ms;
+            if (drift_ppm_ > SNTP_MAX_DRIFT_PPM) drift_ppm_ = SNTP_MAX_DRIFT_PPM;
+            if (drift_ppm_ < -SNTP_MAX_DRIFT_PPM) {
+                drift_ppm_ = -SNTP_MAX_DRIFT_PPM;
+            }
+        }
+        if (magnitude < SNTP_STABLE_OFFSET_US) {
+            poll_interval_s_ = poll_interval_s_ * 2 < SNTP_MAX_POLL_S
+                                   ? poll_interval_s_ * 2
+                                   : SNTP_MAX_POLL_S;
+        } else if (magnitude > 4 * SNTP_STABLE_OFFSET_US) {
+            poll_interval_s_ = poll_interval_s_ / 2 > SNTP_MIN_POLL_S
+                                   ? poll_interval_s_ / 2
+                                   : SNTP_MIN_POLL_S;
+        }
+    }
+    shiftSamples_(offset_us);
+    synchronized_ = true;
+    last_correction_ms_ = now;
+    last_compensation_ms_ = now;
+}
+
+void SntpClient::compensateDrift_() {
+    const uint32_t now = clock_->monotonicMs();
+    const int64_t offset_us = static_cast<int64_t>(
+        drift_ppm_ * static_cast<float>(now - last_compensation_ms_) / 1000);
+    last_compensation_ms_ = now;
+    if (offset_us == 0) return;
+    clock_->slew(offset_us);
+    shiftSamples_(offset_us);
+}
+
+void SntpClient::shiftSamples_(int64_t offset_us) {
+    for (int i = 0; i < server_count_; i++) {
+        for (int j = 0; j < servers_[i].sample_count; j++) {
+            servers_[i].samples[j].offset_us -= offset_us;
+        }
+    }
+}
+
+SntpClient::ServerStatus SntpClient::serverStatus(int server) const {
+    ServerStatus status = {};
+    if (server < 0 || server >= server_count_) return status;
+    const Server& state = servers_[server];
+    status.host = state.host;
+    status.reach = state.reach;
+    status.selected = state.selected;
+    const int best = bestSample_(state, clock_->monotonicMs());
+    if (best >= 0) {
+        status.offset_us = state.samples[best].offset_us;
+        status.delay_us = state.samples[best].delay_us;
+    }
+    return status;
+}
@@ -0,0 +1,204 @@
+#ifndef WORDCLOCK_SNTP_CLIENT_H_
+#define WORDCLOCK_SNTP_CLIENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Maximum number of NTP servers queried.
+#define SNTP_MAX_SERVERS 4
+// Number of samples kept per server, of which the one with the lowest round
+// trip time is used.
+#define SNTP_FILTER_SIZE 8
+// Size of an NTP packet without extensions.
+#define SNTP_PACKET_SIZE 48
+// Time to wait for the replies of a poll, in milliseconds.
+#define SNTP_TIMEOUT_MS 2000
+// Bounds of the time between two polls, in seconds. The interval grows while
+// the clock stays within SNTP_STABLE_OFFSET_US of the servers.
+#define SNTP_MIN_POLL_S 64
+#define SNTP_MAX_POLL_S 1024
+// Offset below which the clock counts as stable, in microseconds.
+#define SNTP_STABLE_OFFSET_US 10000
+// Offset above which the clock is stepped instead of slewed, in microseconds.
+#define SNTP_STEP_THRESHOLD_US 500000
+// Round trip time on top of the best server's within which other servers are
+// trusted, in microseconds.
+#define SNTP_DELAY_MARGIN_US 10000
+// Largest drift that is compensated, in parts per million.
+#define SNTP_MAX_DRIFT_PPM 500
+// Time between two drift compensations, in milliseconds.
+#define SNTP_DRIFT_PERIOD_MS 60000
+
+// Sends and receives NTP packets. Implemented with WiFiUDP on the clock and
+// with sockets on a host.
+class SntpTransport {
+  public:
+    virtual ~SntpTransport() {}
+
+    // Sends `packet` to the NTP port of `host`, which is server number
+    // `server`. Returns false if the host could not be resolved or the packet
+    // could not be sent.
+    virtual bool send(int server, const char* host, const uint8_t* packet,
+                      size_t size) = 0;
+    // Reads a pending packet into `packet`. Returns its size, or 0 if none is
+    // pending. Must not block.
+    virtual size_t receive(uint8_t* packet, size_t size) = 0;
+    // Forgets whatever was cached about server number `server`, e.g. its
+    // resolved address, because it stopped answering.
+    virtual void forget(int /* server */) {}
+};
+
+// Reads and corrects the system clock.
+class SntpClock {
+  public:
+    virtual ~SntpClock() {}
+
+    // Returns a monotonic time in milliseconds, for scheduling.
+    virtual uint32_t monotonicMs() = 0;
+    // Returns the system time, in microseconds since the Unix epoch.
+    virtual int64_t realtimeUs() = 0;
+    // Changes the system time by `offset_us` at once.
+    virtual void step(int64_t offset_us) = 0;
+    // Changes the system time by `offset_us` gradually, on top of any
+    // adjustment still in progress.
+    virtual void slew(int64_t offset_us) = 0;
+};
+
+// SNTP client that queries several servers and disciplines the system clock.
+//
+// Every poll sends one request to each server. Of the last SNTP_FILTER_SIZE
+// samples of a server, the one with the lowest round trip time is the least
+// affected by network queuing and is used, once. Servers whose best round trip
+// time is much worse than the best server's are discarded, and the clock
+// offset is the median of the remaining ones.
+//
+// The clock is stepped when it is not set yet or far off, and slewed
+// otherwise, so that it never jumps in normal operation. The residual offsets
+// after slewing estimate the drift of the clock, which is compensated between
+// polls, letting the poll interval grow.
+//
+// Has no Arduino dependencies, so that it can run on a host against a local
+// NTP server.
+class SntpClient {
+  public:
+    // Per-server state, for reporting.
+    struct ServerStatus {
+        // Host name.
+        const char* host;
+        // Bit mask of the answered polls, most recent in the lowest bit.
+        uint8_t reach;
+        // Offset and round trip time of the best recent sample, in
+        // microseconds. Valid if reach is not 0.
+        int64_t offset_us;
+        uint32_t delay_us;
+        // Whether the server's offset was used for the last correction.
+        bool selected;
+    };
+
+    SntpClient(SntpTransport* transport, SntpClock* clock);
+
+    SntpClient(const SntpClient&) = delete;
+    SntpClient& operator=(const SntpClient&) = delete;
+
+    // Sets the servers to query. The strings must outlive the client. At most
+    // SNTP_MAX_SERVERS are used.
+    void setServers(const char* const* hosts, int count);
+    // Polls the servers as soon as possible.
+    void pollNow();
+    // Sends requests, processes replies and corrects the clock when due. Must
+    // be called often, and never blocks.
+    void loop();
+
+    // Whether the clock was set from the servers.
+    bool synchronized() const { return synchronized_; }
+    // Offset found by the last poll, in microseconds.
+    int64_t lastOffsetUs() const { return last_offset_us_; }
+    // Round trip time of the best server of the last poll, in microseconds.
+    uint32_t lastDelayUs() const { return last_delay_us_; }
+    // Estimated drift of the clock, in parts per million. Positive if the
+    // clock runs slow.
+    float driftPpm() const { return drift_ppm_; }
+    // Current time between two polls, in seconds.
+    uint32_t pollIntervalS() const { return poll_interval_s_; }
+    // Number of steps and slews applied.
+    uint32_t steps() const { return steps_; }
+    uint32_t slews() const { return slews_; }
+    // Number of servers and their status.
+    int serverCount() const { return server_count_; }
+    ServerStatus serverStatus(int server) const;
+
+  private:
+    // Offset and round trip time measured by one request.
+    struct Sample {
+        int64_t offset_us;
+        uint32_t delay_us;
+        // Monotonic time of the measurement.
+        uint32_t time_ms;
+        // Whether the sample was used for a correction already.
+        bool used;
+    };
+
+    // State of a server.
+    struct Server {
+        const char* host;
+        // Transmit timestamp of the pending request, as sent, or 0.
+        uint64_t pending_timestamp;
+        // Local time the pending request was sent, in microseconds.
+        int64_t sent_us;
+        uint8_t reach;
+        Sample samples[SNTP_FILTER_SIZE];
+        int sample_count;
+        int next_sample;
+        bool selected;
+    };
+
+    // Converts between NTP timestamps and microseconds since the Unix epoch.
+    static uint64_t toNtp_(int64_t unix_us);
+    static int64_t fromNtp_(uint64_t ntp);
+
+    // Sends a request to every server.
+    void sendRequests_();
+    // Reads and processes the pending replies.
+    void receiveReplies_();
+    // Processes the reply in `packet`, received at `received_us`.
+    void processReply_(const uint8_t* packet, int64_t received_us);
+    // Ends the current poll: combines the servers' samples and corrects the
+    // clock.
+    void finishPoll_();
+    // Returns the index of the sample of `server` with the lowest round trip
+    // time, aged to `now_ms`, or -1 if it has none.
+    static int bestSample_(const Server& server, uint32_t now_ms);
+    // Applies `offset_us` to the clock, stepping or slewing it.
+    void correct_(int64_t offset_us);
+    // Records that the clock was changed by `offset_us`, which the stored
+    // samples no longer reflect.
+    void shiftSamples_(int64_t offset_us);
+    // Slews the clock by the drift accumulated since the last compensation.
+    void compensateDrift_();
+
+    SntpTransport* transport_;
+    SntpClock* clock_;
+
+    Server servers_[SNTP_MAX_SERVERS];
+    int server_count_ = 0;
+
+    // Whether a poll awaits replies.
+    bool polling_ = false;
+    // Monotonic time the current poll started, or the last one ended.
+    uint32_t poll_ms_ = 0;
+    // Whether the next poll is due regardless of the interval.
+    bool poll_now_ = true;
+    uint32_t poll_interval_s_ = SNTP_MIN_POLL_S;
+
+    bool synchronized_ = false;
+    int64_t last_offset_us_ = 0;
+    uint32_t last_delay_us_ = 0;
+    float drift_ppm_ = 0;
+    // Monotonic time of the last correction and drift compensation.
+    uint32_t last_correction_ms_ = 0;
+    uint32_t last_compensation_ms_ = 0;
+    uint32_t steps_ = 0;
+    uint32_t slews_ = 0;
+};
+
+#endif  // WORDCLOCK_SNTP_CLIENT_H_
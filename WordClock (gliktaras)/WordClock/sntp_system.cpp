@@ -0,0 +1,113 @@
+#include "sntp_system.h"
+
+#include "logging.h"
+
+#include <sys/time.h>
+
+namespace {
+
+struct timeval toTimeval(int64_t us) {
+    struct timeval value;
+    value.tv_sec = us / 1000000;
+    value.tv_usec = us % 1000000;
+    return value;
+}
+
+int64_t fromTimeval(const struct timeval& value) {
+    return static_cast<int64_t>(value.tv_sec) * 1000000 + value.tv_usec;
+}
+
+}  // namespace
+
+bool WiFiSntpTransport::send(int server, const char* host,
+                             const uint8_t* packet, size_t size) {
+    if (server < 0 || server >= SNTP_MAX_SERVERS) return false;
+    if (!resolved_[server]) {
+        if (!WiFi.hostByName(host, addresses_[server])) {
+            LOGW("Cannot resolve NTP server %d.", server);
+            return false;
+        }
+        resolved_[server] = true;
+    }
+    if (!started_) started_ = udp_.begin(SNTP_LOCAL_PORT);
+    if (!started_) return false;
+    if (!udp_.beginPacket(addresses_[server], SNTP_SERVER_PORT)) return false;
+    udp_.write(packet, size);
+    return udp_.endPacket();
+}
+
+size_t WiFiSntpTransport::receive(uint8_t* packet, size_t size) {
+    if (!started_ || udp_.parsePacket() <= 0) return 0;
+    const int read = udp_.read(packet, size);
+    return read > 0 ? read : 0;
+}
+
+void WiFiSntpTransport::forget(int server) {
+    if (server < 0 || server >= SNTP_MAX_SERVERS) return;
+    resolved_[server] = false;
+}
+
+uint32_t SystemSntpClock::monotonicMs() {
+    return millis();
+}
+
+int64_t SystemSntpClock::realtimeUs() {
+    struct timeval now;
+    gettimeofday(&now, nullptr);
+    return fromTimeval(now);
+}
+
+void SystemSntpClock::step(int64_t offset_us) {
+    // A slew still in progress was meant for the old time.
+    struct timeval zero = {0, 0};
+    adjtime(&zero, nullptr);
+    const struct timeval now = toTimeval(realtimeUs() + offset_us);
+    settimeofday(&now, nullptr);
+    // Seconds and milliseconds, as the first step, from 1970, overflows an
+    // int of milliseconds.
+    const int64_t offset_ms = offset_us / 1000;
+    LOGI("Clock stepped by %ld s %d ms.",
+         static_cast<long>(offset_ms / 1000),
+         static_cast<int>(offset_ms % 1000));
+}
+
+void SystemSntpClock::slew(int64_t offset_us) {
+    struct timeval outstanding = {0, 0};
+    adjtime(nullptr, &outstanding);
+    const struct timeval delta =
+        toTimeval(fromTimeval(outstanding) + offset_us);
+    adjtime(&delta, nullptr);
+}
+
+void SntpMetric::writeTo(Print& out) const {
+    out.printf("# TYPE wordclock_ntp_synchronized gauge\n"
+               "wordclock_ntp_synchronized %d\n"
+               "# TYPE wordclock_ntp_offset_seconds gauge\n"
+               "wordclock_ntp_offset_seconds %.6f\n"
+               "# TYPE wordclock_ntp_delay_seconds gauge\n"
+               "wordclock_ntp_delay_seconds %.6f\n"
+               "# TYPE wordclock_ntp_drift_ppm gauge\n"
+               "wordclock_ntp_drift_ppm %.3f\n"
+               "# TYPE wordclock_ntp_poll_interval_seconds gauge\n"
+               "wordclock_ntp_poll_interval_seconds %u\n"
+               "# TYPE wordclock_ntp_steps_total counter\n"
+               "wordclock_ntp_steps_total %u\n"
+               "# TYPE wordclock_ntp_slews_total counter\n"
+               "wordclock_ntp_slews_total %u\n",
+               client_->synchronized() ? 1 : 0,
+               client_->lastOffsetUs() / 1e6, client_->lastDelayUs() / 1e6,
+               client_->driftPpm(), client_->pollIntervalS(), client_->steps(),
+               client_->slews());
+    out.printf("# TYPE wordclock_ntp_server_reach gauge\n");
+    for (int i = 0; i < client_->serverCount(); i++) {
+        const SntpClient::ServerStatus status = client_->serverStatus(i);
+        out.printf("wordclock_ntp_server_reach{server=\"%s\"} %u\n",
+                   status.host, status.reach);
+    }
+    out.printf("# TYPE wordclock_ntp_server_selected gauge\n");
+    for (int i = 0; i < client_->serverCount(); i++) {
+        const SntpClient::ServerStatus status = client_->serverStatus(i);
+        out.printf("wordclock_ntp_server_selected{server=\"%s\"} %d\n",
+                   status.host, status.selected ? 1 : 0);
+    }
+}
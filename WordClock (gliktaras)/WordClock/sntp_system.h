@@ -0,0 +1,58 @@
+#ifndef WORDCLOCK_SNTP_SYSTEM_H_
+#define WORDCLOCK_SNTP_SYSTEM_H_
+
+#include "metrics.h"
+#include "sntp_client.h"
+
+#include <WiFi.h>
+#include <WiFiUdp.h>
+
+// Port NTP servers listen on.
+#define SNTP_SERVER_PORT 123
+// Local port replies are received on.
+#define SNTP_LOCAL_PORT 4123
+
+// Sends NTP packets over WiFi.
+//
+// Server addresses are resolved once and kept until the client reports that
+// the server stopped answering, since resolving blocks the loop for as long as
+// the DNS server takes to answer.
+class WiFiSntpTransport : public SntpTransport {
+  public:
+    bool send(int server, const char* host, const uint8_t* packet,
+              size_t size) override;
+    size_t receive(uint8_t* packet, size_t size) override;
+    void forget(int server) override;
+
+  private:
+    // UDP socket, bound on the first send.
+    WiFiUDP udp_;
+    // Whether the socket is bound.
+    bool started_ = false;
+    // Resolved server addresses, valid where resolved_ is set.
+    IPAddress addresses_[SNTP_MAX_SERVERS];
+    bool resolved_[SNTP_MAX_SERVERS] = {false};
+};
+
+// Reads and adjusts the system clock, which newlib's time() and friends use.
+class SystemSntpClock : public SntpClock {
+  public:
+    uint32_t monotonicMs() override;
+    int64_t realtimeUs() override;
+    void step(int64_t offset_us) override;
+    void slew(int64_t offset_us) override;
+};
+
+// Publishes the state of an SNTP client on /metrics.
+class SntpMetric : public metrics::Metric {
+  public:
+    explicit SntpMetric(const SntpClient* client)
+        : Metric("wordclock_ntp", "SNTP client state."), client_(client) {}
+
+    void writeTo(Print& out) const override;
+
+  private:
+    const SntpClient* client_;
+};
+
+#endif  // WORDCLOCK_SNTP_SYSTEM_H_
@@ -0,0 +1,137 @@
+// Hybrid RTC and NTP time source.
+
+#include "time_source.h"
+
+#include "logging.h"
+
+#include <math.h>
+
+bool TimeSource::setup() {
+    rtc_present_ = rtc_->begin();
+    if (!rtc_present_) {
+        LOGW("No RTC found, waiting for NTP time.");
+        return false;
+    }
+    time_t utc;
+    if (rtc_->lostPower() || !rtc_->readTime(&utc)) {
+        LOGW("RTC time is not valid, waiting for NTP time.");
+        return false;
+    }
+    // The RTC counts whole seconds. Assuming the middle of the current one
+    // halves the worst error until the first measurement.
+    clock_->step(static_cast<int64_t>(utc) * 1000000 + 500000 -
+                 clock_->realtimeUs());
+    kind_ = TimeSourceKind::RTC;
+    LOGI("System time set from RTC.");
+    return true;
+}
+
+void TimeSource::loop(bool ntp_synchronized) {
+    if (ntp_synchronized) kind_ = TimeSourceKind::NTP;
+    if (!rtc_present_) return;
+
+    switch (state_) {
+        case State::IDLE:
+            if (ntp_synchronized &&
+                (!corrected_ || clock_->monotonicMs() - correction_ms_ >=
+                                    TIME_SOURCE_RTC_SYNC_PERIOD_S * 1000UL)) {
+                startCorrection_();
+            }
+            break;
+        case State::MEASURING:
+            measure_();
+            break;
+        case State::WRITING:
+            write_();
+            break;
+    }
+}
+
+void TimeSource::startCorrection_() {
+    corrected_ = true;
+    correction_ms_ = clock_->monotonicMs();
+    if (rtc_->lostPower() || !rtc_->readSeconds(&measure_seconds_)) {
+        state_ = State::WRITING;
+        return;
+    }
+    measure_start_ms_ = correction_ms_;
+    state_ = State::MEASURING;
+}
+
+void TimeSource::measure_() {
+    uint8_t seconds;
+    if (!rtc_->readSeconds(&seconds)) {
+        LOGW("RTC stopped answering.");
+        state_ = State::IDLE;
+        return;
+    }
+    if (seconds == measure_seconds_) {
+        if (clock_->monotonicMs() - measure_start_ms_ >
+            TIME_SOURCE_TICK_TIMEOUT_MS) {
+            LOGW("RTC is not ticking, resetting it.");
+            written_ = false;
+            state_ = State::WRITING;
+        }
+        return;
+    }
+
+    // The RTC ticked since the previous poll, at most one loop iteration ago,
+    // which bounds the error of the measurement.
+    const int64_t system_us = clock_->realtimeUs();
+    time_t rtc_utc;
+    if (!rtc_->readTime(&rtc_utc)) {
+        state_ = State::WRITING;
+        return;
+    }
+    rtc_error_us_ = static_cast<int64_t>(rtc_utc) * 1000000 - system_us;
+    LOGI("RTC is off by %d ms.", static_cast<int>(rtc_error_us_ / 1000));
+    if (written_) correctAging_(rtc_error_us_, system_us);
+    state_ = State::WRITING;
+}
+
+void TimeSource::correctAging_(int64_t error_us, int64_t system_us) {
+    const int64_t elapsed_us = system_us - written_us_;
+    // Too short to tell drift from the measurement error.
+    if (elapsed_us < TIME_SOURCE_RTC_SYNC_PERIOD_S * 1000000LL / 2) return;
+
+    rtc_drift_ppm_ = static_cast<float>(error_us - written_error_us_) /
+                     (elapsed_us / 1e6f);
+    if (fabsf(rtc_drift_ppm_) > TIME_SOURCE_MAX_DRIFT_PPM) {
+        LOGW("RTC drift is out of range, not correcting it.");
+        return;
+    }
+    int8_t offset;
+    if (!rtc_->readAgingOffset(&offset)) return;
+    // Moves towards the offset that corrects the whole drift, a step at a
+    // time, so that one bad measurement cannot throw the RTC off.
+    const int target = Ds3231::agingOffsetFor(offset, rtc_drift_ppm_);
+    int updated = target;
+    if (updated > offset + TIME_SOURCE_MAX_AGING_STEP) {
+        updated = offset + TIME_SOURCE_MAX_AGING_STEP;
+    }
+    if (updated < offset - TIME_SOURCE_MAX_AGING_STEP) {
+        updated = offset - TIME_SOURCE_MAX_AGING_STEP;
+    }
+    if (updated == offset) return;
+    if (rtc_->writeAgingOffset(static_cast<int8_t>(updated))) {
+        LOGI("RTC aging offset changed from %d to %d, towards %d.", offset,
+             updated, target);
+    }
+}
+
+void TimeSource::write_() {
+    const int64_t now_us = clock_->realtimeUs();
+    const int64_t fraction_us = now_us % 1000000;
+    if (fraction_us >= TIME_SOURCE_WRITE_WINDOW_US) return;
+
+    state_ = State::IDLE;
+    if (!rtc_->writeTime(static_cast<time_t>(now_us / 1000000))) {
+        LOGW("Cannot write RTC.");
+        written_ = false;
+        return;
+    }
+    // The RTC's second started with the write, fraction_us late.
+    written_ = true;
+    written_us_ = now_us;
+    written_error_us_ = -fraction_us;
+}
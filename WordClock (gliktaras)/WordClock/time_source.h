@@ -0,0 +1,124 @@
+#ifndef WORDCLOCK_TIME_SOURCE_H_
+#define WORDCLOCK_TIME_SOURCE_H_
+
+#include <stdint.h>
+
+#include "ds3231.h"
+#include "sntp_client.h"
+
+// Time between two corrections of the RTC while NTP time is available, in
+// seconds. Also the shortest time over which the RTC's drift is measured.
+#define TIME_SOURCE_RTC_SYNC_PERIOD_S (6 * 3600L)
+// Longest wait for the RTC's seconds to tick while measuring it, in
+// milliseconds. The RTC's oscillator stopped if it takes longer.
+#define TIME_SOURCE_TICK_TIMEOUT_MS 1500
+// Window at the start of a second within which the RTC is written, in
+// microseconds. Bounds the error of a write.
+#define TIME_SOURCE_WRITE_WINDOW_US 20000
+// Largest drift attributed to aging at once, in parts per million. Anything
+// larger is a bad measurement rather than crystal aging.
+#define TIME_SOURCE_MAX_DRIFT_PPM 10
+// Largest change of the aging offset per correction, in
+// DS3231_AGING_STEP_PPB steps. A single measurement over
+// TIME_SOURCE_RTC_SYNC_PERIOD_S carries a few milliseconds of error, a few
+// steps' worth, so the offset walks towards the measured drift over several
+// corrections instead of following each one.
+#define TIME_SOURCE_MAX_AGING_STEP 1
+
+// Where the system time came from.
+enum class TimeSourceKind {
+    // Nowhere yet.
+    NONE,
+    // The DS3231 RTC, at boot.
+    RTC,
+    // NTP.
+    NTP,
+};
+
+// Sets the system clock from a DS3231 RTC at boot, so that the clock shows the
+// right time without network, and disciplines the RTC while NTP time is
+// available.
+//
+// Every TIME_SOURCE_RTC_SYNC_PERIOD_S, the RTC is compared against the system
+// clock, by catching the tick of its seconds register, and written back at
+// the start of a second. The error accumulated between a write and the next
+// measurement is the RTC's drift, which is corrected with its aging offset,
+// by at most TIME_SOURCE_MAX_AGING_STEP per correction.
+//
+// All RTC accesses are short register reads and writes spread over loop()
+// calls; none of them waits for the RTC. The system clock is read and set
+// through `clock`, so that the logic can run on a host.
+class TimeSource {
+  public:
+    TimeSource(Ds3231* rtc, SntpClock* clock) : rtc_(rtc), clock_(clock) {}
+
+    TimeSource(const TimeSource&) = delete;
+    TimeSource& operator=(const TimeSource&) = delete;
+
+    // Sets the system clock from the RTC if it holds a valid time. Returns
+    // whether it did.
+    bool setup();
+    // Measures and corrects the RTC when due. `ntp_synchronized` tells
+    // whether the system clock follows NTP.
+    void loop(bool ntp_synchronized);
+
+    // Returns where the system time came from.
+    TimeSourceKind kind() const { return kind_; }
+    // Returns whether an RTC was found.
+    bool rtcPresent() const { return rtc_present_; }
+    // Returns the RTC's error found by the last measurement, in
+    // microseconds. Positive if the RTC was ahead.
+    int64_t rtcErrorUs() const { return rtc_error_us_; }
+    // Returns the RTC's drift found by the last measurement, in parts per
+    // million. Positive if the RTC runs fast.
+    float rtcDriftPpm() const { return rtc_drift_ppm_; }
+
+  private:
+    // Steps of an RTC correction.
+    enum class State {
+        // Waiting for the next correction.
+        IDLE,
+        // Polling the RTC's seconds for a tick.
+        MEASURING,
+        // Waiting for the start of a second to write the RTC.
+        WRITING,
+    };
+
+    // Starts measuring the RTC, or writing it if its time is not valid.
+    void startCorrection_();
+    // Polls the RTC's seconds; when they tick, compares the RTC to the system
+    // clock.
+    void measure_();
+    // Derives the drift from the error found by measure_() and adjusts the
+    // aging offset.
+    void correctAging_(int64_t error_us, int64_t system_us);
+    // Writes the system time to the RTC at the start of a second.
+    void write_();
+
+    Ds3231* rtc_;
+    SntpClock* clock_;
+    bool rtc_present_ = false;
+    TimeSourceKind kind_ = TimeSourceKind::NONE;
+
+    State state_ = State::IDLE;
+    // Whether a correction was started since boot, and when, in monotonic
+    // milliseconds.
+    bool corrected_ = false;
+    uint32_t correction_ms_ = 0;
+    // Whether the RTC holds the time written by write_() since boot, so that
+    // its error since then is drift.
+    bool written_ = false;
+    // System time of the last write, in microseconds.
+    int64_t written_us_ = 0;
+    // RTC's error right after the last write, in microseconds.
+    int64_t written_error_us_ = 0;
+
+    // RTC seconds at the start of the measurement, and when it started.
+    uint8_t measure_seconds_ = 0;
+    uint32_t measure_start_ms_ = 0;
+
+    int64_t rtc_error_us_ = 0;
+    float rtc_drift_ppm_ = 0;
+};
+
+#endif  // WORDCLOCK_TIME_SOURCE_H_
@@ -0,0 +1,80 @@
+#include "transition.h"
+
+namespace transition {
+namespace {
+
+// How the LEDs of an effect change.
+struct Kernel {
+    // Part of the transition each LED takes to change, as a right shift of
+    // TRANSITION_ONE, so that it divides by a shift.
+    uint8_t span_shift;
+    // Whether the change eases in quadratically rather than linearly.
+    bool ease_in;
+};
+
+// Kernels of the effects, in Effect order.
+const Kernel kernels[TRANSITION_EFFECT_COUNT] = {
+    {0, true},   // Fade
+    {2, false},  // Wipe
+    {3, true},   // Cascade
+    {6, false},  // Typewriter
+    {3, true},   // Sparkle
+    {3, false},  // Rain
+};
+
+// Returns `value` scaled from 0 to `last` to 0 to 255.
+uint8_t scale(int value, int last) {
+    return last > 0 ? value * 255 / last : 0;
+}
+
+// Mixes the bits of `value`, so that close values give unrelated results.
+uint32_t mix(uint32_t value) {
+    value ^= value >> 16;
+    value *= 0x7FEB352D;
+    value ^= value >> 15;
+    value *= 0x846CA68B;
+    value ^= value >> 16;
+    return value;
+}
+
+// Returns a random looking number for `x`, `y` and `seed`.
+uint32_t hash(int x, int y, uint32_t seed) {
+    return mix(seed ^ mix((static_cast<uint32_t>(x) << 16) ^
+                          static_cast<uint32_t>(y)));
+}
+
+}  // namespace
+
+uint8_t delayFor(Effect effect, const Position& position, int width,
+                 int height, uint32_t seed) {
+    switch (effect) {
+        case Effect::Wipe:
+            return scale(position.x, width - 1);
+        case Effect::Cascade:
+            return scale(position.x * height + position.y,
+                         width * height - 1);
+        case Effect::Typewriter:
+            return scale(position.order, position.count - 1);
+        case Effect::Sparkle:
+            return hash(position.x, position.y, seed) >> 24;
+        case Effect::Rain:
+            // Half of the transition for the drop to start, half to fall.
+            return (hash(position.x, -1, seed) >> 25) +
+                   scale(position.y, height - 1) / 2;
+        case Effect::Fade:
+        default:
+            return 0;
+    }
+}
+
+uint32_t level(Effect effect, uint8_t delay, uint32_t progress) {
+    const Kernel& kernel = kernels[static_cast<int>(effect)];
+    const uint32_t start =
+        delay * (TRANSITION_ONE - (TRANSITION_ONE >> kernel.span_shift)) / 255;
+    if (progress <= start) return 0;
+    const uint32_t local = (progress - start) << kernel.span_shift;
+    if (local >= TRANSITION_ONE) return TRANSITION_ONE;
+    return kernel.ease_in ? local * local >> 16 : local;
+}
+
+}  // namespace transition
@@ -0,0 +1,59 @@
+#ifndef WORDCLOCK_TRANSITION_H_
+#define WORDCLOCK_TRANSITION_H_
+
+#include <stdint.h>
+
+// Number of transition effects.
+#define TRANSITION_EFFECT_COUNT 6
+// Progress and level of a transition at its end, in 16.16 fixed point.
+#define TRANSITION_ONE 0x10000
+
+// Effects shown when the face changes, e.g. at every minute.
+//
+// Every LED changes from its old color to its new one once the transition
+// reaches the LED's delay, over a part of the transition that depends on the
+// effect. Delays only depend on the LED's position, so they are computed once
+// per transition into a table with delayFor(). Each frame then calls the
+// stateless level() for every LED that changes, a few integer operations.
+namespace transition {
+
+enum class Effect : uint8_t {
+    // All LEDs fade at once.
+    Fade,
+    // An edge sweeps the face left to right.
+    Wipe,
+    // Columns change left to right, each one top to bottom.
+    Cascade,
+    // The LEDs that change switch one after the other, in reading order.
+    Typewriter,
+    // LEDs fade in a random order.
+    Sparkle,
+    // Drops fall down every column, starting at random times.
+    Rain,
+};
+
+// Position of an LED on the canvas. Corners take the position of the grid's
+// corner next to them.
+struct Position {
+    int x;
+    int y;
+    // Rank of the LED among the ones that change, in reading order, and the
+    // number of LEDs that change.
+    int order;
+    int count;
+};
+
+// Returns when the LED at `position` of a `width` x `height` canvas starts to
+// change, from 0 at the start of the transition to 255. `seed` varies the
+// random effects from one transition to the next.
+uint8_t delayFor(Effect effect, const Position& position, int width,
+                 int height, uint32_t seed);
+
+// Returns how far an LED with `delay` is from its old color, 0, to its new
+// one, TRANSITION_ONE, when the transition is at `progress`, from 0 to
+// TRANSITION_ONE.
+uint32_t level(Effect effect, uint8_t delay, uint32_t progress);
+
+}  // namespace transition
+
+#endif  // WORDCLOCK_TRANSITION_H_
@@ -0,0 +1,416 @@
+// Compact timezone database access.
+
+#include "tzdb.h"
+#include "tzdb_data.h"
+#include "logging.h"
+
+#include <esp_partition.h>
+#include <rom/crc.h>
+#include <string.h>
+#include <strings.h>
+
+namespace tzdb {
+
+namespace {
+
+// Subtype of the tzdata partition, see partitions.csv.
+#define PARTITION_SUBTYPE static_cast<esp_partition_subtype_t>(0x40)
+// Label of the tzdata partition.
+#define PARTITION_LABEL "tzdata"
+// Marks a database blob.
+#define BLOB_MAGIC 0x42445A54  // "TZDB"
+// Version of the blob layout. Must match BLOB_FORMAT_VERSION in tzdb_gen.py.
+#define BLOB_FORMAT_VERSION 1
+
+static_assert(TZDB_RULE_COUNT <= 256, "Rule indices are 8-bit.");
+
+// Location of a section in a blob.
+struct BlobSection {
+    uint32_t offset;
+    uint32_t size;
+};
+
+// Header of a database blob, little-endian, as written by tzdb_gen.py.
+struct BlobHeader {
+    uint32_t magic;
+    uint16_t format_version;
+    uint16_t header_size;
+    // Size of the whole blob.
+    uint32_t size;
+    // CRC-32 of the blob after the header.
+    uint32_t crc;
+    char data_version[16];
+    uint16_t count;
+    uint16_t rule_count;
+    uint16_t block_size;
+    uint16_t reserved;
+    BlobSection names;
+    BlobSection name_blocks;
+    BlobSection rules;
+    BlobSection rule_offsets;
+    BlobSection zone_rules;
+    BlobSection sorted;
+};
+
+// Sections of a database, built in or mapped from the tzdata partition.
+struct Database {
+    int count;
+    int rule_count;
+    const char* names;
+    size_t names_size;
+    const uint16_t* name_blocks;
+    const char* rules;
+    size_t rules_size;
+    const uint16_t* rule_offsets;
+    const uint8_t* zone_rules;
+    const uint16_t* sorted;
+    const char* version;
+};
+
+const Database BUILT_IN = {
+    TZDB_COUNT, TZDB_RULE_COUNT,
+    data::names, sizeof(data::names), data::name_blocks,
+    data::rules, sizeof(data::rules), data::rule_offsets,
+    data::zone_rules, data::sorted, "built-in",
+};
+
+// Database in use.
+const Database* db = &BUILT_IN;
+// Database of the tzdata partition, valid while mapped.
+Database partition_db;
+// Data version of the partition's database, terminated.
+char partition_version[sizeof(BlobHeader::data_version) + 1];
+// Mapping of the tzdata partition, or 0.
+spi_flash_mmap_handle_t partition_mapping = 0;
+
+// Partition being rewritten by an update, or nullptr.
+const esp_partition_t* update_partition = nullptr;
+// Bytes written by the update so far.
+size_t update_size = 0;
+
+// Returns whether `section` lies within the blob of `header`, is aligned for
+// 16-bit reads and, unless `expected_size` is 0, has that size.
+bool isSectionValid(const BlobSection& section, const BlobHeader& header,
+                    uint32_t expected_size) {
+    return section.offset % 4 == 0 && section.offset >= header.header_size &&
+           section.offset <= header.size &&
+           section.size <= header.size - section.offset &&
+           (expected_size == 0 || section.size == expected_size);
+}
+
+// Returns whether every name, rule and index of `database` lies within its
+// sections.
+bool isConsistent(const Database& database) {
+    const int blocks = (database.count + TZDB_BLOCK_SIZE - 1) / TZDB_BLOCK_SIZE;
+    const char* names_end = database.names + database.names_size;
+    for (int block = 0; block < blocks; block++) {
+        if (database.name_blocks[block] >= database.names_size) return false;
+        const char* p = database.names + database.name_blocks[block];
+        size_t previous_length = 0;
+        for (int i = 0; i < TZDB_BLOCK_SIZE &&
+                        block * TZDB_BLOCK_SIZE + i < database.count;
+             i++) {
+            if (p >= names_end) return false;
+            size_t length = static_cast<uint8_t>(*p++);
+            if (length > previous_length) return false;
+            while (p < names_end && *p != '\0') {
+                p++;
+                length++;
+            }
+            if (p++ >= names_end || length >= TZDB_NAME_LENGTH) return false;
+            previous_length = length;
+        }
+    }
+    if (database.rules[database.rules_size - 1] != '\0') return false;
+    for (int i = 0; i < database.rule_count; i++) {
+        if (database.rule_offsets[i] >= database.rules_size) return false;
+    }
+    for (int i = 0; i < database.count; i++) {
+        if (database.zone_rules[i] >= database.rule_count ||
+            database.sorted[i] >= database.count) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Checks the blob at `blob` of at most `available` bytes, and fills `database`
+// from it. Returns false, leaving `database` unusable, if the blob is missing
+// or malformed.
+bool loadBlob(const uint8_t* blob, size_t available, Database* database) {
+    BlobHeader header;
+    memcpy(&header, blob, sizeof(header));
+    if (header.magic != BLOB_MAGIC) return false;
+    if (header.format_version != BLOB_FORMAT_VERSION ||
+        header.header_size != sizeof(header) || header.size > available ||
+        header.size < sizeof(header)) {
+        LOGW("Unsupported timezone blob, format %u.", header.format_version);
+        return false;
+    }
+    if (crc32_le(0, blob + header.header_size,
+                 header.size - header.header_size) != header.crc) {
+        LOGW("Timezone blob CRC mismatch.");
+        return false;
+    }
+    const int blocks =
+        (header.count + TZDB_BLOCK_SIZE - 1) / TZDB_BLOCK_SIZE;
+    if (header.block_size != TZDB_BLOCK_SIZE || header.count == 0 ||
+        header.rule_count == 0 || header.rule_count > 256 ||
+        !isSectionValid(header.names, header, 0) ||
+        !isSectionValid(header.name_blocks, header, 2 * blocks) ||
+        !isSectionValid(header.rules, header, 0) ||
+        !isSectionValid(header.rule_offsets, header, 2 * header.rule_count) ||
+        !isSectionValid(header.zone_rules, header, header.count) ||
+        !isSectionValid(header.sorted, header, 2 * header.count) ||
+        header.rules.size == 0) {
+        LOGW("Malformed timezone blob.");
+        return false;
+    }
+
+    database->count = header.count;
+    database->rule_count = header.rule_count;
+    database->names = reinterpret_cast<const char*>(blob + header.names.offset);
+    database->names_size = header.names.size;
+    database->name_blocks =
+        reinterpret_cast<const uint16_t*>(blob + header.name_blocks.offset);
+    database->rules = reinterpret_cast<const char*>(blob + header.rules.offset);
+    database->rules_size = header.rules.size;
+    database->rule_offsets =
+        reinterpret_cast<const uint16_t*>(blob + header.rule_offsets.offset);
+    database->zone_rules = blob + header.zone_rules.offset;
+    database->sorted =
+        reinterpret_cast<const uint16_t*>(blob + header.sorted.offset);
+
+    // The CRC rules out corruption, this rules out a faulty generator, so
+    // that lookups need no bounds checks.
+    if (!isConsistent(*database)) {
+        LOGW("Malformed timezone blob.");
+        return false;
+    }
+
+    memcpy(partition_version, header.data_version, sizeof(header.data_version));
+    partition_version[sizeof(header.data_version)] = '\0';
+    database->version = partition_version;
+    return true;
+}
+
+// Unmaps the partition and falls back to the built-in database.
+void unmapPartition() {
+    db = &BUILT_IN;
+    if (partition_mapping != 0) {
+        spi_flash_munmap(partition_mapping);
+        partition_mapping = 0;
+    }
+}
+
+// Maps the tzdata partition, and uses its database if it holds a valid one.
+bool mapPartition() {
+    unmapPartition();
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, PARTITION_SUBTYPE, PARTITION_LABEL);
+    if (partition == nullptr) {
+        LOGI("No tzdata partition, using the built-in timezones.");
+        return false;
+    }
+    const void* mapped = nullptr;
+    if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA,
+                           &mapped, &partition_mapping) != ESP_OK) {
+        LOGW("Could not map the tzdata partition.");
+        partition_mapping = 0;
+        return false;
+    }
+    if (partition->size < sizeof(BlobHeader) ||
+        !loadBlob(static_cast<const uint8_t*>(mapped), partition->size,
+                  &partition_db)) {
+        unmapPartition();
+        LOGI("Using the built-in timezones.");
+        return false;
+    }
+    db = &partition_db;
+    LOGI("Using timezones %s from the tzdata partition.",
+         LOG_STATIC(partition_db.version));
+    return true;
+}
+
+// Returns the zone at `position` of the sorted name index.
+int sortedAt(int position) {
+    return pgm_read_word(&db->sorted[position]);
+}
+
+// Returns the first position of the sorted name index whose name is not
+// ordered before `query` when only the first strlen(query) characters are
+// compared, ignoring case. With `past_prefix`, returns the first position
+// whose name is ordered after all names starting with `query` instead.
+int lowerBound(const char* query, bool past_prefix) {
+    const size_t length = strlen(query);
+    char candidate[TZDB_NAME_LENGTH];
+    int low = 0;
+    int high = db->count;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        name(sortedAt(middle), candidate, sizeof(candidate));
+        const int order = strncasecmp(candidate, query, length);
+        if (order < 0 || (past_prefix && order == 0)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Returns whether `text` contains `query`, ignoring case.
+bool containsIgnoringCase(const char* text, const char* query) {
+    const size_t length = strlen(query);
+    for (; *text != '\0'; text++) {
+        if (strncasecmp(text, query, length) == 0) return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+bool setup() {
+    return mapPartition();
+}
+
+int count() {
+    return db->count;
+}
+
+const char* version() {
+    return db->version;
+}
+
+bool name(int index, char* buffer, size_t size) {
+    if (index < 0 || index >= db->count || size == 0) return false;
+
+    // Decode from the start of the block, reusing the shared prefixes.
+    char decoded[TZDB_NAME_LENGTH];
+    const char* p = db->names +
+                    pgm_read_word(&db->name_blocks[index / TZDB_BLOCK_SIZE]);
+    for (int i = 0; i <= index % TZDB_BLOCK_SIZE; i++) {
+        size_t length = pgm_read_byte(p++);
+        char c;
+        while ((c = pgm_read_byte(p++)) != '\0') {
+            decoded[length++] = c;
+        }
+        decoded[length] = '\0';
+    }
+    strncpy(buffer, decoded, size - 1);
+    buffer[size - 1] = '\0';
+    return true;
+}
+
+const char* rule(int index) {
+    if (index < 0 || index >= db->count) return nullptr;
+    const uint8_t rule_index = pgm_read_byte(&db->zone_rules[index]);
+    return db->rules + pgm_read_word(&db->rule_offsets[rule_index]);
+}
+
+int find(const char* wanted) {
+    char candidate[TZDB_NAME_LENGTH];
+    int low = 0;
+    int high = db->count;
+    while (low < high) {
+        const int middle = (low + high) / 2;
+        const int index = sortedAt(middle);
+        name(index, candidate, sizeof(candidate));
+        const int order = compare(candidate, wanted);
+        if (order == 0) return index;
+        if (order < 0) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return -1;
+}
+
+int compare(const char* a, const char* b) {
+    const int order = strcasecmp(a, b);
+    return order != 0 ? order : strcmp(a, b);
+}
+
+int search(const char* query, int offset, int* indices, int max_count) {
+    int total = 0;
+    const auto add = [&](int index) {
+        if (total >= offset && total - offset < max_count) {
+            indices[total - offset] = index;
+        }
+        total++;
+    };
+
+    // Names starting with the query are contiguous in the sorted index.
+    const int first = lowerBound(query, false);
+    const int last = lowerBound(query, true);
+    for (int position = first; position < last; position++) {
+        add(sortedAt(position));
+    }
+
+    if (*query == '\0') return total;
+    char candidate[TZDB_NAME_LENGTH];
+    for (int position = 0; position < db->count; position++) {
+        // Skip the prefix matches, which were added already.
+        if (position == first && last > first) {
+            position = last - 1;
+            continue;
+        }
+        const int index = sortedAt(position);
+        name(index, candidate, sizeof(candidate));
+        if (containsIgnoringCase(candidate + 1, query)) add(index);
+    }
+    return total;
+}
+
+bool beginUpdate() {
+    abortUpdate();
+    const esp_partition_t* partition = esp_partition_find_first(
+        ESP_PARTITION_TYPE_DATA, PARTITION_SUBTYPE, PARTITION_LABEL);
+    if (partition == nullptr) {
+        LOGW("No tzdata partition to update.");
+        return false;
+    }
+    // The mapped database is about to be erased.
+    unmapPartition();
+    if (esp_partition_erase_range(partition, 0, partition->size) != ESP_OK) {
+        LOGE("Could not erase the tzdata partition.");
+        return false;
+    }
+    update_partition = partition;
+    update_size = 0;
+    LOGI("Updating the tzdata partition.");
+    return true;
+}
+
+bool writeUpdate(const uint8_t* data, size_t size) {
+    if (update_partition == nullptr) return false;
+    if (size > update_partition->size - update_size ||
+        esp_partition_write(update_partition, update_size, data, size) !=
+            ESP_OK) {
+        LOGW("Could not write the tzdata partition at %u.", update_size);
+        abortUpdate();
+        return false;
+    }
+    update_size += size;
+    return true;
+}
+
+bool endUpdate() {
+    const esp_partition_t* partition = update_partition;
+    if (partition == nullptr) return false;
+    update_partition = nullptr;
+    if (mapPartition()) return true;
+    // Leave no partial blob behind.
+    esp_partition_erase_range(partition, 0, partition->size);
+    return false;
+}
+
+void abortUpdate() {
+    if (update_partition == nullptr) return;
+    esp_partition_erase_range(update_partition, 0, update_partition->size);
+    update_partition = nullptr;
+    LOGW("Aborted the tzdata partition update.");
+}
+
+}  // namespace tzdb
@@ -0,0 +1,73 @@
+#ifndef WORDCLOCK_TZDB_H_
+#define WORDCLOCK_TZDB_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Number of names per front-coded block. Bounds the work of decoding a name.
+#define TZDB_BLOCK_SIZE 16
+// Size of a buffer that fits any zone name, terminator included.
+#define TZDB_NAME_LENGTH 32
+
+// Timezone database, generated by tools/tzdb_gen.py.
+//
+// Zones are identified by their index, which configurations store and which
+// never changes. Rules are deduplicated and names are front-coded, so that the
+// database takes a fraction of the flash of plain string tables.
+//
+// A database is built into the firmware from tzdb_data.h. A newer one can be
+// written to the "tzdata" partition as a blob, which is then used in place,
+// mapped from flash, without reflashing the firmware.
+namespace tzdb {
+
+// Uses the database of the tzdata partition if it holds a valid one, and the
+// built-in one otherwise. Returns whether the partition's database is used.
+bool setup();
+
+// Returns the number of zones.
+int count();
+
+// Returns the data version of the database in use, e.g. "2024a", or
+// "built-in".
+const char* version();
+
+// Copies the name of zone `index`, e.g. "Europe/Amsterdam", into `buffer` of
+// `size` bytes. Returns false if `index` is out of range.
+bool name(int index, char* buffer, size_t size);
+
+// Returns the POSIX TZ rule of zone `index`, e.g. "CET-1CEST,M3.5.0,M10.5.0/3",
+// or nullptr if `index` is out of range.
+const char* rule(int index);
+
+// Returns the index of the zone called `name`, or -1. Binary search over the
+// sorted name index.
+int find(const char* name);
+
+// Orders zone names the way the sorted name index does: ignoring case, ties
+// broken by byte order.
+int compare(const char* a, const char* b);
+
+// Searches zone names containing `query`, ignoring case. Names starting with
+// `query` come first, found by binary search over the sorted name index, then
+// the other matches, each group in name order.
+//
+// Writes the indices of at most `max_count` matches, skipping the first
+// `offset` ones, to `indices`. Returns the total number of matches.
+int search(const char* query, int offset, int* indices, int max_count);
+
+// Starts replacing the tzdata partition's blob, erasing it. Until endUpdate()
+// succeeds, the built-in database is used, and pointers returned by rule()
+// before are invalid. Returns false on failure.
+bool beginUpdate();
+// Appends `size` bytes of the new blob. Returns false and aborts the update
+// on failure.
+bool writeUpdate(const uint8_t* data, size_t size);
+// Completes the update and switches to the new blob. Returns false, erasing
+// the partition, if the blob is invalid.
+bool endUpdate();
+// Aborts the update in progress, if any.
+void abortUpdate();
+
+}  // namespace tzdb
+
+#endif  // WORDCLOCK_TZDB_H_
@@ -0,0 +1,677 @@
+#ifndef WORDCLOCK_TZDB_DATA_H_
+#define WORDCLOCK_TZDB_DATA_H_
+
+// This file was generated by tools/tzdb_gen.py from tools/timezones.csv. Do not
+// edit it by hand.
+
+#include <Arduino.h>
+
+// Number of zones.
+#define TZDB_COUNT 460
+// Number of distinct rules.
+#define TZDB_RULE_COUNT 99
+
+namespace tzdb {
+namespace data {
+
+// Zone names in index order, front-coded: every entry is the length of the
+// prefix shared with the previous name, then the rest of the name and a
+// terminator. The first name of every block is stored whole.
+const char names[] PROGMEM =
+    "\000Africa/Abidjan\000"
+    "\010ccra\000"
+    "\010ddis Ababa\000"
+    "\010lgiers\000"
+    "\010smara\000"
+    "\007Bamako\000"
+    "\011ngui\000"
+    "\012jul\000"
+    "\010issau\000"
+    "\010lantyre\000"
+    "\010razzaville\000"
+    "\010ujumbura\000"
+    "\007Cairo\000"
+    "\011sablanca\000"
+    "\010euta\000"
+    "\010onakry\000"
+    "\000Africa/Dakar\000"
+    "\011r es Salaam\000"
+    "\010jibouti\000"
+    "\010ouala\000"
+    "\007El Aaiun\000"
+    "\007Freetown\000"
+    "\007Gaborone\000"
+    "\007Harare\000"
+    "\007Johannesburg\000"
+    "\010uba\000"
+    "\007Kampala\000"
+    "\010hartoum\000"
+    "\010igali\000"
+    "\011nshasa\000"
+    "\007Lagos\000"
+    "\010ibreville\000"
+    "\000Africa/Lome\000"
+    "\010uanda\000"
+    "\011bumbashi\000"
+    "\011saka\000"
+    "\007Malabo\000"
+    "\011puto\000"
+    "\011seru\000"
+    "\010babane\000"
+    "\010ogadishu\000"
+    "\011nrovia\000"
+    "\007Nairobi\000"
+    "\010djamena\000"
+    "\010iamey\000"
+    "\010ouakchott\000"
+    "\007Ouagadougou\000"
+    "\007Porto-Novo\000"
+    "\000Africa/Sao Tome\000"
+    "\007Tripoli\000"
+    "\010unis\000"
+    "\007Windhoek\000"
+    "\001merica/Adak\000"
+    "\011nchorage\000"
+    "\012guilla\000"
+    "\012tigua\000"
+    "\011raguaina\000"
+    "\012gentina/Buenos Aires\000"
+    "\022Catamarca\000"
+    "\023ordoba\000"
+    "\022Jujuy\000"
+    "\022La Rioja\000"
+    "\022Mendoza\000"
+    "\022Rio Gallegos\000"
+    "\000America/Argentina/Salta\000"
+    "\024n Juan\000"
+    "\026Luis\000"
+    "\022Tucuman\000"
+    "\022Ushuaia\000"
+    "\012uba\000"
+    "\011suncion\000"
+    "\011tikokan\000"
+    "\010Bahia\000"
+    "\015 Banderas\000"
+    "\012rbados\000"
+    "\011elem\000"
+    "\013ize\000"
+    "\011lanc-Sablon\000"
+    "\011oa Vista\000"
+    "\012gota\000"
+    "\000America/Boise\000"
+    "\010Cambridge Bay\000"
+    "\013po Grande\000"
+    "\012ncun\000"
+    "\012racas\000"
+    "\012yenne\000"
+    "\013man\000"
+    "\011hicago\000"
+    "\013huahua\000"
+    "\011osta Rica\000"
+    "\011reston\000"
+    "\011uiaba\000"
+    "\012racao\000"
+    "\010Danmarkshavn\000"
+    "\012wson\000"
+    "\016 Creek\000"
+    "\000America/Denver\000"
+    "\012troit\000"
+    "\011ominica\000"
+    "\010Edmonton\000"
+    "\011irunepe\000"
+    "\011l Salvador\000"
+    "\010Fort Nelson\000"
+    "\014aleza\000"
+    "\010Glace Bay\000"
+    "\011odthab\000"
+    "\012ose Bay\000"
+    "\011rand Turk\000"
+    "\012enada\000"
+    "\011uadeloupe\000"
+    "\013temala\000"
+    "\013yaquil\000"
+    "\000America/Guyana\000"
+    "\010Halifax\000"
+    "\012vana\000"
+    "\011ermosillo\000"
+    "\010Indiana/Indianapolis\000"
+    "\020Knox\000"
+    "\020Marengo\000"
+    "\020Petersburg\000"
+    "\020Tell City\000"
+    "\020Vevay\000"
+    "\021incennes\000"
+    "\020Winamac\000"
+    "\012uvik\000"
+    "\011qaluit\000"
+    "\010Jamaica\000"
+    "\011uneau\000"
+    "\000America/Kentucky/Louisville\000"
+    "\021Monticello\000"
+    "\011ralendijk\000"
+    "\010La Paz\000"
+    "\011ima\000"
+    "\011os Angeles\000"
+    "\012wer Princes\000"
+    "\010Maceio\000"
+    "\012nagua\000"
+    "\014us\000"
+    "\012rigot\000"
+    "\013tinique\000"
+    "\012tamoros\000"
+    "\012zatlan\000"
+    "\011enominee\000"
+    "\012rida\000"
+    "\000America/Metlakatla\000"
+    "\012xico City\000"
+    "\011iquelon\000"
+    "\011oncton\000"
+    "\013terrey\000"
+    "\015video\000"
+    "\014real\000"
+    "\014serrat\000"
+    "\010Nassau\000"
+    "\011ew York\000"
+    "\011ipigon\000"
+    "\011ome\000"
+    "\012ronha\000"
+    "\013th Dakota/Beulah\000"
+    "\025Center\000"
+    "\025New Salem\000"
+    "\000America/Ojinaga\000"
+    "\010Panama\000"
+    "\013gnirtung\000"
+    "\012ramaribo\000"
+    "\011hoenix\000"
+    "\011ort-au-Prince\000"
+    "\014 of Spain\000"
+    "\014o Velho\000"
+    "\011uerto Rico\000"
+    "\012nta Arenas\000"
+    "\010Rainy River\000"
+    "\012nkin Inlet\000"
+    "\011ecife\000"
+    "\012gina\000"
+    "\012solute\000"
+    "\011io Branco\000"
+    "\000America/Santarem\000"
+    "\014iago\000"
+    "\014o Domingo\000"
+    "\012o Paulo\000"
+    "\011coresbysund\000"
+    "\011itka\000"
+    "\011t Barthelemy\000"
+    "\013Johns\000"
+    "\013Kitts\000"
+    "\013Lucia\000"
+    "\013Thomas\000"
+    "\013Vincent\000"
+    "\011wift Current\000"
+    "\010Tegucigalpa\000"
+    "\011hule\000"
+    "\013nder Bay\000"
+    "\000America/Tijuana\000"
+    "\011oronto\000"
+    "\013tola\000"
+    "\010Vancouver\000"
+    "\010Whitehorse\000"
+    "\011innipeg\000"
+    "\010Yakutat\000"
+    "\011ellowknife\000"
+    "\001ntarctica/Casey\000"
+    "\013Davis\000"
+    "\014umontDUrville\000"
+    "\013Macquarie\000"
+    "\015wson\000"
+    "\014cMurdo\000"
+    "\013Palmer\000"
+    "\013Rothera\000"
+    "\000Antarctica/Syowa\000"
+    "\013Troll\000"
+    "\013Vostok\000"
+    "\001rctic/Longyearbyen\000"
+    "\001sia/Aden\000"
+    "\006lmaty\000"
+    "\006mman\000"
+    "\006nadyr\000"
+    "\006qtau\000"
+    "\010obe\000"
+    "\006shgabat\000"
+    "\006tyrau\000"
+    "\005Baghdad\000"
+    "\007hrain\000"
+    "\007ku\000"
+    "\007ngkok\000"
+    "\000Asia/Barnaul\000"
+    "\006eirut\000"
+    "\006ishkek\000"
+    "\006runei\000"
+    "\005Chita\000"
+    "\007oibalsan\000"
+    "\006olombo\000"
+    "\005Damascus\000"
+    "\006haka\000"
+    "\006ili\000"
+    "\006ubai\000"
+    "\007shanbe\000"
+    "\005Famagusta\000"
+    "\005Gaza\000"
+    "\005Hebron\000"
+    "\006o Chi Minh\000"
+    "\000Asia/Hong Kong\000"
+    "\007vd\000"
+    "\005Irkutsk\000"
+    "\005Jakarta\000"
+    "\007yapura\000"
+    "\006erusalem\000"
+    "\005Kabul\000"
+    "\007mchatka\000"
+    "\007rachi\000"
+    "\007thmandu\000"
+    "\006handyga\000"
+    "\006olkata\000"
+    "\006rasnoyarsk\000"
+    "\006uala Lumpur\000"
+    "\007ching\000"
+    "\007wait\000"
+    "\000Asia/Macau\000"
+    "\007gadan\000"
+    "\007kassar\000"
+    "\007nila\000"
+    "\006uscat\000"
+    "\005Nicosia\000"
+    "\006ovokuznetsk\000"
+    "\011sibirsk\000"
+    "\005Omsk\000"
+    "\006ral\000"
+    "\005Phnom Penh\000"
+    "\006ontianak\000"
+    "\006yongyang\000"
+    "\005Qatar\000"
+    "\006yzylorda\000"
+    "\005Riyadh\000"
+    "\000Asia/Sakhalin\000"
+    "\007markand\000"
+    "\006eoul\000"
+    "\006hanghai\000"
+    "\006ingapore\000"
+    "\006rednekolymsk\000"
+    "\005Taipei\000"
+    "\007shkent\000"
+    "\006bilisi\000"
+    "\006ehran\000"
+    "\006himphu\000"
+    "\006okyo\000"
+    "\007msk\000"
+    "\005Ulaanbaatar\000"
+    "\006rumqi\000"
+    "\006st-Nera\000"
+    "\000Asia/Vientiane\000"
+    "\006ladivostok\000"
+    "\005Yakutsk\000"
+    "\007ngon\000"
+    "\006ekaterinburg\000"
+    "\007revan\000"
+    "\001tlantic/Azores\000"
+    "\011Bermuda\000"
+    "\011Canary\000"
+    "\013pe Verde\000"
+    "\011Faroe\000"
+    "\011Madeira\000"
+    "\011Reykjavik\000"
+    "\011South Georgia\000"
+    "\012t Helena\000"
+    "\013anley\000"
+    "\000Australia/Adelaide\000"
+    "\012Brisbane\000"
+    "\014oken Hill\000"
+    "\012Currie\000"
+    "\012Darwin\000"
+    "\012Eucla\000"
+    "\012Hobart\000"
+    "\012Lindeman\000"
+    "\013ord Howe\000"
+    "\012Melbourne\000"
+    "\012Perth\000"
+    "\012Sydney\000"
+    "\000Etc/GMT\000"
+    "\007+0\000"
+    "\0101\000"
+    "\0110\000"
+    "\000Etc/GMT+11\000"
+    "\0112\000"
+    "\0102\000"
+    "\0103\000"
+    "\0104\000"
+    "\0105\000"
+    "\0106\000"
+    "\0107\000"
+    "\0108\000"
+    "\0109\000"
+    "\007-0\000"
+    "\0101\000"
+    "\0110\000"
+    "\0111\000"
+    "\0112\000"
+    "\0113\000"
+    "\000Etc/GMT-14\000"
+    "\0102\000"
+    "\0103\000"
+    "\0104\000"
+    "\0105\000"
+    "\0106\000"
+    "\0107\000"
+    "\0108\000"
+    "\0109\000"
+    "\0070\000"
+    "\005reenwich\000"
+    "\004UCT\000"
+    "\005TC\000"
+    "\005niversal\000"
+    "\004Zulu\000"
+    "\001urope/Amsterdam\000"
+    "\000Europe/Andorra\000"
+    "\010strakhan\000"
+    "\010thens\000"
+    "\007Belgrade\000"
+    "\011rlin\000"
+    "\010ratislava\000"
+    "\011ussels\000"
+    "\010ucharest\000"
+    "\011dapest\000"
+    "\011singen\000"
+    "\007Chisinau\000"
+    "\010openhagen\000"
+    "\007Dublin\000"
+    "\007Gibraltar\000"
+    "\010uernsey\000"
+    "\007Helsinki\000"
+    "\000Europe/Isle of Man\000"
+    "\011tanbul\000"
+    "\007Jersey\000"
+    "\007Kaliningrad\000"
+    "\010iev\000"
+    "\011rov\000"
+    "\007Lisbon\000"
+    "\010jubljana\000"
+    "\010ondon\000"
+    "\010uxembourg\000"
+    "\007Madrid\000"
+    "\011lta\000"
+    "\011riehamn\000"
+    "\010insk\000"
+    "\010onaco\000"
+    "\011scow\000"
+    "\000Europe/Oslo\000"
+    "\007Paris\000"
+    "\010odgorica\000"
+    "\010rague\000"
+    "\007Riga\000"
+    "\010ome\000"
+    "\007Samara\000"
+    "\011n Marino\000"
+    "\011rajevo\000"
+    "\013tov\000"
+    "\010imferopol\000"
+    "\010kopje\000"
+    "\010ofia\000"
+    "\010tockholm\000"
+    "\007Tallinn\000"
+    "\010irane\000"
+    "\000Europe/Ulyanovsk\000"
+    "\010zhgorod\000"
+    "\007Vaduz\000"
+    "\011tican\000"
+    "\010ienna\000"
+    "\011lnius\000"
+    "\010olgograd\000"
+    "\007Warsaw\000"
+    "\007Zagreb\000"
+    "\011porozhye\000"
+    "\010urich\000"
+    "\000Indian/Antananarivo\000"
+    "\007Chagos\000"
+    "\011ristmas\000"
+    "\010ocos\000"
+    "\011moro\000"
+    "\000Indian/Kerguelen\000"
+    "\007Mahe\000"
+    "\011ldives\000"
+    "\011uritius\000"
+    "\011yotte\000"
+    "\007Reunion\000"
+    "\000Pacific/Apia\000"
+    "\011uckland\000"
+    "\010Bougainville\000"
+    "\010Chatham\000"
+    "\012uuk\000"
+    "\010Easter\000"
+    "\011fate\000"
+    "\011nderbury\000"
+    "\010Fakaofo\000"
+    "\011iji\000"
+    "\000Pacific/Funafuti\000"
+    "\010Galapagos\000"
+    "\012mbier\000"
+    "\011uadalcanal\000"
+    "\013m\000"
+    "\010Honolulu\000"
+    "\010Kiritimati\000"
+    "\011osrae\000"
+    "\011wajalein\000"
+    "\010Majuro\000"
+    "\012rquesas\000"
+    "\011idway\000"
+    "\010Nauru\000"
+    "\011iue\000"
+    "\011orfolk\000"
+    "\012umea\000"
+    "\000Pacific/Pago Pago\000"
+    "\012lau\000"
+    "\011itcairn\000"
+    "\011ohnpei\000"
+    "\012rt Moresby\000"
+    "\010Rarotonga\000"
+    "\010Saipan\000"
+    "\010Tahiti\000"
+    "\012rawa\000"
+    "\011ongatapu\000"
+    "\010Wake\000"
+    "\012llis";
+
+// Offset in names of every block of TZDB_BLOCK_SIZE names.
+const uint16_t name_blocks[] PROGMEM = {
+    0, 137, 288, 431, 602, 748, 891, 1047, 1205, 1363, 1514, 1683,
+    1841, 2006, 2143, 2276, 2419, 2558, 2700, 2866, 3003, 3061, 3152, 3305,
+    3441, 3570, 3718, 3864, 4004,
+};
+
+// Distinct POSIX TZ rules, each followed by a terminator.
+const char rules[] PROGMEM =
+    "<+00>0<+02>-2,M3.5.0/1,M10.5.0/3\000"
+    "<+01>-1\000"
+    "<+02>-2\000"
+    "<+0330>-3:30<+0430>,J79/24,J263/24\000"
+    "<+03>-3\000"
+    "<+0430>-4:30\000"
+    "<+04>-4\000"
+    "<+0530>-5:30\000"
+    "<+0545>-5:45\000"
+    "<+05>-5\000"
+    "<+0630>-6:30\000"
+    "<+06>-6\000"
+    "<+07>-7\000"
+    "<+0845>-8:45\000"
+    "<+08>-8\000"
+    "<+09>-9\000"
+    "<+1030>-10:30<+11>-11,M10.1.0,M4.1.0\000"
+    "<+10>-10\000"
+    "<+11>-11\000"
+    "<+11>-11<+12>,M10.1.0,M4.1.0/3\000"
+    "<+1245>-12:45<+1345>,M9.5.0/2:45,M4.1.0/3:45\000"
+    "<+12>-12\000"
+    "<+12>-12<+13>,M11.2.0,M1.2.3/99\000"
+    "<+13>-13\000"
+    "<+13>-13<+14>,M9.5.0/3,M4.1.0/4\000"
+    "<+14>-14\000"
+    "<-01>1\000"
+    "<-01>1<+00>,M3.5.0/0,M10.5.0/1\000"
+    "<-02>2\000"
+    "<-03>3\000"
+    "<-03>3<-02>,M3.2.0,M11.1.0\000"
+    "<-03>3<-02>,M3.5.0/-2,M10.5.0/-1\000"
+    "<-04>4\000"
+    "<-04>4<-03>,M10.1.0/0,M3.4.0/0\000"
+    "<-04>4<-03>,M9.1.6/24,M4.1.6/24\000"
+    "<-05>5\000"
+    "<-06>6\000"
+    "<-06>6<-05>,M9.1.6/22,M4.1.6/22\000"
+    "<-07>7\000"
+    "<-08>8\000"
+    "<-0930>9:30\000"
+    "<-09>9\000"
+    "<-10>10\000"
+    "<-11>11\000"
+    "<-12>12\000"
+    "ACST-9:30\000"
+    "ACST-9:30ACDT,M10.1.0,M4.1.0/3\000"
+    "AEST-10\000"
+    "AEST-10AEDT,M10.1.0,M4.1.0/3\000"
+    "AKST9AKDT,M3.2.0,M11.1.0\000"
+    "AST4\000"
+    "AST4ADT,M3.2.0,M11.1.0\000"
+    "AWST-8\000"
+    "CAT-2\000"
+    "CET-1\000"
+    "CET-1CEST,M3.5.0,M10.5.0/3\000"
+    "CST-8\000"
+    "CST5CDT,M3.2.0/0,M11.1.0/1\000"
+    "CST6\000"
+    "CST6CDT,M3.2.0,M11.1.0\000"
+    "CST6CDT,M4.1.0,M10.5.0\000"
+    "ChST-10\000"
+    "EAT-3\000"
+    "EET-2\000"
+    "EET-2EEST,M3.4.4/48,M10.4.4/49\000"
+    "EET-2EEST,M3.5.0,M10.5.0/3\000"
+    "EET-2EEST,M3.5.0/0,M10.5.0/0\000"
+    "EET-2EEST,M3.5.0/3,M10.5.0/4\000"
+    "EET-2EEST,M3.5.4/24,M10.5.5/1\000"
+    "EET-2EEST,M3.5.5/0,M10.5.5/0\000"
+    "EST5\000"
+    "EST5EDT,M3.2.0,M11.1.0\000"
+    "GMT0\000"
+    "GMT0BST,M3.5.0/1,M10.5.0\000"
+    "HKT-8\000"
+    "HST10\000"
+    "HST10HDT,M3.2.0,M11.1.0\000"
+    "IST-1GMT0,M10.5.0,M3.5.0/1\000"
+    "IST-2IDT,M3.4.4/26,M10.5.0\000"
+    "IST-5:30\000"
+    "JST-9\000"
+    "KST-9\000"
+    "MSK-3\000"
+    "MST7\000"
+    "MST7MDT,M3.2.0,M11.1.0\000"
+    "MST7MDT,M4.1.0,M10.5.0\000"
+    "NST3:30NDT,M3.2.0,M11.1.0\000"
+    "NZST-12NZDT,M9.5.0,M4.1.0/3\000"
+    "PKT-5\000"
+    "PST-8\000"
+    "PST8PDT,M3.2.0,M11.1.0\000"
+    "SAST-2\000"
+    "SST11\000"
+    "UTC0\000"
+    "WAT-1\000"
+    "WET0WEST,M3.5.0/1,M10.5.0\000"
+    "WIB-7\000"
+    "WIT-9\000"
+    "WITA-8";
+
+// Offset in rules of every distinct rule.
+const uint16_t rule_offsets[] PROGMEM = {
+    0, 33, 41, 49, 84, 92, 105, 113, 126, 139, 147, 160,
+    168, 176, 189, 197, 205, 242, 251, 260, 291, 336, 345, 377,
+    386, 418, 427, 434, 465, 472, 479, 506, 539, 546, 577, 609,
+    616, 623, 655, 662, 669, 681, 688, 696, 704, 712, 722, 753,
+    761, 790, 815, 820, 843, 850, 856, 862, 889, 895, 922, 927,
+    950, 973, 981, 987, 993, 1024, 1051, 1080, 1109, 1139, 1168, 1173,
+    1196, 1201, 1226, 1232, 1238, 1262, 1289, 1316, 1325, 1331, 1337, 1343,
+    1348, 1371, 1394, 1420, 1448, 1454, 1460, 1483, 1490, 1496, 1501, 1507,
+    1533, 1539, 1545,
+};
+
+// Index in rule_offsets of the rule of every zone.
+const uint8_t zone_rules[] PROGMEM = {
+    72, 72, 62, 54, 62, 72, 94, 72, 72, 53, 94, 53, 63, 1, 55, 72, 72, 62, 62, 94,
+    1, 72, 53, 53, 91, 62, 62, 53, 53, 94, 94, 94, 72, 94, 53, 53, 94, 53, 91, 91,
+    62, 72, 62, 94, 94, 72, 72, 94, 72, 63, 54, 53, 76, 49, 50, 50, 29, 29, 29, 29,
+    29, 29, 29, 29, 29, 29, 29, 29, 29, 50, 33, 70, 29, 60, 50, 29, 58, 50, 32, 35,
+    84, 84, 32, 70, 32, 29, 70, 59, 85, 58, 83, 32, 50, 72, 83, 83, 84, 71, 50, 84,
+    35, 58, 83, 29, 51, 31, 51, 71, 50, 50, 58, 35, 32, 51, 57, 83, 71, 59, 71, 71,
+    59, 71, 71, 71, 84, 71, 70, 49, 71, 71, 50, 32, 35, 90, 50, 29, 58, 32, 50, 50,
+    59, 85, 59, 60, 49, 60, 30, 51, 60, 29, 71, 50, 71, 71, 71, 49, 28, 59, 59, 59,
+    84, 70, 71, 29, 83, 71, 50, 32, 50, 29, 59, 59, 29, 58, 59, 35, 29, 34, 50, 29,
+    27, 49, 50, 86, 50, 50, 50, 50, 58, 58, 51, 71, 90, 71, 50, 90, 83, 59, 49, 84,
+    18, 12, 17, 48, 9, 87, 29, 29, 4, 0, 11, 55, 4, 11, 68, 21, 9, 9, 9, 9,
+    4, 4, 6, 12, 12, 66, 11, 14, 15, 14, 7, 69, 11, 15, 6, 9, 67, 64, 64, 12,
+    74, 12, 14, 96, 97, 78, 5, 21, 88, 8, 15, 79, 12, 14, 14, 4, 56, 18, 98, 89,
+    6, 67, 12, 12, 11, 9, 12, 96, 81, 4, 9, 4, 18, 9, 81, 56, 14, 18, 56, 9,
+    6, 3, 11, 80, 12, 14, 11, 17, 12, 17, 15, 10, 9, 6, 27, 51, 95, 26, 95, 95,
+    72, 28, 72, 29, 46, 47, 46, 48, 45, 13, 48, 47, 16, 48, 52, 48, 72, 72, 26, 42,
+    43, 44, 28, 29, 32, 35, 36, 38, 39, 41, 72, 1, 17, 18, 21, 23, 25, 2, 4, 6,
+    9, 11, 12, 14, 15, 72, 72, 93, 93, 93, 93, 55, 55, 6, 67, 55, 55, 55, 55, 67,
+    55, 55, 65, 55, 77, 55, 73, 67, 73, 4, 73, 63, 67, 4, 95, 55, 73, 55, 55, 55,
+    67, 4, 55, 82, 55, 55, 55, 55, 67, 55, 6, 55, 55, 6, 82, 55, 67, 55, 67, 55,
+    6, 67, 55, 55, 55, 67, 6, 55, 55, 67, 55, 62, 11, 12, 10, 62, 9, 6, 9, 6,
+    62, 6, 24, 87, 18, 20, 17, 37, 18, 23, 23, 22, 21, 36, 41, 18, 61, 75, 25, 18,
+    21, 21, 40, 92, 21, 43, 19, 18, 92, 15, 39, 18, 17, 42, 61, 42, 21, 23, 21, 21,
+};
+
+// Zone indices sorted by name, ignoring case.
+const uint16_t sorted[] PROGMEM = {
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11,
+    12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23,
+    24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35,
+    36, 37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47,
+    48, 49, 50, 51, 52, 53, 54, 55, 56, 57, 58, 59,
+    60, 61, 62, 63, 64, 65, 66, 67, 68, 69, 70, 71,
+    72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83,
+    84, 85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95,
+    96, 97, 98, 99, 100, 101, 102, 103, 104, 105, 106, 107,
+    108, 109, 110, 111, 112, 113, 114, 115, 116, 117, 118, 119,
+    120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131,
+    132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143,
+    144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155,
+    156, 157, 158, 159, 160, 161, 162, 163, 164, 166, 165, 167,
+    168, 169, 170, 171, 172, 173, 174, 175, 176, 177, 178, 179,
+    180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+    192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203,
+    204, 205, 206, 207, 208, 209, 210, 211, 212, 213, 214, 215,
+    216, 217, 218, 219, 220, 221, 222, 223, 224, 225, 226, 227,
+    228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239,
+    240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251,
+    252, 253, 254, 255, 256, 257, 258, 259, 260, 261, 262, 263,
+    264, 265, 266, 267, 268, 269, 270, 271, 272, 273, 274, 275,
+    276, 277, 278, 279, 280, 281, 282, 283, 284, 285, 286, 287,
+    288, 289, 290, 291, 292, 293, 294, 295, 296, 297, 298, 299,
+    300, 301, 302, 303, 304, 305, 306, 307, 308, 309, 310, 311,
+    312, 313, 314, 315, 316, 317, 318, 319, 320, 321, 322, 323,
+    324, 325, 326, 327, 328, 329, 330, 331, 332, 333, 334, 335,
+    336, 337, 338, 339, 340, 341, 342, 343, 344, 345, 346, 347,
+    349, 348, 350, 351, 352, 353, 354, 355, 356, 357, 358, 359,
+    360, 361, 362, 363, 364, 365, 366, 367, 368, 369, 370, 371,
+    372, 373, 374, 375, 376, 377, 378, 379, 380, 381, 382, 383,
+    384, 385, 386, 387, 388, 389, 390, 391, 392, 393, 394, 395,
+    396, 397, 398, 399, 400, 401, 402, 403, 404, 405, 406, 407,
+    408, 409, 410, 411, 412, 413, 414, 415, 416, 417, 418, 419,
+    420, 421, 422, 423, 424, 425, 426, 427, 428, 429, 430, 431,
+    432, 433, 434, 435, 436, 437, 438, 439, 440, 441, 442, 443,
+    444, 445, 446, 447, 448, 449, 450, 451, 452, 453, 454, 455,
+    456, 457, 458, 459,
+};
+
+}  // namespace data
+}  // namespace tzdb
+
+#endif  // WORDCLOCK_TZDB_DATA_H_
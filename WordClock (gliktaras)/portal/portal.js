@@ -0,0 +1,214 @@
+"use strict";
+// Enhances IotWebConf's configuration form. tools/portal_gen.py minifies this
+// file into WordClock/portal_assets.h.
+
+// Labels IotWebConf's own fields the way the clock calls them.
+function relabel() {
+  var label = document.querySelector("label[for=iwcThingName]");
+  if (label) label.innerText = "Clock name";
+  label = document.querySelector("label[for=iwcApPassword]");
+  if (label) label.innerText = "AP password (login: admin)";
+}
+
+// Adds a button next to every password field that shows or hides it.
+function addPasswordToggles() {
+  var HIDDEN = "\ud83d\udc41\ufe0f";  // Eye.
+  var SHOWN = "\ud83d\udd12";  // Lock.
+  document.querySelectorAll("input[type=password]").forEach(function (input) {
+    var toggle = document.createElement("input");
+    toggle.classList.add("pwtoggle");
+    toggle.type = "button";
+    toggle.value = HIDDEN;
+    input.insertAdjacentElement("afterend", toggle);
+    toggle.onclick = function () {
+      var hidden = input.type === "password";
+      input.type = hidden ? "text" : "password";
+      toggle.value = hidden ? SHOWN : HIDDEN;
+    };
+  });
+}
+
+// Disables the submit button once the form is sent.
+function disableSubmitOnSave() {
+  var form = document.querySelector("form");
+  if (!form) return;
+  form.addEventListener("submit", function () {
+    var button = document.querySelector("button[type=submit]");
+    button.innerText = "Saving...";
+    button.toggleAttribute("disabled", true);
+  });
+}
+
+// Replaces every input with a data-options attribute, a "|" separated list of
+// options, by a select whose values are the option indices. Options named
+// "Group/Name" are put in an optgroup per group.
+function addSelects() {
+  document.querySelectorAll("input[data-options]").forEach(function (input) {
+    var value = input.value;
+    var options = input.getAttribute("data-options").split("|");
+    var select = document.createElement("select");
+    select.name = input.name;
+    select.id = input.id;
+    if (value === "") select.appendChild(document.createElement("option"));
+
+    var group = null;
+    options.forEach(function (option, index) {
+      var parts = option.split("/");
+      var text = option;
+      if (parts.length > 1) {
+        var groupLabel = parts.shift();
+        if (!group || group.label != groupLabel) {
+          if (group) select.appendChild(group);
+          group = document.createElement("optgroup");
+          group.label = groupLabel;
+        }
+        text = parts.join(" / ");
+      } else if (group) {
+        select.appendChild(group);
+        group = null;
+      }
+      var element = document.createElement("option");
+      element.value = index;
+      element.innerText = text;
+      if (index == value) element.toggleAttribute("selected");
+      (group || select).appendChild(element);
+    });
+    if (group) select.appendChild(group);
+
+    input.id += "-d";
+    input.insertAdjacentElement("beforebegin", select);
+    input.parentElement.removeChild(input);
+  });
+}
+
+// Turns every input with a data-search attribute, the URL of a timezone
+// search, into a search field. The input itself is hidden and keeps the index
+// of the chosen zone.
+function addZoneSearches() {
+  document.querySelectorAll("input[data-search]").forEach(function (input) {
+    var url = input.getAttribute("data-search");
+    var search = document.createElement("input");
+    var list = document.createElement("div");
+    var timer;
+    // Number of the latest search. Responses to earlier ones, which may come
+    // back after it, are dropped.
+    var latest = 0;
+
+    // Lists page `page` of the zones matching `query`, after those listed, if
+    // search `sequence` is still the latest.
+    function find(query, page, sequence) {
+      fetch(url + query + "&page=" + page).then(function (response) {
+        return response.json();
+      }).then(function (result) {
+        if (sequence !== latest) return;
+        if (!page) list.innerHTML = "";
+        result.zones.forEach(function (zone) {
+          var button = document.createElement("button");
+          button.type = "button";
+          button.innerText = zone.name;
+          button.onclick = function () {
+            input.value = zone.index;
+            search.value = zone.name;
+            list.innerHTML = "";
+          };
+          list.appendChild(button);
+        });
+        if ((page + 1) * result.page_size < result.total) {
+          var more = document.createElement("button");
+          more.type = "button";
+          more.innerText = "More...";
+          more.onclick = function () {
+            list.removeChild(more);
+            find(query, page + 1, sequence);
+          };
+          list.appendChild(more);
+        }
+      });
+    }
+
+    search.type = "search";
+    search.placeholder = "Search city or region";
+    search.autocomplete = "off";
+    list.className = "tzlist";
+    input.type = "hidden";
+    input.insertAdjacentElement("afterend", list);
+    input.insertAdjacentElement("afterend", search);
+
+    fetch(url + "?i=" + input.value).then(function (response) {
+      return response.json();
+    }).then(function (result) {
+      // Unless a search started meanwhile.
+      if (latest === 0 && result.zones.length) {
+        search.value = result.zones[0].name;
+      }
+    });
+
+    search.oninput = function () {
+      clearTimeout(timer);
+      var sequence = ++latest;
+      timer = setTimeout(function () {
+        if (search.value) {
+          find("?q=" + encodeURIComponent(search.value), 0, sequence);
+        } else {
+          list.innerHTML = "";
+        }
+      }, 200);
+    };
+  });
+}
+
+// Shows the value of every range input, or its label from data-labels, a "|"
+// separated list of labels.
+function addRangeLabels() {
+  document.querySelectorAll("input[type=range]").forEach(function (input) {
+    var labels = input.getAttribute("data-labels");
+    labels = labels && labels.split("|");
+    function update() {
+      input.setAttribute("data-label",
+          labels ? labels[parseInt(input.value, 10)] || input.value
+                 : input.value);
+    }
+    input.oninput = update;
+    update();
+  });
+}
+
+// Shows either the manual date and time or the timezone, depending on whether
+// the time comes from NTP.
+function toggleTimeFields() {
+  var ntp = document.getElementById("ntp_enabled");
+  if (!ntp) return;
+  function update() {
+    var enabled = ntp.value == 1;
+    document.querySelectorAll("#date, #time").forEach(function (field) {
+      field.parentElement.style.display = enabled ? "none" : "";
+    });
+    document.getElementById("timezone").parentElement.style.display =
+        enabled ? "" : "none";
+  }
+  ntp.addEventListener("change", update);
+  update();
+}
+
+// Paints the logo's background in the chosen color.
+function previewColor() {
+  var color = document.querySelector("input[type=color]");
+  if (!color) return;
+  function update() {
+    document.querySelector(".logoContainer").style.backgroundColor =
+        color.value;
+  }
+  color.addEventListener("input", update);
+  update();
+}
+
+document.addEventListener("DOMContentLoaded", function () {
+  relabel();
+  addPasswordToggles();
+  disableSubmitOnSave();
+  addSelects();
+  addZoneSearches();
+  addRangeLabels();
+  toggleTimeFields();
+  previewColor();
+});
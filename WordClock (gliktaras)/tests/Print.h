@@ -0,0 +1,20 @@
+#ifndef WORDCLOCK_TESTS_PRINT_H_
+#define WORDCLOCK_TESTS_PRINT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Host stand-in for Arduino's Print, as far as logging.h uses it.
+class Print {
+  public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t written = 0;
+        while (written < size && write(buffer[written])) written++;
+        return written;
+    }
+};
+
+#endif  // WORDCLOCK_TESTS_PRINT_H_
@@ -0,0 +1,49 @@
+#ifndef WORDCLOCK_TESTS_CHECK_H_
+#define WORDCLOCK_TESTS_CHECK_H_
+
+#include <stdio.h>
+
+// Minimal assertions for the host tests. A failed CHECK prints its location
+// and marks the test as failed, without stopping it.
+
+namespace check {
+
+// Number of failed checks.
+extern int failures;
+
+// Returns the exit status of the test: 0 if every check passed.
+inline int result(const char* name) {
+    if (failures == 0) {
+        printf("%s: ok\n", name);
+        return 0;
+    }
+    printf("%s: %d failed\n", name, failures);
+    return 1;
+}
+
+}  // namespace check
+
+#define CHECK(condition)                                                  \
+    do {                                                                  \
+        if (!(condition)) {                                               \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__,       \
+                   #condition);                                           \
+            check::failures++;                                            \
+        }                                                                 \
+    } while (0)
+
+#define CHECK_EQ(expected, actual)                                        \
+    do {                                                                  \
+        const long long expected_ = (expected);                           \
+        const long long actual_ = (actual);                               \
+        if (expected_ != actual_) {                                       \
+            printf("%s:%d: expected %s == %lld, got %lld\n", __FILE__,    \
+                   __LINE__, #actual, expected_, actual_);                \
+            check::failures++;                                            \
+        }                                                                 \
+    } while (0)
+
+// Defines check::failures. Used once per test program.
+#define CHECK_MAIN int check::failures = 0
+
+#endif  // WORDCLOCK_TESTS_CHECK_H_
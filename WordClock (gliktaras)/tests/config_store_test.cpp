@@ -0,0 +1,285 @@
+// Host test of the configuration record and its migrations.
+//
+// Records of older firmwares are built byte by byte at the offsets those
+// firmwares wrote, rather than from the payload structs, so that a change of
+// a released layout fails the test.
+
+#include <string.h>
+
+#include <vector>
+
+#include "check.h"
+#include "config_store.h"
+#include "memory_key_value_store.h"
+
+CHECK_MAIN;
+
+namespace {
+
+#define MAGIC 0x47464357
+#define HEADER_SIZE 12
+
+// Size of the payload of every schema version, as released. Index 0 is
+// unused.
+const size_t PAYLOAD_SIZES[] = {0, 12, 176, 180, 184, 188, 192};
+#define LATEST_VERSION 6
+
+uint32_t crc32(const std::vector<uint8_t>& data, size_t start) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = start; i < data.size(); i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+        }
+    }
+    return ~crc;
+}
+
+// A little endian record, as written by the ESP32.
+class Record {
+  public:
+    explicit Record(size_t payload_size)
+        : bytes_(HEADER_SIZE + payload_size, 0) {}
+
+    void put8(size_t offset, uint8_t value) {
+        bytes_[HEADER_SIZE + offset] = value;
+    }
+    void put16(size_t offset, uint16_t value) {
+        put8(offset, value & 0xFF);
+        put8(offset + 1, value >> 8);
+    }
+    void put32(size_t offset, uint32_t value) {
+        put16(offset, value & 0xFFFF);
+        put16(offset + 2, value >> 16);
+    }
+    void putString(size_t offset, const char* value) {
+        memcpy(&bytes_[HEADER_SIZE + offset], value, strlen(value));
+    }
+
+    // Returns the record with its header.
+    std::vector<uint8_t> build(uint16_t version) {
+        putHeader32(0, MAGIC);
+        putHeader16(4, version);
+        putHeader16(6, bytes_.size() - HEADER_SIZE);
+        putHeader32(8, crc32(bytes_, HEADER_SIZE));
+        return bytes_;
+    }
+
+  private:
+    void putHeader16(size_t offset, uint16_t value) {
+        bytes_[offset] = value & 0xFF;
+        bytes_[offset + 1] = value >> 8;
+    }
+    void putHeader32(size_t offset, uint32_t value) {
+        putHeader16(offset, value & 0xFFFF);
+        putHeader16(offset + 2, value >> 16);
+    }
+
+    std::vector<uint8_t> bytes_;
+};
+
+// Returns a record whose fields of schema `version` all differ from the
+// defaults, with `payload_size` bytes of payload and `header_version` in its
+// header.
+std::vector<uint8_t> fixture(int version, size_t payload_size,
+                             int header_version) {
+    Record record(payload_size);
+    record.put32(0, 0x123456);  // color
+    record.put16(4, 42);        // timezone
+    record.put16(6, 120);       // fast_time_factor
+    record.put8(8, 3);          // palette_id
+    record.put8(9, 2);          // clock_mode
+    record.put8(10, 1);         // dst
+    record.put8(11, 1);         // period
+    if (version >= 2) {
+        record.putString(12, "broker.lan");  // mqtt_host
+        record.putString(76, "clock");       // mqtt_user
+        record.putString(108, "secret");     // mqtt_password
+        record.putString(140, "hall/clock"); // mqtt_topic
+        record.put16(172, 8883);             // mqtt_port
+        record.put16(174, 300);              // mqtt_interval_s
+    }
+    if (version >= 3) record.put16(176, 1500);  // power_limit_ma
+    if (version >= 4) record.put8(180, 2);      // orientation
+    if (version >= 5) record.put8(184, 1);      // power_save
+    if (version >= 6) record.put8(188, 4);      // transition
+    return record.build(header_version);
+}
+
+std::vector<uint8_t> fixture(int version) {
+    return fixture(version, PAYLOAD_SIZES[version], version);
+}
+
+// Checks that `config` holds the fields of `fixture(version)` up to
+// `version`, and defaults after it.
+void checkFixture(const ClockConfig& config, int version) {
+    const ClockConfig defaults = ClockConfig::defaults();
+    CHECK_EQ(0x123456, config.color);
+    CHECK_EQ(42, config.timezone);
+    CHECK_EQ(120, config.fast_time_factor);
+    CHECK_EQ(3, config.palette_id);
+    CHECK_EQ(2, config.clock_mode);
+    CHECK(config.dst);
+    CHECK(config.period);
+    if (version >= 2) {
+        CHECK(strcmp(config.mqtt_host, "broker.lan") == 0);
+        CHECK(strcmp(config.mqtt_user, "clock") == 0);
+        CHECK(strcmp(config.mqtt_password, "secret") == 0);
+        CHECK(strcmp(config.mqtt_topic, "hall/clock") == 0);
+        CHECK_EQ(8883, config.mqtt_port);
+        CHECK_EQ(300, config.mqtt_interval_s);
+    } else {
+        CHECK(strcmp(config.mqtt_host, defaults.mqtt_host) == 0);
+        CHECK(strcmp(config.mqtt_user, defaults.mqtt_user) == 0);
+        CHECK(strcmp(config.mqtt_password, defaults.mqtt_password) == 0);
+        CHECK(strcmp(config.mqtt_topic, defaults.mqtt_topic) == 0);
+        CHECK_EQ(defaults.mqtt_port, config.mqtt_port);
+        CHECK_EQ(defaults.mqtt_interval_s, config.mqtt_interval_s);
+    }
+    CHECK_EQ(version >= 3 ? 1500 : defaults.power_limit_ma,
+             config.power_limit_ma);
+    CHECK_EQ(version >= 4 ? 2 : defaults.orientation, config.orientation);
+    CHECK_EQ(version >= 5 ? true : defaults.power_save, config.power_save);
+    CHECK_EQ(version >= 6 ? 4 : defaults.transition, config.transition);
+}
+
+void testCurrentVersion() {
+    CHECK_EQ(LATEST_VERSION, CONFIG_SCHEMA_VERSION);
+}
+
+void testEmpty() {
+    MemoryKeyValueStore kv;
+    ConfigStore store(&kv);
+    ClockConfig config = ClockConfig::defaults();
+    config.timezone = 7;
+    CHECK(!store.load(&config));
+    CHECK_EQ(7, config.timezone);
+}
+
+void testMigrations() {
+    for (int version = 1; version <= LATEST_VERSION; version++) {
+        MemoryKeyValueStore kv;
+        ConfigStore store(&kv);
+        kv.blobs[CONFIG_STORE_KEY] = fixture(version);
+        ClockConfig config;
+        CHECK(store.load(&config));
+        checkFixture(config, version);
+
+        // Written back in the latest layout.
+        CHECK(store.save(config));
+        const std::vector<uint8_t>& saved = kv.blobs[CONFIG_STORE_KEY];
+        CHECK_EQ(HEADER_SIZE + PAYLOAD_SIZES[LATEST_VERSION], saved.size());
+        CHECK_EQ(LATEST_VERSION, saved[4] | saved[5] << 8);
+        ClockConfig reloaded;
+        CHECK(store.load(&reloaded));
+        checkFixture(reloaded, version);
+    }
+}
+
+void testLatestLayout() {
+    // A saved record matches the released layout byte for byte.
+    MemoryKeyValueStore kv;
+    ConfigStore store(&kv);
+    kv.blobs[CONFIG_STORE_KEY] = fixture(LATEST_VERSION);
+    ClockConfig config;
+    CHECK(store.load(&config));
+    CHECK(store.save(config));
+    CHECK(kv.blobs[CONFIG_STORE_KEY] == fixture(LATEST_VERSION));
+}
+
+void testNewerFirmware() {
+    // A newer firmware appended fields this one ignores.
+    MemoryKeyValueStore kv;
+    ConfigStore store(&kv);
+    kv.blobs[CONFIG_STORE_KEY] =
+        fixture(LATEST_VERSION, PAYLOAD_SIZES[LATEST_VERSION] + 8,
+                LATEST_VERSION + 1);
+    ClockConfig config;
+    CHECK(store.load(&config));
+    checkFixture(config, LATEST_VERSION);
+}
+
+void testShortPayload() {
+    // A version 3 header over a version 2 payload keeps the default limit.
+    MemoryKeyValueStore kv;
+    ConfigStore store(&kv);
+    kv.blobs[CONFIG_STORE_KEY] = fixture(3, PAYLOAD_SIZES[2], 3);
+    ClockConfig config;
+    CHECK(store.load(&config));
+    checkFixture(config, 2);
+}
+
+void testCorruptRecords() {
+    MemoryKeyValueStore kv;
+    ConfigStore store(&kv);
+    ClockConfig config = ClockConfig::defaults();
+
+    std::vector<uint8_t> record = fixture(LATEST_VERSION);
+    record[HEADER_SIZE + 4] ^= 1;
+    kv.blobs[CONFIG_STORE_KEY] = record;
+    CHECK(!store.load(&config));
+
+    record = fixture(LATEST_VERSION);
+    record[0] ^= 1;
+    kv.blobs[CONFIG_STORE_KEY] = record;
+    CHECK(!store.load(&config));
+
+    // Payload size in the header does not match the blob.
+    record = fixture(LATEST_VERSION);
+    record.pop_back();
+    kv.blobs[CONFIG_STORE_KEY] = record;
+    CHECK(!store.load(&config));
+    record = fixture(LATEST_VERSION);
+    record.push_back(0);
+    kv.blobs[CONFIG_STORE_KEY] = record;
+    CHECK(!store.load(&config));
+
+    // Too short for any version, and no version.
+    kv.blobs[CONFIG_STORE_KEY] = fixture(1, PAYLOAD_SIZES[1] - 1, 1);
+    CHECK(!store.load(&config));
+    kv.blobs[CONFIG_STORE_KEY] = fixture(1, PAYLOAD_SIZES[1], 0);
+    CHECK(!store.load(&config));
+    kv.blobs[CONFIG_STORE_KEY] = std::vector<uint8_t>(HEADER_SIZE - 1, 0);
+    CHECK(!store.load(&config));
+
+    // Left unchanged.
+    CHECK_EQ(ClockConfig::defaults().color, config.color);
+}
+
+void testUnterminatedStrings() {
+    MemoryKeyValueStore kv;
+    ConfigStore store(&kv);
+    Record record(PAYLOAD_SIZES[2]);
+    std::string host(CONFIG_MQTT_HOST_SIZE, 'h');
+    record.putString(12, host.c_str());
+    kv.blobs[CONFIG_STORE_KEY] = record.build(2);
+    ClockConfig config;
+    CHECK(store.load(&config));
+    CHECK_EQ(CONFIG_MQTT_HOST_SIZE - 1, strlen(config.mqtt_host));
+}
+
+void testFailedWrite() {
+    MemoryKeyValueStore kv;
+    ConfigStore store(&kv);
+    kv.blobs[CONFIG_STORE_KEY] = fixture(4);
+    kv.fail_writes = true;
+    CHECK(!store.save(ClockConfig::defaults()));
+    ClockConfig config;
+    CHECK(store.load(&config));
+    checkFixture(config, 4);
+}
+
+}  // namespace
+
+int main() {
+    testCurrentVersion();
+    testEmpty();
+    testMigrations();
+    testLatestLayout();
+    testNewerFirmware();
+    testShortPayload();
+    testCorruptRecords();
+    testUnterminatedStrings();
+    testFailedWrite();
+    return check::result("config_store_test");
+}
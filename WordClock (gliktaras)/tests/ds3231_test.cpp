@@ -0,0 +1,165 @@
+// Host test of the DS3231 driver against a fake register file.
+
+#include <time.h>
+
+#include "check.h"
+#include "ds3231.h"
+#include "fake_i2c_bus.h"
+
+CHECK_MAIN;
+
+namespace {
+
+// Registers of the DS3231.
+#define REG_HOURS 0x02
+#define REG_MONTH 0x05
+#define REG_CONTROL 0x0E
+#define REG_STATUS 0x0F
+#define REG_AGING 0x10
+
+time_t utc(int year, int month, int day, int hour, int minute, int second) {
+    struct tm time = {};
+    time.tm_year = year - 1900;
+    time.tm_mon = month - 1;
+    time.tm_mday = day;
+    time.tm_hour = hour;
+    time.tm_min = minute;
+    time.tm_sec = second;
+    return timegm(&time);
+}
+
+void testRegisters() {
+    FakeI2cBus bus(DS3231_ADDRESS);
+    Ds3231 rtc(&bus);
+    // Thursday.
+    CHECK(rtc.writeTime(utc(2024, 2, 29, 23, 58, 7)));
+    const uint8_t expected[] = {0x07, 0x58, 0x23, 0x05, 0x29, 0x02, 0x24};
+    for (int i = 0; i < 7; i++) {
+        CHECK_EQ(expected[i], bus.registers[i]);
+    }
+}
+
+void testRoundTrip() {
+    const time_t times[] = {
+        utc(2000, 1, 1, 0, 0, 0),      utc(2019, 12, 31, 12, 0, 59),
+        utc(2024, 2, 29, 23, 59, 59),  utc(2038, 1, 19, 3, 14, 8),
+        utc(2099, 12, 31, 23, 59, 59), utc(2100, 1, 1, 0, 0, 0),
+        utc(2100, 3, 1, 10, 20, 30),   utc(2199, 12, 31, 23, 59, 59),
+    };
+    for (const time_t time : times) {
+        FakeI2cBus bus(DS3231_ADDRESS);
+        Ds3231 rtc(&bus);
+        CHECK(rtc.writeTime(time));
+        time_t read = 0;
+        CHECK(rtc.readTime(&read));
+        CHECK_EQ(time, read);
+        // Years from 2100 set the century bit.
+        struct tm parts;
+        gmtime_r(&time, &parts);
+        CHECK_EQ(parts.tm_year >= 200, (bus.registers[REG_MONTH] & 0x80) != 0);
+    }
+}
+
+void testOutOfRange() {
+    FakeI2cBus bus(DS3231_ADDRESS);
+    Ds3231 rtc(&bus);
+    CHECK(!rtc.writeTime(utc(1999, 12, 31, 23, 59, 59)));
+    CHECK(!rtc.writeTime(utc(2200, 1, 1, 0, 0, 0)));
+    CHECK_EQ(0, bus.writes);
+
+    // Month 0, as on a chip that never held a time.
+    time_t read;
+    CHECK(!rtc.readTime(&read));
+    bus.registers[REG_MONTH] = 0x13;
+    bus.registers[0x04] = 0x01;
+    CHECK(!rtc.readTime(&read));
+}
+
+void testTwelveHourMode() {
+    FakeI2cBus bus(DS3231_ADDRESS);
+    Ds3231 rtc(&bus);
+    CHECK(rtc.writeTime(utc(2024, 6, 1, 0, 0, 0)));
+    const struct {
+        uint8_t hours;
+        int hour;
+    } cases[] = {
+        {0x40 | 0x12, 0},         // 12 AM
+        {0x40 | 0x01, 1},         // 1 AM
+        {0x40 | 0x11, 11},        // 11 AM
+        {0x40 | 0x20 | 0x12, 12}, // 12 PM
+        {0x40 | 0x20 | 0x01, 13}, // 1 PM
+        {0x40 | 0x20 | 0x11, 23}, // 11 PM
+    };
+    for (const auto& c : cases) {
+        bus.registers[REG_HOURS] = c.hours;
+        time_t read;
+        CHECK(rtc.readTime(&read));
+        CHECK_EQ(utc(2024, 6, 1, c.hour, 0, 0), read);
+    }
+}
+
+void testLostPower() {
+    FakeI2cBus bus(DS3231_ADDRESS);
+    Ds3231 rtc(&bus);
+    CHECK(rtc.begin());
+    // Oscillator stop flag set on first power up, other bits kept.
+    bus.registers[REG_STATUS] = 0x80 | 0x08;
+    CHECK(rtc.lostPower());
+    CHECK(rtc.writeTime(utc(2024, 1, 1, 0, 0, 0)));
+    CHECK(!rtc.lostPower());
+    CHECK_EQ(0x08, bus.registers[REG_STATUS]);
+
+    bus.present = false;
+    CHECK(!rtc.begin());
+    CHECK(rtc.lostPower());
+    time_t read;
+    CHECK(!rtc.readTime(&read));
+    uint8_t seconds;
+    CHECK(!rtc.readSeconds(&seconds));
+}
+
+void testAgingOffset() {
+    FakeI2cBus bus(DS3231_ADDRESS);
+    Ds3231 rtc(&bus);
+    CHECK(rtc.writeAgingOffset(-5));
+    CHECK_EQ(0xFB, bus.registers[REG_AGING]);
+    // Starts a conversion to apply it.
+    CHECK_EQ(0x20, bus.registers[REG_CONTROL] & 0x20);
+    int8_t offset = 0;
+    CHECK(rtc.readAgingOffset(&offset));
+    CHECK_EQ(-5, offset);
+
+    // Not while a conversion is running, which applies it anyway.
+    bus.registers[REG_CONTROL] = 0;
+    bus.registers[REG_STATUS] = 0x04;
+    CHECK(rtc.writeAgingOffset(12));
+    CHECK_EQ(0, bus.registers[REG_CONTROL]);
+    CHECK_EQ(12, bus.registers[REG_AGING]);
+}
+
+void testAgingCorrection() {
+    // A fast clock is slowed down with a larger offset, 0.1 ppm per step.
+    CHECK_EQ(10, Ds3231::agingOffsetFor(0, 1.0f));
+    CHECK_EQ(-10, Ds3231::agingOffsetFor(0, -1.0f));
+    CHECK_EQ(-2, Ds3231::agingOffsetFor(3, -0.5f));
+    CHECK_EQ(5, Ds3231::agingOffsetFor(5, 0.04f));
+    CHECK_EQ(6, Ds3231::agingOffsetFor(5, 0.06f));
+    // Clamped to the register.
+    CHECK_EQ(127, Ds3231::agingOffsetFor(120, 1.0f));
+    CHECK_EQ(-128, Ds3231::agingOffsetFor(-120, -1.0f));
+    CHECK_EQ(127, Ds3231::agingOffsetFor(0, 1e9f));
+    CHECK_EQ(-128, Ds3231::agingOffsetFor(0, -1e9f));
+}
+
+}  // namespace
+
+int main() {
+    testRegisters();
+    testRoundTrip();
+    testOutOfRange();
+    testTwelveHourMode();
+    testLostPower();
+    testAgingOffset();
+    testAgingCorrection();
+    return check::result("ds3231_test");
+}
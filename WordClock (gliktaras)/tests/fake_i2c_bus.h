@@ -0,0 +1,49 @@
+#ifndef WORDCLOCK_TESTS_FAKE_I2C_BUS_H_
+#define WORDCLOCK_TESTS_FAKE_I2C_BUS_H_
+
+#include <string.h>
+
+#include "i2c_bus.h"
+
+// I2C bus with a single device, whose registers are a plain array. Accesses
+// past the last register wrap around, as on the DS3231.
+class FakeI2cBus : public I2cBus {
+  public:
+    explicit FakeI2cBus(uint8_t address) : address_(address) {
+        memset(registers, 0, sizeof(registers));
+    }
+
+    FakeI2cBus(const FakeI2cBus&) = delete;
+    FakeI2cBus& operator=(const FakeI2cBus&) = delete;
+
+    bool read(uint8_t address, uint8_t reg, uint8_t* data,
+              size_t size) override {
+        if (!present || address != address_) return false;
+        for (size_t i = 0; i < size; i++) {
+            data[i] = registers[static_cast<uint8_t>(reg + i)];
+        }
+        return true;
+    }
+
+    bool write(uint8_t address, uint8_t reg, const uint8_t* data,
+               size_t size) override {
+        if (!present || address != address_) return false;
+        for (size_t i = 0; i < size; i++) {
+            registers[static_cast<uint8_t>(reg + i)] = data[i];
+        }
+        writes++;
+        return true;
+    }
+
+    // Whether the device answers.
+    bool present = true;
+    // Registers of the device.
+    uint8_t registers[256];
+    // Number of write transactions.
+    int writes = 0;
+
+  private:
+    const uint8_t address_;
+};
+
+#endif  // WORDCLOCK_TESTS_FAKE_I2C_BUS_H_
@@ -0,0 +1,64 @@
+// MQTT transport of a host, to run MqttClient on Linux.
+
+#include "host_mqtt.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+TcpMqttTransport::TcpMqttTransport() {}
+
+TcpMqttTransport::~TcpMqttTransport() { stop(); }
+
+bool TcpMqttTransport::connect(const char* host, uint16_t port) {
+    stop();
+    char service[8];
+    snprintf(service, sizeof(service), "%u", port);
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* results;
+    if (getaddrinfo(host, service, &hints, &results) != 0) return false;
+    socket_ = socket(AF_INET, SOCK_STREAM, 0);
+    // Blocks until the broker accepts, as WiFiClient does.
+    const bool ok =
+        socket_ >= 0 &&
+        ::connect(socket_, results->ai_addr, results->ai_addrlen) == 0 &&
+        fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL) | O_NONBLOCK) == 0;
+    freeaddrinfo(results);
+    if (!ok) stop();
+    return ok;
+}
+
+bool TcpMqttTransport::connected() { return socket_ >= 0 && !closed_; }
+
+int TcpMqttTransport::write(const uint8_t* data, size_t size) {
+    if (socket_ < 0) return -1;
+    const ssize_t written =
+        send(socket_, data, size, MSG_DONTWAIT | MSG_NOSIGNAL);
+    if (written >= 0) return written;
+    return errno == EAGAIN || errno == EWOULDBLOCK ? 0 : -1;
+}
+
+int TcpMqttTransport::read(uint8_t* data, size_t size) {
+    if (socket_ < 0 || size == 0) return socket_ < 0 ? -1 : 0;
+    const ssize_t received = recv(socket_, data, size, MSG_DONTWAIT);
+    if (received > 0) return received;
+    if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return 0;
+    closed_ = true;
+    return -1;
+}
+
+void TcpMqttTransport::stop() {
+    if (socket_ >= 0) close(socket_);
+    socket_ = -1;
+    closed_ = false;
+}
+
+void TcpMqttTransport::drop() {
+    if (socket_ >= 0) shutdown(socket_, SHUT_RDWR);
+}
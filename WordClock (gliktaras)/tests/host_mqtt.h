@@ -0,0 +1,32 @@
+#ifndef WORDCLOCK_TESTS_HOST_MQTT_H_
+#define WORDCLOCK_TESTS_HOST_MQTT_H_
+
+#include "mqtt_client.h"
+
+// MQTT transport over a non-blocking TCP socket of the host. Hosts are IPv4
+// addresses or names.
+class TcpMqttTransport : public MqttTransport {
+  public:
+    TcpMqttTransport();
+    ~TcpMqttTransport() override;
+
+    TcpMqttTransport(const TcpMqttTransport&) = delete;
+    TcpMqttTransport& operator=(const TcpMqttTransport&) = delete;
+
+    bool connect(const char* host, uint16_t port) override;
+    bool connected() override;
+    int write(const uint8_t* data, size_t size) override;
+    int read(uint8_t* data, size_t size) override;
+    void stop() override;
+
+    // Shuts the connection down without telling the client, as a broker or
+    // network going away would.
+    void drop();
+
+  private:
+    int socket_ = -1;
+    // Whether the peer closed the connection.
+    bool closed_ = false;
+};
+
+#endif  // WORDCLOCK_TESTS_HOST_MQTT_H_
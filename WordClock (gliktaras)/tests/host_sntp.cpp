@@ -0,0 +1,120 @@
+// SNTP transport and clock of a host, to run SntpClient on Linux.
+
+#include "host_sntp.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+int64_t hostUs(clockid_t clock) {
+    struct timespec now;
+    clock_gettime(clock, &now);
+    return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+}  // namespace
+
+UdpSntpTransport::UdpSntpTransport() {}
+
+UdpSntpTransport::~UdpSntpTransport() {
+    if (socket_ >= 0) close(socket_);
+}
+
+bool UdpSntpTransport::begin() {
+    socket_ = socket(AF_INET, SOCK_DGRAM, 0);
+    if (socket_ < 0) return false;
+    return fcntl(socket_, F_SETFL, fcntl(socket_, F_GETFL) | O_NONBLOCK) == 0;
+}
+
+bool UdpSntpTransport::send(int server, const char* host,
+                            const uint8_t* packet, size_t size) {
+    if (server < 0 || server >= SNTP_MAX_SERVERS) return false;
+    if (!resolved_[server] && !resolve_(server, host)) return false;
+    const sockaddr* address =
+        reinterpret_cast<const sockaddr*>(&addresses_[server]);
+    return sendto(socket_, packet, size, 0, address,
+                  sizeof(addresses_[server])) == static_cast<ssize_t>(size);
+}
+
+size_t UdpSntpTransport::receive(uint8_t* packet, size_t size) {
+    const ssize_t received = recv(socket_, packet, size, MSG_DONTWAIT);
+    return received > 0 ? received : 0;
+}
+
+void UdpSntpTransport::forget(int server) {
+    if (server >= 0 && server < SNTP_MAX_SERVERS) resolved_[server] = false;
+}
+
+bool UdpSntpTransport::resolve_(int server, const char* host) {
+    char name[256];
+    strncpy(name, host, sizeof(name) - 1);
+    name[sizeof(name) - 1] = 0;
+    int port = HOST_SNTP_DEFAULT_PORT;
+    char* colon = strrchr(name, ':');
+    if (colon != nullptr) {
+        *colon = 0;
+        port = atoi(colon + 1);
+    }
+
+    addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* results;
+    if (getaddrinfo(name, nullptr, &hints, &results) != 0) return false;
+    memcpy(&addresses_[server], results->ai_addr, sizeof(addresses_[server]));
+    freeaddrinfo(results);
+    addresses_[server].sin_port = htons(port);
+    resolved_[server] = true;
+    return true;
+}
+
+SimulatedSntpClock::SimulatedSntpClock(int64_t offset_us, double drift_ppm)
+    : error_us_(offset_us),
+      drift_ppm_(drift_ppm),
+      updated_us_(hostUs(CLOCK_MONOTONIC)) {}
+
+uint32_t SimulatedSntpClock::monotonicMs() {
+    return hostUs(CLOCK_MONOTONIC) / 1000;
+}
+
+int64_t SimulatedSntpClock::realtimeUs() {
+    update_();
+    return hostUs(CLOCK_REALTIME) + static_cast<int64_t>(error_us_);
+}
+
+void SimulatedSntpClock::step(int64_t offset_us) {
+    update_();
+    error_us_ += offset_us;
+}
+
+void SimulatedSntpClock::slew(int64_t offset_us) {
+    update_();
+    pending_us_ += offset_us;
+}
+
+int64_t SimulatedSntpClock::errorUs() {
+    update_();
+    return static_cast<int64_t>(error_us_);
+}
+
+void SimulatedSntpClock::update_() {
+    const int64_t now_us = hostUs(CLOCK_MONOTONIC);
+    const double elapsed_us = now_us - updated_us_;
+    updated_us_ = now_us;
+    error_us_ += elapsed_us * drift_ppm_ / 1e6;
+
+    const double max_slew_us = elapsed_us * HOST_SNTP_SLEW_RATE_PPM / 1e6;
+    double slew_us = pending_us_;
+    if (slew_us > max_slew_us) slew_us = max_slew_us;
+    if (slew_us < -max_slew_us) slew_us = -max_slew_us;
+    error_us_ += slew_us;
+    pending_us_ -= slew_us;
+}
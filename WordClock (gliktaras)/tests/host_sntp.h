@@ -0,0 +1,81 @@
+#ifndef WORDCLOCK_TESTS_HOST_SNTP_H_
+#define WORDCLOCK_TESTS_HOST_SNTP_H_
+
+#include <netinet/in.h>
+
+#include "sntp_client.h"
+
+// Default NTP port, used when a host has no port.
+#define HOST_SNTP_DEFAULT_PORT 123
+// Rate at which SimulatedSntpClock slews, in parts per million, as adjtime()
+// on Linux.
+#define HOST_SNTP_SLEW_RATE_PPM 500
+
+// SNTP transport over a non-blocking UDP socket of the host. Hosts are IPv4
+// addresses or names, optionally followed by `:port`, e.g. 127.0.0.1:12301.
+class UdpSntpTransport : public SntpTransport {
+  public:
+    UdpSntpTransport();
+    ~UdpSntpTransport() override;
+
+    UdpSntpTransport(const UdpSntpTransport&) = delete;
+    UdpSntpTransport& operator=(const UdpSntpTransport&) = delete;
+
+    // Opens the socket. Returns false on failure.
+    bool begin();
+
+    bool send(int server, const char* host, const uint8_t* packet,
+              size_t size) override;
+    size_t receive(uint8_t* packet, size_t size) override;
+    void forget(int server) override;
+
+  private:
+    // Resolves `host` into addresses_[server]. Returns false on failure.
+    bool resolve_(int server, const char* host);
+
+    int socket_ = -1;
+    // Resolved address of every server, valid if resolved_ is set.
+    sockaddr_in addresses_[SNTP_MAX_SERVERS];
+    bool resolved_[SNTP_MAX_SERVERS] = {};
+};
+
+// Clock that the client disciplines instead of the host's: the host's clock,
+// off by an initial offset and running fast or slow by a drift. The host's
+// clock, which the stand-in servers follow, is the reference its error is
+// measured against.
+//
+// Steps apply at once. Slews apply at HOST_SNTP_SLEW_RATE_PPM, like the
+// adjtime() the clock uses, so that their residual shows in the error.
+class SimulatedSntpClock : public SntpClock {
+  public:
+    // `offset_us` is the initial error, `drift_ppm` the rate of the clock
+    // against the host's, positive if it runs fast.
+    SimulatedSntpClock(int64_t offset_us, double drift_ppm);
+
+    SimulatedSntpClock(const SimulatedSntpClock&) = delete;
+    SimulatedSntpClock& operator=(const SimulatedSntpClock&) = delete;
+
+    uint32_t monotonicMs() override;
+    int64_t realtimeUs() override;
+    void step(int64_t offset_us) override;
+    void slew(int64_t offset_us) override;
+
+    // Returns the error of the clock against the host's, in microseconds.
+    int64_t errorUs();
+    // Returns the part of the slews still to apply, in microseconds.
+    int64_t pendingSlewUs() const { return static_cast<int64_t>(pending_us_); }
+
+  private:
+    // Advances the error to the host's current time.
+    void update_();
+
+    // Error against the host's clock, and the slews still to apply, in
+    // microseconds.
+    double error_us_;
+    double pending_us_ = 0;
+    const double drift_ppm_;
+    // Host monotonic time of the last update, in microseconds.
+    int64_t updated_us_;
+};
+
+#endif  // WORDCLOCK_TESTS_HOST_SNTP_H_
@@ -0,0 +1,288 @@
+// Host test of the JSON reader and writer, which parse and answer the REST
+// API's requests.
+
+#include <string.h>
+
+#include <string>
+
+#include "check.h"
+#include "json.h"
+
+CHECK_MAIN;
+
+namespace {
+
+// Returns whether `json` reads to the end without an error.
+bool valid(const char* json) {
+    JsonReader reader(json, strlen(json));
+    for (;;) {
+        const JsonToken token = reader.next();
+        if (token == JsonToken::END) return true;
+        if (token == JsonToken::ERROR) return false;
+    }
+}
+
+// Returns the single string value of `json`, or "<error>".
+std::string stringOf(const char* json) {
+    JsonReader reader(json, strlen(json));
+    if (reader.next() != JsonToken::STRING ||
+        reader.next() != JsonToken::END) {
+        return "<error>";
+    }
+    return reader.string();
+}
+
+// Reads the single number of `json` into `number`. Returns false on error.
+bool numberOf(const char* json, int32_t* number) {
+    JsonReader reader(json, strlen(json));
+    if (reader.next() != JsonToken::NUMBER ||
+        reader.next() != JsonToken::END) {
+        return false;
+    }
+    *number = reader.number();
+    return true;
+}
+
+void testTokens() {
+    const char json[] =
+        " {\"color\": \"#FF0000\", \"n\": [1, -2, true, false, null], "
+        "\"o\": {}}\n";
+    JsonReader reader(json, strlen(json));
+    CHECK(reader.next() == JsonToken::BEGIN_OBJECT);
+    CHECK(reader.next() == JsonToken::KEY);
+    CHECK(strcmp(reader.string(), "color") == 0);
+    CHECK(reader.next() == JsonToken::STRING);
+    CHECK(strcmp(reader.string(), "#FF0000") == 0);
+    CHECK(reader.next() == JsonToken::KEY);
+    CHECK(reader.next() == JsonToken::BEGIN_ARRAY);
+    CHECK(reader.next() == JsonToken::NUMBER);
+    CHECK_EQ(1, reader.number());
+    CHECK(reader.next() == JsonToken::NUMBER);
+    CHECK_EQ(-2, reader.number());
+    CHECK(reader.next() == JsonToken::TRUE);
+    CHECK(reader.next() == JsonToken::FALSE);
+    CHECK(reader.next() == JsonToken::NUL);
+    CHECK(reader.next() == JsonToken::END_ARRAY);
+    CHECK(reader.next() == JsonToken::KEY);
+    CHECK(reader.next() == JsonToken::BEGIN_OBJECT);
+    CHECK(reader.next() == JsonToken::END_OBJECT);
+    CHECK(reader.next() == JsonToken::END_OBJECT);
+    CHECK(reader.next() == JsonToken::END);
+    CHECK(reader.next() == JsonToken::END);
+}
+
+void testMalformed() {
+    CHECK(!valid(""));
+    CHECK(!valid("   "));
+    CHECK(!valid("[1,]"));
+    CHECK(!valid("{\"a\":1,}"));
+    CHECK(!valid("[,1]"));
+    CHECK(!valid("{,}"));
+    CHECK(!valid("[1 2]"));
+    CHECK(!valid("{\"a\" 1}"));
+    CHECK(!valid("{\"a\":}"));
+    CHECK(!valid("{1:2}"));
+    CHECK(!valid("[1}"));
+    CHECK(!valid("{\"a\":1]"));
+    CHECK(!valid("[1]]"));
+    CHECK(!valid("[1"));
+    CHECK(!valid("{} {}"));
+    CHECK(!valid("1 2"));
+    CHECK(!valid("tru"));
+    CHECK(!valid("nul"));
+    CHECK(!valid("True"));
+    CHECK(!valid("'a'"));
+    CHECK(!valid("\"a"));
+    CHECK(!valid("\"a\nb\""));
+    CHECK(!valid("\"\\x\""));
+
+    // Every token after an error is an error.
+    JsonReader reader("[1,]", 4);
+    CHECK(reader.next() == JsonToken::BEGIN_ARRAY);
+    CHECK(reader.next() == JsonToken::NUMBER);
+    CHECK(reader.next() == JsonToken::ERROR);
+    CHECK(reader.next() == JsonToken::ERROR);
+}
+
+void testNumbers() {
+    int32_t number = 0;
+    CHECK(numberOf("0", &number));
+    CHECK_EQ(0, number);
+    CHECK(numberOf("-0", &number));
+    CHECK_EQ(0, number);
+    CHECK(numberOf("2147483647", &number));
+    CHECK_EQ(INT32_MAX, number);
+    CHECK(numberOf("-2147483648", &number));
+    CHECK_EQ(INT32_MIN, number);
+    CHECK(!numberOf("2147483648", &number));
+    CHECK(!numberOf("-2147483649", &number));
+    CHECK(!numberOf("99999999999999999999", &number));
+
+    // Leading zeros.
+    CHECK(!numberOf("01", &number));
+    CHECK(!numberOf("-01", &number));
+    CHECK(!numberOf("00", &number));
+
+    // Only integers.
+    CHECK(!numberOf("1.5", &number));
+    CHECK(!numberOf("1e3", &number));
+    CHECK(!numberOf("1E3", &number));
+    CHECK(!numberOf("+1", &number));
+    CHECK(!numberOf("-", &number));
+    CHECK(!numberOf(".5", &number));
+}
+
+void testStrings() {
+    CHECK(stringOf("\"\"") == "");
+    CHECK(stringOf("\"\\\"\\\\\\/\\b\\f\\n\\r\\t\"") == "\"\\/\b\f\n\r\t");
+    CHECK(stringOf("\"\\u0041\\u00e9\\u20AC\"") == "A\xC3\xA9\xE2\x82\xAC");
+
+    // A surrogate pair is one code point, U+1F600 here.
+    CHECK(stringOf("\"\\ud83d\\ude00\"") == "\xF0\x9F\x98\x80");
+    CHECK(stringOf("\"\\uDBFF\\uDFFF\"") == "\xF4\x8F\xBF\xBF");
+    // Unpaired or reversed surrogates.
+    CHECK(stringOf("\"\\ud83d\"") == "<error>");
+    CHECK(stringOf("\"\\ud83dx\"") == "<error>");
+    CHECK(stringOf("\"\\ud83d\\u0041\"") == "<error>");
+    CHECK(stringOf("\"\\ude00\"") == "<error>");
+    CHECK(stringOf("\"\\ude00\\ud83d\"") == "<error>");
+    // Malformed \u escapes.
+    CHECK(stringOf("\"\\u12\"") == "<error>");
+    CHECK(stringOf("\"\\u12g4\"") == "<error>");
+
+    // Longest strings, escaped or not.
+    const std::string longest(JSON_STRING_LENGTH, 'a');
+    CHECK(stringOf(("\"" + longest + "\"").c_str()) == longest);
+    CHECK(stringOf(("\"" + longest + "a\"").c_str()) == "<error>");
+    const std::string almost(JSON_STRING_LENGTH - 1, 'a');
+    CHECK(stringOf(("\"" + almost + "\\u00e9\"").c_str()) == "<error>");
+    CHECK(stringOf(("\"" + almost + "\\n\"").c_str()) == almost + "\n");
+}
+
+void testNesting() {
+    std::string deepest;
+    for (int i = 0; i < JSON_MAX_DEPTH; i++) deepest += "[";
+    for (int i = 0; i < JSON_MAX_DEPTH; i++) deepest += "]";
+    CHECK(valid(deepest.c_str()));
+    CHECK(!valid(("[" + deepest + "]").c_str()));
+
+    std::string objects;
+    for (int i = 0; i < JSON_MAX_DEPTH; i++) objects += "{\"a\":";
+    objects += "1";
+    for (int i = 0; i < JSON_MAX_DEPTH; i++) objects += "}";
+    CHECK(valid(objects.c_str()));
+    CHECK(!valid(("[" + objects + "]").c_str()));
+}
+
+void testSkipValue() {
+    const char json[] = "{\"skip\": {\"a\": [1, {\"b\": 2}]}, \"keep\": 3}";
+    JsonReader reader(json, strlen(json));
+    CHECK(reader.next() == JsonToken::BEGIN_OBJECT);
+    CHECK(reader.next() == JsonToken::KEY);
+    CHECK(reader.skipValue(reader.next()));
+    CHECK(reader.next() == JsonToken::KEY);
+    CHECK(strcmp(reader.string(), "keep") == 0);
+    CHECK(reader.next() == JsonToken::NUMBER);
+    CHECK_EQ(3, reader.number());
+    CHECK(reader.next() == JsonToken::END_OBJECT);
+    CHECK(reader.next() == JsonToken::END);
+
+    JsonReader broken("{\"a\": [1,]}", 11);
+    CHECK(broken.next() == JsonToken::BEGIN_OBJECT);
+    CHECK(broken.next() == JsonToken::KEY);
+    CHECK(!broken.skipValue(broken.next()));
+}
+
+void testWriter() {
+    char buffer[128];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    json.key("color");
+    json.stringValue("#FF0000");
+    json.key("values");
+    json.beginArray();
+    json.numberValue(1);
+    json.numberValue(-9000000000LL);
+    json.boolValue(true);
+    json.nullValue();
+    json.beginObject();
+    json.endObject();
+    json.endArray();
+    json.key("on");
+    json.boolValue(false);
+    json.endObject();
+    CHECK(json.ok());
+    CHECK(strcmp(json.c_str(),
+                 "{\"color\":\"#FF0000\",\"values\":[1,-9000000000,true,"
+                 "null,{}],\"on\":false}") == 0);
+    CHECK_EQ(strlen(buffer), json.length());
+}
+
+void testWriterEscaping() {
+    char buffer[64];
+    JsonWriter json(buffer, sizeof(buffer));
+    json.beginObject();
+    json.key("k\"");
+    json.stringValue("a\"b\\c\n\x01\x1f\xC3\xA9/");
+    json.endObject();
+    CHECK(json.ok());
+    CHECK(strcmp(json.c_str(),
+                 "{\"k\\\"\":\"a\\\"b\\\\c\\u000a\\u0001\\u001f\xC3\xA9/\"}") ==
+          0);
+
+    // What the writer escapes, the reader reads back.
+    JsonReader reader(json.c_str(), json.length());
+    CHECK(reader.next() == JsonToken::BEGIN_OBJECT);
+    CHECK(reader.next() == JsonToken::KEY);
+    CHECK(strcmp(reader.string(), "k\"") == 0);
+    CHECK(reader.next() == JsonToken::STRING);
+    CHECK(strcmp(reader.string(), "a\"b\\c\n\x01\x1f\xC3\xA9/") == 0);
+}
+
+void testWriterOverflow() {
+    // Room for exactly {"a":1} and its NUL.
+    char buffer[8];
+    JsonWriter fits(buffer, sizeof(buffer));
+    fits.beginObject();
+    fits.key("a");
+    fits.numberValue(1);
+    fits.endObject();
+    CHECK(fits.ok());
+    CHECK(strcmp(buffer, "{\"a\":1}") == 0);
+
+    JsonWriter overflows(buffer, sizeof(buffer));
+    overflows.beginObject();
+    overflows.key("a");
+    overflows.numberValue(10);
+    overflows.endObject();
+    CHECK(!overflows.ok());
+    // Still NUL-terminated, within the buffer.
+    CHECK_EQ(sizeof(buffer) - 1, strlen(buffer));
+    CHECK_EQ(sizeof(buffer) - 1, overflows.length());
+
+    // Stays failed even if later output would fit.
+    char small[4];
+    JsonWriter failed(small, sizeof(small));
+    failed.stringValue("long");
+    failed.nullValue();
+    CHECK(!failed.ok());
+
+    JsonWriter empty(small, 0);
+    empty.nullValue();
+    CHECK(!empty.ok());
+}
+
+}  // namespace
+
+int main() {
+    testTokens();
+    testMalformed();
+    testNumbers();
+    testStrings();
+    testNesting();
+    testSkipValue();
+    testWriter();
+    testWriterEscaping();
+    testWriterOverflow();
+    return check::result("json_test");
+}
@@ -0,0 +1,47 @@
+#ifndef WORDCLOCK_TESTS_MEMORY_KEY_VALUE_STORE_H_
+#define WORDCLOCK_TESTS_MEMORY_KEY_VALUE_STORE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "config_store.h"
+
+// Key value store in memory, standing in for NVS on a host. Blobs may be
+// inspected and replaced directly, e.g. with records of older firmwares.
+class MemoryKeyValueStore : public KeyValueStore {
+  public:
+    MemoryKeyValueStore() {}
+
+    MemoryKeyValueStore(const MemoryKeyValueStore&) = delete;
+    MemoryKeyValueStore& operator=(const MemoryKeyValueStore&) = delete;
+
+    size_t size(const char* key) override {
+        const auto blob = blobs.find(key);
+        return blob == blobs.end() ? 0 : blob->second.size();
+    }
+
+    bool read(const char* key, void* data, size_t size) override {
+        const auto blob = blobs.find(key);
+        if (blob == blobs.end() || blob->second.size() != size) return false;
+        memcpy(data, blob->second.data(), size);
+        return true;
+    }
+
+    bool write(const char* key, const void* data, size_t size) override {
+        if (fail_writes) return false;
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        blobs[key].assign(bytes, bytes + size);
+        return true;
+    }
+
+    // Blobs by key.
+    std::map<std::string, std::vector<uint8_t>> blobs;
+    // Whether writes fail, keeping the old blobs.
+    bool fail_writes = false;
+};
+
+#endif  // WORDCLOCK_TESTS_MEMORY_KEY_VALUE_STORE_H_
@@ -0,0 +1,177 @@
+// Runs MqttClient on a host against a broker, typically a local mosquitto, and
+// checks that it connects, subscribes, publishes and reconnects.
+//
+//   mqtt_runner [--timeout S] HOST[:PORT]
+//
+// --timeout  time every step may take (default 10 s)
+//
+// Topics are under wordclock-runner/<pid>, so that runs do not see each other.
+// Exits with status 1 if a step fails.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <functional>
+
+#include "host_mqtt.h"
+#include "mqtt_client.h"
+
+namespace {
+
+#define DEFAULT_PORT 1883
+// Interval between two messages sent to oneself, in milliseconds.
+#define ECHO_PERIOD_MS 500
+
+uint32_t monotonicMs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+void usage() {
+    fprintf(stderr, "Usage: mqtt_runner [--timeout S] HOST[:PORT]\n");
+    exit(2);
+}
+
+// Client under test and what it received.
+class Runner {
+  public:
+    Runner(const char* host, uint16_t port, double timeout_s)
+        : client_(&transport_), timeout_ms_(timeout_s * 1000) {
+        snprintf(prefix_, sizeof(prefix_), "wordclock-runner/%d", getpid());
+        snprintf(client_id_, sizeof(client_id_), "wordclock-runner-%d",
+                 getpid());
+        snprintf(status_topic_, sizeof(status_topic_), "%s/status", prefix_);
+        snprintf(echo_topic_, sizeof(echo_topic_), "%s/echo", prefix_);
+        snprintf(filter_, sizeof(filter_), "%s/#", prefix_);
+        client_.setStatusTopic(status_topic_);
+        client_.subscribe(filter_);
+        client_.onMessage([this](const char* topic, const char* payload,
+                                 size_t) {
+            printf("%6ums  received %s: %s\n", monotonicMs() - start_ms_,
+                   topic, payload);
+            if (strcmp(topic, status_topic_) == 0) {
+                snprintf(status_, sizeof(status_), "%s", payload);
+                if (strcmp(payload, "offline") == 0) offline_seen_ = true;
+            } else if (strcmp(topic, echo_topic_) == 0) {
+                snprintf(echo_, sizeof(echo_), "%s", payload);
+            }
+        });
+        snprintf(host_, sizeof(host_), "%s", host);
+        client_.setServer(host_, port, client_id_, "", "");
+        start_ms_ = monotonicMs();
+    }
+
+    Runner(const Runner&) = delete;
+    Runner& operator=(const Runner&) = delete;
+
+    // Runs the client until `done` returns true. Returns false, printing
+    // `step`, if it does not within the timeout.
+    bool runUntil(const char* step, const std::function<bool()>& done) {
+        const uint32_t step_ms = monotonicMs();
+        while (!done()) {
+            if (monotonicMs() - step_ms > timeout_ms_) {
+                printf("%6ums  FAILED: %s\n", monotonicMs() - start_ms_, step);
+                return false;
+            }
+            client_.loop(monotonicMs());
+            usleep(1000);
+        }
+        printf("%6ums  ok: %s\n", monotonicMs() - start_ms_, step);
+        return true;
+    }
+
+    // Publishes `payload` to the echo topic until it comes back.
+    bool echo(const char* payload) {
+        uint32_t sent_ms = 0;
+        return runUntil("message published and received back", [&]() {
+            if (strcmp(echo_, payload) == 0) return true;
+            if (client_.connected() &&
+                monotonicMs() - sent_ms >= ECHO_PERIOD_MS) {
+                client_.publish(echo_topic_, payload);
+                sent_ms = monotonicMs();
+            }
+            return false;
+        });
+    }
+
+    bool run() {
+        if (!runUntil("connected", [&]() { return client_.connected(); }) ||
+            !runUntil("subscribed, status online",
+                      [&]() { return strcmp(status_, "online") == 0; }) ||
+            !echo("1")) {
+            return false;
+        }
+
+        // The broker notices the lost connection and publishes the will.
+        printf("%6ums  dropping the connection\n", monotonicMs() - start_ms_);
+        transport_.drop();
+        if (!runUntil("disconnected", [&]() { return !client_.connected(); }) ||
+            !runUntil("reconnected",
+                      [&]() { return client_.connections() == 2; }) ||
+            !runUntil("will published, status offline",
+                      [&]() { return offline_seen_; }) ||
+            !runUntil("resubscribed, status online",
+                      [&]() { return strcmp(status_, "online") == 0; }) ||
+            !echo("2")) {
+            return false;
+        }
+
+        // Clears the retained status, then disconnects cleanly.
+        client_.publish(status_topic_, "", true);
+        client_.loop(monotonicMs());
+        client_.setServer("", 0, "", "", "");
+        return client_.dropped() == 0;
+    }
+
+  private:
+    TcpMqttTransport transport_;
+    MqttClient client_;
+    const uint32_t timeout_ms_;
+    uint32_t start_ms_ = 0;
+    char host_[256] = "";
+    char prefix_[64];
+    char client_id_[64];
+    char status_topic_[80];
+    char echo_topic_[80];
+    char filter_[80];
+    // Last payloads received on the status and echo topics.
+    char status_[16] = "";
+    char echo_[16] = "";
+    // Whether the broker published the will.
+    bool offline_seen_ = false;
+};
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double timeout_s = 10;
+    const char* address = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--timeout") == 0 && i + 1 < argc) {
+            timeout_s = atof(argv[++i]);
+        } else if (argv[i][0] == '-' || address != nullptr) {
+            usage();
+        } else {
+            address = argv[i];
+        }
+    }
+    if (address == nullptr) usage();
+
+    char host[256];
+    snprintf(host, sizeof(host), "%s", address);
+    uint16_t port = DEFAULT_PORT;
+    char* colon = strrchr(host, ':');
+    if (colon != nullptr) {
+        *colon = 0;
+        port = atoi(colon + 1);
+    }
+
+    Runner runner(host, port, timeout_s);
+    if (!runner.run()) return 1;
+    printf("mqtt_runner: ok\n");
+    return 0;
+}
@@ -0,0 +1,154 @@
+// Host test of PosixTimezone against the C library's TZ handling, for every
+// zone of tools/timezones.csv.
+//
+//   posix_tz_test [timezones.csv]
+//
+// Local times are compared every half hour from 2017 to 2040, and to the
+// second around every transition the C library finds. Zones sharing a TZ
+// string are compared once.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <map>
+#include <string>
+
+#include "check.h"
+#include "posix_tz.h"
+
+CHECK_MAIN;
+
+namespace {
+
+#define DEFAULT_ZONES_PATH "../tools/timezones.csv"
+#define STEP_S 1800
+
+time_t utc(int year) {
+    struct tm time = {};
+    time.tm_year = year - 1900;
+    time.tm_mday = 1;
+    return timegm(&time);
+}
+
+// Local time of `time` according to the C library, for the TZ set last.
+struct tm libcLocal(time_t time) {
+    struct tm local;
+    localtime_r(&time, &local);
+    return local;
+}
+
+// Compares the local time of `time`. Returns false, printing the difference
+// once, if it does not match.
+bool compare(const char* zone, const char* tz, PosixTimezone* timezone,
+             time_t time) {
+    const struct tm expected = libcLocal(time);
+    struct tm actual;
+    timezone->toLocal(time, &actual);
+    if (expected.tm_year == actual.tm_year &&
+        expected.tm_yday == actual.tm_yday &&
+        expected.tm_hour == actual.tm_hour &&
+        expected.tm_min == actual.tm_min &&
+        expected.tm_sec == actual.tm_sec &&
+        expected.tm_isdst == actual.tm_isdst) {
+        return true;
+    }
+    printf("%s \"%s\" at %lld: expected %04d-%03d %02d:%02d:%02d dst %d, got "
+           "%04d-%03d %02d:%02d:%02d dst %d\n",
+           zone, tz, static_cast<long long>(time), expected.tm_year + 1900,
+           expected.tm_yday, expected.tm_hour, expected.tm_min,
+           expected.tm_sec, expected.tm_isdst, actual.tm_year + 1900,
+           actual.tm_yday, actual.tm_hour, actual.tm_min, actual.tm_sec,
+           actual.tm_isdst);
+    check::failures++;
+    return false;
+}
+
+// Returns the first second after `before` with the UTC offset of `after`.
+time_t findTransition(time_t before, time_t after) {
+    const long offset = libcLocal(after).tm_gmtoff;
+    while (after - before > 1) {
+        const time_t middle = before + (after - before) / 2;
+        if (libcLocal(middle).tm_gmtoff == offset) {
+            after = middle;
+        } else {
+            before = middle;
+        }
+    }
+    return after;
+}
+
+// Compares `tz` against the C library. Returns the number of transitions
+// checked.
+int compareZone(const char* zone, const char* tz) {
+    setenv("TZ", tz, 1);
+    tzset();
+    PosixTimezone timezone;
+    const time_t begin = utc(2017);
+    const time_t end = utc(2041);
+    if (!timezone.set(tz, begin)) {
+        printf("%s \"%s\" does not parse\n", zone, tz);
+        check::failures++;
+        return 0;
+    }
+
+    int transitions = 0;
+    long previous_offset = libcLocal(begin).tm_gmtoff;
+    for (time_t time = begin; time < end; time += STEP_S) {
+        if (!compare(zone, tz, &timezone, time)) return transitions;
+        const long offset = libcLocal(time).tm_gmtoff;
+        if (offset != previous_offset) {
+            const time_t transition = findTransition(time - STEP_S, time);
+            for (time_t around = transition - 2; around <= transition + 1;
+                 around++) {
+                if (!compare(zone, tz, &timezone, around)) {
+                    return transitions;
+                }
+            }
+            transitions++;
+            previous_offset = offset;
+        }
+    }
+    return transitions;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : DEFAULT_ZONES_PATH;
+    FILE* file = fopen(path, "r");
+    if (file == nullptr) {
+        perror(path);
+        return 2;
+    }
+
+    // First zone of every TZ string.
+    std::map<std::string, std::string> strings;
+    int zones = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), file) != nullptr) {
+        // "name","tz"
+        char* separator = strstr(line, "\",\"");
+        char* last = strrchr(line, '"');
+        if (line[0] != '"' || separator == nullptr || last <= separator + 2) {
+            printf("%s: bad line %s", path, line);
+            check::failures++;
+            continue;
+        }
+        *separator = 0;
+        *last = 0;
+        strings.insert(std::make_pair(separator + 3, line + 1));
+        zones++;
+    }
+    fclose(file);
+    CHECK(zones > 0);
+
+    int transitions = 0;
+    for (const auto& entry : strings) {
+        transitions += compareZone(entry.second.c_str(), entry.first.c_str());
+    }
+    printf("%d zones, %zu TZ strings, %d transitions\n", zones, strings.size(),
+           transitions);
+    return check::result("posix_tz_test");
+}
@@ -0,0 +1,104 @@
+// Runs SntpClient on a host against NTP servers, typically the stand-ins of
+// tools/ntp_standin.py, and prints how well it disciplines a simulated clock.
+//
+//   sntp_runner [--offset S] [--drift PPM] [--duration S] [--max-error-ms MS]
+//               HOST[:PORT]...
+//
+// --offset        initial error of the simulated clock (default 2 s)
+// --drift         rate error of the simulated clock, positive if it runs fast
+//                 (default 0 ppm)
+// --duration      time to run for (default 300 s)
+// --max-error-ms  exit with status 1 if the final error is larger
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "host_sntp.h"
+#include "sntp_client.h"
+
+namespace {
+
+void usage() {
+    fprintf(stderr,
+            "Usage: sntp_runner [--offset S] [--drift PPM] [--duration S] "
+            "[--max-error-ms MS] HOST[:PORT]...\n");
+    exit(2);
+}
+
+void printStatus(uint32_t elapsed_s, SimulatedSntpClock* clock,
+                 const SntpClient& client) {
+    printf("%4us error %+9.3f ms  offset %+9.3f ms  delay %7.3f ms  "
+           "drift %+7.2f ppm  poll %4us  steps %u slews %u ",
+           elapsed_s, clock->errorUs() / 1e3, client.lastOffsetUs() / 1e3,
+           client.lastDelayUs() / 1e3, client.driftPpm(),
+           client.pollIntervalS(), client.steps(), client.slews());
+    for (int i = 0; i < client.serverCount(); i++) {
+        const SntpClient::ServerStatus status = client.serverStatus(i);
+        printf(" %s reach %02x%s", status.host, status.reach,
+               status.selected ? "*" : "");
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double offset_s = 2;
+    double drift_ppm = 0;
+    double duration_s = 300;
+    double max_error_ms = -1;
+    const char* hosts[SNTP_MAX_SERVERS];
+    int host_count = 0;
+    for (int i = 1; i < argc; i++) {
+        const bool has_value = i + 1 < argc;
+        if (strcmp(argv[i], "--offset") == 0 && has_value) {
+            offset_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--drift") == 0 && has_value) {
+            drift_ppm = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--duration") == 0 && has_value) {
+            duration_s = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--max-error-ms") == 0 && has_value) {
+            max_error_ms = atof(argv[++i]);
+        } else if (argv[i][0] == '-' || host_count == SNTP_MAX_SERVERS) {
+            usage();
+        } else {
+            hosts[host_count++] = argv[i];
+        }
+    }
+    if (host_count == 0) usage();
+
+    UdpSntpTransport transport;
+    if (!transport.begin()) {
+        perror("socket");
+        return 2;
+    }
+    SimulatedSntpClock clock(static_cast<int64_t>(offset_s * 1e6), drift_ppm);
+    SntpClient client(&transport, &clock);
+    client.setServers(hosts, host_count);
+
+    const uint32_t start_ms = clock.monotonicMs();
+    uint32_t printed_s = 0;
+    const struct timespec pause = {0, 1000000};
+    for (;;) {
+        client.loop();
+        const uint32_t elapsed_s = (clock.monotonicMs() - start_ms) / 1000;
+        if (elapsed_s >= duration_s) break;
+        if (elapsed_s >= printed_s) {
+            printStatus(elapsed_s, &clock, client);
+            printed_s = elapsed_s + (elapsed_s < 10 ? 1 : 10);
+        }
+        nanosleep(&pause, nullptr);
+    }
+    printStatus(duration_s, &clock, client);
+
+    const double error_ms = fabs(clock.errorUs() / 1e3);
+    if (max_error_ms >= 0 && (!client.synchronized() || error_ms > max_error_ms)) {
+        printf("Error %.3f ms exceeds %.3f ms\n", error_ms, max_error_ms);
+        return 1;
+    }
+    return 0;
+}
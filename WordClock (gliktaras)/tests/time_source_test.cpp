@@ -0,0 +1,241 @@
+// Host test of TimeSource's RTC corrections, against a DS3231 register file
+// and a clock that only moves when told to.
+
+#include <math.h>
+#include <time.h>
+
+#include "check.h"
+#include "ds3231.h"
+#include "fake_i2c_bus.h"
+#include "time_source.h"
+
+CHECK_MAIN;
+
+namespace {
+
+// Registers of the DS3231.
+#define REG_STATUS 0x0F
+#define REG_AGING 0x10
+
+#define STATUS_OSF 0x80
+
+// 2023-11-14 22:13:20 UTC.
+#define START_UTC 1700000000
+
+// System clock of the test. Stepping and slewing change it at once.
+class FakeClock : public SntpClock {
+  public:
+    uint32_t monotonicMs() override { return ms; }
+    int64_t realtimeUs() override { return us; }
+    void step(int64_t offset_us) override { us += offset_us; }
+    void slew(int64_t offset_us) override { us += offset_us; }
+
+    // Moves both clocks forward by `delta_us`.
+    void advance(int64_t delta_us) {
+        us += delta_us;
+        ms += delta_us / 1000;
+    }
+
+    uint32_t ms = 1000;
+    int64_t us = 0;
+};
+
+// A TimeSource with its RTC and clock.
+class Harness {
+  public:
+    Harness() : bus(DS3231_ADDRESS), rtc(&bus), source(&rtc, &clock) {}
+
+    Harness(const Harness&) = delete;
+    Harness& operator=(const Harness&) = delete;
+
+    // Sets up a source whose RTC holds a valid time.
+    void start() {
+        rtc.writeTime(START_UTC);
+        CHECK(source.setup());
+    }
+
+    // Runs the first correction after a write of the RTC, which finds it off
+    // by `error_us`, and waits for the RTC to be written.
+    void measure(int64_t error_us) {
+        source.loop(true);
+        tick(error_us);
+        write();
+    }
+
+    // Runs a correction that finds the RTC `drift_ppm` fast since it was
+    // last written, and waits for the RTC to be written again.
+    void correct(float drift_ppm) {
+        source.loop(true);
+        const int64_t elapsed_us = nextTickUs() - written_us_;
+        tick(-WRITE_ERROR_US + llround(drift_ppm * elapsed_us / 1e6));
+        write();
+    }
+
+    // Waits for the RTC to be written, WRITE_ERROR_US into a second.
+    void write() {
+        clock.advance(1000000 - clock.us % 1000000 + WRITE_ERROR_US);
+        source.loop(true);
+        time_t utc = 0;
+        CHECK(rtc.readTime(&utc));
+        CHECK_EQ(clock.us / 1000000, utc);
+        written_us_ = clock.us;
+    }
+
+    // Lets a correction period pass.
+    void wait() { clock.advance(TIME_SOURCE_RTC_SYNC_PERIOD_S * 1000000LL); }
+
+    int aging() const { return static_cast<int8_t>(bus.registers[REG_AGING]); }
+
+    // How late in a second the RTC is written, in microseconds.
+    static const int64_t WRITE_ERROR_US = 1000;
+
+    FakeI2cBus bus;
+    Ds3231 rtc;
+    FakeClock clock;
+    TimeSource source;
+
+  private:
+    // Returns the system time of the next whole second, in microseconds.
+    int64_t nextTickUs() const { return (clock.us / 1000000 + 1) * 1000000; }
+
+    // Makes the RTC tick `error_us` before the system clock's next second,
+    // and lets the source measure it.
+    void tick(int64_t error_us) {
+        const int64_t tick_us = nextTickUs();
+        clock.advance(tick_us - error_us - clock.us);
+        rtc.writeTime(static_cast<time_t>(tick_us / 1000000));
+        source.loop(true);
+        CHECK_EQ(error_us, source.rtcErrorUs());
+    }
+
+    // System time of the last write of the RTC.
+    int64_t written_us_ = 0;
+};
+
+void testSetup() {
+    Harness valid;
+    valid.start();
+    CHECK(valid.source.rtcPresent());
+    CHECK(valid.source.kind() == TimeSourceKind::RTC);
+    // The middle of the RTC's second.
+    CHECK_EQ(START_UTC * 1000000LL + 500000, valid.clock.us);
+    valid.source.loop(true);
+    CHECK(valid.source.kind() == TimeSourceKind::NTP);
+
+    Harness stopped;
+    stopped.rtc.writeTime(START_UTC);
+    stopped.bus.registers[REG_STATUS] |= STATUS_OSF;
+    CHECK(!stopped.source.setup());
+    CHECK(stopped.source.rtcPresent());
+    CHECK(stopped.source.kind() == TimeSourceKind::NONE);
+    CHECK_EQ(0, stopped.clock.us);
+
+    Harness missing;
+    missing.bus.present = false;
+    CHECK(!missing.source.setup());
+    CHECK(!missing.source.rtcPresent());
+    missing.source.loop(true);
+    CHECK(missing.source.kind() == TimeSourceKind::NTP);
+}
+
+void testWaitsForNtp() {
+    Harness harness;
+    harness.start();
+    const int writes = harness.bus.writes;
+    for (int i = 0; i < 10; i++) {
+        harness.source.loop(false);
+        harness.clock.advance(TIME_SOURCE_RTC_SYNC_PERIOD_S * 1000000LL);
+    }
+    CHECK_EQ(writes, harness.bus.writes);
+}
+
+void testWritesInvalidRtc() {
+    Harness harness;
+    harness.bus.registers[REG_STATUS] |= STATUS_OSF;
+    CHECK(!harness.source.setup());
+    harness.clock.us = START_UTC * 1000000LL + 300000;
+    // Not written until the start of a second.
+    harness.source.loop(true);
+    harness.source.loop(true);
+    CHECK_EQ(0, harness.bus.writes);
+    harness.write();
+    CHECK(!harness.rtc.lostPower());
+
+    // Then left alone until the next correction is due.
+    const int writes = harness.bus.writes;
+    harness.clock.advance(TIME_SOURCE_RTC_SYNC_PERIOD_S * 1000000LL / 2);
+    harness.source.loop(true);
+    harness.source.loop(true);
+    CHECK_EQ(writes, harness.bus.writes);
+}
+
+void testResetsStoppedRtc() {
+    Harness harness;
+    harness.start();
+    harness.source.loop(true);
+    const int writes = harness.bus.writes;
+    // The seconds never tick.
+    harness.clock.advance(TIME_SOURCE_TICK_TIMEOUT_MS * 1000LL - 1000);
+    harness.source.loop(true);
+    CHECK_EQ(writes, harness.bus.writes);
+    harness.clock.advance(2000);
+    harness.source.loop(true);
+    harness.write();
+    CHECK(harness.bus.writes > writes);
+}
+
+void testMeasuresError() {
+    Harness harness;
+    harness.start();
+    // The RTC was not written since boot, so its error is not drift.
+    harness.measure(250000);
+    CHECK_EQ(0, harness.source.rtcDriftPpm());
+    CHECK_EQ(0, harness.aging());
+}
+
+void testAgingMovesOneStepAtATime() {
+    Harness harness;
+    harness.start();
+    harness.measure(0);
+
+    // 5 ppm fast calls for 50 steps, which are taken one per correction.
+    for (int i = 1; i <= 3; i++) {
+        harness.wait();
+        harness.correct(5);
+        CHECK(fabsf(harness.source.rtcDriftPpm() - 5) < 0.01f);
+        CHECK_EQ(i * TIME_SOURCE_MAX_AGING_STEP, harness.aging());
+    }
+
+    // Back the other way, as the drift turns.
+    harness.wait();
+    harness.correct(-5);
+    CHECK_EQ(2 * TIME_SOURCE_MAX_AGING_STEP, harness.aging());
+
+    // No change for a drift below half a step.
+    harness.wait();
+    harness.correct(0.02f);
+    CHECK_EQ(2 * TIME_SOURCE_MAX_AGING_STEP, harness.aging());
+}
+
+void testIgnoresImplausibleDrift() {
+    Harness harness;
+    harness.start();
+    harness.measure(0);
+    harness.wait();
+    harness.correct(TIME_SOURCE_MAX_DRIFT_PPM * 2);
+    CHECK(harness.source.rtcDriftPpm() > TIME_SOURCE_MAX_DRIFT_PPM);
+    CHECK_EQ(0, harness.aging());
+}
+
+}  // namespace
+
+int main() {
+    testSetup();
+    testWaitsForNtp();
+    testWritesInvalidRtc();
+    testResetsStoppedRtc();
+    testMeasuresError();
+    testAgingMovesOneStepAtATime();
+    testIgnoresImplausibleDrift();
+    return check::result("time_source_test");
+}
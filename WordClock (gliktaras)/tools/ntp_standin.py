@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+"""Stand-in NTP server with configurable error, for exercising SntpClient.
+
+Every --server option starts a server on a local UDP port, with its own clock
+offset, one-way network delays and jitter:
+
+    ntp_standin.py --server 12301 --server 12302:offset=0.25,delay=0.04 \\
+        --server 12303:delay=0.01,jitter=0.03,asymmetry=0.02
+
+offset     seconds added to the host clock in the replies (default 0)
+delay      base delay of both the request and the reply (default 0.005 s)
+jitter     upper bound of a uniformly random delay added to each (default 0)
+asymmetry  extra delay of the reply only, which biases the measured offset by
+           half of it and cannot be detected by a client (default 0)
+loss       probability of dropping a request (default 0)
+
+Point a host build of the client at 127.0.0.1:<port> for each server.
+"""
+
+import argparse
+import random
+import selectors
+import socket
+import struct
+import threading
+import time
+
+NTP_UNIX_OFFSET = 2208988800
+
+
+def to_ntp(unix_time):
+    seconds = int(unix_time)
+    fraction = int((unix_time - seconds) * (1 << 32))
+    return ((seconds + NTP_UNIX_OFFSET) & 0xFFFFFFFF) << 32 | fraction
+
+
+class Server:
+    def __init__(self, spec):
+        port, _, options = spec.partition(':')
+        self.port = int(port)
+        self.offset = 0.0
+        self.delay = 0.005
+        self.jitter = 0.0
+        self.asymmetry = 0.0
+        self.loss = 0.0
+        for option in filter(None, options.split(',')):
+            name, _, value = option.partition('=')
+            if not hasattr(self, name) or name == 'port':
+                raise SystemExit('Unknown option %s' % name)
+            setattr(self, name, float(value))
+        self.socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.socket.bind(('127.0.0.1', self.port))
+        self.requests = 0
+
+    def one_way_delay(self):
+        return self.delay + random.uniform(0, self.jitter)
+
+    def handle(self):
+        request, address = self.socket.recvfrom(512)
+        if len(request) < 48 or random.random() < self.loss:
+            return
+        self.requests += 1
+        # The request spends its delay in flight before the server sees it.
+        threading.Timer(self.one_way_delay(), self.reply,
+                        (request, address)).start()
+
+    def reply(self, request, address):
+        now = time.time() + self.offset
+        receive = to_ntp(now)
+        origin = request[40:48]
+        # Leap 0, version 4, server mode, stratum 2, poll 6, precision -20.
+        header = struct.pack('!BBbb', 0x24, 2, 6, -20)
+        packet = (header + bytes(8) + b'LOCL' + struct.pack('!Q', receive) +
+                  origin + struct.pack('!QQ', receive, to_ntp(now)))
+        threading.Timer(self.one_way_delay() + self.asymmetry,
+                        self.socket.sendto, (packet, address)).start()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description=__doc__.split('\n')[0],
+        formatter_class=argparse.RawDescriptionHelpFormatter, epilog=__doc__)
+    parser.add_argument('--server', action='append', required=True,
+                        metavar='PORT[:OPTIONS]')
+    args = parser.parse_args()
+
+    servers = [Server(spec) for spec in args.server]
+    selector = selectors.DefaultSelector()
+    for server in servers:
+        selector.register(server.socket, selectors.EVENT_READ, server)
+        print('Serving on 127.0.0.1:%d offset=%g delay=%g jitter=%g '
+              'asymmetry=%g loss=%g' % (server.port, server.offset,
+                                        server.delay, server.jitter,
+                                        server.asymmetry, server.loss))
+    while True:
+        for key, _ in selector.select():
+            key.data.handle()
+
+
+if __name__ == '__main__':
+    main()
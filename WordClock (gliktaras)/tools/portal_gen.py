@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Builds the configuration portal's static assets into a header.
+
+Every file of portal/ is gzip-compressed and written to WordClock/portal_assets.h
+as a PROGMEM array, together with its content type and a strong ETag derived
+from the compressed bytes. The firmware serves them at /static/<file name>
+with Content-Encoding: gzip, so that they are sent compressed and cached by
+browsers. Scripts are minified first, so that portal/ keeps readable sources.
+
+The header also holds the HTML that the configuration pages embed, with the
+asset URLs already filled in, so that the firmware sends it as is.
+
+Run it after editing any file of portal/:
+    portal_gen.py
+"""
+
+import argparse
+import gzip
+import hashlib
+import os
+import re
+import sys
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+SOURCE_DIR = os.path.join(TOOLS_DIR, '..', 'portal')
+OUTPUT_PATH = os.path.join(TOOLS_DIR, '..', 'WordClock', 'portal_assets.h')
+
+# URL prefix of the assets.
+URL_PREFIX = '/static/'
+CONTENT_TYPES = {
+    '.css': 'text/css',
+    '.html': 'text/html',
+    '.js': 'application/javascript',
+    '.svg': 'image/svg+xml',
+}
+
+# HTML the configuration pages embed, as C string names and templates. Asset
+# URLs are referred to as {logo_svg} and the like.
+FRAGMENTS = [
+    # Tags added to the head, after IotWebConf's style, so that the portal's
+    # style overrides it.
+    ('HTML_HEAD_EXTENSION',
+     '<meta name="theme-color" content="#121212" />\n'
+     '<link rel="icon" href="{logo_svg}" type="image/svg+xml" />\n'
+     '<link rel="stylesheet" href="{portal_css}" />\n'
+     '<script src="{portal_js}" defer></script>\n'),
+    # Start of the body: the logo, then what IotWebConf's body starts with.
+    ('HTML_BODY_INNER',
+     '<header><div class="logoContainer"><img class="logo" src="{logo_svg}"/>'
+     '</div></header>\n'
+     '<div style=\'text-align:left;display:inline-block;min-width:260px;\'>'
+     '\n'),
+]
+
+
+def minify_js(source):
+    """Removes the comments and the whitespace that scripts do not need.
+
+    Strings are kept as they are. Statements must end with semicolons, as
+    newlines are dropped, and regular expression literals are not supported.
+    """
+    out = []
+    i = 0
+    pending_space = False
+    while i < len(source):
+        c = source[i]
+        if source.startswith('//', i):
+            i = source.find('\n', i)
+            i = len(source) if i < 0 else i
+            pending_space = True
+        elif source.startswith('/*', i):
+            i = source.index('*/', i) + 2
+            pending_space = True
+        elif c.isspace():
+            i += 1
+            pending_space = True
+        elif c in '"\'`':
+            end = i + 1
+            while source[end] != c:
+                if source[end] == '\\':
+                    end += 1
+                elif source[end] == '\n' and c != '`':
+                    sys.exit('Unterminated string: %s' % source[i:end])
+                end += 1
+            if pending_space and out and is_word(out[-1][-1]):
+                out.append(' ')
+            out.append(source[i:end + 1])
+            i = end + 1
+            pending_space = False
+        else:
+            # Keeps a space only where tokens would otherwise merge.
+            if pending_space and out and (
+                    (is_word(out[-1][-1]) and is_word(c)) or
+                    (out[-1][-1] in '+-' and c == out[-1][-1])):
+                out.append(' ')
+            out.append(c)
+            i += 1
+            pending_space = False
+    return ''.join(out)
+
+
+def is_word(c):
+    return c.isalnum() or c in '_$'
+
+
+MINIFIERS = {
+    '.js': lambda raw: minify_js(raw.decode('utf-8')).encode('utf-8'),
+}
+
+
+class Asset:
+    def __init__(self, file_name, raw):
+        extension = os.path.splitext(file_name)[1]
+        if extension not in CONTENT_TYPES:
+            sys.exit('Unknown asset type: %s' % file_name)
+        if not re.fullmatch(r'[a-z0-9_]+\.[a-z]+', file_name):
+            sys.exit('Asset names must be lowercase identifiers: %s'
+                     % file_name)
+        self.file_name = file_name
+        self.identifier = file_name.replace('.', '_')
+        self.content_type = CONTENT_TYPES[extension]
+        if extension in MINIFIERS:
+            raw = MINIFIERS[extension](raw)
+        self.raw_size = len(raw)
+        # A fixed mtime keeps the output, and the ETag, reproducible.
+        self.data = gzip.compress(raw, compresslevel=9, mtime=0)
+        self.etag = hashlib.sha1(self.data).hexdigest()[:16]
+
+    @property
+    def path(self):
+        return URL_PREFIX + self.file_name
+
+    @property
+    def url(self):
+        # Pages refer to assets by their ETag, so that they can be cached
+        # for good and a firmware update still changes the reference.
+        return '%s?v=%s' % (self.path, self.etag)
+
+
+def read_assets():
+    assets = []
+    for file_name in sorted(os.listdir(SOURCE_DIR)):
+        with open(os.path.join(SOURCE_DIR, file_name), 'rb') as f:
+            assets.append(Asset(file_name, f.read()))
+    return assets
+
+
+def c_bytes(data, per_line=16):
+    lines = []
+    for i in range(0, len(data), per_line):
+        lines.append('    ' + ', '.join('0x%02x' % b
+                                        for b in data[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+def c_string(text):
+    lines = text.replace('\\', '\\\\').replace('"', '\\"').split('\n')
+    return '\n'.join('    "%s\\n"' % line for line in lines[:-1]) + (
+        '\n    "%s"' % lines[-1] if lines[-1] else '')
+
+
+def generate_header(assets):
+    asset_urls = {a.identifier: a.url for a in assets}
+    fragments = '\n\n'.join(
+        'const char %s[] PROGMEM =\n%s;' % (
+            name, c_string(template.format(**asset_urls)))
+        for name, template in FRAGMENTS)
+    urls = '\n'.join('#define PORTAL_URL_%s "%s"' % (a.identifier.upper(),
+                                                     a.url)
+                     for a in assets)
+    arrays = '\n\n'.join(
+        '// %s, %d bytes uncompressed.\n'
+        'const uint8_t %s[] PROGMEM = {\n%s\n};' % (
+            a.file_name, a.raw_size, a.identifier, c_bytes(a.data))
+        for a in assets)
+    entries = '\n'.join(
+        '    {"%s", "%s", "\\"%s\\"",\n'
+        '     data::%s, sizeof(data::%s)},' % (
+            a.path, a.content_type, a.etag, a.identifier, a.identifier)
+        for a in assets)
+    return '''\
+#ifndef WORDCLOCK_PORTAL_ASSETS_H_
+#define WORDCLOCK_PORTAL_ASSETS_H_
+
+// This file was generated by tools/portal_gen.py from portal/. Do not edit it
+// by hand.
+
+#include <Arduino.h>
+
+// Number of assets.
+#define PORTAL_ASSET_COUNT {count}
+
+// URLs to refer to the assets by, which change with their content.
+{urls}
+
+namespace portal {{
+
+// A static file of the configuration portal.
+struct Asset {{
+    // Path the asset is served at.
+    const char* path;
+    const char* content_type;
+    // Strong ETag, quoted.
+    const char* etag;
+    // Content, gzip-compressed.
+    const uint8_t* data;
+    size_t size;
+}};
+
+namespace data {{
+
+{arrays}
+
+}}  // namespace data
+
+const Asset assets[PORTAL_ASSET_COUNT] = {{
+{entries}
+}};
+
+// HTML of the configuration pages, with the asset URLs filled in.
+{fragments}
+
+}}  // namespace portal
+
+#endif  // WORDCLOCK_PORTAL_ASSETS_H_
+'''.format(count=len(assets), urls=urls, arrays=arrays, entries=entries,
+           fragments=fragments)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.parse_args()
+    assets = read_assets()
+    with open(OUTPUT_PATH, 'w', encoding='utf-8') as f:
+        f.write(generate_header(assets))
+    for asset in assets:
+        print('%-12s %6d -> %5d bytes' % (asset.file_name, asset.raw_size,
+                                          len(asset.data)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,128 @@
+#!/usr/bin/env python3
+"""Loads the configuration portal and reports the render loop's jitter.
+
+Scrapes /metrics, keeps --clients connections busy for --duration seconds,
+scrapes it again and prints, for the time in between, the distribution of the
+main loop iterations' durations, how late the loop woke up for its render
+ticks, and how many frames it missed:
+
+    portal_load.py 192.168.1.42 --clients 4 --duration 30
+
+Half of the clients fetch /config over and over. The other half are slow:
+they send their request one byte at a time, which a server handling requests
+in the render loop waits for. Run it with --clients 0 for a baseline.
+"""
+
+import argparse
+import re
+import socket
+import threading
+import time
+import urllib.request
+
+# Histograms reported, with what they count.
+HISTOGRAMS = [
+    ('wordclock_loop_duration_seconds', 'loop iterations'),
+    ('wordclock_render_tick_jitter_seconds', 'render ticks, by lateness'),
+]
+LATE_FRAMES = 'wordclock_render_late_frames_total'
+# Pause between the bytes of a slow client's request, in seconds.
+SLOW_BYTE_INTERVAL = 0.2
+
+
+def scrape(host):
+    with urllib.request.urlopen('http://%s/metrics' % host, timeout=10) as f:
+        return f.read().decode()
+
+
+def buckets(text, metric):
+    found = {}
+    for match in re.finditer(r'^%s_bucket\{le="([^"]+)"\} (\d+)$' % metric,
+                             text, re.M):
+        found[match.group(1)] = int(match.group(2))
+    if not found:
+        raise SystemExit('%s is missing from /metrics' % metric)
+    return found
+
+
+def counter(text, metric):
+    match = re.search(r'^%s (\d+)$' % metric, text, re.M)
+    if not match:
+        raise SystemExit('%s is missing from /metrics' % metric)
+    return int(match.group(1))
+
+
+def fast_client(host, stop, counts):
+    while not stop.is_set():
+        try:
+            with urllib.request.urlopen('http://%s/config' % host,
+                                        timeout=10) as f:
+                f.read()
+            counts['fast'] += 1
+        except OSError:
+            counts['errors'] += 1
+
+
+def slow_client(host, stop, counts):
+    request = ('GET / HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n\r\n'
+               % host).encode()
+    while not stop.is_set():
+        try:
+            with socket.create_connection((host, 80), timeout=10) as s:
+                for i in range(len(request)):
+                    if stop.is_set():
+                        return
+                    s.send(request[i:i + 1])
+                    time.sleep(SLOW_BYTE_INTERVAL)
+                while s.recv(1024):
+                    pass
+            counts['slow'] += 1
+        except OSError:
+            counts['errors'] += 1
+
+
+def report(before, after, what):
+    bounds = sorted(before, key=lambda le: float(le))
+    total = after['+Inf'] - before['+Inf']
+    print('%d %s' % (total, what))
+    if total == 0:
+        return
+    previous = 0
+    for le in bounds:
+        cumulative = after[le] - before[le]
+        print('  <= %-8s %8d  %6.2f%%' % (le, cumulative - previous,
+                                          100.0 * cumulative / total))
+        previous = cumulative
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('host')
+    parser.add_argument('--clients', type=int, default=4)
+    parser.add_argument('--duration', type=float, default=30)
+    args = parser.parse_args()
+
+    before = scrape(args.host)
+    stop = threading.Event()
+    counts = {'fast': 0, 'slow': 0, 'errors': 0}
+    threads = [threading.Thread(target=slow_client if i % 2 else fast_client,
+                                args=(args.host, stop, counts), daemon=True)
+               for i in range(args.clients)]
+    for thread in threads:
+        thread.start()
+    time.sleep(args.duration)
+    stop.set()
+    for thread in threads:
+        thread.join(timeout=15)
+    after = scrape(args.host)
+
+    print('%d fast and %d slow requests, %d errors' % (
+        counts['fast'], counts['slow'], counts['errors']))
+    for metric, what in HISTOGRAMS:
+        report(buckets(before, metric), buckets(after, metric), what)
+    print('%d late frames' % (counter(after, LATE_FRAMES) -
+                              counter(before, LATE_FRAMES)))
+
+
+if __name__ == '__main__':
+    main()
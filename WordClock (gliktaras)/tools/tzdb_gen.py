@@ -0,0 +1,382 @@
+#!/usr/bin/env python3
+"""Builds the timezone database, as a header or as a flash partition blob.
+
+The zones are read from timezones.csv, whose rows are "name","POSIX TZ rule"
+pairs as found in https://github.com/nayarsystems/posix_tz_db (zones.csv).
+The row order is the zone index stored in existing configurations, so rows must
+only ever be appended.
+
+Usage:
+    tzdb_gen.py [--merge zones.csv] header
+    tzdb_gen.py [--merge zones.csv] blob --data-version 2024a tzdata.bin
+    tzdb_gen.py validate tzdata.bin
+
+header writes WordClock/tzdb_data.h, the database built into the firmware.
+blob writes the same database in the format of the "tzdata" partition, which
+the firmware prefers over the built-in one and which can be replaced on its
+own, by uploading it to /api/tzdata or with:
+    parttool.py write_partition --partition-name tzdata --input tzdata.bin
+validate checks a blob the way the firmware does, and decodes all of it.
+
+--merge updates the rules of known zones from an upstream zones.csv and appends
+the zones it does not know yet to timezones.csv first. tests/posix_tz_test
+checks the firmware's parser against the C library for every zone of it.
+"""
+
+import argparse
+import csv
+import os
+import struct
+import sys
+import zlib
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+SOURCE_PATH = os.path.join(TOOLS_DIR, 'timezones.csv')
+OUTPUT_PATH = os.path.join(TOOLS_DIR, '..', 'WordClock', 'tzdb_data.h')
+
+# Number of names per front-coded block. Must match TZDB_BLOCK_SIZE in tzdb.h.
+BLOCK_SIZE = 16
+# Longest name, terminator included. Must match TZDB_NAME_LENGTH in tzdb.h.
+NAME_LENGTH = 32
+
+# Blob header, see BlobHeader in tzdb.cpp: magic, format version, header size,
+# blob size, CRC-32 of the blob after the header, data version, zone count,
+# rule count, block size, reserved, then offset and size of every section.
+BLOB_MAGIC = 0x42445A54  # "TZDB"
+BLOB_FORMAT_VERSION = 1
+BLOB_SECTIONS = ('names', 'name_blocks', 'rules', 'rule_offsets',
+                 'zone_rules', 'sorted')
+BLOB_HEADER = struct.Struct('<IHHII16sHHHH' + 'II' * len(BLOB_SECTIONS))
+# Size of the tzdata partition in partitions.csv.
+PARTITION_SIZE = 0x10000
+
+
+def read_zones(path):
+    with open(path, newline='', encoding='utf-8') as f:
+        return [(name, rule) for name, rule in csv.reader(f)]
+
+
+def write_zones(path, zones):
+    with open(path, 'w', newline='', encoding='utf-8') as f:
+        writer = csv.writer(f, quoting=csv.QUOTE_ALL, lineterminator='\n')
+        writer.writerows(zones)
+
+
+def merge(zones, upstream):
+    """Returns zones with rules updated and new zones appended."""
+    index = {name: i for i, (name, _) in enumerate(zones)}
+    zones = list(zones)
+    for name, rule in upstream:
+        # Upstream uses underscores, the portal shows spaces.
+        name = name.replace('_', ' ')
+        if name in index:
+            zones[index[name]] = (name, rule)
+        else:
+            index[name] = len(zones)
+            zones.append((name, rule))
+    return zones
+
+
+def shared_prefix(a, b):
+    length = 0
+    while length < min(len(a), len(b), 255) and a[length] == b[length]:
+        length += 1
+    return length
+
+
+def encode_names(names):
+    """Front-codes names, restarting every BLOCK_SIZE names.
+
+    Returns the encoded entries and the offset of every block.
+    """
+    entries = []
+    blocks = []
+    offset = 0
+    previous = b''
+    for i, name in enumerate(names):
+        if i % BLOCK_SIZE == 0:
+            blocks.append(offset)
+            previous = b''
+        prefix = shared_prefix(previous, name)
+        entries.append(bytes([prefix]) + name[prefix:] + b'\0')
+        offset += len(entries[-1])
+        previous = name
+    return entries, blocks
+
+
+def encode_rules(rules):
+    """Deduplicates rules.
+
+    Returns the encoded entries, their offsets and the rule index of every zone.
+    """
+    unique = sorted(set(rules))
+    entries = []
+    offsets = []
+    offset = 0
+    for rule in unique:
+        offsets.append(offset)
+        entries.append(rule + b'\0')
+        offset += len(entries[-1])
+    position = {rule: i for i, rule in enumerate(unique)}
+    return entries, offsets, [position[rule] for rule in rules]
+
+
+def c_string(entries):
+    """Formats entries as C string literals, one per line."""
+    lines = []
+    for entry in entries:
+        line = ''
+        for byte in entry:
+            if 32 <= byte < 127 and chr(byte) not in '"\\?':
+                line += chr(byte)
+            else:
+                # Three digit octal escapes never swallow the next character.
+                line += '\\%03o' % byte
+        lines.append('    "%s"' % line)
+    # The compiler adds the terminator of the last entry.
+    assert lines[-1].endswith('\\000"')
+    lines[-1] = lines[-1][:-5] + '"'
+    return '\n'.join(lines)
+
+
+def c_numbers(values, per_line=12):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join(str(v) for v in values[i:i + per_line]) + ',')
+    return '\n'.join(lines)
+
+
+class Database:
+    """Encoded sections of the database."""
+
+    def __init__(self, zones):
+        names = [name.encode('utf-8') for name, _ in zones]
+        rules = [rule.encode('ascii') for _, rule in zones]
+        for name in names:
+            if len(name) >= NAME_LENGTH:
+                sys.exit('Name too long: %s' % name.decode())
+            # Names are written to JSON and HTML unescaped.
+            if any(c in name for c in b'"\\<>&\'|') or min(name) < 32:
+                sys.exit('Unsafe character in name: %s' % name.decode())
+        if len(set(names)) != len(names):
+            sys.exit('Duplicate zone names.')
+
+        self.count = len(zones)
+        self.name_entries, self.blocks = encode_names(names)
+        self.rule_entries, self.rule_offsets, self.zone_rules = (
+            encode_rules(rules))
+        if len(self.rule_offsets) > 256:
+            sys.exit('Too many distinct rules for 8-bit indices.')
+        if max(self.blocks[-1], self.rule_offsets[-1]) > 0xFFFF:
+            sys.exit('Blob too large for 16-bit offsets.')
+        # Case-insensitive order, ties broken by byte order, as tzdb::compare()
+        # compares.
+        self.sorted = sorted(range(len(names)),
+                             key=lambda i: (names[i].lower(), names[i]))
+
+
+def generate_header(db):
+    return '''\
+#ifndef WORDCLOCK_TZDB_DATA_H_
+#define WORDCLOCK_TZDB_DATA_H_
+
+// This file was generated by tools/tzdb_gen.py from tools/timezones.csv. Do not
+// edit it by hand.
+
+#include <Arduino.h>
+
+// Number of zones.
+#define TZDB_COUNT {count}
+// Number of distinct rules.
+#define TZDB_RULE_COUNT {rule_count}
+
+namespace tzdb {{
+namespace data {{
+
+// Zone names in index order, front-coded: every entry is the length of the
+// prefix shared with the previous name, then the rest of the name and a
+// terminator. The first name of every block is stored whole.
+const char names[] PROGMEM =
+{names};
+
+// Offset in names of every block of TZDB_BLOCK_SIZE names.
+const uint16_t name_blocks[] PROGMEM = {{
+{blocks}
+}};
+
+// Distinct POSIX TZ rules, each followed by a terminator.
+const char rules[] PROGMEM =
+{rules};
+
+// Offset in rules of every distinct rule.
+const uint16_t rule_offsets[] PROGMEM = {{
+{rule_offsets}
+}};
+
+// Index in rule_offsets of the rule of every zone.
+const uint8_t zone_rules[] PROGMEM = {{
+{zone_rules}
+}};
+
+// Zone indices sorted by name, ignoring case.
+const uint16_t sorted[] PROGMEM = {{
+{sorted}
+}};
+
+}}  // namespace data
+}}  // namespace tzdb
+
+#endif  // WORDCLOCK_TZDB_DATA_H_
+'''.format(count=db.count, rule_count=len(db.rule_offsets),
+           names=c_string(db.name_entries), blocks=c_numbers(db.blocks),
+           rules=c_string(db.rule_entries),
+           rule_offsets=c_numbers(db.rule_offsets),
+           zone_rules=c_numbers(db.zone_rules, 20),
+           sorted=c_numbers(db.sorted))
+
+
+def generate_blob(db, data_version):
+    """Returns the partition image of the database."""
+    sections = {
+        'names': b''.join(db.name_entries),
+        'name_blocks': struct.pack('<%dH' % len(db.blocks), *db.blocks),
+        'rules': b''.join(db.rule_entries),
+        'rule_offsets': struct.pack('<%dH' % len(db.rule_offsets),
+                                    *db.rule_offsets),
+        'zone_rules': bytes(db.zone_rules),
+        'sorted': struct.pack('<%dH' % len(db.sorted), *db.sorted),
+    }
+    body = bytearray()
+    layout = []
+    for section in BLOB_SECTIONS:
+        # Sections are 4-byte aligned, for the 16-bit reads from mapped flash.
+        body += bytes(-(BLOB_HEADER.size + len(body)) % 4)
+        layout += [BLOB_HEADER.size + len(body), len(sections[section])]
+        body += sections[section]
+    header = BLOB_HEADER.pack(
+        BLOB_MAGIC, BLOB_FORMAT_VERSION, BLOB_HEADER.size,
+        BLOB_HEADER.size + len(body), zlib.crc32(body),
+        data_version.encode('ascii'), db.count, len(db.rule_offsets),
+        BLOCK_SIZE, 0, *layout)
+    blob = header + body
+    if len(blob) > PARTITION_SIZE:
+        sys.exit('Blob of %d bytes does not fit the partition.' % len(blob))
+    return blob
+
+
+def validate_blob(blob):
+    """Checks a blob like tzdb.cpp does. Returns a list of errors."""
+    if len(blob) < BLOB_HEADER.size:
+        return ['Blob is shorter than its header.']
+    fields = BLOB_HEADER.unpack_from(blob)
+    (magic, format_version, header_size, size, crc, data_version, count,
+     rule_count, block_size, _) = fields[:10]
+    layout = dict(zip(BLOB_SECTIONS, zip(fields[10::2], fields[11::2])))
+    if magic != BLOB_MAGIC:
+        return ['Bad magic 0x%08X.' % magic]
+    if format_version != BLOB_FORMAT_VERSION:
+        return ['Unsupported format version %d.' % format_version]
+    if header_size != BLOB_HEADER.size or not header_size <= size <= len(blob):
+        return ['Bad header or blob size.']
+    if zlib.crc32(blob[header_size:size]) != crc:
+        return ['CRC mismatch.']
+    if block_size != BLOCK_SIZE or count == 0 or rule_count == 0:
+        return ['Bad zone count, rule count or block size.']
+    expected_sizes = {
+        'name_blocks': 2 * ((count + block_size - 1) // block_size),
+        'rule_offsets': 2 * rule_count,
+        'zone_rules': count,
+        'sorted': 2 * count,
+    }
+    errors = []
+    for section, (offset, length) in layout.items():
+        if offset % 4 or offset < header_size or offset + length > size:
+            errors.append('Section %s out of bounds.' % section)
+        elif expected_sizes.get(section, length) != length:
+            errors.append('Section %s has a bad size.' % section)
+    if errors:
+        return errors
+
+    def section(name):
+        offset, length = layout[name]
+        return blob[offset:offset + length]
+
+    def u16(name):
+        data = section(name)
+        return struct.unpack('<%dH' % (len(data) // 2), data)
+
+    names_data = section('names')
+    rules_data = section('rules')
+    names = []
+    for block, block_offset in enumerate(u16('name_blocks')):
+        position = block_offset
+        previous = b''
+        for _ in range(min(block_size, count - block * block_size)):
+            end = names_data.find(b'\0', position + 1)
+            if position >= len(names_data) or end < 0:
+                return ['Name %d out of bounds.' % len(names)]
+            prefix = names_data[position]
+            name = previous[:prefix] + names_data[position + 1:end]
+            if prefix > len(previous) or len(name) >= NAME_LENGTH:
+                return ['Name %d is malformed.' % len(names)]
+            names.append(name)
+            previous = name
+            position = end + 1
+    rule_offsets = u16('rule_offsets')
+    for offset in rule_offsets:
+        if offset >= len(rules_data) or rules_data.find(b'\0', offset) < 0:
+            errors.append('Rule at %d out of bounds.' % offset)
+    for zone, rule in enumerate(section('zone_rules')):
+        if rule >= rule_count:
+            errors.append('Zone %d has no rule.' % zone)
+    order = u16('sorted')
+    if sorted(order) != list(range(count)):
+        errors.append('Sorted index is not a permutation.')
+    elif any((names[a].lower(), names[a]) > (names[b].lower(), names[b])
+             for a, b in zip(order, order[1:])):
+        errors.append('Sorted index is not sorted.')
+    if not errors:
+        print('%d zones, %d rules, data version %s, %d of %d bytes.' % (
+            count, rule_count, data_version.rstrip(b'\0').decode(), size,
+            PARTITION_SIZE))
+    return errors
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+    parser.add_argument('--merge', metavar='ZONES_CSV',
+                        help='upstream zones.csv to merge first')
+    commands = parser.add_subparsers(dest='command')
+    commands.add_parser('header', help='write WordClock/tzdb_data.h')
+    blob_parser = commands.add_parser('blob', help='write a partition blob')
+    blob_parser.add_argument('--data-version', required=True,
+                             help='version of the rules, e.g. 2024a')
+    blob_parser.add_argument('output')
+    validate_parser = commands.add_parser('validate', help='check a blob')
+    validate_parser.add_argument('input')
+    args = parser.parse_args()
+
+    if args.command == 'validate':
+        with open(args.input, 'rb') as f:
+            errors = validate_blob(f.read())
+        for error in errors:
+            print(error, file=sys.stderr)
+        sys.exit(1 if errors else 0)
+
+    zones = read_zones(SOURCE_PATH)
+    if args.merge:
+        zones = merge(zones, read_zones(args.merge))
+        write_zones(SOURCE_PATH, zones)
+    db = Database(zones)
+    if args.command == 'blob':
+        if len(args.data_version.encode('ascii')) > 15:
+            sys.exit('Data version is too long.')
+        with open(args.output, 'wb') as f:
+            f.write(generate_blob(db, args.data_version))
+    else:
+        with open(OUTPUT_PATH, 'w', encoding='utf-8') as f:
+            f.write(generate_header(db))
+
+
+if __name__ == '__main__':
+    main()